@@ -106,6 +106,8 @@ void dense_qp_hpipm_opts_initialize_default(void *config_, void *dims_, void *op
     opts->hpipm_opts->alpha_min = 1e-8;
     opts->hpipm_opts->mu0 = 1e0;
 
+    opts->time_limit = 0.0;
+
     return;
 }
 
@@ -124,7 +126,15 @@ void dense_qp_hpipm_opts_set(void *config_, void *opts_, const char *field, void
 {
     dense_qp_hpipm_opts *opts = opts_;
 
-	d_dense_qp_ipm_arg_set((char *) field, value, opts->hpipm_opts);
+    if (!strcmp(field, "time_limit"))
+    {
+        double *time_limit = value;
+        opts->time_limit = *time_limit;
+    }
+    else
+    {
+        d_dense_qp_ipm_arg_set((char *) field, value, opts->hpipm_opts);
+    }
 
 	return;
 }
@@ -173,6 +183,8 @@ void *dense_qp_hpipm_memory_assign(void *config_, void *dims_, void *opts_, void
     d_dense_qp_ipm_ws_create(dims, opts->hpipm_opts, ipm_workspace, c_ptr);
     c_ptr += ipm_workspace->memsize;
 
+    mem->time_per_iter = 0.0;
+
     assert((char *) raw_memory + dense_qp_hpipm_memory_calculate_size(config_, dims, opts) == c_ptr);
 
     return mem;
@@ -207,6 +219,15 @@ int dense_qp_hpipm(void *config, void *qp_in_, void *qp_out_, void *opts_, void
 	int ns = qp_in->dim->ns;
 	blasfeo_dvecse(nv+2*ns, 0.0, qp_out->v, 0);
 
+    // enforce the deadline by limiting the number of iterations, estimated from the last solve
+    int iter_max = opts->hpipm_opts->iter_max;
+    if (opts->time_limit > 0.0 && memory->time_per_iter > 0.0)
+    {
+        int iter_deadline = (int) (opts->time_limit / memory->time_per_iter);
+        iter_deadline = iter_deadline > 1 ? iter_deadline : 1;
+        opts->hpipm_opts->iter_max = iter_deadline < iter_max ? iter_deadline : iter_max;
+    }
+
     // solve ipm
     acados_tic(&qp_timer);
     int hpipm_status;
@@ -219,6 +240,10 @@ int dense_qp_hpipm(void *config, void *qp_in_, void *qp_out_, void *opts_, void
     info->num_iter = memory->hpipm_workspace->iter;
     info->t_computed = 1;
 
+    opts->hpipm_opts->iter_max = iter_max;
+    if (info->num_iter > 0)
+        memory->time_per_iter = info->solve_QP_time / info->num_iter;
+
     // check exit conditions
     int acados_status = hpipm_status;
     if (hpipm_status == 0) acados_status = ACADOS_SUCCESS;
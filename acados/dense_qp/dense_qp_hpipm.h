@@ -52,6 +52,7 @@ extern "C" {
 typedef struct dense_qp_hpipm_opts_
 {
     struct d_dense_qp_ipm_arg *hpipm_opts;
+    double time_limit;  // deadline of a solve in seconds, <= 0 for none
 } dense_qp_hpipm_opts;
 
 
@@ -59,6 +60,7 @@ typedef struct dense_qp_hpipm_opts_
 typedef struct dense_qp_hpipm_memory_
 {
     struct d_dense_qp_ipm_ws *hpipm_workspace;
+    double time_per_iter;  // measured in the last solve, converts the deadline into iter_max
 } dense_qp_hpipm_memory;
 
 
@@ -373,6 +373,10 @@ void dense_qp_ooqp_opts_set(void *config_, void *opts_, const char *field, void
     else if (!strcmp(field, "warm_start"))
     {
 		// TODO set solver warm start
+    }
+    else if (!strcmp(field, "time_limit"))
+    {
+		// no-op: OOQP cannot be interrupted, as in ocp_qp_ooqp
     }
 	else
 	{
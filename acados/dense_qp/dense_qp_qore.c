@@ -126,6 +126,10 @@ void dense_qp_qore_opts_set(void *config_, void *opts_, const char *field, void
     else if (!strcmp(field, "warm_start"))
     {
 		// TODO set solver warm start
+    }
+    else if (!strcmp(field, "time_limit"))
+    {
+		// no-op: qore has no time limit; bound the solve time with max_iter instead
     }
 	else
 	{
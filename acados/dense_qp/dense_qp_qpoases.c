@@ -158,14 +158,19 @@ void dense_qp_qpoases_opts_set(void *config_, void *opts_, const char *field, vo
     }
     else if (!strcmp(field, "warm_start"))
     {
-        // TODO set solver warm start
-        // opts->
+        int *warm_start = value;
+        opts->warm_start = *warm_start;
     }
     else if (!strcmp(field, "iter_max"))
     {
         int *max_iter = value;
         opts->max_nwsr = *max_iter;
     }
+    else if (!strcmp(field, "time_limit"))
+    {
+        double *time_limit = value;
+        opts->max_cputime = *time_limit > 0.0 ? *time_limit : 1000.0;
+    }
     else
     {
         printf("\nerror: dense_qp_qpoases_opts_set: wrong field: %s\n", field);
@@ -231,6 +236,17 @@ int dense_qp_qpoases_memory_calculate_size(void *config_, dense_qp_dims *dims, v
     else  // QProblemB
         size += QProblemB_calculateMemorySize(nv);
 
+    // working set for warm start
+    if (ng > 0 || ns > 0)
+    {
+        size += Bounds_calculateMemorySize(nv2);
+        size += Constraints_calculateMemorySize(ng2);
+    }
+    else
+    {
+        size += Bounds_calculateMemorySize(nv);
+    }
+
     make_int_multiple_of(8, &size);
 
     return size;
@@ -317,6 +333,21 @@ void *dense_qp_qpoases_memory_assign(void *config_, dense_qp_dims *dims, void *o
         c_ptr += QProblemB_calculateMemorySize(nv);
     }
 
+    // working set for warm start
+    if (ng > 0 || ns > 0)
+    {
+        Bounds_assignMemory(nv2, (Bounds **) &(mem->bounds), c_ptr);
+        c_ptr += Bounds_calculateMemorySize(nv2);
+        Constraints_assignMemory(ng2, (Constraints **) &(mem->constraints), c_ptr);
+        c_ptr += Constraints_calculateMemorySize(ng2);
+    }
+    else
+    {
+        Bounds_assignMemory(nv, (Bounds **) &(mem->bounds), c_ptr);
+        c_ptr += Bounds_calculateMemorySize(nv);
+        mem->constraints = NULL;
+    }
+
     assign_and_advance_int(nb, &mem->idxb, &c_ptr);
     assign_and_advance_int(nb2, &mem->idxb_stacked, &c_ptr);
     assign_and_advance_int(ns, &mem->idxs, &c_ptr);
@@ -326,6 +357,7 @@ void *dense_qp_qpoases_memory_assign(void *config_, dense_qp_dims *dims, void *o
 
     // assign default values to fields stored in the memory
     mem->first_it = 1;  // only used if hotstart (only constant data matrices) is enabled
+    mem->has_working_set = 0;
 
     return mem;
 }
@@ -387,6 +419,8 @@ int dense_qp_qpoases(void *config_, dense_qp_in *qp_in, dense_qp_out *qp_out, vo
     double *dual_sol = memory->dual_sol;
     QProblemB *QPB = memory->QPB;
     QProblem *QP = memory->QP;
+    Bounds *bounds = memory->bounds;
+    Constraints *constraints = memory->constraints;
     dense_qp_in *qp_stacked = memory->qp_stacked;
 
     // extract dense qp size
@@ -549,13 +583,15 @@ int dense_qp_qpoases(void *config_, dense_qp_in *qp_in, dense_qp_out *qp_out, vo
                     Options_setToMPC(&options);
                     QProblem_setOptions(QP, options);
                 }
-                if (opts->warm_start)
+                if (opts->warm_start && memory->has_working_set)
                 {
+                    // start the homotopy from the previous solution and working set, across
+                    // SQP iterations only a few active set changes are expected
                     qpoases_status = (ns > 0) ?
                         QProblem_initW(QP, HH, gg, CC, d_lb, d_ub, d_lg, d_ug, &nwsr,
-                                       &cputime, NULL, dual_sol, NULL, NULL, NULL) :
+                                       &cputime, prim_sol, dual_sol, bounds, constraints, NULL) :
                         QProblem_initW(QP, H, g, C, d_lb, d_ub, d_lg0, d_ug0, &nwsr,
-                                       &cputime, NULL, dual_sol, NULL, NULL, NULL);
+                                       &cputime, prim_sol, dual_sol, bounds, constraints, NULL);
                 }
                 else
                 {
@@ -566,6 +602,8 @@ int dense_qp_qpoases(void *config_, dense_qp_in *qp_in, dense_qp_out *qp_out, vo
             }
             QProblem_getPrimalSolution(QP, prim_sol);
             QProblem_getDualSolution(QP, dual_sol);
+            QProblem_getBounds(QP, bounds);
+            QProblem_getConstraints(QP, constraints);
         }
         else
         {  // QProblemB
@@ -592,11 +630,11 @@ int dense_qp_qpoases(void *config_, dense_qp_in *qp_in, dense_qp_out *qp_out, vo
                     Options_setToMPC(&options);
                     QProblemB_setOptions(QPB, options);
                 }
-                if (opts->warm_start)
+                if (opts->warm_start && memory->has_working_set)
                 {
                     qpoases_status = QProblemB_initW(QPB, H, g, d_lb, d_ub, &nwsr, &cputime,
-                                                     /* primal sol */ NULL, /* dual sol */ dual_sol,
-                                                     /* guessed bounds */ NULL,
+                                                     /* primal sol */ prim_sol, /* dual sol */ dual_sol,
+                                                     /* guessed bounds */ bounds,
                                                      /* R */ NULL);
                 }
                 else
@@ -606,7 +644,12 @@ int dense_qp_qpoases(void *config_, dense_qp_in *qp_in, dense_qp_out *qp_out, vo
             }
             QProblemB_getPrimalSolution(QPB, prim_sol);
             QProblemB_getDualSolution(QPB, dual_sol);
+            QProblemB_getBounds(QPB, bounds);
         }
+
+        // a failed solve leaves no usable working set
+        memory->has_working_set =
+            qpoases_status == SUCCESSFUL_RETURN || qpoases_status == RET_MAX_NWSR_REACHED;
     }
 
     // save solution statistics to memory
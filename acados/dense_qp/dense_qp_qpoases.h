@@ -50,7 +50,7 @@ typedef struct dense_qp_qpoases_opts_
 {
     double max_cputime;  // maximum cpu time in seconds
     int max_nwsr;        // maximum number of working set recalculations
-    int warm_start;      // warm start with dual_sol in memory
+    int warm_start;      // warm start with the primal-dual solution and working set in memory
     int use_precomputed_cholesky;
     int hotstart;  // this option requires constant data matrices! (eg linear MPC, inexact schemes
                    // with frozen sensitivities)
@@ -90,6 +90,9 @@ typedef struct dense_qp_qpoases_memory_
     double *dual_sol;
     void *QPB;       // NOTE(giaf): cast to QProblemB to use
     void *QP;        // NOTE(giaf): cast to QProblem to use
+    void *bounds;       // NOTE: cast to Bounds to use, working set of the last solve
+    void *constraints;  // NOTE: cast to Constraints to use, working set of the last solve
+    int has_working_set;  // bounds and constraints hold the working set of a successful solve
     double cputime;  // cputime of qpoases
     int nwsr;        // performed number of working set recalculations
     int first_it;    // to be used with hotstart
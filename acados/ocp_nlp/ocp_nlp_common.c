@@ -346,7 +346,8 @@ ocp_nlp_dims *ocp_nlp_dims_assign(void *config_, void *raw_memory)
 void ocp_nlp_dims_set_opt_vars(void *config_, void *dims_, const char *field,
                                     const void* value_array)
 {
-    // to set dimension nx, nu, nz, ns (number of slacks = number of soft constraints)
+    // to set dimension nx, nu, nz, ns (number of slacks = number of soft constraints),
+    // and mb_hold (move blocking: 1 if the controls of the stage equal the ones of the previous stage)
     ocp_nlp_config *config = config_;
     ocp_nlp_dims *dims = dims_;
 
@@ -494,6 +495,15 @@ void ocp_nlp_dims_set_opt_vars(void *config_, void *dims_, const char *field,
                                         &int_array[i]);
         }
     }
+    else if (!strcmp(field, "mb_hold"))
+    {
+        // move blocking, only seen by the qp solver
+        for (int i = 0; i <= N; i++)
+        {
+            config->qp_solver->dims_set(config->qp_solver, dims->qp_solver, i, "mb_hold",
+                                        &int_array[i]);
+        }
+    }
     else
     {
         printf("error: dims type not available in module ocp_nlp: %s", field);
@@ -92,6 +92,8 @@ typedef struct
     // evaluate solver // TODO rename into solve
     int (*evaluate)(void *config, void *dims, void *nlp_in, void *nlp_out, void *opts_, void *mem, void *work);
     void (*eval_param_sens)(void *config, void *dims, void *opts_, void *mem, void *work, char *field, int stage, int index, void *sens_nlp_out);
+    // overwrite the state of stage+1 in nlp_out by the simulated dynamics of stage (NULL if not available)
+    void (*simulate_stage)(void *config, void *dims, void *nlp_in, void *nlp_out, void *opts_, void *mem, void *work, int stage);
     // prepare memory
     int (*precompute)(void *config, void *dims, void *nlp_in, void *nlp_out, void *opts_, void *mem, void *work);
     // initalize this struct with default values
@@ -647,6 +647,51 @@ int ocp_nlp_constraints_bgh_model_set(void *config_, void *dims_,
 }
 
 
+int ocp_nlp_constraints_bgh_model_get(void *config_, void *dims_,
+                         void *model_, const char *field, void *value)
+{
+    ocp_nlp_constraints_bgh_dims *dims = (ocp_nlp_constraints_bgh_dims *) dims_;
+    ocp_nlp_constraints_bgh_model *model = (ocp_nlp_constraints_bgh_model *) model_;
+
+    if (!dims || !model || !field || !value)
+    {
+        printf("ocp_nlp_constraints_bgh_model_get: got Null pointer \n");
+        exit(1);
+    }
+
+    int nb = dims->nb;
+    int ng = dims->ng;
+    int nh = dims->nh;
+    int nbx = dims->nbx;
+    int nbu = dims->nbu;
+
+    if (!strcmp(field, "lbx"))
+    {
+        blasfeo_unpack_dvec(nbx, &model->d, nbu, value);
+    }
+    else if (!strcmp(field, "ubx"))
+    {
+        blasfeo_unpack_dvec(nbx, &model->d, nb + ng + nh + nbu, value);
+    }
+    else if (!strcmp(field, "lbu"))
+    {
+        blasfeo_unpack_dvec(nbu, &model->d, 0, value);
+    }
+    else if (!strcmp(field, "ubu"))
+    {
+        blasfeo_unpack_dvec(nbu, &model->d, nb + ng + nh, value);
+    }
+    else
+    {
+        printf("\nerror: ocp_nlp_constraints_bgh_model_get: field %s not available\n", field);
+        exit(1);
+    }
+
+    return ACADOS_SUCCESS;
+}
+
+
+
 /************************************************
  * options
  ************************************************/
@@ -683,6 +728,9 @@ void ocp_nlp_constraints_bgh_opts_initialize_default(void *config_, void *dims_,
 
     opts->compute_adj = 1;
     opts->compute_hess = 0;
+    opts->screen_margin = 0.0;
+    opts->screen_lam_tol = 1e-6;
+    opts->screen_verify = 0;
 
     return;
 }
@@ -713,6 +761,21 @@ void ocp_nlp_constraints_bgh_opts_set(void *config_, void *opts_, char *field, v
         int *compute_hess = value;
         opts->compute_hess = *compute_hess;
     }
+    else if(!strcmp(field, "screen_margin"))
+    {
+        double *screen_margin = value;
+        opts->screen_margin = *screen_margin;
+    }
+    else if(!strcmp(field, "screen_lam_tol"))
+    {
+        double *screen_lam_tol = value;
+        opts->screen_lam_tol = *screen_lam_tol;
+    }
+    else if(!strcmp(field, "screen_verify"))
+    {
+        int *screen_verify = value;
+        opts->screen_verify = *screen_verify;
+    }
     else
     {
         printf("\nerror: field %s not available in ocp_nlp_constraints_bgh_opts_set\n", field);
@@ -732,6 +795,7 @@ void ocp_nlp_constraints_bgh_opts_set(void *config_, void *opts_, char *field, v
 int ocp_nlp_constraints_bgh_memory_calculate_size(void *config_, void *dims_, void *opts_)
 {
     ocp_nlp_constraints_bgh_dims *dims = dims_;
+    ocp_nlp_constraints_bgh_opts *opts = opts_;
 
     // extract dims
     int nx = dims->nx;
@@ -748,6 +812,13 @@ int ocp_nlp_constraints_bgh_memory_calculate_size(void *config_, void *dims_, vo
     size += 1 * blasfeo_memsize_dvec(2 * nb + 2 * ng + 2 * nh + 2 * ns);  // fun
     size += 1 * blasfeo_memsize_dvec(nu + nx + 2 * ns);                   // adj
 
+    if (opts->screen_margin > 0.0 && nh > 0)
+    {
+        size += 1 * blasfeo_memsize_dmat(nu + nx, nh);  // jac_h_s
+        size += 1 * blasfeo_memsize_dvec(nh);           // h_s
+        size += 1 * blasfeo_memsize_dvec(nu + nx);      // ux_s
+    }
+
     size += 1 * 64;  // blasfeo_mem align
 
     return size;
@@ -759,6 +830,7 @@ void *ocp_nlp_constraints_bgh_memory_assign(void *config_, void *dims_, void *op
                                             void *raw_memory)
 {
     ocp_nlp_constraints_bgh_dims *dims = dims_;
+    ocp_nlp_constraints_bgh_opts *opts = opts_;
 
     char *c_ptr = (char *) raw_memory;
 
@@ -777,10 +849,22 @@ void *ocp_nlp_constraints_bgh_memory_assign(void *config_, void *dims_, void *op
     // blasfeo_mem align
     align_char_to(64, &c_ptr);
 
+    // jac_h_s
+    if (opts->screen_margin > 0.0 && nh > 0)
+        assign_and_advance_blasfeo_dmat_mem(nu + nx, nh, &memory->jac_h_s, &c_ptr);
     // fun
     assign_and_advance_blasfeo_dvec_mem(2 * nb + 2 * ng + 2 * nh + 2 * ns, &memory->fun, &c_ptr);
     // adj
     assign_and_advance_blasfeo_dvec_mem(nu + nx + 2 * ns, &memory->adj, &c_ptr);
+    if (opts->screen_margin > 0.0 && nh > 0)
+    {
+        // h_s
+        assign_and_advance_blasfeo_dvec_mem(nh, &memory->h_s, &c_ptr);
+        // ux_s
+        assign_and_advance_blasfeo_dvec_mem(nu + nx, &memory->ux_s, &c_ptr);
+    }
+
+    memory->screened = 0;
 
     assert((char *) raw_memory +
                ocp_nlp_constraints_bgh_memory_calculate_size(config_, dims, opts_) >=
@@ -994,11 +1078,42 @@ void ocp_nlp_constraints_bgh_initialize(void *config_, void *dims_, void *model_
     // initialize general constraints matrix
     blasfeo_dgecp(nu + nx, ng, &model->DCt, 0, 0, memory->DCt, 0, 0);
 
+    // the parameters of h may have changed
+    memory->screened = 0;
+
     return;
 }
 
 
 
+// checks if all nonlinear constraints (values in tmp_ni) are at least screen_margin away from
+// their bounds and have (numerically) zero multipliers
+static int bgh_h_far_inactive(ocp_nlp_constraints_bgh_dims *dims, ocp_nlp_constraints_bgh_model *model,
+                              ocp_nlp_constraints_bgh_opts *opts, ocp_nlp_constraints_bgh_memory *memory,
+                              ocp_nlp_constraints_bgh_workspace *work)
+{
+    int nb = dims->nb;
+    int ng = dims->ng;
+    int nh = dims->nh;
+
+    int j;
+    double h;
+
+    for (j = 0; j < nh; j++)
+    {
+        h = BLASFEO_DVECEL(&work->tmp_ni, nb+ng+j);
+        if (h - BLASFEO_DVECEL(&model->d, nb+ng+j) <= opts->screen_margin ||
+            BLASFEO_DVECEL(&model->d, 2*nb+2*ng+nh+j) - h <= opts->screen_margin ||
+            BLASFEO_DVECEL(memory->lam, nb+ng+j) > opts->screen_lam_tol ||
+            BLASFEO_DVECEL(memory->lam, 2*nb+2*ng+nh+j) > opts->screen_lam_tol)
+            return 0;
+    }
+
+    return 1;
+}
+
+
+
 void ocp_nlp_constraints_bgh_update_qp_matrices(void *config_, void *dims_, void *model_,
                                                 void *opts_, void *memory_, void *work_)
 {
@@ -1030,8 +1145,26 @@ void ocp_nlp_constraints_bgh_update_qp_matrices(void *config_, void *dims_, void
     // general linear
     blasfeo_dgemv_t(nu+nx, ng, 1.0, memory->DCt, 0, 0, memory->ux, 0, 0.0, &work->tmp_ni, nb, &work->tmp_ni, nb);
 
+    // screening: far from their bounds and inactive, the nonlinear constraints are extrapolated
+    // linearly from the screening point instead of being evaluated
+    int screen = opts->screen_margin > 0.0 && nh > 0 && nz == 0;
+    if (screen && memory->screened && !opts->screen_verify)
+    {
+        blasfeo_dveccp(nh, &memory->h_s, 0, &work->tmp_ni, nb+ng);
+        blasfeo_dgemv_t(nu+nx, nh, -1.0, &memory->jac_h_s, 0, 0, &memory->ux_s, 0, 1.0, &work->tmp_ni, nb+ng, &work->tmp_ni, nb+ng);
+        blasfeo_dgemv_t(nu+nx, nh, 1.0, &memory->jac_h_s, 0, 0, memory->ux, 0, 1.0, &work->tmp_ni, nb+ng, &work->tmp_ni, nb+ng);
+        if (bgh_h_far_inactive(dims, model, opts, memory, work))
+            blasfeo_dgecp(nu+nx, nh, &memory->jac_h_s, 0, 0, memory->DCt, 0, ng);
+        else
+            memory->screened = 0;
+    }
+    else
+    {
+        memory->screened = 0;
+    }
+
     // nonlinear
-    if (nh > 0)
+    if (nh > 0 && !memory->screened)
     {
         struct blasfeo_dvec_args x_in;  // input x of external fun;
         x_in.x = memory->ux;
@@ -1145,6 +1278,15 @@ void ocp_nlp_constraints_bgh_update_qp_matrices(void *config_, void *dims_, void
 			blasfeo_dgemv_t(nu+nx, nh, -1.0, &work->tmp_nz_nh, 0, 0, memory->ux,
 					0, 1.0, &memory->fun, 0, &memory->fun, 0);
         }
+
+        // screen from the next call on
+        if (screen && bgh_h_far_inactive(dims, model, opts, memory, work))
+        {
+            blasfeo_dveccp(nh, &work->tmp_ni, nb+ng, &memory->h_s, 0);
+            blasfeo_dgecp(nu+nx, nh, memory->DCt, 0, ng, &memory->jac_h_s, 0, 0);
+            blasfeo_dveccp(nu+nx, memory->ux, 0, &memory->ux_s, 0);
+            memory->screened = 1;
+        }
     }
 
     blasfeo_daxpy(nb+ng+nh, -1.0, &work->tmp_ni, 0, &model->d, 0, &memory->fun, 0);
@@ -1186,6 +1328,7 @@ void ocp_nlp_constraints_bgh_config_initialize_default(void *config_)
     config->model_calculate_size = &ocp_nlp_constraints_bgh_model_calculate_size;
     config->model_assign = &ocp_nlp_constraints_bgh_model_assign;
     config->model_set = &ocp_nlp_constraints_bgh_model_set;
+    config->model_get = &ocp_nlp_constraints_bgh_model_get;
     config->opts_calculate_size = &ocp_nlp_constraints_bgh_opts_calculate_size;
     config->opts_assign = &ocp_nlp_constraints_bgh_opts_assign;
     config->opts_initialize_default = &ocp_nlp_constraints_bgh_opts_initialize_default;
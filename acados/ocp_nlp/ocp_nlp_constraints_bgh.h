@@ -110,6 +110,9 @@ void *ocp_nlp_constraints_bgh_model_assign(void *config, void *dims, void *raw_m
 //
 int ocp_nlp_constraints_bgh_model_set(void *config_, void *dims_,
                          void *model_, const char *field, void *value);
+//
+int ocp_nlp_constraints_bgh_model_get(void *config_, void *dims_,
+                         void *model_, const char *field, void *value);
 
 
 
@@ -121,6 +124,9 @@ typedef struct
 {
     int compute_adj;
     int compute_hess;
+    double screen_margin;   // distance of h from its bounds above which h is not re-evaluated, <= 0 for none (set before memory creation)
+    double screen_lam_tol;  // multipliers of h above which h is not screened
+    int screen_verify;      // evaluate h also if screened (e.g. before termination)
 } ocp_nlp_constraints_bgh_opts;
 
 //
@@ -152,6 +158,11 @@ typedef struct
     struct blasfeo_dmat *dzduxt; // pointer to dzduxt in ocp_nlp memory
     int *idxb;                   // pointer to idxb[ii] in qp_in
     int *idxs;                   // pointer to idxs[ii] in qp_in
+    // screening of far-inactive nonlinear constraints (only if screen_margin > 0)
+    struct blasfeo_dmat jac_h_s; // Jacobian of h at the screening point
+    struct blasfeo_dvec h_s;     // h at the screening point
+    struct blasfeo_dvec ux_s;    // screening point
+    int screened;                // 1 if h is extrapolated instead of evaluated
 } ocp_nlp_constraints_bgh_memory;
 
 //
@@ -635,6 +635,51 @@ int ocp_nlp_constraints_bghp_model_set(void *config_, void *dims_,
 
 
 
+int ocp_nlp_constraints_bghp_model_get(void *config_, void *dims_,
+                         void *model_, const char *field, void *value)
+{
+    ocp_nlp_constraints_bghp_dims *dims = (ocp_nlp_constraints_bghp_dims *) dims_;
+    ocp_nlp_constraints_bghp_model *model = (ocp_nlp_constraints_bghp_model *) model_;
+
+    if (!dims || !model || !field || !value)
+    {
+        printf("ocp_nlp_constraints_bghp_model_get: got Null pointer \n");
+        exit(1);
+    }
+
+    int nb = dims->nb;
+    int ng = dims->ng;
+    int nh = dims->nh;
+    int nbx = dims->nbx;
+    int nbu = dims->nbu;
+
+    if (!strcmp(field, "lbx"))
+    {
+        blasfeo_unpack_dvec(nbx, &model->d, nbu, value);
+    }
+    else if (!strcmp(field, "ubx"))
+    {
+        blasfeo_unpack_dvec(nbx, &model->d, nb + ng + nh + nbu, value);
+    }
+    else if (!strcmp(field, "lbu"))
+    {
+        blasfeo_unpack_dvec(nbu, &model->d, 0, value);
+    }
+    else if (!strcmp(field, "ubu"))
+    {
+        blasfeo_unpack_dvec(nbu, &model->d, nb + ng + nh, value);
+    }
+    else
+    {
+        printf("\nerror: ocp_nlp_constraints_bghp_model_get: field %s not available\n", field);
+        exit(1);
+    }
+
+    return ACADOS_SUCCESS;
+}
+
+
+
 /* options */
 
 int ocp_nlp_constraints_bghp_opts_calculate_size(void *config_, void *dims_)
@@ -1130,6 +1175,7 @@ void ocp_nlp_constraints_bghp_config_initialize_default(void *config_)
     config->model_calculate_size = &ocp_nlp_constraints_bghp_model_calculate_size;
     config->model_assign = &ocp_nlp_constraints_bghp_model_assign;
     config->model_set = &ocp_nlp_constraints_bghp_model_set;
+    config->model_get = &ocp_nlp_constraints_bghp_model_get;
     config->opts_calculate_size = &ocp_nlp_constraints_bghp_opts_calculate_size;
     config->opts_assign = &ocp_nlp_constraints_bghp_opts_assign;
     config->opts_initialize_default = &ocp_nlp_constraints_bghp_opts_initialize_default;
@@ -103,6 +103,9 @@ void *ocp_nlp_constraints_bghp_assign(void *config, void *dims, void *raw_memory
 //
 int ocp_nlp_constraints_bghp_model_set(void *config_, void *dims_,
                          void *model_, const char *field, void *value);
+//
+int ocp_nlp_constraints_bghp_model_get(void *config_, void *dims_,
+                         void *model_, const char *field, void *value);
 
 /* options */
 
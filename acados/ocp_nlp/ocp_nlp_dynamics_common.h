@@ -102,6 +102,12 @@ typedef struct
                                void *work_);
     int (*precompute)(void *config_, void *dims, void *model_, void *opts_, void *mem_,
                                void *work_);
+    // evaluate fun only, BAbt and RSQrq are not touched
+    void (*compute_fun)(void *config_, void *dims, void *model_, void *opts_, void *mem_,
+                        void *work_);
+    // evaluate fun and the exact adjoint adj, BAbt and RSQrq are not touched
+    void (*compute_fun_and_adj)(void *config_, void *dims, void *model_, void *opts_, void *mem_,
+                                void *work_);
 } ocp_nlp_dynamics_config;
 
 //
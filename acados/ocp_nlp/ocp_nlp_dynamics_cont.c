@@ -521,6 +521,7 @@ int ocp_nlp_dynamics_cont_workspace_calculate_size(void *config_, void *dims_, v
     // extract dims
     int nx = dims->nx;
     int nu = dims->nu;
+    int nx1 = dims->nx1;
 
     int size = 0;
 
@@ -531,6 +532,11 @@ int ocp_nlp_dynamics_cont_workspace_calculate_size(void *config_, void *dims_, v
     size += config->sim_solver->workspace_calculate_size(config->sim_solver, dims->sim, opts->sim_solver);
 
     size += 1 * blasfeo_memsize_dmat(nu+nx, nu+nx);   // hess
+    if (nx1 != nx)
+    {
+        size += 1 * blasfeo_memsize_dmat(nu+nx, nx);  // S_forw_tran
+        size += 1 * blasfeo_memsize_dvec(nx);         // tmp_nx
+    }
 
     size += 1*64;  // blasfeo_mem align
 
@@ -553,6 +559,7 @@ static void ocp_nlp_dynamics_cont_cast_workspace(void *config_, void *dims_, voi
     // extract dims
     int nx = dims->nx;
     int nu = dims->nu;
+    int nx1 = dims->nx1;
 
     // sim in
     work->sim_in = sim_in_assign(config->sim_solver, dims->sim, c_ptr);
@@ -570,6 +577,14 @@ static void ocp_nlp_dynamics_cont_cast_workspace(void *config_, void *dims_, voi
     // hess
     assign_and_advance_blasfeo_dmat_mem(nu+nx, nu+nx, &work->hess, &c_ptr);
 
+    if (nx1 != nx)
+    {
+        // S_forw_tran
+        assign_and_advance_blasfeo_dmat_mem(nu+nx, nx, &work->S_forw_tran, &c_ptr);
+        // tmp_nx
+        assign_and_advance_blasfeo_dvec_mem(nx, &work->tmp_nx, &c_ptr);
+    }
+
     assert((char *) work + ocp_nlp_dynamics_cont_workspace_calculate_size(config, dims, opts) >= c_ptr);
 
     return;
@@ -587,8 +602,8 @@ int ocp_nlp_dynamics_cont_model_calculate_size(void *config_, void *dims_)
     ocp_nlp_dynamics_cont_dims *dims = dims_;
 
     // extract dims
-    // int nx = dims->nx;
-    // int nu = dims->nu;
+    int nx = dims->nx;
+    int nx1 = dims->nx1;
 
     int size = 0;
 
@@ -596,6 +611,12 @@ int ocp_nlp_dynamics_cont_model_calculate_size(void *config_, void *dims_)
 
     size += config->sim_solver->model_calculate_size(config->sim_solver, dims->sim);
 
+    if (nx1 != nx)
+    {
+        size += 1 * blasfeo_memsize_dmat(nx1, nx);  // state_transition
+        size += 1*64;  // blasfeo_mem align
+    }
+
     return size;
 }
 
@@ -609,8 +630,8 @@ void *ocp_nlp_dynamics_cont_model_assign(void *config_, void *dims_, void *raw_m
     char *c_ptr = (char *) raw_memory;
 
     // extract dims
-    // int nx = dims->nx;
-    // int nu = dims->nu;
+    int nx = dims->nx;
+    int nx1 = dims->nx1;
 
     // struct
     ocp_nlp_dynamics_cont_model *model = (ocp_nlp_dynamics_cont_model *) c_ptr;
@@ -619,6 +640,17 @@ void *ocp_nlp_dynamics_cont_model_assign(void *config_, void *dims_, void *raw_m
     model->sim_model = config->sim_solver->model_assign(config->sim_solver, dims->sim, c_ptr);
     c_ptr += config->sim_solver->model_calculate_size(config->sim_solver, dims->sim);
 
+    if (nx1 != nx)
+    {
+        // blasfeo_mem align
+        align_char_to(64, &c_ptr);
+
+        // state_transition, default: keep the first min(nx, nx1) states
+        assign_and_advance_blasfeo_dmat_mem(nx1, nx, &model->state_transition, &c_ptr);
+        blasfeo_dgese(nx1, nx, 0.0, &model->state_transition, 0, 0);
+        blasfeo_ddiare(nx1 < nx ? nx1 : nx, 1.0, &model->state_transition, 0, 0);
+    }
+
     assert((char *) raw_memory + ocp_nlp_dynamics_cont_model_calculate_size(config, dims) >= c_ptr);
 
     return model;
@@ -638,6 +670,17 @@ void ocp_nlp_dynamics_cont_model_set(void *config_, void *dims_, void *model_, c
         double *T = (double *) value;
         model->T = *T;
     }
+    else if (!strcmp(field, "state_transition"))
+    {
+        ocp_nlp_dynamics_cont_dims *dims = dims_;
+        if (dims->nx1 == dims->nx)
+        {
+            printf("\nerror: ocp_nlp_dynamics_cont_model_set: state_transition only available if nx1 != nx\n");
+            exit(1);
+        }
+        double *state_transition = (double *) value;
+        blasfeo_pack_dmat(dims->nx1, dims->nx, state_transition, dims->nx1, &model->state_transition, 0, 0);
+    }
     else
     {
         int status = sim_config->model_set(model->sim_model, field, value);
@@ -705,36 +748,57 @@ void ocp_nlp_dynamics_cont_update_qp_matrices(void *config_, void *dims_, void *
     }
 
     // initialize seeds
-    // TODO fix dims if nx!=nx1 !!!!!!!!!!!!!!!!!
-    // set S_forw = [eye(nx), zeros(nx x nu)]
-    for(jj = 0; jj < nx1 * (nx + nu); jj++)
-        work->sim_in->S_forw[jj] = 0.0;
-    for(jj = 0; jj < nx1; jj++)
-        work->sim_in->S_forw[jj * (nx + 1)] = 1.0;
+    // S_forw = [eye(nx), zeros(nx x nu)] is implicit, the integrator does not read sim_in->S_forw
     work->sim_in->identity_seed = true;
+    // forward sensitivities are written by the integrator directly into BAbt,
+    // or into the workspace if the state transition to the next stage has to be applied
+    if (nx1 == nx)
+        work->sim_out->S_forw_tran = mem->BAbt;
+    else
+        work->sim_out->S_forw_tran = &work->S_forw_tran;
 
     // adjoint seed
     for(jj = 0; jj < nx + nu; jj++)
         work->sim_in->S_adj[jj] = 0.0;
-    blasfeo_unpack_dvec(nx1, mem->pi, 0, work->sim_in->S_adj);
+    if (nx1 == nx)
+    {
+        blasfeo_unpack_dvec(nx1, mem->pi, 0, work->sim_in->S_adj);
+    }
+    else
+    {
+        // state_transition' * pi
+        blasfeo_dgemv_t(nx1, nx, 1.0, &model->state_transition, 0, 0, mem->pi, 0, 0.0,
+                        &work->tmp_nx, 0, &work->tmp_nx, 0);
+        blasfeo_unpack_dvec(nx, &work->tmp_nx, 0, work->sim_in->S_adj);
+    }
 
     // call integrator
     config->sim_solver->evaluate(config->sim_solver, work->sim_in, work->sim_out, opts->sim_solver,
             mem->sim_solver, work->sim_solver);
 
-    // TODO transition functions for changing dimensions not yet implemented!
+    if (nx1 != nx)
+    {
+        // BAbt = [Su, Sx]^T * state_transition'
+        blasfeo_dgemm_nt(nu+nx, nx1, nx, 1.0, &work->S_forw_tran, 0, 0, &model->state_transition, 0, 0,
+                         0.0, mem->BAbt, 0, 0, mem->BAbt, 0, 0);
+    }
 
-    // B
-    blasfeo_pack_tran_dmat(nx1, nu, work->sim_out->S_forw + nx1 * nx, nx1, mem->BAbt, 0, 0);
-    // A
-    blasfeo_pack_tran_dmat(nx1, nx, work->sim_out->S_forw + 0, nx1, mem->BAbt, nu, 0);
     // dzduxt
     blasfeo_pack_tran_dmat(nz, nu, work->sim_out->S_algebraic + nx*nz, nz, mem->dzduxt, 0, 0);
     blasfeo_pack_tran_dmat(nz, nx, work->sim_out->S_algebraic + 0, nz, mem->dzduxt, nu, 0);
     // blasfeo_print_dmat(nx + nu, nz, mem->dzduxt, 0, 0);
 
     // function
-    blasfeo_pack_dvec(nx1, work->sim_out->xn, &mem->fun, 0);
+    if (nx1 == nx)
+    {
+        blasfeo_pack_dvec(nx1, work->sim_out->xn, &mem->fun, 0);
+    }
+    else
+    {
+        blasfeo_pack_dvec(nx, work->sim_out->xn, &work->tmp_nx, 0);
+        blasfeo_dgemv_n(nx1, nx, 1.0, &model->state_transition, 0, 0, &work->tmp_nx, 0, 0.0,
+                        &mem->fun, 0, &mem->fun, 0);
+    }
     blasfeo_daxpy(nx1, -1.0, mem->ux1, nu1, &mem->fun, 0, &mem->fun, 0);
     blasfeo_pack_dvec(nz, work->sim_out->zn, mem->z_alg, 0); // TODO rename sim_out->zn into z0n ???
 
@@ -780,6 +844,126 @@ void ocp_nlp_dynamics_cont_update_qp_matrices(void *config_, void *dims_, void *
 
 
 
+// integrates without forward sensitivities, the jacobians in BAbt are not updated;
+// with compute_adj the exact adjoint is propagated by the integrator
+static void ocp_nlp_dynamics_cont_eval_fun(void *config_, void *dims_, void *model_, void *opts_,
+                                           void *mem_, void *work_, bool compute_adj)
+{
+    ocp_nlp_dynamics_cont_cast_workspace(config_, dims_, opts_, work_);
+
+    ocp_nlp_dynamics_config *config = config_;
+    ocp_nlp_dynamics_cont_dims *dims = dims_;
+    ocp_nlp_dynamics_cont_opts *opts = opts_;
+    ocp_nlp_dynamics_cont_workspace *work = work_;
+    ocp_nlp_dynamics_cont_memory *mem = mem_;
+    ocp_nlp_dynamics_cont_model *model = model_;
+
+    int nx = dims->nx;
+    int nu = dims->nu;
+    int nz = dims->nz;
+    int nx1 = dims->nx1;
+    int nu1 = dims->nu1;
+
+    sim_opts *sim_opts_ = opts->sim_solver;
+
+    // the integrator memory and workspace are sized for the sensitivities requested at creation
+    if (compute_adj && !sim_opts_->sens_adj)
+    {
+        printf("\nerror: ocp_nlp_dynamics_cont: exact adjoint needs the integrator option sens_adj,"
+               " set it before creating the solver\n");
+        exit(1);
+    }
+
+    // backup sensitivity options
+    bool sens_forw = sim_opts_->sens_forw;
+    bool sens_adj = sim_opts_->sens_adj;
+    bool sens_hess = sim_opts_->sens_hess;
+    bool sens_algebraic = sim_opts_->sens_algebraic;
+
+    sim_opts_->sens_forw = false;
+    sim_opts_->sens_adj = compute_adj;
+    sim_opts_->sens_hess = false;
+    sim_opts_->sens_algebraic = false;
+
+    // setup model
+    work->sim_in->model = model->sim_model;
+    work->sim_in->T = model->T;
+
+    blasfeo_unpack_dvec(nu, mem->ux, 0, work->sim_in->u);
+    blasfeo_unpack_dvec(nx, mem->ux, nu, work->sim_in->x);
+
+    // S_forw_tran may still point to BAbt from update_qp_matrices, which must stay untouched
+    work->sim_out->S_forw_tran = NULL;
+
+    if (compute_adj)
+    {
+        for (int jj = 0; jj < nx + nu; jj++)
+            work->sim_in->S_adj[jj] = 0.0;
+        if (nx1 == nx)
+        {
+            blasfeo_unpack_dvec(nx1, mem->pi, 0, work->sim_in->S_adj);
+        }
+        else
+        {
+            blasfeo_dgemv_t(nx1, nx, 1.0, &model->state_transition, 0, 0, mem->pi, 0, 0.0,
+                            &work->tmp_nx, 0, &work->tmp_nx, 0);
+            blasfeo_unpack_dvec(nx, &work->tmp_nx, 0, work->sim_in->S_adj);
+        }
+    }
+
+    config->sim_solver->evaluate(config->sim_solver, work->sim_in, work->sim_out, opts->sim_solver,
+            mem->sim_solver, work->sim_solver);
+
+    // restore sensitivity options
+    sim_opts_->sens_forw = sens_forw;
+    sim_opts_->sens_adj = sens_adj;
+    sim_opts_->sens_hess = sens_hess;
+    sim_opts_->sens_algebraic = sens_algebraic;
+
+    // function
+    if (nx1 == nx)
+    {
+        blasfeo_pack_dvec(nx1, work->sim_out->xn, &mem->fun, 0);
+    }
+    else
+    {
+        blasfeo_pack_dvec(nx, work->sim_out->xn, &work->tmp_nx, 0);
+        blasfeo_dgemv_n(nx1, nx, 1.0, &model->state_transition, 0, 0, &work->tmp_nx, 0, 0.0,
+                        &mem->fun, 0, &mem->fun, 0);
+    }
+    blasfeo_daxpy(nx1, -1.0, mem->ux1, nu1, &mem->fun, 0, &mem->fun, 0);
+    blasfeo_pack_dvec(nz, work->sim_out->zn, mem->z_alg, 0);
+
+    // adjoint
+    if (compute_adj)
+    {
+        blasfeo_pack_dvec(nu, work->sim_out->S_adj+nx, &mem->adj, 0);
+        blasfeo_pack_dvec(nx, work->sim_out->S_adj+0, &mem->adj, nu);
+        blasfeo_dvecsc(nu+nx, -1.0, &mem->adj, 0);
+        blasfeo_dveccp(nx1, mem->pi, 0, &mem->adj, nu+nx);
+    }
+
+    return;
+}
+
+
+
+void ocp_nlp_dynamics_cont_compute_fun(void *config_, void *dims_, void *model_, void *opts_,
+                                       void *mem_, void *work_)
+{
+    ocp_nlp_dynamics_cont_eval_fun(config_, dims_, model_, opts_, mem_, work_, false);
+}
+
+
+
+void ocp_nlp_dynamics_cont_compute_fun_and_adj(void *config_, void *dims_, void *model_,
+                                               void *opts_, void *mem_, void *work_)
+{
+    ocp_nlp_dynamics_cont_eval_fun(config_, dims_, model_, opts_, mem_, work_, true);
+}
+
+
+
 int ocp_nlp_dynamics_cont_precompute(void *config_, void *dims_, void *model_, void *opts_,
                                         void *mem_, void *work_)
 {
@@ -839,6 +1023,8 @@ void ocp_nlp_dynamics_cont_config_initialize_default(void *config_)
     config->initialize = &ocp_nlp_dynamics_cont_initialize;
     config->update_qp_matrices = &ocp_nlp_dynamics_cont_update_qp_matrices;
     config->precompute = &ocp_nlp_dynamics_cont_precompute;
+    config->compute_fun = &ocp_nlp_dynamics_cont_compute_fun;
+    config->compute_fun_and_adj = &ocp_nlp_dynamics_cont_compute_fun_and_adj;
     config->config_initialize_default = &ocp_nlp_dynamics_cont_config_initialize_default;
 
     return;
@@ -153,6 +153,8 @@ void ocp_nlp_dynamics_cont_memory_set_BAbt_ptr(struct blasfeo_dmat *BAbt, void *
 typedef struct
 {
     struct blasfeo_dmat hess;
+    struct blasfeo_dmat S_forw_tran;  // [Su, Sx]^T before the state transition (only if nx1 != nx)
+    struct blasfeo_dvec tmp_nx;       // only if nx1 != nx
     sim_in *sim_in;
     sim_out *sim_out;
     void *sim_solver;  // sim solver workspace
@@ -169,7 +171,7 @@ int ocp_nlp_dynamics_cont_workspace_calculate_size(void *config, void *dims, voi
 typedef struct
 {
     void *sim_model;
-    // double *state_transition; // TODO
+    struct blasfeo_dmat state_transition;  // nx1 x nx map to the next stage (only if nx1 != nx)
     double T;  // simulation time
 } ocp_nlp_dynamics_cont_model;
 
@@ -195,6 +197,12 @@ void ocp_nlp_dynamics_cont_initialize(void *config_, void *dims, void *model_, v
 void ocp_nlp_dynamics_cont_update_qp_matrices(void *config_, void *dims, void *model_, void *opts,
                                               void *mem, void *work_);
 //
+void ocp_nlp_dynamics_cont_compute_fun(void *config_, void *dims, void *model_, void *opts,
+                                       void *mem, void *work_);
+//
+void ocp_nlp_dynamics_cont_compute_fun_and_adj(void *config_, void *dims, void *model_, void *opts,
+                                               void *mem, void *work_);
+//
 int ocp_nlp_dynamics_cont_precompute(void *config_, void *dims, void *model_, void *opts_,
                                         void *mem_, void *work_);
 
@@ -436,7 +436,7 @@ int ocp_nlp_dynamics_disc_workspace_calculate_size(void *config_, void *dims_, v
 
     int nx = dims->nx;
     int nu = dims->nu;
-    // int nx1 = dims->nx1;
+    int nx1 = dims->nx1;
 
     int size = 0;
 
@@ -445,10 +445,10 @@ int ocp_nlp_dynamics_disc_workspace_calculate_size(void *config_, void *dims_, v
     if (opts->compute_hess!=0)
     {
         size += 1 * blasfeo_memsize_dmat(nu+nx, nu+nx);   // tmp_nv_nv
-
-        size += 1*64;  // blasfeo_mem align
-
     }
+    size += 1 * blasfeo_memsize_dmat(nu+nx, nx1);   // tmp_nv_nx1
+
+    size += 1*64;  // blasfeo_mem align
 
     return size;
 }
@@ -465,21 +465,23 @@ static void ocp_nlp_dynamics_disc_cast_workspace(void *config_, void *dims_, voi
 
     int nx = dims->nx;
     int nu = dims->nu;
-    // int nx1 = dims->nx1;
+    int nx1 = dims->nx1;
 
     char *c_ptr = (char *) work_;
     c_ptr += sizeof(ocp_nlp_dynamics_disc_workspace);
 
+    // blasfeo_mem align
+    align_char_to(64, &c_ptr);
+
     if (opts->compute_hess!=0)
     {
-        // blasfeo_mem align
-        align_char_to(64, &c_ptr);
-
         // tmp_nv_nv
         assign_and_advance_blasfeo_dmat_mem(nu+nx, nu+nx, &work->tmp_nv_nv, &c_ptr);
-
     }
 
+    // tmp_nv_nx1
+    assign_and_advance_blasfeo_dmat_mem(nu+nx, nx1, &work->tmp_nv_nx1, &c_ptr);
+
     assert((char *) work + ocp_nlp_dynamics_disc_workspace_calculate_size(config_, dims, opts_) >= c_ptr);
 
     return;
@@ -677,6 +679,97 @@ void ocp_nlp_dynamics_disc_update_qp_matrices(void *config_, void *dims_, void *
 
 
 
+static void ocp_nlp_dynamics_disc_eval_fun_jac_tmp(void *config_, void *dims_, void *model_,
+                                                   void *opts_, void *mem_, void *work_)
+{
+    ocp_nlp_dynamics_disc_cast_workspace(config_, dims_, opts_, work_);
+
+    ocp_nlp_dynamics_disc_dims *dims = dims_;
+    ocp_nlp_dynamics_disc_workspace *work = work_;
+    ocp_nlp_dynamics_disc_memory *memory = mem_;
+    ocp_nlp_dynamics_disc_model *model = model_;
+
+    int nu = dims->nu;
+    int nx1 = dims->nx1;
+    int nu1 = dims->nu1;
+
+    ext_fun_arg_t ext_fun_type_in[2];
+    void *ext_fun_in[2];
+    ext_fun_arg_t ext_fun_type_out[2];
+    void *ext_fun_out[2];
+
+    struct blasfeo_dvec_args x_in;  // input x of external fun;
+    x_in.x = memory->ux;
+    x_in.xi = nu;
+
+    struct blasfeo_dvec_args u_in;  // input u of external fun;
+    u_in.x = memory->ux;
+    u_in.xi = 0;
+
+    struct blasfeo_dvec_args fun_out;
+    fun_out.x = &memory->fun;
+    fun_out.xi = 0;
+
+    // the jacobian goes to the workspace, BAbt keeps the old linearization
+    struct blasfeo_dmat_args jac_out;
+    jac_out.A = &work->tmp_nv_nx1;
+    jac_out.ai = 0;
+    jac_out.aj = 0;
+
+    ext_fun_type_in[0] = BLASFEO_DVEC_ARGS;
+    ext_fun_in[0] = &x_in;
+    ext_fun_type_in[1] = BLASFEO_DVEC_ARGS;
+    ext_fun_in[1] = &u_in;
+
+    ext_fun_type_out[0] = BLASFEO_DVEC_ARGS;
+    ext_fun_out[0] = &fun_out;  // fun: nx1
+    ext_fun_type_out[1] = BLASFEO_DMAT_ARGS;
+    ext_fun_out[1] = &jac_out;  // jac': (nu+nx) * nx1
+
+    model->disc_dyn_fun_jac->evaluate(model->disc_dyn_fun_jac, ext_fun_type_in, ext_fun_in,
+            ext_fun_type_out, ext_fun_out);
+
+    // fun
+    blasfeo_daxpy(nx1, -1.0, memory->ux1, nu1, &memory->fun, 0, &memory->fun, 0);
+
+    return;
+}
+
+
+
+void ocp_nlp_dynamics_disc_compute_fun(void *config_, void *dims_, void *model_, void *opts_,
+                                       void *mem_, void *work_)
+{
+    ocp_nlp_dynamics_disc_eval_fun_jac_tmp(config_, dims_, model_, opts_, mem_, work_);
+
+    return;
+}
+
+
+
+void ocp_nlp_dynamics_disc_compute_fun_and_adj(void *config_, void *dims_, void *model_,
+                                               void *opts_, void *mem_, void *work_)
+{
+    ocp_nlp_dynamics_disc_dims *dims = dims_;
+    ocp_nlp_dynamics_disc_workspace *work = work_;
+    ocp_nlp_dynamics_disc_memory *memory = mem_;
+
+    int nx = dims->nx;
+    int nu = dims->nu;
+    int nx1 = dims->nx1;
+
+    ocp_nlp_dynamics_disc_eval_fun_jac_tmp(config_, dims_, model_, opts_, mem_, work_);
+
+    // adj with the current jacobian
+    blasfeo_dgemv_n(nu+nx, nx1, -1.0, &work->tmp_nv_nx1, 0, 0, memory->pi, 0, 0.0, &memory->adj, 0,
+                    &memory->adj, 0);
+    blasfeo_dveccp(nx1, memory->pi, 0, &memory->adj, nu + nx);
+
+    return;
+}
+
+
+
 int ocp_nlp_dynamics_disc_precompute(void *config_, void *dims, void *model_, void *opts_,
                                         void *mem_, void *work_)
 {
@@ -718,6 +811,8 @@ void ocp_nlp_dynamics_disc_config_initialize_default(void *config_)
     config->initialize = &ocp_nlp_dynamics_disc_initialize;
     config->update_qp_matrices = &ocp_nlp_dynamics_disc_update_qp_matrices;
     config->precompute = &ocp_nlp_dynamics_disc_precompute;
+    config->compute_fun = &ocp_nlp_dynamics_disc_compute_fun;
+    config->compute_fun_and_adj = &ocp_nlp_dynamics_disc_compute_fun_and_adj;
     config->config_initialize_default = &ocp_nlp_dynamics_disc_config_initialize_default;
 
     return;
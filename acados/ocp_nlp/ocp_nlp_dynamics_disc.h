@@ -95,6 +95,12 @@ void ocp_nlp_dynamics_disc_opts_initialize_default(void *config, void *dims, voi
 //
 void ocp_nlp_dynamics_disc_opts_update(void *config, void *dims, void *opts);
 //
+void ocp_nlp_dynamics_disc_compute_fun(void *config_, void *dims, void *model_, void *opts,
+                                       void *mem, void *work_);
+//
+void ocp_nlp_dynamics_disc_compute_fun_and_adj(void *config_, void *dims, void *model_, void *opts,
+                                               void *mem, void *work_);
+//
 int ocp_nlp_dynamics_disc_precompute(void *config_, void *dims, void *model_, void *opts_,
                                         void *mem_, void *work_);
 
@@ -140,6 +146,7 @@ void ocp_nlp_dynamics_disc_memory_set_BAbt_ptr(struct blasfeo_dmat *BAbt, void *
 typedef struct
 {
     struct blasfeo_dmat tmp_nv_nv;
+    struct blasfeo_dmat tmp_nv_nx1;  // jacobian not written into BAbt (compute_fun*)
 } ocp_nlp_dynamics_disc_workspace;
 
 int ocp_nlp_dynamics_disc_workspace_calculate_size(void *config, void *dims, void *opts);
@@ -50,6 +50,7 @@
 #include "blasfeo/include/blasfeo_d_blas.h"
 // acados
 #include "acados/ocp_nlp/ocp_nlp_common.h"
+#include "acados/ocp_nlp/ocp_nlp_constraints_bgh.h"
 #include "acados/ocp_nlp/ocp_nlp_dynamics_cont.h"
 #include "acados/ocp_nlp/ocp_nlp_reg_common.h"
 #include "acados/ocp_qp/ocp_qp_common.h"
@@ -205,6 +206,17 @@ void ocp_nlp_sqp_opts_initialize_default(void *config_, void *dims_, void *opts_
 
 	opts->step_length = 1.0;
 
+	opts->qn_update = QN_NONE;
+
+	opts->time_budget = 0.0;
+
+	opts->ws_db_size = 0;
+	opts->ws_db_jump = 0.0;
+
+	opts->cancel = NULL;
+
+	opts->screen_margin = 0.0;
+
     // submodules opts
 
     // qp solver
@@ -282,6 +294,24 @@ void ocp_nlp_sqp_opts_update(void *config_, void *dims_, void *opts_)
 
 
 
+// exact Hessian evaluation in the cost and dynamics modules
+static void sqp_set_exact_hess(ocp_nlp_config *config, ocp_nlp_sqp_opts *opts, int *exact_hess)
+{
+	int ii;
+	int N = config->N;
+	// cost
+	for (ii=0; ii<=N; ii++)
+		config->cost[ii]->opts_set(config->cost[ii], opts->cost[ii], "exact_hess", exact_hess);
+	// dynamics
+	for (ii=0; ii<N; ii++)
+		config->dynamics[ii]->opts_set(config->dynamics[ii], opts->dynamics[ii], "compute_hess", exact_hess);
+	// constraints TODO disabled for now as prevents convergence !!!
+//	for (ii=0; ii<=N; ii++)
+//		config->constraints[ii]->opts_set(config->constraints[ii], opts->constraints[ii], "compute_hess", exact_hess);
+}
+
+
+
 void ocp_nlp_sqp_opts_set(void *config_, void *opts_, const char *field, void* value)
 {
     ocp_nlp_sqp_opts *opts = (ocp_nlp_sqp_opts *) opts_;
@@ -362,16 +392,9 @@ void ocp_nlp_sqp_opts_set(void *config_, void *opts_, const char *field, void* v
 		}
 		else if (!strcmp(field, "exact_hess"))
 		{
-			int N = config->N;
-			// cost
-			for (ii=0; ii<=N; ii++)
-				config->cost[ii]->opts_set(config->cost[ii], opts->cost[ii], "exact_hess", value);
-			// dynamics
-			for (ii=0; ii<N; ii++)
-				config->dynamics[ii]->opts_set(config->dynamics[ii], opts->dynamics[ii], "compute_hess", value);
-			// constraints TODO disabled for now as prevents convergence !!!
-//			for (ii=0; ii<=N; ii++)
-//				config->constraints[ii]->opts_set(config->constraints[ii], opts->constraints[ii], "compute_hess", value);
+			// the quasi-Newton blocks replace the exact Hessian, which is then not evaluated
+			int exact_hess = opts->qn_update == QN_NONE ? *((int *) value) : 0;
+			sqp_set_exact_hess(config, opts, &exact_hess);
 		}
 		else if (!strcmp(field, "ext_qp_res"))
 		{
@@ -383,6 +406,62 @@ void ocp_nlp_sqp_opts_set(void *config_, void *opts_, const char *field, void* v
 			double* step_length = (double *) value;
 			opts->step_length = *step_length;
 		}
+		else if (!strcmp(field, "qn_update"))
+		{
+			int* qn_update = (int *) value;
+			if (*qn_update < QN_NONE || *qn_update > QN_SR1)
+			{
+				printf("\nerror: ocp_nlp_sqp_opts_set: invalid value for qn_update: %d\n", *qn_update);
+				exit(1);
+			}
+			opts->qn_update = *qn_update;
+			// skip the exact Hessian evaluation in the modules, the first quasi-Newton blocks
+			// are initialized with the Gauss-Newton Hessian
+			if (opts->qn_update != QN_NONE)
+			{
+				int exact_hess = 0;
+				sqp_set_exact_hess(config, opts, &exact_hess);
+			}
+		}
+		else if (!strcmp(field, "time_budget"))
+		{
+			double* time_budget = (double *) value;
+			opts->time_budget = *time_budget;
+			// also resets the QP deadline when the budget is removed
+			config->qp_solver->opts_set(config->qp_solver, opts->qp_solver_opts, "time_limit", value);
+		}
+		else if (!strcmp(field, "ws_db_size"))
+		{
+			int* ws_db_size = (int *) value;
+			if (*ws_db_size < 0)
+			{
+				printf("\nerror: ocp_nlp_sqp_opts_set: invalid value for ws_db_size: %d\n", *ws_db_size);
+				exit(1);
+			}
+			opts->ws_db_size = *ws_db_size;
+		}
+		else if (!strcmp(field, "ws_db_jump"))
+		{
+			double* ws_db_jump = (double *) value;
+			opts->ws_db_jump = *ws_db_jump;
+		}
+		else if (!strcmp(field, "cancel"))
+		{
+			// pointer to a flag shared with other threads (accessed atomically), NULL to disable
+			opts->cancel = (int *) value;
+		}
+		else if (!strcmp(field, "screen_margin"))
+		{
+			double* screen_margin = (double *) value;
+			opts->screen_margin = *screen_margin;
+			// only the bgh module evaluates h by an external function
+			int N = config->N;
+			for (ii=0; ii<=N; ii++)
+			{
+				if (config->constraints[ii]->update_qp_matrices == &ocp_nlp_constraints_bgh_update_qp_matrices)
+					config->constraints[ii]->opts_set(config->constraints[ii], opts->constraints[ii], "screen_margin", value);
+			}
+		}
 		else
 		{
 			printf("\nerror: ocp_nlp_sqp_opts_set: wrong field: %s\n", field);
@@ -445,6 +524,32 @@ void ocp_nlp_sqp_constraints_opts_set(void *config_, void *opts_, int stage,
  * memory
  ************************************************/
 
+// warm start database: the key is x0, i.e. the state bounds of the first stage
+static int ws_db_key_size(ocp_nlp_config *config, ocp_nlp_dims *dims)
+{
+    int nbx0;
+    config->constraints[0]->dims_get(config->constraints[0], dims->constraints[0], "nbx", &nbx0);
+    return nbx0;
+}
+
+
+
+// warm start database: an entry holds ux, z, lam, t, pi and the integrator guess of all stages
+static int ws_db_entry_size(ocp_nlp_dims *dims)
+{
+    int N = dims->N;
+    int size = 0;
+    for (int ii = 0; ii <= N; ii++)
+    {
+        size += dims->nv[ii] + dims->nz[ii] + 4*dims->ni[ii];
+        size += dims->nx[ii] + dims->nz[ii] + 1;  // sim_guess, set_sim_guess
+        if (ii < N)
+            size += dims->nx[ii+1];
+    }
+    return size;
+}
+
+
 int ocp_nlp_sqp_memory_calculate_size(void *config_, void *dims_, void *opts_)
 {
     ocp_nlp_dims *dims = dims_;
@@ -519,6 +624,15 @@ int ocp_nlp_sqp_memory_calculate_size(void *config_, void *dims_, void *opts_)
 		stat_n += 4;
 	size += stat_n*stat_m*sizeof(double);
 
+	// warm start database
+	if (opts->ws_db_size > 0)
+	{
+		int ws_db_nkey = ws_db_key_size(config, dims);
+		size += (opts->ws_db_size+2)*ws_db_nkey*sizeof(double);  // key, key_cur, key_prev
+		size += opts->ws_db_size*ws_db_entry_size(dims)*sizeof(double);  // val
+		size += opts->ws_db_size*sizeof(int);  // used
+	}
+
 	// dzduxt
 	size += (N+1)*sizeof(struct blasfeo_dmat);
 	for(ii=0; ii<=N; ii++)
@@ -527,6 +641,17 @@ int ocp_nlp_sqp_memory_calculate_size(void *config_, void *dims_, void *opts_)
 	size += (N+1)*sizeof(struct blasfeo_dvec);
 	for(ii=0; ii<=N; ii++)
 		size += blasfeo_memsize_dvec(nz[ii]);
+	// quasi-Newton
+	if (opts->qn_update != QN_NONE)
+	{
+		size += (N+1)*sizeof(struct blasfeo_dmat);
+		size += 3*(N+1)*sizeof(struct blasfeo_dvec);
+		for(ii=0; ii<=N; ii++)
+		{
+			size += blasfeo_memsize_dmat(nu[ii]+nx[ii], nu[ii]+nx[ii]);
+			size += 3*blasfeo_memsize_dvec(nu[ii]+nx[ii]);
+		}
+	}
 
     size += 1*8;  // blasfeo_str align
     size += 1*64;  // blasfeo_mem align
@@ -630,6 +755,32 @@ void *ocp_nlp_sqp_memory_assign(void *config_, void *dims_, void *opts_, void *r
 		mem->stat_n += 4;
 	c_ptr += mem->stat_m*mem->stat_n*sizeof(double);
 
+	// warm start database
+	mem->ws_db_nkey = 0;
+	mem->ws_db_len = 0;
+	mem->ws_db_num = 0;
+	mem->ws_db_tick = 0;
+	mem->ws_db_prev_set = 0;
+	mem->ws_db_hit = 0;
+	if (opts->ws_db_size > 0)
+	{
+		mem->ws_db_nkey = ws_db_key_size(config, dims);
+		mem->ws_db_len = ws_db_entry_size(dims);
+		assign_and_advance_double(opts->ws_db_size*mem->ws_db_nkey, &mem->ws_db_key, &c_ptr);
+		assign_and_advance_double(opts->ws_db_size*mem->ws_db_len, &mem->ws_db_val, &c_ptr);
+		assign_and_advance_double(mem->ws_db_nkey, &mem->ws_db_key_cur, &c_ptr);
+		assign_and_advance_double(mem->ws_db_nkey, &mem->ws_db_key_prev, &c_ptr);
+		assign_and_advance_int(opts->ws_db_size, &mem->ws_db_used, &c_ptr);
+	}
+	else
+	{
+		mem->ws_db_key = NULL;
+		mem->ws_db_val = NULL;
+		mem->ws_db_key_cur = NULL;
+		mem->ws_db_key_prev = NULL;
+		mem->ws_db_used = NULL;
+	}
+
     // blasfeo_str align
     align_char_to(8, &c_ptr);
 
@@ -639,6 +790,25 @@ void *ocp_nlp_sqp_memory_assign(void *config_, void *dims_, void *opts_, void *r
 	// z_alg
 	mem->z_alg = (struct blasfeo_dvec *) c_ptr;
 	c_ptr += (N+1)*sizeof(struct blasfeo_dvec);
+	// quasi-Newton
+	if (opts->qn_update != QN_NONE)
+	{
+		mem->qn_B = (struct blasfeo_dmat *) c_ptr;
+		c_ptr += (N+1)*sizeof(struct blasfeo_dmat);
+		mem->qn_grad = (struct blasfeo_dvec *) c_ptr;
+		c_ptr += (N+1)*sizeof(struct blasfeo_dvec);
+		mem->qn_s = (struct blasfeo_dvec *) c_ptr;
+		c_ptr += (N+1)*sizeof(struct blasfeo_dvec);
+		mem->qn_tmp = (struct blasfeo_dvec *) c_ptr;
+		c_ptr += (N+1)*sizeof(struct blasfeo_dvec);
+	}
+	else
+	{
+		mem->qn_B = NULL;
+		mem->qn_grad = NULL;
+		mem->qn_s = NULL;
+		mem->qn_tmp = NULL;
+	}
 
     // blasfeo_mem align
     align_char_to(64, &c_ptr);
@@ -655,6 +825,21 @@ void *ocp_nlp_sqp_memory_assign(void *config_, void *dims_, void *opts_, void *r
 		blasfeo_create_dvec(nz[ii], mem->z_alg+ii, c_ptr);
 		c_ptr += blasfeo_memsize_dvec(nz[ii]);
     }
+	// quasi-Newton
+	if (opts->qn_update != QN_NONE)
+	{
+		for (int ii=0; ii<=N; ii++)
+		{
+			blasfeo_create_dmat(nu[ii]+nx[ii], nu[ii]+nx[ii], mem->qn_B+ii, c_ptr);
+			c_ptr += blasfeo_memsize_dmat(nu[ii]+nx[ii], nu[ii]+nx[ii]);
+			blasfeo_create_dvec(nu[ii]+nx[ii], mem->qn_grad+ii, c_ptr);
+			c_ptr += blasfeo_memsize_dvec(nu[ii]+nx[ii]);
+			blasfeo_create_dvec(nu[ii]+nx[ii], mem->qn_s+ii, c_ptr);
+			c_ptr += blasfeo_memsize_dvec(nu[ii]+nx[ii]);
+			blasfeo_create_dvec(nu[ii]+nx[ii], mem->qn_tmp+ii, c_ptr);
+			c_ptr += blasfeo_memsize_dvec(nu[ii]+nx[ii]);
+		}
+	}
 
     mem->status = ACADOS_READY;
 
@@ -1242,6 +1427,398 @@ static void sqp_update_variables(void *config_, ocp_nlp_dims *dims, ocp_nlp_out
 
 
 
+// stage-wise part of the Lagrangian gradient that depends nonlinearly on (u,x):
+// cost gradient, dynamics and general constraints; linear terms (bounds, pi_{i-1}) cancel in
+// the quasi-Newton difference and are left out
+static void qn_lagrangian_grad(ocp_nlp_dims *dims, ocp_nlp_out *nlp_out, ocp_nlp_sqp_memory *mem,
+                               int i, struct blasfeo_dvec *grad)
+{
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+
+    int nb = mem->qp_in->dim->nb[i];
+    int ng = mem->qp_in->dim->ng[i];
+
+    blasfeo_dveccp(nu[i]+nx[i], mem->nlp_mem->cost_grad+i, 0, grad, 0);
+
+    // dynamics
+    if (i < N)
+        blasfeo_dgemv_n(nu[i]+nx[i], nx[i+1], 1.0, mem->qp_in->BAbt+i, 0, 0, nlp_out->pi+i, 0,
+                        1.0, grad, 0, grad, 0);
+
+    // general constraints (linear and nonlinear)
+    blasfeo_dgemv_n(nu[i]+nx[i], ng, -1.0, mem->qp_in->DCt+i, 0, 0, nlp_out->lam+i, nb,
+                    1.0, grad, 0, grad, 0);
+    blasfeo_dgemv_n(nu[i]+nx[i], ng, 1.0, mem->qp_in->DCt+i, 0, 0, nlp_out->lam+i, 2*nb+ng,
+                    1.0, grad, 0, grad, 0);
+
+    return;
+}
+
+
+
+// damped BFGS or SR1 update of the Hessian block of stage i;
+// on entry qn_s holds the step and qn_grad holds y = grad_new - grad_old
+static void qn_update_block(int qn_update, int n, struct blasfeo_dmat *B, struct blasfeo_dvec *s,
+                            struct blasfeo_dvec *y, struct blasfeo_dvec *Bs)
+{
+    int ii, jj;
+    double tmp;
+
+    if (n == 0)
+        return;
+
+    blasfeo_dgemv_n(n, n, 1.0, B, 0, 0, s, 0, 0.0, Bs, 0, Bs, 0);
+    double sBs = blasfeo_ddot(n, s, 0, Bs, 0);
+    double sy = blasfeo_ddot(n, s, 0, y, 0);
+    double ss = blasfeo_ddot(n, s, 0, s, 0);
+
+    if (qn_update == QN_BFGS)
+    {
+        if (sBs <= 1e-12 * ss || ss == 0.0)
+            return;
+
+        // Powell damping: r = theta*y + (1-theta)*Bs, such that s'r >= 0.2 s'Bs
+        double theta = 1.0;
+        if (sy < 0.2 * sBs)
+            theta = 0.8 * sBs / (sBs - sy);
+
+        // y <- r
+        blasfeo_dvecsc(n, theta, y, 0);
+        blasfeo_daxpy(n, 1.0-theta, Bs, 0, y, 0, y, 0);
+        double sr = blasfeo_ddot(n, s, 0, y, 0);
+
+        // B <- B - Bs Bs' / s'Bs + r r' / s'r
+        for (jj = 0; jj < n; jj++)
+        {
+            for (ii = 0; ii < n; ii++)
+            {
+                tmp = - BLASFEO_DVECEL(Bs, ii) * BLASFEO_DVECEL(Bs, jj) / sBs
+                      + BLASFEO_DVECEL(y, ii) * BLASFEO_DVECEL(y, jj) / sr;
+                BLASFEO_DMATEL(B, ii, jj) += tmp;
+            }
+        }
+    }
+    else if (qn_update == QN_SR1)
+    {
+        // y <- r = y - Bs
+        blasfeo_daxpy(n, -1.0, Bs, 0, y, 0, y, 0);
+        double rs = blasfeo_ddot(n, y, 0, s, 0);
+        double rr = blasfeo_ddot(n, y, 0, y, 0);
+
+        // standard skipping rule
+        if (fabs(rs) <= 1e-8 * sqrt(rr * ss) || rr == 0.0)
+            return;
+
+        // B <- B + r r' / r's
+        for (jj = 0; jj < n; jj++)
+        {
+            for (ii = 0; ii < n; ii++)
+            {
+                BLASFEO_DMATEL(B, ii, jj) += BLASFEO_DVECEL(y, ii) * BLASFEO_DVECEL(y, jj) / rs;
+            }
+        }
+    }
+
+    return;
+}
+
+
+
+// store the Lagrangian gradient at the old linearization and the new multipliers, and the step
+static void qn_save_old(ocp_nlp_dims *dims, ocp_nlp_out *nlp_out, ocp_nlp_sqp_opts *opts,
+                        ocp_nlp_sqp_memory *mem)
+{
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+
+    int i;
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (i = 0; i <= N; i++)
+    {
+        qn_lagrangian_grad(dims, nlp_out, mem, i, mem->qn_grad+i);
+        blasfeo_dveccpsc(nu[i]+nx[i], opts->step_length, mem->qp_out->ux+i, 0, mem->qn_s+i, 0);
+    }
+
+    return;
+}
+
+
+
+// update the Hessian blocks and write them into the QP; on the first iteration the blocks are
+// initialized with the Hessian computed by the modules
+static void qn_update_qp_hessian(ocp_nlp_dims *dims, ocp_nlp_out *nlp_out, ocp_nlp_sqp_opts *opts,
+                                 ocp_nlp_sqp_memory *mem, int sqp_iter)
+{
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+
+    int i;
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (i = 0; i <= N; i++)
+    {
+        int nv_i = nu[i]+nx[i];
+        if (sqp_iter == 0)
+        {
+            blasfeo_dgecp(nv_i, nv_i, mem->qp_in->RSQrq+i, 0, 0, mem->qn_B+i, 0, 0);
+        }
+        else
+        {
+            // y = grad_new - grad_old, stored in qn_grad
+            qn_lagrangian_grad(dims, nlp_out, mem, i, mem->qn_tmp+i);
+            blasfeo_daxpy(nv_i, -1.0, mem->qn_grad+i, 0, mem->qn_tmp+i, 0, mem->qn_grad+i, 0);
+            qn_update_block(opts->qn_update, nv_i, mem->qn_B+i, mem->qn_s+i, mem->qn_grad+i,
+                            mem->qn_tmp+i);
+            blasfeo_dgecp(nv_i, nv_i, mem->qn_B+i, 0, 0, mem->qp_in->RSQrq+i, 0, 0);
+        }
+    }
+
+    return;
+}
+
+
+
+// copy the iterate and the integrator guesses to (pack != 0) or from a database entry
+static void ws_db_copy(ocp_nlp_dims *dims, ocp_nlp_out *nlp_out, ocp_nlp_memory *nlp_mem,
+    double *val, int pack)
+{
+    int N = dims->N;
+    int *nv = dims->nv;
+    int *nx = dims->nx;
+    int *nz = dims->nz;
+    int *ni = dims->ni;
+
+    for (int ii = 0; ii <= N; ii++)
+    {
+        if (pack)
+        {
+            blasfeo_unpack_dvec(nv[ii], nlp_out->ux+ii, 0, val);
+            blasfeo_unpack_dvec(nz[ii], nlp_out->z+ii, 0, val+nv[ii]);
+            val += nv[ii] + nz[ii];
+            blasfeo_unpack_dvec(2*ni[ii], nlp_out->lam+ii, 0, val);
+            blasfeo_unpack_dvec(2*ni[ii], nlp_out->t+ii, 0, val+2*ni[ii]);
+            val += 4*ni[ii];
+            blasfeo_unpack_dvec(nx[ii]+nz[ii], nlp_mem->sim_guess+ii, 0, val);
+            val[nx[ii]+nz[ii]] = nlp_mem->set_sim_guess[ii] ? 1.0 : 0.0;
+            val += nx[ii] + nz[ii] + 1;
+            if (ii < N)
+            {
+                blasfeo_unpack_dvec(nx[ii+1], nlp_out->pi+ii, 0, val);
+                val += nx[ii+1];
+            }
+        }
+        else
+        {
+            blasfeo_pack_dvec(nv[ii], val, nlp_out->ux+ii, 0);
+            blasfeo_pack_dvec(nz[ii], val+nv[ii], nlp_out->z+ii, 0);
+            val += nv[ii] + nz[ii];
+            blasfeo_pack_dvec(2*ni[ii], val, nlp_out->lam+ii, 0);
+            blasfeo_pack_dvec(2*ni[ii], val+2*ni[ii], nlp_out->t+ii, 0);
+            val += 4*ni[ii];
+            blasfeo_pack_dvec(nx[ii]+nz[ii], val, nlp_mem->sim_guess+ii, 0);
+            nlp_mem->set_sim_guess[ii] = val[nx[ii]+nz[ii]] != 0.0;
+            val += nx[ii] + nz[ii] + 1;
+            if (ii < N)
+            {
+                blasfeo_pack_dvec(nx[ii+1], val, nlp_out->pi+ii, 0);
+                val += nx[ii+1];
+            }
+        }
+    }
+}
+
+
+
+static double ws_db_dist(int n, double *a, double *b)
+{
+    double dist = 0.0;
+    for (int ii = 0; ii < n; ii++)
+        dist = fmax(dist, fabs(a[ii] - b[ii]));
+    return dist;
+}
+
+
+
+// index of the stored key closest to key, -1 if the database is empty
+static int ws_db_nearest(ocp_nlp_sqp_memory *mem, double *key, double *dist)
+{
+    int idx = -1;
+    double tmp;
+    for (int ii = 0; ii < mem->ws_db_num; ii++)
+    {
+        tmp = ws_db_dist(mem->ws_db_nkey, key, mem->ws_db_key+ii*mem->ws_db_nkey);
+        if (idx < 0 || tmp < *dist)
+        {
+            idx = ii;
+            *dist = tmp;
+        }
+    }
+    return idx;
+}
+
+
+
+// on a jump of x0 larger than ws_db_jump, initialize nlp_out from the closest stored solution
+// if that is closer to the new x0 than the previous one
+static void ws_db_lookup(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *nlp_in,
+    ocp_nlp_out *nlp_out, ocp_nlp_sqp_opts *opts, ocp_nlp_sqp_memory *mem)
+{
+    mem->ws_db_hit = 0;
+
+    if (opts->ws_db_size <= 0)
+        return;
+
+    if (config->constraints[0]->model_get == NULL)
+    {
+        printf("\nerror: ocp_nlp_sqp: ws_db_size > 0 needs model_get in the constraints module\n");
+        exit(1);
+    }
+    config->constraints[0]->model_get(config->constraints[0], dims->constraints[0],
+        nlp_in->constraints[0], "lbx", mem->ws_db_key_cur);
+
+    // the previous solution is only a candidate if there was a previous call
+    int first = !mem->ws_db_prev_set;
+    double jump = 0.0;
+    if (!first)
+        jump = ws_db_dist(mem->ws_db_nkey, mem->ws_db_key_cur, mem->ws_db_key_prev);
+    int search = first || jump > opts->ws_db_jump;
+
+    for (int ii = 0; ii < mem->ws_db_nkey; ii++)
+        mem->ws_db_key_prev[ii] = mem->ws_db_key_cur[ii];
+    mem->ws_db_prev_set = 1;
+
+    if (!search)
+        return;
+
+    double dist;
+    int idx = ws_db_nearest(mem, mem->ws_db_key_cur, &dist);
+    if (idx >= 0 && (first || dist < jump))
+    {
+        ws_db_copy(dims, nlp_out, mem->nlp_mem, mem->ws_db_val+idx*mem->ws_db_len, 0);
+        mem->ws_db_used[idx] = ++mem->ws_db_tick;
+        mem->ws_db_hit = 1;
+    }
+}
+
+
+
+// store a converged solution: it replaces the closest entry if that is within ws_db_jump,
+// else it takes a free entry or the least recently used one
+static void ws_db_store(ocp_nlp_dims *dims, ocp_nlp_out *nlp_out, ocp_nlp_sqp_opts *opts,
+    ocp_nlp_sqp_memory *mem)
+{
+    if (opts->ws_db_size <= 0)
+        return;
+
+    double dist;
+    int idx = ws_db_nearest(mem, mem->ws_db_key_cur, &dist);
+    if (idx < 0 || dist > opts->ws_db_jump)
+    {
+        if (mem->ws_db_num < opts->ws_db_size)
+        {
+            idx = mem->ws_db_num;
+            mem->ws_db_num++;
+        }
+        else
+        {
+            idx = 0;
+            for (int ii = 1; ii < mem->ws_db_num; ii++)
+            {
+                if (mem->ws_db_used[ii] < mem->ws_db_used[idx])
+                    idx = ii;
+            }
+        }
+    }
+
+    for (int ii = 0; ii < mem->ws_db_nkey; ii++)
+        mem->ws_db_key[idx*mem->ws_db_nkey+ii] = mem->ws_db_key_cur[ii];
+    ws_db_copy(dims, nlp_out, mem->nlp_mem, mem->ws_db_val+idx*mem->ws_db_len, 1);
+    mem->ws_db_used[idx] = ++mem->ws_db_tick;
+}
+
+
+
+static void sqp_compute_inf_norm_res(ocp_nlp_out *nlp_out, ocp_nlp_sqp_memory *mem)
+{
+    nlp_out->inf_norm_res = mem->nlp_res->inf_norm_res_g;
+    nlp_out->inf_norm_res = (mem->nlp_res->inf_norm_res_b > nlp_out->inf_norm_res) ?
+                                mem->nlp_res->inf_norm_res_b :
+                                nlp_out->inf_norm_res;
+    nlp_out->inf_norm_res = (mem->nlp_res->inf_norm_res_d > nlp_out->inf_norm_res) ?
+                                mem->nlp_res->inf_norm_res_d :
+                                nlp_out->inf_norm_res;
+    nlp_out->inf_norm_res = (mem->nlp_res->inf_norm_res_m > nlp_out->inf_norm_res) ?
+                                mem->nlp_res->inf_norm_res_m :
+                                nlp_out->inf_norm_res;
+}
+
+
+
+static int sqp_converged(ocp_nlp_sqp_opts *opts, ocp_nlp_sqp_memory *mem)
+{
+    return (mem->nlp_res->inf_norm_res_g < opts->tol_stat) &
+           (mem->nlp_res->inf_norm_res_b < opts->tol_eq) &
+           (mem->nlp_res->inf_norm_res_d < opts->tol_ineq) &
+           (mem->nlp_res->inf_norm_res_m < opts->tol_comp);
+}
+
+
+
+// screened nonlinear constraints are only extrapolated: before terminating, linearize again
+// with all constraints evaluated and check the residuals on the true problem
+static int screen_verify(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *nlp_in,
+                         ocp_nlp_out *nlp_out, ocp_nlp_sqp_opts *opts, ocp_nlp_sqp_memory *mem,
+                         ocp_nlp_sqp_work *work)
+{
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+
+    int ii;
+    int verify;
+
+    verify = 1;
+    for (ii = 0; ii <= N; ii++)
+    {
+        if (config->constraints[ii]->update_qp_matrices == &ocp_nlp_constraints_bgh_update_qp_matrices)
+            config->constraints[ii]->opts_set(config->constraints[ii], opts->constraints[ii], "screen_verify", &verify);
+    }
+
+    linearize_update_qp_matrices(config, dims, nlp_in, nlp_out, opts, mem, work);
+
+    // the quasi-Newton blocks are already up to date
+    if (opts->qn_update != QN_NONE)
+    {
+        for (ii = 0; ii <= N; ii++)
+            blasfeo_dgecp(nu[ii]+nx[ii], nu[ii]+nx[ii], mem->qn_B+ii, 0, 0, mem->qp_in->RSQrq+ii, 0, 0);
+    }
+
+    sqp_update_qp_vectors(config, dims, nlp_in, nlp_out, opts, mem, work);
+
+    ocp_nlp_res_compute(dims, nlp_in, nlp_out, mem->nlp_res, mem->nlp_mem);
+    sqp_compute_inf_norm_res(nlp_out, mem);
+
+    verify = 0;
+    for (ii = 0; ii <= N; ii++)
+    {
+        if (config->constraints[ii]->update_qp_matrices == &ocp_nlp_constraints_bgh_update_qp_matrices)
+            config->constraints[ii]->opts_set(config->constraints[ii], opts->constraints[ii], "screen_verify", &verify);
+    }
+
+    return sqp_converged(opts, mem);
+}
+
+
+
 // Simple fixed-step Gauss-Newton based SQP routine
 int ocp_nlp_sqp(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
                 void *opts_, void *mem_, void *work_)
@@ -1280,6 +1857,11 @@ int ocp_nlp_sqp(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
 	int qp_iter = 0;
 	int qp_status = 0;
 
+	// time of the phases of the last sqp iteration, to predict if the next one fits the budget
+	double time_phases_start;
+	double time_iter_pred = 0.0;
+	double time_elapsed;
+
 #if defined(ACADOS_WITH_OPENMP)
     // backup number of threads
     int num_threads_bkp = omp_get_num_threads();
@@ -1358,6 +1940,9 @@ int ocp_nlp_sqp(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
     } // end of parallel region
 #endif
 
+    // warm start from the solution database
+    ws_db_lookup(config, dims, nlp_in, nlp_out, opts, mem);
+
     // initialize QP
     initialize_qp(config, dims, nlp_in, nlp_out, opts, mem, work);
 
@@ -1369,12 +1954,22 @@ int ocp_nlp_sqp(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
 //        if(sqp_iter==2)
 //        exit(1);
 
+        time_phases_start = mem->time_lin + mem->time_reg + mem->time_qp_sol;
+
         // start timer
         acados_tic(&timer1);
 
+        // quasi-Newton: Lagrangian gradient at the old linearization
+        if (opts->qn_update != QN_NONE && sqp_iter > 0)
+            qn_save_old(dims, nlp_out, opts, mem);
+
         // linearizate NLP and update QP matrices
         linearize_update_qp_matrices(config, dims, nlp_in, nlp_out, opts, mem, work);
 
+        // quasi-Newton: replace Hessian blocks
+        if (opts->qn_update != QN_NONE)
+            qn_update_qp_hessian(dims, nlp_out, opts, mem, sqp_iter);
+
         // stop timer
         mem->time_lin += acados_toc(&timer1);
 
@@ -1383,17 +1978,7 @@ int ocp_nlp_sqp(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
 
         // compute nlp residuals
         ocp_nlp_res_compute(dims, nlp_in, nlp_out, mem->nlp_res, mem->nlp_mem);
-
-        nlp_out->inf_norm_res = mem->nlp_res->inf_norm_res_g;
-        nlp_out->inf_norm_res = (mem->nlp_res->inf_norm_res_b > nlp_out->inf_norm_res) ?
-                                    mem->nlp_res->inf_norm_res_b :
-                                    nlp_out->inf_norm_res;
-        nlp_out->inf_norm_res = (mem->nlp_res->inf_norm_res_d > nlp_out->inf_norm_res) ?
-                                    mem->nlp_res->inf_norm_res_d :
-                                    nlp_out->inf_norm_res;
-        nlp_out->inf_norm_res = (mem->nlp_res->inf_norm_res_m > nlp_out->inf_norm_res) ?
-                                    mem->nlp_res->inf_norm_res_m :
-                                    nlp_out->inf_norm_res;
+        sqp_compute_inf_norm_res(nlp_out, mem);
 
 		// save statistics
 		if (sqp_iter < mem->stat_m)
@@ -1406,11 +1991,9 @@ int ocp_nlp_sqp(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
 			mem->stat[mem->stat_n*sqp_iter+5] = qp_iter;
 		}
 
-        // exit conditions on residuals
-        if ((mem->nlp_res->inf_norm_res_g < opts->tol_stat) &
-            (mem->nlp_res->inf_norm_res_b < opts->tol_eq) &
-            (mem->nlp_res->inf_norm_res_d < opts->tol_ineq) &
-            (mem->nlp_res->inf_norm_res_m < opts->tol_comp))
+        // exit conditions on residuals (on the true constraints if some were screened)
+        if (sqp_converged(opts, mem) &&
+            (opts->screen_margin <= 0.0 || screen_verify(config, dims, nlp_in, nlp_out, opts, mem, work)))
         {
             // printf("%d sqp iterations\n", sqp_iter);
             // print_ocp_qp_in(mem->qp_in);
@@ -1430,10 +2013,73 @@ int ocp_nlp_sqp(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
             // restore number of threads
             omp_set_num_threads(num_threads_bkp);
 #endif
+            ws_db_store(dims, nlp_out, opts, mem);
+
             mem->status = ACADOS_SUCCESS;
             return mem->status;
         }
 
+        // cooperative cancellation, e.g. by another instance of a multi-start solve
+        int cancelled = 0;
+        if (opts->cancel != NULL)
+        {
+#if defined(ACADOS_WITH_OPENMP)
+            #pragma omp atomic read
+#endif
+            cancelled = *opts->cancel;
+        }
+        if (cancelled)
+        {
+            // save sqp iterations number
+            mem->sqp_iter = sqp_iter;
+            nlp_out->sqp_iter = sqp_iter;
+
+            // stop timer
+            total_time += acados_toc(&timer0);
+
+            // save time
+            nlp_out->total_time = total_time;
+            mem->time_tot = total_time;
+
+#if defined(ACADOS_WITH_OPENMP)
+            // restore number of threads
+            omp_set_num_threads(num_threads_bkp);
+#endif
+            mem->status = ACADOS_CANCELLED;
+            return mem->status;
+        }
+
+        // exit condition on the time budget: stop at the current iterate if the remainder of
+        // this iteration and the next linearization are not expected to fit
+        if (opts->time_budget > 0.0)
+        {
+            time_elapsed = acados_toc(&timer0);
+            if (time_elapsed + time_iter_pred > opts->time_budget)
+            {
+                // save sqp iterations number
+                mem->sqp_iter = sqp_iter;
+                nlp_out->sqp_iter = sqp_iter;
+
+                // stop timer
+                total_time += acados_toc(&timer0);
+
+                // save time
+                nlp_out->total_time = total_time;
+                mem->time_tot = total_time;
+
+#if defined(ACADOS_WITH_OPENMP)
+                // restore number of threads
+                omp_set_num_threads(num_threads_bkp);
+#endif
+                mem->status = ACADOS_TIMEOUT;
+                return mem->status;
+            }
+
+            // the rest of the budget is the deadline of the QP solver
+            double time_limit = opts->time_budget - time_elapsed;
+            config->qp_solver->opts_set(config->qp_solver, opts->qp_solver_opts, "time_limit", &time_limit);
+        }
+
 
         // start timer
         acados_tic(&timer1);
@@ -1521,6 +2167,8 @@ int ocp_nlp_sqp(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
 
         sqp_update_variables(config, dims, nlp_out, opts, mem, work);
 
+        time_iter_pred = mem->time_lin + mem->time_reg + mem->time_qp_sol - time_phases_start;
+
         // ocp_nlp_dims_print(nlp_out->dims);
         // ocp_nlp_out_print(nlp_out);
         // exit(1);
@@ -1680,6 +2328,39 @@ void ocp_nlp_sqp_eval_param_sens(void *config_, void *dims_, void *opts_, void *
 
 
 
+void ocp_nlp_sqp_simulate_stage(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
+        void *opts_, void *mem_, void *work_, int stage)
+{
+    ocp_nlp_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+    ocp_nlp_sqp_opts *opts = opts_;
+    ocp_nlp_sqp_memory *mem = mem_;
+    ocp_nlp_in *nlp_in = nlp_in_;
+    ocp_nlp_out *nlp_out = nlp_out_;
+
+    ocp_nlp_sqp_work *work = work_;
+
+    ocp_nlp_sqp_cast_workspace(config, dims, work, mem, opts);
+
+    int nx1 = dims->nx[stage+1];
+    int nu1 = dims->nu[stage+1];
+
+    config->dynamics[stage]->memory_set_ux_ptr(nlp_out->ux+stage, mem->dynamics[stage]);
+    config->dynamics[stage]->memory_set_ux1_ptr(nlp_out->ux+stage+1, mem->dynamics[stage]);
+
+    // fun = phi(x, u) - x1
+    config->dynamics[stage]->compute_fun(config->dynamics[stage], dims->dynamics[stage],
+            nlp_in->dynamics[stage], opts->dynamics[stage], mem->dynamics[stage],
+            work->dynamics[stage]);
+
+    struct blasfeo_dvec *fun = config->dynamics[stage]->memory_get_fun_ptr(mem->dynamics[stage]);
+    blasfeo_daxpy(nx1, 1.0, fun, 0, nlp_out->ux+stage+1, nu1, nlp_out->ux+stage+1, nu1);
+
+    return;
+}
+
+
+
 // TODO rename memory_get ???
 void ocp_nlp_sqp_get(void *config_, void *mem_, const char *field, void *return_value_)
 {
@@ -1741,6 +2422,21 @@ void ocp_nlp_sqp_get(void *config_, void *mem_, const char *field, void *return_
         void **value = return_value_;
         *value = mem->nlp_mem;
     }
+    else if (!strcmp("qp_in", field))
+    {
+        void **value = return_value_;
+        *value = mem->qp_in;
+    }
+    else if (!strcmp("qp_out", field))
+    {
+        void **value = return_value_;
+        *value = mem->qp_out;
+    }
+    else if (!strcmp("ws_db_hit", field))
+    {
+        int *value = return_value_;
+        *value = mem->ws_db_hit;
+    }
     else
     {
         printf("\nerror: field %s not available in ocp_nlp_sqp_get\n", field);
@@ -1768,6 +2464,7 @@ void ocp_nlp_sqp_config_initialize_default(void *config_)
     config->workspace_calculate_size = &ocp_nlp_sqp_workspace_calculate_size;
     config->evaluate = &ocp_nlp_sqp;
     config->eval_param_sens = &ocp_nlp_sqp_eval_param_sens;
+    config->simulate_stage = &ocp_nlp_sqp_simulate_stage;
     config->config_initialize_default = &ocp_nlp_sqp_config_initialize_default;
     config->precompute = &ocp_nlp_sqp_precompute;
     config->get = &ocp_nlp_sqp_get;
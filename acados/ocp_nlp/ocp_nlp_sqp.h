@@ -58,6 +58,14 @@ extern "C" {
  * options
  ************************************************/
 
+// block-wise quasi-Newton Hessian approximation
+typedef enum
+{
+    QN_NONE,  // use the Hessian provided by the modules (Gauss-Newton / exact)
+    QN_BFGS,  // damped BFGS update per stage block
+    QN_SR1,   // SR1 update per stage block
+} ocp_nlp_qn_update_t;
+
 typedef struct
 {
     void *qp_solver_opts;
@@ -75,6 +83,12 @@ typedef struct
     int num_threads;
 	int ext_qp_res;      // compute external QP residuals (i.e. at SQP level) at each SQP iteration (for debugging)
 	int qp_warm_start;
+	int qn_update;       // ocp_nlp_qn_update_t, replaces the stage Hessian blocks (set before memory creation)
+	double time_budget;  // wall-clock budget of a call in seconds, <= 0 for none
+	int ws_db_size;      // entries of the solution database for warm starts, 0 for none (set before memory creation)
+	double ws_db_jump;   // change of x0 (inf-norm) above which the database is searched
+	int *cancel;  // if not NULL, the solver returns ACADOS_CANCELLED once *cancel != 0 (omp atomic)
+	double screen_margin;  // screening of far-inactive nonlinear constraints (bgh stages), <= 0 for none (set before memory creation)
 
 } ocp_nlp_sqp_opts;
 
@@ -105,6 +119,11 @@ typedef struct
 	// QP stuff not entering the qp_in struct
     struct blasfeo_dmat *dzduxt; // dzdux transposed
     struct blasfeo_dvec *z_alg; // z_alg, output algebraic variables
+	// block-wise quasi-Newton (only if qn_update != QN_NONE)
+	struct blasfeo_dmat *qn_B; // Hessian approximation of each stage block
+	struct blasfeo_dvec *qn_grad; // Lagrangian gradient at the previous iterate
+	struct blasfeo_dvec *qn_s; // primal step
+	struct blasfeo_dvec *qn_tmp; // B*s
 
     //    ocp_nlp_dims *dims;
     void *qp_solver_mem;
@@ -134,6 +153,19 @@ typedef struct
 	int stat_m;
 	int stat_n;
 
+	// solution database for warm starts, keyed on x0 (only if ws_db_size > 0)
+	double *ws_db_key;       // stored keys, ws_db_size x ws_db_nkey
+	double *ws_db_val;       // stored primal-dual trajectories and integrator guesses, ws_db_size x ws_db_len
+	double *ws_db_key_cur;   // key of the current call
+	double *ws_db_key_prev;  // key of the previous call
+	int *ws_db_used;         // time of last use of each entry, for LRU eviction
+	int ws_db_nkey;
+	int ws_db_len;
+	int ws_db_num;           // number of stored entries
+	int ws_db_tick;
+	int ws_db_prev_set;
+	int ws_db_hit;           // 1 if the last call was initialized from the database
+
 } ocp_nlp_sqp_memory;
 
 //
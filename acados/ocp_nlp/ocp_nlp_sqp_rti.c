@@ -51,6 +51,7 @@
 // acados
 #include "acados/ocp_nlp/ocp_nlp_common.h"
 #include "acados/ocp_nlp/ocp_nlp_dynamics_cont.h"
+#include "acados/ocp_nlp/ocp_nlp_dynamics_disc.h"
 #include "acados/ocp_nlp/ocp_nlp_reg_common.h"
 #include "acados/ocp_qp/ocp_qp_common.h"
 #include "acados/sim/sim_common.h"
@@ -198,6 +199,13 @@ void ocp_nlp_sqp_rti_opts_initialize_default(void *config_, void *dims_, void *o
 
 	opts->step_length = 1.0;
 
+	opts->qp_warm_start = 0;
+
+    opts->mli_level = MLI_LEVEL_D;
+    opts->mli_full_period = 0;
+
+    opts->delay = 0.0;
+
     // submodules opts
 
     // do not compute adjoint in dynamics and constraints
@@ -338,6 +346,26 @@ void ocp_nlp_sqp_rti_opts_set(void *config_, void *opts_, const char *field, voi
 			double* step_length = (double *) value;
 			opts->step_length = *step_length;
 		}
+		else if (!strcmp(field, "mli_level"))
+		{
+			int* mli_level = (int *) value;
+			if (*mli_level < MLI_LEVEL_A || *mli_level > MLI_LEVEL_D)
+			{
+				printf("\nerror: ocp_nlp_sqp_rti_opts_set: mli_level %d not in [0, 3]\n", *mli_level);
+				exit(1);
+			}
+			opts->mli_level = *mli_level;
+		}
+		else if (!strcmp(field, "mli_full_period"))
+		{
+			int* mli_full_period = (int *) value;
+			opts->mli_full_period = *mli_full_period;
+		}
+		else if (!strcmp(field, "delay"))
+		{
+			double* delay = (double *) value;
+			opts->delay = *delay;
+		}
 		else
 		{
 			printf("\nerror: ocp_nlp_sqp_rti_opts_set: wrong field: %s\n", field);
@@ -421,6 +449,7 @@ int ocp_nlp_sqp_rti_memory_calculate_size(void *config_, void *dims_, void *opts
 	int *nx = dims->nx;
 	int *nu = dims->nu;
 	int *nz = dims->nz;
+	int *nv = dims->nv;
 
     int size = 0;
 
@@ -444,6 +473,8 @@ int ocp_nlp_sqp_rti_memory_calculate_size(void *config_, void *dims_, void *opts
         size += dynamics[ii]->memory_calculate_size(dynamics[ii], dims->dynamics[ii],
                                                     opts->dynamics[ii]);
     }
+    // delay compensation
+    size += dynamics[0]->memory_calculate_size(dynamics[0], dims->dynamics[0], opts->dynamics[0]);
 
     // cost
     size += (N + 1) * sizeof(void *);
@@ -478,6 +509,19 @@ int ocp_nlp_sqp_rti_memory_calculate_size(void *config_, void *dims_, void *opts
 	size += (N+1)*sizeof(struct blasfeo_dvec);
 	for(ii=0; ii<=N; ii++)
 		size += blasfeo_memsize_dvec(nz[ii]);
+	// RSQrq_lin
+	size += (N+1)*sizeof(struct blasfeo_dmat);
+	for(ii=0; ii<=N; ii++)
+		size += blasfeo_memsize_dmat(nu[ii]+nx[ii], nu[ii]+nx[ii]);
+	// ux_lin
+	size += (N+1)*sizeof(struct blasfeo_dvec);
+	for(ii=0; ii<=N; ii++)
+		size += blasfeo_memsize_dvec(nv[ii]);
+	// delay compensation
+	size += 3*nx[0]*sizeof(double);
+	size += blasfeo_memsize_dvec(nu[0]+nx[0]);
+	size += blasfeo_memsize_dvec(nu[1]+nx[1]);
+	size += blasfeo_memsize_dvec(nz[0]);
 
     size += 1*8;  // blasfeo_str align
     size += 1*64;  // blasfeo_mem align
@@ -514,6 +558,7 @@ void *ocp_nlp_sqp_rti_memory_assign(void *config_, void *dims_, void *opts_, voi
 	int *nx = dims->nx;
 	int *nu = dims->nu;
 	int *nz = dims->nz;
+	int *nv = dims->nv;
 
     // initial align
     align_char_to(8, &c_ptr);
@@ -552,6 +597,10 @@ void *ocp_nlp_sqp_rti_memory_assign(void *config_, void *dims_, void *opts_, voi
         c_ptr += dynamics[ii]->memory_calculate_size(dynamics[ii], dims->dynamics[ii],
                                                      opts->dynamics[ii]);
     }
+    // delay compensation
+    mem->delay_dynamics = dynamics[0]->memory_assign(dynamics[0], dims->dynamics[0],
+                                                     opts->dynamics[0], c_ptr);
+    c_ptr += dynamics[0]->memory_calculate_size(dynamics[0], dims->dynamics[0], opts->dynamics[0]);
 
     // cost
     mem->cost = (void **) c_ptr;
@@ -581,6 +630,9 @@ void *ocp_nlp_sqp_rti_memory_assign(void *config_, void *dims_, void *opts_, voi
 		mem->stat_n += 4;
 	c_ptr += mem->stat_m*mem->stat_n*sizeof(double);
 
+	// delay compensation
+	assign_and_advance_double(3*nx[0], &mem->delay_x0, &c_ptr);
+
     // blasfeo_str align
     align_char_to(8, &c_ptr);
 
@@ -590,6 +642,12 @@ void *ocp_nlp_sqp_rti_memory_assign(void *config_, void *dims_, void *opts_, voi
 	// z_alg
 	mem->z_alg = (struct blasfeo_dvec *) c_ptr;
 	c_ptr += (N+1)*sizeof(struct blasfeo_dvec);
+	// RSQrq_lin
+	mem->RSQrq_lin = (struct blasfeo_dmat *) c_ptr;
+	c_ptr += (N+1)*sizeof(struct blasfeo_dmat);
+	// ux_lin
+	mem->ux_lin = (struct blasfeo_dvec *) c_ptr;
+	c_ptr += (N+1)*sizeof(struct blasfeo_dvec);
 
     // blasfeo_mem align
     align_char_to(64, &c_ptr);
@@ -606,6 +664,35 @@ void *ocp_nlp_sqp_rti_memory_assign(void *config_, void *dims_, void *opts_, voi
 		blasfeo_create_dvec(nz[ii], mem->z_alg+ii, c_ptr);
 		c_ptr += blasfeo_memsize_dvec(nz[ii]);
 		}
+	// RSQrq_lin
+	for(ii=0; ii<=N; ii++)
+		{
+		blasfeo_create_dmat(nu[ii]+nx[ii], nu[ii]+nx[ii], mem->RSQrq_lin+ii, c_ptr);
+		c_ptr += blasfeo_memsize_dmat(nu[ii]+nx[ii], nu[ii]+nx[ii]);
+		}
+	// ux_lin
+	for(ii=0; ii<=N; ii++)
+		{
+		blasfeo_create_dvec(nv[ii], mem->ux_lin+ii, c_ptr);
+		c_ptr += blasfeo_memsize_dvec(nv[ii]);
+		}
+	// delay compensation
+	blasfeo_create_dvec(nu[0]+nx[0], &mem->delay_ux, c_ptr);
+	c_ptr += blasfeo_memsize_dvec(nu[0]+nx[0]);
+	blasfeo_create_dvec(nu[1]+nx[1], &mem->delay_ux1, c_ptr);
+	c_ptr += blasfeo_memsize_dvec(nu[1]+nx[1]);
+	blasfeo_create_dvec(nz[0], &mem->delay_z_alg, c_ptr);
+	c_ptr += blasfeo_memsize_dvec(nz[0]);
+	mem->delay_u_set = false;
+
+	// only compute_fun is called on the prediction dynamics, which leaves the QP matrices alone
+	dynamics[0]->memory_set_ux_ptr(&mem->delay_ux, mem->delay_dynamics);
+	dynamics[0]->memory_set_ux1_ptr(&mem->delay_ux1, mem->delay_dynamics);
+	dynamics[0]->memory_set_z_alg_ptr(&mem->delay_z_alg, mem->delay_dynamics);
+
+    mem->mli_iter = 0;
+    mem->mli_level = MLI_LEVEL_D;
+    mem->mli_lin_valid = false;
 
     mem->status = ACADOS_READY;
 
@@ -973,12 +1060,9 @@ static void initialize_qp(void *config_, ocp_nlp_dims *dims, ocp_nlp_in *nlp_in,
 
 
 
-static void linearize_update_qp_matrices(void *config_, ocp_nlp_dims *dims, ocp_nlp_in *nlp_in,
-                                         ocp_nlp_out *nlp_out, ocp_nlp_sqp_rti_opts *opts,
-                                         ocp_nlp_sqp_rti_memory *mem, ocp_nlp_sqp_rti_work *work)
+static void collect_stage_evaluations(ocp_nlp_config *config, ocp_nlp_dims *dims,
+                                      ocp_nlp_sqp_rti_memory *mem)
 {
-    ocp_nlp_config *config = (ocp_nlp_config *) config_;
-
     // loop index
     int i;
 
@@ -991,31 +1075,6 @@ static void linearize_update_qp_matrices(void *config_, ocp_nlp_dims *dims, ocp_
 
     ocp_nlp_memory *nlp_mem = mem->nlp_mem;
 
-    /* stage-wise multiple shooting lagrangian evaluation */
-
-#if defined(ACADOS_WITH_OPENMP)
-    #pragma omp parallel for
-#endif
-    for (i = 0; i <= N; i++)
-    {
-        // init Hessian to 0 
-        blasfeo_dgese(nu[i] + nx[i], nu[i] + nx[i], 0.0, mem->qp_in->RSQrq+i, 0, 0);
-        // dynamics
-        if (i < N)
-            config->dynamics[i]->update_qp_matrices(config->dynamics[i], dims->dynamics[i],
-                    nlp_in->dynamics[i], opts->dynamics[i],
-                    mem->dynamics[i], work->dynamics[i]);
-        // cost
-        config->cost[i]->update_qp_matrices(config->cost[i], dims->cost[i], nlp_in->cost[i],
-                                            opts->cost[i], mem->cost[i], work->cost[i]);
-        // constraints
-        config->constraints[i]->update_qp_matrices(config->constraints[i], dims->constraints[i],
-                                                   nlp_in->constraints[i], opts->constraints[i],
-                                                   mem->constraints[i], work->constraints[i]);
-    }
-
-    /* collect stage-wise evaluations */
-
 #if defined(ACADOS_WITH_OPENMP)
     #pragma omp parallel for
 #endif
@@ -1065,6 +1124,51 @@ static void linearize_update_qp_matrices(void *config_, ocp_nlp_dims *dims, ocp_
 
     }
 
+    return;
+}
+
+
+
+static void linearize_update_qp_matrices(void *config_, ocp_nlp_dims *dims, ocp_nlp_in *nlp_in,
+                                         ocp_nlp_out *nlp_out, ocp_nlp_sqp_rti_opts *opts,
+                                         ocp_nlp_sqp_rti_memory *mem, ocp_nlp_sqp_rti_work *work)
+{
+    ocp_nlp_config *config = (ocp_nlp_config *) config_;
+
+    // loop index
+    int i;
+
+    // extract dims
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+
+    /* stage-wise multiple shooting lagrangian evaluation */
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (i = 0; i <= N; i++)
+    {
+        // init Hessian to 0 
+        blasfeo_dgese(nu[i] + nx[i], nu[i] + nx[i], 0.0, mem->qp_in->RSQrq+i, 0, 0);
+        // dynamics
+        if (i < N)
+            config->dynamics[i]->update_qp_matrices(config->dynamics[i], dims->dynamics[i],
+                    nlp_in->dynamics[i], opts->dynamics[i],
+                    mem->dynamics[i], work->dynamics[i]);
+        // cost
+        config->cost[i]->update_qp_matrices(config->cost[i], dims->cost[i], nlp_in->cost[i],
+                                            opts->cost[i], mem->cost[i], work->cost[i]);
+        // constraints
+        config->constraints[i]->update_qp_matrices(config->constraints[i], dims->constraints[i],
+                                                   nlp_in->constraints[i], opts->constraints[i],
+                                                   mem->constraints[i], work->constraints[i]);
+    }
+
+    /* collect stage-wise evaluations */
+    collect_stage_evaluations(config, dims, mem);
+
     // TODO(all): still to clean !!!!!!!!!!!!!
 
     for (i = 0; i <= N; i++)
@@ -1089,6 +1193,121 @@ static void linearize_update_qp_matrices(void *config_, ocp_nlp_dims *dims, ocp_
 }
 
 
+// multi-level iterations B and C: evaluate functions (and exact adjoints for C) at the
+// current iterate, keep the dynamics jacobians and hessian of the last level D iteration
+static void mli_update_qp(void *config_, ocp_nlp_dims *dims, ocp_nlp_in *nlp_in,
+                          ocp_nlp_out *nlp_out, ocp_nlp_sqp_rti_opts *opts,
+                          ocp_nlp_sqp_rti_memory *mem, ocp_nlp_sqp_rti_work *work, int level)
+{
+    ocp_nlp_config *config = (ocp_nlp_config *) config_;
+
+    // loop index
+    int i;
+
+    // extract dims
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (i = 0; i <= N; i++)
+    {
+        // dynamics
+        if (i < N)
+        {
+            if (level == MLI_LEVEL_C)
+                config->dynamics[i]->compute_fun_and_adj(config->dynamics[i], dims->dynamics[i],
+                        nlp_in->dynamics[i], opts->dynamics[i], mem->dynamics[i], work->dynamics[i]);
+            else
+                config->dynamics[i]->compute_fun(config->dynamics[i], dims->dynamics[i],
+                        nlp_in->dynamics[i], opts->dynamics[i], mem->dynamics[i], work->dynamics[i]);
+        }
+        // cost and constraints are cheap compared to the dynamics and fully updated
+        config->cost[i]->update_qp_matrices(config->cost[i], dims->cost[i], nlp_in->cost[i],
+                                            opts->cost[i], mem->cost[i], work->cost[i]);
+        config->constraints[i]->update_qp_matrices(config->constraints[i], dims->constraints[i],
+                                                   nlp_in->constraints[i], opts->constraints[i],
+                                                   mem->constraints[i], work->constraints[i]);
+        // hessian of the last level D iteration
+        blasfeo_dgecp(nu[i] + nx[i], nu[i] + nx[i], mem->RSQrq_lin+i, 0, 0, mem->qp_in->RSQrq+i, 0, 0);
+    }
+
+    collect_stage_evaluations(config, dims, mem);
+
+    return;
+}
+
+
+
+// gradient correction of level C: rq += adj_exact - adj_old, with adj_old = -BAbt_old * pi
+static void mli_gradient_correction(void *config_, ocp_nlp_dims *dims, ocp_nlp_out *nlp_out,
+                                    ocp_nlp_sqp_rti_memory *mem)
+{
+    ocp_nlp_config *config = (ocp_nlp_config *) config_;
+
+    // loop index
+    int i;
+
+    // extract dims
+    int N = dims->N;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for
+#endif
+    for (i = 0; i < N; i++)
+    {
+        struct blasfeo_dvec *dyn_adj = config->dynamics[i]->memory_get_adj_ptr(mem->dynamics[i]);
+        blasfeo_daxpy(nu[i]+nx[i], 1.0, dyn_adj, 0, mem->qp_in->rqz+i, 0, mem->qp_in->rqz+i, 0);
+        blasfeo_dgemv_n(nu[i]+nx[i], nx[i+1], 1.0, mem->qp_in->BAbt+i, 0, 0, nlp_out->pi+i, 0,
+                        1.0, mem->qp_in->rqz+i, 0, mem->qp_in->rqz+i, 0);
+    }
+
+    return;
+}
+
+
+
+// multi-level iteration A: reuse the QP of the last iteration around the point it was built at,
+// only the constraints of the first stage (containing x0) are updated
+static void mli_update_x0(void *config_, ocp_nlp_dims *dims, ocp_nlp_in *nlp_in,
+                          ocp_nlp_out *nlp_out, ocp_nlp_sqp_rti_opts *opts,
+                          ocp_nlp_sqp_rti_memory *mem, ocp_nlp_sqp_rti_work *work)
+{
+    ocp_nlp_config *config = (ocp_nlp_config *) config_;
+
+    // loop index
+    int i;
+
+    // extract dims
+    int N = dims->N;
+    int *nv = dims->nv;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+    int *ni = dims->ni;
+
+    // the QP step is taken from its linearization point
+    for (i = 0; i <= N; i++)
+        blasfeo_dveccp(nv[i], mem->ux_lin+i, 0, nlp_out->ux+i, 0);
+
+    config->constraints[0]->update_qp_matrices(config->constraints[0], dims->constraints[0],
+                                               nlp_in->constraints[0], opts->constraints[0],
+                                               mem->constraints[0], work->constraints[0]);
+    struct blasfeo_dvec *ineq_fun = config->constraints[0]->memory_get_fun_ptr(mem->constraints[0]);
+    blasfeo_dveccp(2 * ni[0], ineq_fun, 0, mem->nlp_mem->ineq_fun, 0);
+    blasfeo_dveccp(2 * ni[0], ineq_fun, 0, mem->qp_in->d, 0);
+
+    for (i = 0; i <= N; i++)
+        blasfeo_dgecp(nu[i] + nx[i], nu[i] + nx[i], mem->RSQrq_lin+i, 0, 0, mem->qp_in->RSQrq+i, 0, 0);
+
+    return;
+}
+
+
+
 // update QP rhs for SQP (step prim var, abs dual var)
 // TODO(all): move in dynamics, cost, constraints modules ???
 static void sqp_update_qp_vectors(void *config_, ocp_nlp_dims *dims, ocp_nlp_in *nlp_in,
@@ -1192,6 +1411,104 @@ static void sqp_update_variables(ocp_nlp_dims *dims, ocp_nlp_out *nlp_out,
 
 
 
+// delay compensation: replace the measured x0 in the bounds of the first stage by its prediction
+// at the end of the delay, under the first control of the previous call; if the delay equals the
+// first sampling time, the stage 0 sensitivities of the last linearization are reused, else the
+// stage 0 integrator is called over the delay
+static void delay_predict_x0(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *nlp_in,
+                             ocp_nlp_out *nlp_out, ocp_nlp_sqp_rti_opts *opts,
+                             ocp_nlp_sqp_rti_memory *mem, ocp_nlp_sqp_rti_work *work)
+{
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+
+    int nbx0;
+    config->constraints[0]->dims_get(config->constraints[0], dims->constraints[0], "nbx", &nbx0);
+    if (nbx0 != nx[0] || nx[1] != nx[0] || config->constraints[0]->model_get == NULL)
+    {
+        printf("\nerror: ocp_nlp_sqp_rti: delay compensation needs x0 as bounds on all states\n");
+        exit(1);
+    }
+
+    // measured x0
+    config->constraints[0]->model_get(config->constraints[0], dims->constraints[0],
+                                      nlp_in->constraints[0], "lbx", mem->delay_x0);
+    config->constraints[0]->model_get(config->constraints[0], dims->constraints[0],
+                                      nlp_in->constraints[0], "ubx", mem->delay_x0+nx[0]);
+
+    // [u; x0]
+    if (!mem->delay_u_set)
+        blasfeo_dveccp(nu[0], nlp_out->ux, 0, &mem->delay_ux, 0);
+    blasfeo_pack_dvec(nx[0], mem->delay_x0, &mem->delay_ux, nu[0]);
+
+    if (mem->mli_lin_valid && fabs(opts->delay - nlp_in->Ts[0]) < ACADOS_EPS)
+    {
+        // x = phi(ux_lin) + [B; A]' * ([u; x0] - ux_lin)
+        blasfeo_daxpy(nx[1], 1.0, mem->nlp_mem->dyn_fun, 0, mem->ux_lin+1, nu[1],
+                      &mem->delay_ux1, nu[1]);
+        blasfeo_dgemv_t(nu[0]+nx[0], nx[1], -1.0, mem->qp_in->BAbt, 0, 0, mem->ux_lin, 0, 1.0,
+                        &mem->delay_ux1, nu[1], &mem->delay_ux1, nu[1]);
+        blasfeo_dgemv_t(nu[0]+nx[0], nx[1], 1.0, mem->qp_in->BAbt, 0, 0, &mem->delay_ux, 0, 1.0,
+                        &mem->delay_ux1, nu[1], &mem->delay_ux1, nu[1]);
+    }
+    else
+    {
+        // a discrete model ignores T, it can only predict over its own sampling time
+        if (config->dynamics[0]->compute_fun == &ocp_nlp_dynamics_disc_compute_fun &&
+            fabs(opts->delay - nlp_in->Ts[0]) >= ACADOS_EPS)
+        {
+            printf("\nerror: ocp_nlp_sqp_rti: delay compensation with discrete dynamics needs"
+                   " delay == Ts[0]\n");
+            exit(1);
+        }
+
+        // x = phi([u; x0]) over the delay, i.e. fun with a zero next state; evaluated on separate
+        // dynamics memory, the integrator state and the outputs of mem->dynamics[0] are untouched
+        blasfeo_dvecse(nu[1]+nx[1], 0.0, &mem->delay_ux1, 0);
+        config->dynamics[0]->model_set(config->dynamics[0], dims->dynamics[0], nlp_in->dynamics[0],
+                                       "T", &opts->delay);
+
+        config->dynamics[0]->compute_fun(config->dynamics[0], dims->dynamics[0],
+                nlp_in->dynamics[0], opts->dynamics[0], mem->delay_dynamics, work->dynamics[0]);
+
+        struct blasfeo_dvec *fun = config->dynamics[0]->memory_get_fun_ptr(mem->delay_dynamics);
+        blasfeo_dveccp(nx[1], fun, 0, &mem->delay_ux1, nu[1]);
+
+        config->dynamics[0]->model_set(config->dynamics[0], dims->dynamics[0], nlp_in->dynamics[0],
+                                       "T", nlp_in->Ts);
+    }
+
+    // predicted x0
+    double *x0_pred = mem->delay_x0+2*nx[0];
+    blasfeo_unpack_dvec(nx[1], &mem->delay_ux1, nu[1], x0_pred);
+    config->constraints[0]->model_set(config->constraints[0], dims->constraints[0],
+                                      nlp_in->constraints[0], "lbx", x0_pred);
+    config->constraints[0]->model_set(config->constraints[0], dims->constraints[0],
+                                      nlp_in->constraints[0], "ubx", x0_pred);
+}
+
+
+
+// delay compensation: restore the measured x0, keep the first control for the next prediction
+static void delay_restore_x0(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *nlp_in,
+                             ocp_nlp_out *nlp_out, ocp_nlp_sqp_rti_memory *mem, bool new_u)
+{
+    int nx0 = dims->nx[0];
+
+    config->constraints[0]->model_set(config->constraints[0], dims->constraints[0],
+                                      nlp_in->constraints[0], "lbx", mem->delay_x0);
+    config->constraints[0]->model_set(config->constraints[0], dims->constraints[0],
+                                      nlp_in->constraints[0], "ubx", mem->delay_x0+nx0);
+
+    if (new_u)
+    {
+        blasfeo_dveccp(dims->nu[0], nlp_out->ux, 0, &mem->delay_ux, 0);
+        mem->delay_u_set = true;
+    }
+}
+
+
+
 // Simple fixed-step Gauss-Newton based SQP routine
 int ocp_nlp_sqp_rti(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
                 void *opts_, void *mem_, void *work_)
@@ -1310,6 +1627,10 @@ int ocp_nlp_sqp_rti(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
     } // end of parallel region
 #endif
 
+    // delay compensation
+    if (opts->delay > 0.0)
+        delay_predict_x0(config, dims, nlp_in, nlp_out, opts, mem, work);
+
     // initialize QP
     initialize_qp(config, dims, nlp_in, nlp_out, opts, mem, work);
 
@@ -1317,17 +1638,53 @@ int ocp_nlp_sqp_rti(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
 
     // SQP body
 
+    // level of the multi-level iteration scheme
+    int mli_level = opts->mli_level;
+    if (opts->mli_full_period > 0 && mem->mli_iter % opts->mli_full_period == 0)
+        mli_level = MLI_LEVEL_D;
+    if (!mem->mli_lin_valid)
+        mli_level = MLI_LEVEL_D;
+    mem->mli_level = mli_level;
+    mem->mli_iter++;
+
     // start timer
     acados_tic(&timer1);
 
-    // linearizate NLP and update QP matrices
-    linearize_update_qp_matrices(config, dims, nlp_in, nlp_out, opts, mem, work);
+    if (mli_level == MLI_LEVEL_D)
+    {
+        // linearizate NLP and update QP matrices
+        linearize_update_qp_matrices(config, dims, nlp_in, nlp_out, opts, mem, work);
+
+        // store the hessian for the lower levels
+        for (ii = 0; ii <= N; ii++)
+            blasfeo_dgecp(dims->nu[ii] + dims->nx[ii], dims->nu[ii] + dims->nx[ii],
+                          mem->qp_in->RSQrq+ii, 0, 0, mem->RSQrq_lin+ii, 0, 0);
+        mem->mli_lin_valid = true;
+    }
+    else if (mli_level == MLI_LEVEL_A)
+    {
+        mli_update_x0(config, dims, nlp_in, nlp_out, opts, mem, work);
+    }
+    else
+    {
+        mli_update_qp(config, dims, nlp_in, nlp_out, opts, mem, work, mli_level);
+    }
 
     // stop timer
     mem->time_lin += acados_toc(&timer1);
 
-    // update QP rhs for SQP (step prim var, abs dual var)
-    sqp_update_qp_vectors(config, dims, nlp_in, nlp_out, opts, mem, work);
+    if (mli_level != MLI_LEVEL_A)
+    {
+        // update QP rhs for SQP (step prim var, abs dual var)
+        sqp_update_qp_vectors(config, dims, nlp_in, nlp_out, opts, mem, work);
+
+        if (mli_level == MLI_LEVEL_C)
+            mli_gradient_correction(config, dims, nlp_out, mem);
+
+        // linearization point of the QP vectors, used by level A
+        for (ii = 0; ii <= N; ii++)
+            blasfeo_dveccp(dims->nv[ii], nlp_out->ux+ii, 0, mem->ux_lin+ii, 0);
+    }
 
 	// save statistics
 //	mem->stat[mem->stat_n*1+0] = qp_status;
@@ -1344,9 +1701,8 @@ int ocp_nlp_sqp_rti(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
     // print_ocp_qp_in(mem->qp_in);
     // exit(1);
 
-	// TODO no warm start across NLP solutions (yet)
-	int tmp_int = 0;
-	config->qp_solver->opts_set(config->qp_solver, opts->qp_solver_opts, "warm_start", &tmp_int);
+	// warm start across samples, the QP solution of the previous sample is kept in memory
+	config->qp_solver->opts_set(config->qp_solver, opts->qp_solver_opts, "warm_start", &opts->qp_warm_start);
 
     // start timer
     acados_tic(&timer1);
@@ -1396,6 +1752,8 @@ int ocp_nlp_sqp_rti(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
         nlp_out->total_time = total_time;
 
         printf("QP solver returned error status %d\n", qp_status);
+        if (opts->delay > 0.0)
+            delay_restore_x0(config, dims, nlp_in, nlp_out, mem, false);
 #if defined(ACADOS_WITH_OPENMP)
         // restore number of threads
         omp_set_num_threads(num_threads_bkp);
@@ -1406,6 +1764,9 @@ int ocp_nlp_sqp_rti(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
 
     sqp_update_variables(dims, nlp_out, opts, mem, work);
 
+    if (opts->delay > 0.0)
+        delay_restore_x0(config, dims, nlp_in, nlp_out, mem, true);
+
     // ocp_nlp_dims_print(nlp_out->dims);
     // ocp_nlp_out_print(nlp_out);
     // exit(1);
@@ -1470,6 +1831,12 @@ int ocp_nlp_sqp_rti_precompute(void *config_, void *dims_, void *nlp_in_, void *
         if (status != ACADOS_SUCCESS) return status;
     }
 
+    // delay compensation
+    config->dynamics[0]->model_set(config->dynamics[0], dims->dynamics[0], nlp_in->dynamics[0], "T", nlp_in->Ts);
+    status = config->dynamics[0]->precompute(config->dynamics[0], dims->dynamics[0],
+                                        nlp_in->dynamics[0], opts->dynamics[0],
+                                        mem->delay_dynamics, work->dynamics[0]);
+
     return status;
 }
 
@@ -1550,6 +1917,39 @@ void ocp_nlp_sqp_rti_eval_param_sens(void *config_, void *dims_, void *opts_, vo
 
 
 
+void ocp_nlp_sqp_rti_simulate_stage(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
+        void *opts_, void *mem_, void *work_, int stage)
+{
+    ocp_nlp_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+    ocp_nlp_sqp_rti_opts *opts = opts_;
+    ocp_nlp_sqp_rti_memory *mem = mem_;
+    ocp_nlp_in *nlp_in = nlp_in_;
+    ocp_nlp_out *nlp_out = nlp_out_;
+
+    ocp_nlp_sqp_rti_work *work = work_;
+
+    ocp_nlp_sqp_rti_cast_workspace(config, dims, work, mem, opts);
+
+    int nx1 = dims->nx[stage+1];
+    int nu1 = dims->nu[stage+1];
+
+    config->dynamics[stage]->memory_set_ux_ptr(nlp_out->ux+stage, mem->dynamics[stage]);
+    config->dynamics[stage]->memory_set_ux1_ptr(nlp_out->ux+stage+1, mem->dynamics[stage]);
+
+    // fun = phi(x, u) - x1
+    config->dynamics[stage]->compute_fun(config->dynamics[stage], dims->dynamics[stage],
+            nlp_in->dynamics[stage], opts->dynamics[stage], mem->dynamics[stage],
+            work->dynamics[stage]);
+
+    struct blasfeo_dvec *fun = config->dynamics[stage]->memory_get_fun_ptr(mem->dynamics[stage]);
+    blasfeo_daxpy(nx1, 1.0, fun, 0, nlp_out->ux+stage+1, nu1, nlp_out->ux+stage+1, nu1);
+
+    return;
+}
+
+
+
 // TODO remane mmeory_get ???
 void ocp_nlp_sqp_rti_get(void *config_, void *mem_, const char *field, void *return_value_)
 {
@@ -1601,11 +2001,26 @@ void ocp_nlp_sqp_rti_get(void *config_, void *mem_, const char *field, void *ret
         int *value = return_value_;
         *value = mem->stat_n;
     }
+    else if (!strcmp("mli_level", field))
+    {
+        int *value = return_value_;
+        *value = mem->mli_level;
+    }
     else if (!strcmp("nlp_mem", field))
     {
         void **value = return_value_;
         *value = mem->nlp_mem;
     }
+    else if (!strcmp("qp_in", field))
+    {
+        void **value = return_value_;
+        *value = mem->qp_in;
+    }
+    else if (!strcmp("qp_out", field))
+    {
+        void **value = return_value_;
+        *value = mem->qp_out;
+    }
     else
     {
         printf("\nerror: output type %s not available in ocp_nlp_sqp_rti module\n", field);
@@ -1631,6 +2046,7 @@ void ocp_nlp_sqp_rti_config_initialize_default(void *config_)
     config->workspace_calculate_size = &ocp_nlp_sqp_rti_workspace_calculate_size;
     config->evaluate = &ocp_nlp_sqp_rti;
     config->eval_param_sens = &ocp_nlp_sqp_rti_eval_param_sens;
+    config->simulate_stage = &ocp_nlp_sqp_rti_simulate_stage;
     config->config_initialize_default = &ocp_nlp_sqp_rti_config_initialize_default;
     config->precompute = &ocp_nlp_sqp_rti_precompute;
     config->get = &ocp_nlp_sqp_rti_get;
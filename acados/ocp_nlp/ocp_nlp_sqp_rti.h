@@ -57,6 +57,17 @@ extern "C" {
  * options
  ************************************************/
 
+// levels of the multi-level iteration scheme
+typedef enum
+{
+    MLI_LEVEL_A,  // QP of the last iteration with the new x0, no evaluations
+    MLI_LEVEL_B,  // function evaluations, jacobians and hessian of the last level D iteration
+    MLI_LEVEL_C,  // as B, plus adjoint based gradient correction
+    MLI_LEVEL_D,  // full linearization
+} ocp_nlp_mli_level;
+
+
+
 typedef struct
 {
     void *qp_solver_opts;
@@ -70,6 +81,9 @@ typedef struct
     int num_threads;
 	int ext_qp_res;      // compute external QP residuals (i.e. at SQP level) at each SQP iteration (for debugging)
 	int qp_warm_start;
+    int mli_level;        // level of the iterations (ocp_nlp_mli_level), default MLI_LEVEL_D
+    int mli_full_period;  // if > 0, every mli_full_period-th iteration is a level D iteration
+    double delay;         // if > 0, x0 is predicted over this delay before the feedback
 } ocp_nlp_sqp_rti_opts;
 
 //
@@ -120,6 +134,21 @@ typedef struct
 	double *stat;
 	int stat_m;
 	int stat_n;
+
+    // multi-level iterations
+    struct blasfeo_dmat *RSQrq_lin;  // hessian of the last level D iteration (not regularized)
+    struct blasfeo_dvec *ux_lin;     // iterate at which the current qp_in vectors were built
+    int mli_iter;                    // number of iterations since the last reset
+    int mli_level;                   // level of the last iteration
+    bool mli_lin_valid;              // a level D iteration has been performed
+
+    // delay compensation
+    struct blasfeo_dvec delay_ux;    // [u; x0], control applied during the delay and measured x0
+    struct blasfeo_dvec delay_ux1;   // next stage variables used in the prediction
+    double *delay_x0;                // measured lbx and ubx of the first stage (restored after the call), prediction
+    bool delay_u_set;                // delay_ux holds the first control of the previous call
+    void *delay_dynamics;            // stage 0 dynamics memory of the prediction, not aliasing qp_in
+    struct blasfeo_dvec delay_z_alg; // algebraic variables of the prediction
 } ocp_nlp_sqp_rti_memory;
 
 //
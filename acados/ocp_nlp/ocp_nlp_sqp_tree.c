@@ -0,0 +1,1618 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+
+#include "acados/ocp_nlp/ocp_nlp_sqp_tree.h"
+
+// external
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#if defined(ACADOS_WITH_OPENMP)
+#include <omp.h>
+#endif
+
+// blasfeo
+#include "blasfeo/include/blasfeo_d_aux.h"
+#include "blasfeo/include/blasfeo_d_blas.h"
+// acados
+#include "acados/ocp_nlp/ocp_nlp_common.h"
+#include "acados/utils/mem.h"
+#include "acados/utils/timing.h"
+#include "acados/utils/types.h"
+
+
+
+/************************************************
+ * dims
+ ************************************************/
+
+int ocp_nlp_tree_num_nodes(int md, int Nr, int Nh)
+{
+    int Nn = 0;
+    int n_stage = 1;  // number of nodes in the current stage
+
+    for (int ii = 0; ii <= Nh; ii++)
+    {
+        Nn += n_stage;
+        if (ii < Nr)
+            n_stage *= md;
+    }
+
+    return Nn;
+}
+
+
+
+int ocp_nlp_tree_dims_calculate_size(void *config_, int md, int Nr, int Nh)
+{
+    ocp_nlp_config *config = config_;
+
+    int N = config->N;
+    int Nn = ocp_nlp_tree_num_nodes(md, Nr, Nh);
+
+    int ii;
+
+    int size = 0;
+
+    // self
+    size += sizeof(ocp_nlp_tree_dims);
+
+    // nlp dims
+    size += ocp_nlp_dims_calculate_size_self(N);
+
+    // dynamics
+    for (ii = 0; ii < N; ii++)
+        size += config->dynamics[ii]->dims_calculate_size(config->dynamics[ii]);
+
+    // cost
+    for (ii = 0; ii <= N; ii++)
+        size += config->cost[ii]->dims_calculate_size(config->cost[ii]);
+
+    // constraints
+    for (ii = 0; ii <= N; ii++)
+        size += config->constraints[ii]->dims_calculate_size(config->constraints[ii]);
+
+    // qp dims per node
+    size += 6 * Nn * sizeof(int);  // nbx, nbu, ng, nsbx, nsbu, nsg
+
+    // tree
+    size += sizeof(struct sctree);
+    size += sctree_memsize(md, Nr, Nh);
+    size += sizeof(struct tree);
+
+    // tree qp dims
+    size += sizeof(struct d_tree_ocp_qp_dim);
+    size += d_tree_ocp_qp_dim_memsize(Nn);
+
+    size += 3 * 8;  // aligns
+
+    return size;
+}
+
+
+
+static void ocp_nlp_tree_dims_update_qp(ocp_nlp_tree_dims *dims)
+{
+    d_tree_ocp_qp_dim_set_all(dims->ttree, dims->nlp_dims->nx, dims->nlp_dims->nu, dims->nbx,
+                              dims->nbu, dims->ng, dims->nsbx, dims->nsbu, dims->nsg, dims->qp_dims);
+
+    return;
+}
+
+
+
+ocp_nlp_tree_dims *ocp_nlp_tree_dims_assign(void *config_, int md, int Nr, int Nh, void *raw_memory)
+{
+    ocp_nlp_config *config = config_;
+
+    int N = config->N;
+    int Nn = ocp_nlp_tree_num_nodes(md, Nr, Nh);
+
+    if (Nn != N + 1)
+    {
+        printf("\nerror: ocp_nlp_tree_dims_assign: config created with N = %d, ", N);
+        printf("but the scenario tree has %d nodes, N = Nn-1 is required\n", Nn);
+        exit(1);
+    }
+
+    int ii;
+
+    char *c_ptr = (char *) raw_memory;
+
+    // initial align
+    align_char_to(8, &c_ptr);
+
+    // struct
+    ocp_nlp_tree_dims *dims = (ocp_nlp_tree_dims *) c_ptr;
+    c_ptr += sizeof(ocp_nlp_tree_dims);
+
+    // nlp dims
+    dims->nlp_dims = ocp_nlp_dims_assign_self(N, c_ptr);
+    c_ptr += ocp_nlp_dims_calculate_size_self(N);
+
+    // dynamics
+    for (ii = 0; ii < N; ii++)
+    {
+        dims->nlp_dims->dynamics[ii] = config->dynamics[ii]->dims_assign(config->dynamics[ii], c_ptr);
+        c_ptr += config->dynamics[ii]->dims_calculate_size(config->dynamics[ii]);
+    }
+
+    // cost
+    for (ii = 0; ii <= N; ii++)
+    {
+        dims->nlp_dims->cost[ii] = config->cost[ii]->dims_assign(config->cost[ii], c_ptr);
+        c_ptr += config->cost[ii]->dims_calculate_size(config->cost[ii]);
+    }
+
+    // constraints
+    for (ii = 0; ii <= N; ii++)
+    {
+        dims->nlp_dims->constraints[ii] =
+            config->constraints[ii]->dims_assign(config->constraints[ii], c_ptr);
+        c_ptr += config->constraints[ii]->dims_calculate_size(config->constraints[ii]);
+    }
+
+    // the tree is solved by hpipm directly, no xcond solver
+    dims->nlp_dims->qp_solver = NULL;
+
+    // qp dims per node
+    assign_and_advance_int(Nn, &dims->nbx, &c_ptr);
+    assign_and_advance_int(Nn, &dims->nbu, &c_ptr);
+    assign_and_advance_int(Nn, &dims->ng, &c_ptr);
+    assign_and_advance_int(Nn, &dims->nsbx, &c_ptr);
+    assign_and_advance_int(Nn, &dims->nsbu, &c_ptr);
+    assign_and_advance_int(Nn, &dims->nsg, &c_ptr);
+    for (ii = 0; ii < Nn; ii++)
+    {
+        dims->nbx[ii] = 0;
+        dims->nbu[ii] = 0;
+        dims->ng[ii] = 0;
+        dims->nsbx[ii] = 0;
+        dims->nsbu[ii] = 0;
+        dims->nsg[ii] = 0;
+    }
+
+    // structs
+    align_char_to(8, &c_ptr);
+    dims->sctree = (struct sctree *) c_ptr;
+    c_ptr += sizeof(struct sctree);
+    dims->ttree = (struct tree *) c_ptr;
+    c_ptr += sizeof(struct tree);
+    dims->qp_dims = (struct d_tree_ocp_qp_dim *) c_ptr;
+    c_ptr += sizeof(struct d_tree_ocp_qp_dim);
+
+    // tree
+    align_char_to(8, &c_ptr);
+    sctree_create(md, Nr, Nh, dims->sctree, c_ptr);
+    c_ptr += dims->sctree->memsize;
+    sctree_cast_to_tree(dims->sctree, dims->ttree);
+
+    // tree qp dims
+    align_char_to(8, &c_ptr);
+    d_tree_ocp_qp_dim_create(Nn, dims->qp_dims, c_ptr);
+    c_ptr += dims->qp_dims->memsize;
+
+    dims->Nn = Nn;
+    dims->md = md;
+    dims->Nr = Nr;
+    dims->Nh = Nh;
+
+    ocp_nlp_tree_dims_update_qp(dims);
+
+    assert((char *) raw_memory + ocp_nlp_tree_dims_calculate_size(config_, md, Nr, Nh) >= c_ptr);
+
+    return dims;
+}
+
+
+
+int ocp_nlp_tree_dims_get_parent(ocp_nlp_tree_dims *dims, int node)
+{
+    return dims->ttree->root[node].dad;
+}
+
+
+
+int ocp_nlp_tree_dims_get_stage(ocp_nlp_tree_dims *dims, int node)
+{
+    return dims->ttree->root[node].stage;
+}
+
+
+
+void ocp_nlp_tree_dims_set_opt_vars(void *config_, void *dims_, const char *field,
+                                    const void *value_array)
+{
+    ocp_nlp_config *config = config_;
+    ocp_nlp_tree_dims *dims = dims_;
+    ocp_nlp_dims *nlp_dims = dims->nlp_dims;
+
+    int N = nlp_dims->N;
+    int *int_array = (int *) value_array;
+
+    int ii, dad;
+
+    if (!strcmp(field, "nx") || !strcmp(field, "nu"))
+    {
+        int *nlp_field = !strcmp(field, "nx") ? nlp_dims->nx : nlp_dims->nu;
+        const char *field1 = !strcmp(field, "nx") ? "nx1" : "nu1";
+
+        // nodes
+        for (ii = 0; ii <= N; ii++)
+        {
+            nlp_field[ii] = int_array[ii];
+            nlp_dims->nv[ii] = nlp_dims->nu[ii] + nlp_dims->nx[ii] + 2 * nlp_dims->ns[ii];
+            config->cost[ii]->dims_set(config->cost[ii], nlp_dims->cost[ii], field, &int_array[ii]);
+            config->constraints[ii]->dims_set(config->constraints[ii], nlp_dims->constraints[ii],
+                                              field, &int_array[ii]);
+        }
+        // edges: from the parent of node ii+1 to node ii+1
+        for (ii = 0; ii < N; ii++)
+        {
+            dad = ocp_nlp_tree_dims_get_parent(dims, ii+1);
+            config->dynamics[ii]->dims_set(config->dynamics[ii], nlp_dims->dynamics[ii], field,
+                                           &int_array[dad]);
+            config->dynamics[ii]->dims_set(config->dynamics[ii], nlp_dims->dynamics[ii], field1,
+                                           &int_array[ii+1]);
+        }
+    }
+    else if (!strcmp(field, "nz"))
+    {
+        // nodes
+        for (ii = 0; ii <= N; ii++)
+        {
+            nlp_dims->nz[ii] = int_array[ii];
+            config->cost[ii]->dims_set(config->cost[ii], nlp_dims->cost[ii], "nz", &int_array[ii]);
+            config->constraints[ii]->dims_set(config->constraints[ii], nlp_dims->constraints[ii],
+                                              "nz", &int_array[ii]);
+        }
+        // edges
+        for (ii = 0; ii < N; ii++)
+        {
+            dad = ocp_nlp_tree_dims_get_parent(dims, ii+1);
+            config->dynamics[ii]->dims_set(config->dynamics[ii], nlp_dims->dynamics[ii], "nz",
+                                           &int_array[dad]);
+        }
+    }
+    else if (!strcmp(field, "ns"))
+    {
+        for (ii = 0; ii <= N; ii++)
+        {
+            nlp_dims->ns[ii] = int_array[ii];
+            nlp_dims->nv[ii] = nlp_dims->nu[ii] + nlp_dims->nx[ii] + 2 * nlp_dims->ns[ii];
+            config->cost[ii]->dims_set(config->cost[ii], nlp_dims->cost[ii], "ns", &int_array[ii]);
+        }
+    }
+    else
+    {
+        printf("\nerror: ocp_nlp_tree_dims_set_opt_vars: field %s not available\n", field);
+        exit(1);
+    }
+
+    ocp_nlp_tree_dims_update_qp(dims);
+
+    return;
+}
+
+
+
+void ocp_nlp_tree_dims_set_constraints(void *config_, void *dims_, int node, const char *field,
+                                       const void *value)
+{
+    ocp_nlp_config *config = config_;
+    ocp_nlp_tree_dims *dims = dims_;
+    ocp_nlp_dims *nlp_dims = dims->nlp_dims;
+
+    int *int_value = (int *) value;
+    int i = node;
+
+    // set in constraint module
+    config->constraints[i]->dims_set(config->constraints[i], nlp_dims->constraints[i], field,
+                                     int_value);
+    // update ni
+    config->constraints[i]->dims_get(config->constraints[i], nlp_dims->constraints[i], "ni",
+                                     &nlp_dims->ni[i]);
+
+    // update qp dims
+    if (!strcmp(field, "nbx"))
+    {
+        dims->nbx[i] = *int_value;
+    }
+    else if (!strcmp(field, "nbu"))
+    {
+        dims->nbu[i] = *int_value;
+    }
+    else if (!strcmp(field, "nsbx"))
+    {
+        dims->nsbx[i] = *int_value;
+    }
+    else if (!strcmp(field, "nsbu"))
+    {
+        dims->nsbu[i] = *int_value;
+    }
+    else if (!strcmp(field, "ng") || !strcmp(field, "nh"))
+    {
+        int ng, nh;
+        config->constraints[i]->dims_get(config->constraints[i], nlp_dims->constraints[i], "ng", &ng);
+        config->constraints[i]->dims_get(config->constraints[i], nlp_dims->constraints[i], "nh", &nh);
+        dims->ng[i] = ng + nh;
+    }
+    else if (!strcmp(field, "nsg") || !strcmp(field, "nsh"))
+    {
+        int nsg, nsh;
+        config->constraints[i]->dims_get(config->constraints[i], nlp_dims->constraints[i], "nsg",
+                                         &nsg);
+        config->constraints[i]->dims_get(config->constraints[i], nlp_dims->constraints[i], "nsh",
+                                         &nsh);
+        dims->nsg[i] = nsg + nsh;
+    }
+
+    ocp_nlp_tree_dims_update_qp(dims);
+
+    return;
+}
+
+
+
+void ocp_nlp_tree_dims_set_cost(void *config_, void *dims_, int node, const char *field,
+                                const void *value)
+{
+    ocp_nlp_config *config = config_;
+    ocp_nlp_tree_dims *dims = dims_;
+
+    int *int_value = (int *) value;
+
+    config->cost[node]->dims_set(config->cost[node], dims->nlp_dims->cost[node], field, int_value);
+
+    return;
+}
+
+
+
+void ocp_nlp_tree_dims_set_dynamics(void *config_, void *dims_, int edge, const char *field,
+                                    const void *value)
+{
+    ocp_nlp_config *config = config_;
+    ocp_nlp_tree_dims *dims = dims_;
+
+    int *int_value = (int *) value;
+
+    config->dynamics[edge]->dims_set(config->dynamics[edge], dims->nlp_dims->dynamics[edge], field,
+                                     int_value);
+
+    return;
+}
+
+
+
+/************************************************
+ * options
+ ************************************************/
+
+int ocp_nlp_sqp_tree_opts_calculate_size(void *config_, void *dims_)
+{
+    ocp_nlp_tree_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+
+    ocp_nlp_dynamics_config **dynamics = config->dynamics;
+    ocp_nlp_cost_config **cost = config->cost;
+    ocp_nlp_constraints_config **constraints = config->constraints;
+
+    int N = dims->nlp_dims->N;
+
+    int size = 0;
+
+    size += sizeof(ocp_nlp_sqp_tree_opts);
+
+    // qp solver
+    size += sizeof(struct d_tree_ocp_qp_ipm_arg);
+    size += d_tree_ocp_qp_ipm_arg_memsize(dims->qp_dims);
+
+    // dynamics
+    size += N * sizeof(void *);
+    for (int ii = 0; ii < N; ii++)
+    {
+        size += dynamics[ii]->opts_calculate_size(dynamics[ii], dims->nlp_dims->dynamics[ii]);
+    }
+
+    // cost
+    size += (N + 1) * sizeof(void *);
+    for (int ii = 0; ii <= N; ii++)
+    {
+        size += cost[ii]->opts_calculate_size(cost[ii], dims->nlp_dims->cost[ii]);
+    }
+
+    // constraints
+    size += (N + 1) * sizeof(void *);
+    for (int ii = 0; ii <= N; ii++)
+    {
+        size += constraints[ii]->opts_calculate_size(constraints[ii],
+                                                     dims->nlp_dims->constraints[ii]);
+    }
+
+    size += 8;  // align
+
+    return size;
+}
+
+
+
+void *ocp_nlp_sqp_tree_opts_assign(void *config_, void *dims_, void *raw_memory)
+{
+    ocp_nlp_tree_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+
+    ocp_nlp_dynamics_config **dynamics = config->dynamics;
+    ocp_nlp_cost_config **cost = config->cost;
+    ocp_nlp_constraints_config **constraints = config->constraints;
+
+    int N = dims->nlp_dims->N;
+
+    char *c_ptr = (char *) raw_memory;
+
+    ocp_nlp_sqp_tree_opts *opts = (ocp_nlp_sqp_tree_opts *) c_ptr;
+    c_ptr += sizeof(ocp_nlp_sqp_tree_opts);
+
+    // qp solver
+    opts->qp_solver_opts = (struct d_tree_ocp_qp_ipm_arg *) c_ptr;
+    c_ptr += sizeof(struct d_tree_ocp_qp_ipm_arg);
+
+    align_char_to(8, &c_ptr);
+    d_tree_ocp_qp_ipm_arg_create(dims->qp_dims, opts->qp_solver_opts, c_ptr);
+    c_ptr += d_tree_ocp_qp_ipm_arg_memsize(dims->qp_dims);
+
+    // dynamics
+    opts->dynamics = (void **) c_ptr;
+    c_ptr += N * sizeof(void *);
+    for (int ii = 0; ii < N; ii++)
+    {
+        opts->dynamics[ii] = dynamics[ii]->opts_assign(dynamics[ii], dims->nlp_dims->dynamics[ii],
+                                                       c_ptr);
+        c_ptr += dynamics[ii]->opts_calculate_size(dynamics[ii], dims->nlp_dims->dynamics[ii]);
+    }
+
+    // cost
+    opts->cost = (void **) c_ptr;
+    c_ptr += (N + 1) * sizeof(void *);
+    for (int ii = 0; ii <= N; ii++)
+    {
+        opts->cost[ii] = cost[ii]->opts_assign(cost[ii], dims->nlp_dims->cost[ii], c_ptr);
+        c_ptr += cost[ii]->opts_calculate_size(cost[ii], dims->nlp_dims->cost[ii]);
+    }
+
+    // constraints
+    opts->constraints = (void **) c_ptr;
+    c_ptr += (N + 1) * sizeof(void *);
+    for (int ii = 0; ii <= N; ii++)
+    {
+        opts->constraints[ii] = constraints[ii]->opts_assign(constraints[ii],
+                                    dims->nlp_dims->constraints[ii], c_ptr);
+        c_ptr += constraints[ii]->opts_calculate_size(constraints[ii],
+                                                      dims->nlp_dims->constraints[ii]);
+    }
+
+    assert((char *) raw_memory + ocp_nlp_sqp_tree_opts_calculate_size(config, dims) >= c_ptr);
+
+    return opts;
+}
+
+
+
+void ocp_nlp_sqp_tree_opts_initialize_default(void *config_, void *dims_, void *opts_)
+{
+    ocp_nlp_tree_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+    ocp_nlp_sqp_tree_opts *opts = opts_;
+
+    ocp_nlp_dynamics_config **dynamics = config->dynamics;
+    ocp_nlp_cost_config **cost = config->cost;
+    ocp_nlp_constraints_config **constraints = config->constraints;
+
+    int ii;
+
+    int N = dims->nlp_dims->N;
+
+    // SQP opts
+
+    opts->max_iter = 20;
+    opts->tol_stat = 1e-8;
+    opts->tol_eq   = 1e-8;
+    opts->tol_ineq = 1e-8;
+    opts->tol_comp = 1e-8;
+
+#if defined(ACADOS_WITH_OPENMP)
+    opts->num_threads = ACADOS_NUM_THREADS;
+#else
+    opts->num_threads = 1;
+#endif
+
+    opts->step_length = 1.0;
+
+    // submodules opts
+
+    // qp solver, same defaults as ocp_qp_hpipm
+    d_tree_ocp_qp_ipm_arg_set_default(BALANCE, opts->qp_solver_opts);
+    opts->qp_solver_opts->res_g_max = 1e-6;
+    opts->qp_solver_opts->res_b_max = 1e-8;
+    opts->qp_solver_opts->res_d_max = 1e-8;
+    opts->qp_solver_opts->res_m_max = 1e-8;
+    opts->qp_solver_opts->iter_max = 50;
+    opts->qp_solver_opts->stat_max = 50;
+    opts->qp_solver_opts->alpha_min = 1e-8;
+    opts->qp_solver_opts->mu0 = 1e0;
+
+    // dynamics
+    for (ii = 0; ii < N; ii++)
+    {
+        dynamics[ii]->opts_initialize_default(dynamics[ii], dims->nlp_dims->dynamics[ii],
+                                              opts->dynamics[ii]);
+    }
+
+    // cost
+    for (ii = 0; ii <= N; ii++)
+    {
+        cost[ii]->opts_initialize_default(cost[ii], dims->nlp_dims->cost[ii], opts->cost[ii]);
+    }
+
+    // constraints
+    for (ii = 0; ii <= N; ii++)
+    {
+        constraints[ii]->opts_initialize_default(constraints[ii], dims->nlp_dims->constraints[ii],
+                                                 opts->constraints[ii]);
+    }
+
+    return;
+}
+
+
+
+void ocp_nlp_sqp_tree_opts_update(void *config_, void *dims_, void *opts_)
+{
+    ocp_nlp_tree_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+    ocp_nlp_sqp_tree_opts *opts = opts_;
+
+    ocp_nlp_dynamics_config **dynamics = config->dynamics;
+    ocp_nlp_cost_config **cost = config->cost;
+    ocp_nlp_constraints_config **constraints = config->constraints;
+
+    int ii;
+
+    int N = dims->nlp_dims->N;
+
+    // dynamics
+    for (ii = 0; ii < N; ii++)
+    {
+        dynamics[ii]->opts_update(dynamics[ii], dims->nlp_dims->dynamics[ii], opts->dynamics[ii]);
+    }
+
+    // cost
+    for (ii = 0; ii <= N; ii++)
+    {
+        cost[ii]->opts_update(cost[ii], dims->nlp_dims->cost[ii], opts->cost[ii]);
+    }
+
+    // constraints
+    for (ii = 0; ii <= N; ii++)
+    {
+        constraints[ii]->opts_update(constraints[ii], dims->nlp_dims->constraints[ii],
+                                     opts->constraints[ii]);
+    }
+
+    return;
+}
+
+
+
+void ocp_nlp_sqp_tree_opts_set(void *config_, void *opts_, const char *field, void *value)
+{
+    ocp_nlp_sqp_tree_opts *opts = (ocp_nlp_sqp_tree_opts *) opts_;
+    ocp_nlp_config *config = config_;
+
+    int ii;
+
+    if (!strcmp(field, "max_iter"))
+    {
+        int *max_iter = (int *) value;
+        opts->max_iter = *max_iter;
+    }
+    else if (!strcmp(field, "num_threads"))
+    {
+        int *num_threads = (int *) value;
+        opts->num_threads = *num_threads;
+    }
+    else if (!strcmp(field, "tol_stat"))
+    {
+        double *tol_stat = (double *) value;
+        opts->tol_stat = *tol_stat;
+        opts->qp_solver_opts->res_g_max = *tol_stat;
+    }
+    else if (!strcmp(field, "tol_eq"))
+    {
+        double *tol_eq = (double *) value;
+        opts->tol_eq = *tol_eq;
+        opts->qp_solver_opts->res_b_max = *tol_eq;
+    }
+    else if (!strcmp(field, "tol_ineq"))
+    {
+        double *tol_ineq = (double *) value;
+        opts->tol_ineq = *tol_ineq;
+        opts->qp_solver_opts->res_d_max = *tol_ineq;
+    }
+    else if (!strcmp(field, "tol_comp"))
+    {
+        double *tol_comp = (double *) value;
+        opts->tol_comp = *tol_comp;
+        opts->qp_solver_opts->res_m_max = *tol_comp;
+    }
+    else if (!strcmp(field, "step_length"))
+    {
+        double *step_length = (double *) value;
+        opts->step_length = *step_length;
+    }
+    else if (!strcmp(field, "exact_hess"))
+    {
+        int N = config->N;
+        // cost
+        for (ii = 0; ii <= N; ii++)
+            config->cost[ii]->opts_set(config->cost[ii], opts->cost[ii], "exact_hess", value);
+        // dynamics
+        for (ii = 0; ii < N; ii++)
+            config->dynamics[ii]->opts_set(config->dynamics[ii], opts->dynamics[ii],
+                                           "compute_hess", value);
+    }
+    else if (!strcmp(field, "qp_iter_max"))
+    {
+        int *iter_max = (int *) value;
+        opts->qp_solver_opts->iter_max = *iter_max;
+    }
+    else if (!strcmp(field, "qp_mu0"))
+    {
+        double *mu0 = (double *) value;
+        opts->qp_solver_opts->mu0 = *mu0;
+    }
+    else
+    {
+        printf("\nerror: ocp_nlp_sqp_tree_opts_set: wrong field: %s\n", field);
+        exit(1);
+    }
+
+    return;
+}
+
+
+
+void ocp_nlp_sqp_tree_dynamics_opts_set(void *config_, void *opts_, int edge,
+        const char *field, void *value)
+{
+    ocp_nlp_config *config = config_;
+    ocp_nlp_sqp_tree_opts *opts = opts_;
+    ocp_nlp_dynamics_config *dyn_config = config->dynamics[edge];
+
+    dyn_config->opts_set(dyn_config, opts->dynamics[edge], field, value);
+
+    return;
+}
+
+
+
+void ocp_nlp_sqp_tree_cost_opts_set(void *config_, void *opts_, int node,
+        const char *field, void *value)
+{
+    ocp_nlp_config *config = config_;
+    ocp_nlp_sqp_tree_opts *opts = opts_;
+    ocp_nlp_cost_config *cost_config = config->cost[node];
+
+    cost_config->opts_set(cost_config, opts->cost[node], field, value);
+
+    return;
+}
+
+
+
+void ocp_nlp_sqp_tree_constraints_opts_set(void *config_, void *opts_, int node,
+        const char *field, void *value)
+{
+    ocp_nlp_config *config = config_;
+    ocp_nlp_sqp_tree_opts *opts = opts_;
+    ocp_nlp_constraints_config *constraints_config = config->constraints[node];
+
+    constraints_config->opts_set(constraints_config, opts->constraints[node], (char *) field, value);
+
+    return;
+}
+
+
+
+/************************************************
+ * memory
+ ************************************************/
+
+int ocp_nlp_sqp_tree_memory_calculate_size(void *config_, void *dims_, void *opts_)
+{
+    ocp_nlp_tree_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+    ocp_nlp_sqp_tree_opts *opts = opts_;
+
+    ocp_nlp_dynamics_config **dynamics = config->dynamics;
+    ocp_nlp_cost_config **cost = config->cost;
+    ocp_nlp_constraints_config **constraints = config->constraints;
+
+    ocp_nlp_dims *nlp_dims = dims->nlp_dims;
+
+    int ii;
+
+    // extract dims
+    int N = nlp_dims->N;
+    int *nx = nlp_dims->nx;
+    int *nu = nlp_dims->nu;
+    int *nz = nlp_dims->nz;
+
+    int size = 0;
+
+    size += sizeof(ocp_nlp_sqp_tree_memory);
+
+    // tree qp in
+    size += sizeof(struct d_tree_ocp_qp);
+    size += d_tree_ocp_qp_memsize(dims->qp_dims);
+
+    // tree qp out
+    size += sizeof(struct d_tree_ocp_qp_sol);
+    size += d_tree_ocp_qp_sol_memsize(dims->qp_dims);
+
+    // qp solver
+    size += sizeof(struct d_tree_ocp_qp_ipm_ws);
+    size += d_tree_ocp_qp_ipm_ws_memsize(dims->qp_dims, opts->qp_solver_opts);
+
+    // dynamics
+    size += N * sizeof(void *);
+    for (ii = 0; ii < N; ii++)
+    {
+        size += dynamics[ii]->memory_calculate_size(dynamics[ii], nlp_dims->dynamics[ii],
+                                                    opts->dynamics[ii]);
+    }
+
+    // cost
+    size += (N + 1) * sizeof(void *);
+    for (ii = 0; ii <= N; ii++)
+    {
+        size += cost[ii]->memory_calculate_size(cost[ii], nlp_dims->cost[ii], opts->cost[ii]);
+    }
+
+    // constraints
+    size += (N + 1) * sizeof(void *);
+    for (ii = 0; ii <= N; ii++)
+    {
+        size += constraints[ii]->memory_calculate_size(constraints[ii], nlp_dims->constraints[ii],
+                                                       opts->constraints[ii]);
+    }
+
+    // nlp res
+    size += ocp_nlp_res_calculate_size(nlp_dims);
+
+    // nlp mem
+    size += ocp_nlp_memory_calculate_size(config, nlp_dims);
+
+    // stat
+    int stat_m = opts->max_iter+1;
+    int stat_n = 6;
+    size += stat_n*stat_m*sizeof(double);
+
+    // dzduxt
+    size += (N+1)*sizeof(struct blasfeo_dmat);
+    for (ii = 0; ii <= N; ii++)
+        size += blasfeo_memsize_dmat(nu[ii]+nx[ii], nz[ii]);
+    // z_alg
+    size += (N+1)*sizeof(struct blasfeo_dvec);
+    for (ii = 0; ii <= N; ii++)
+        size += blasfeo_memsize_dvec(nz[ii]);
+
+    size += 3*8;  // aligns
+    size += 1*64;  // blasfeo_mem align
+
+    return size;
+}
+
+
+
+void *ocp_nlp_sqp_tree_memory_assign(void *config_, void *dims_, void *opts_, void *raw_memory)
+{
+    ocp_nlp_tree_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+    ocp_nlp_sqp_tree_opts *opts = opts_;
+
+    ocp_nlp_dynamics_config **dynamics = config->dynamics;
+    ocp_nlp_cost_config **cost = config->cost;
+    ocp_nlp_constraints_config **constraints = config->constraints;
+
+    ocp_nlp_dims *nlp_dims = dims->nlp_dims;
+
+    char *c_ptr = (char *) raw_memory;
+
+    // extract dims
+    int N = nlp_dims->N;
+    int *nx = nlp_dims->nx;
+    int *nu = nlp_dims->nu;
+    int *nz = nlp_dims->nz;
+
+    // initial align
+    align_char_to(8, &c_ptr);
+
+    ocp_nlp_sqp_tree_memory *mem = (ocp_nlp_sqp_tree_memory *) c_ptr;
+    c_ptr += sizeof(ocp_nlp_sqp_tree_memory);
+
+    // tree qp structs
+    mem->qp_in = (struct d_tree_ocp_qp *) c_ptr;
+    c_ptr += sizeof(struct d_tree_ocp_qp);
+    mem->qp_out = (struct d_tree_ocp_qp_sol *) c_ptr;
+    c_ptr += sizeof(struct d_tree_ocp_qp_sol);
+    mem->qp_solver_mem = (struct d_tree_ocp_qp_ipm_ws *) c_ptr;
+    c_ptr += sizeof(struct d_tree_ocp_qp_ipm_ws);
+
+    align_char_to(8, &c_ptr);
+
+    // tree qp in
+    d_tree_ocp_qp_create(dims->qp_dims, mem->qp_in, c_ptr);
+    c_ptr += mem->qp_in->memsize;
+
+    // tree qp out
+    d_tree_ocp_qp_sol_create(dims->qp_dims, mem->qp_out, c_ptr);
+    c_ptr += mem->qp_out->memsize;
+
+    // qp solver
+    d_tree_ocp_qp_ipm_ws_create(dims->qp_dims, opts->qp_solver_opts, mem->qp_solver_mem, c_ptr);
+    c_ptr += mem->qp_solver_mem->memsize;
+
+    // nlp res
+    mem->nlp_res = ocp_nlp_res_assign(nlp_dims, c_ptr);
+    c_ptr += mem->nlp_res->memsize;
+
+    // nlp mem
+    mem->nlp_mem = ocp_nlp_memory_assign(config, nlp_dims, c_ptr);
+    c_ptr += ocp_nlp_memory_calculate_size(config, nlp_dims);
+
+    // dynamics
+    mem->dynamics = (void **) c_ptr;
+    c_ptr += N * sizeof(void *);
+    for (int ii = 0; ii < N; ii++)
+    {
+        mem->dynamics[ii] = dynamics[ii]->memory_assign(dynamics[ii], nlp_dims->dynamics[ii],
+                                                        opts->dynamics[ii], c_ptr);
+        c_ptr += dynamics[ii]->memory_calculate_size(dynamics[ii], nlp_dims->dynamics[ii],
+                                                     opts->dynamics[ii]);
+    }
+
+    // cost
+    mem->cost = (void **) c_ptr;
+    c_ptr += (N + 1) * sizeof(void *);
+    for (int ii = 0; ii <= N; ii++)
+    {
+        mem->cost[ii] = cost[ii]->memory_assign(cost[ii], nlp_dims->cost[ii], opts->cost[ii], c_ptr);
+        c_ptr += cost[ii]->memory_calculate_size(cost[ii], nlp_dims->cost[ii], opts->cost[ii]);
+    }
+
+    // constraints
+    mem->constraints = (void **) c_ptr;
+    c_ptr += (N + 1) * sizeof(void *);
+    for (int ii = 0; ii <= N; ii++)
+    {
+        mem->constraints[ii] = constraints[ii]->memory_assign(constraints[ii],
+                                   nlp_dims->constraints[ii], opts->constraints[ii], c_ptr);
+        c_ptr += constraints[ii]->memory_calculate_size(constraints[ii], nlp_dims->constraints[ii],
+                                                        opts->constraints[ii]);
+    }
+
+    // stat
+    mem->stat = (double *) c_ptr;
+    mem->stat_m = opts->max_iter+1;
+    mem->stat_n = 6;
+    c_ptr += mem->stat_m*mem->stat_n*sizeof(double);
+
+    // blasfeo_str align
+    align_char_to(8, &c_ptr);
+
+    // dzduxt
+    mem->dzduxt = (struct blasfeo_dmat *) c_ptr;
+    c_ptr += (N+1)*sizeof(struct blasfeo_dmat);
+    // z_alg
+    mem->z_alg = (struct blasfeo_dvec *) c_ptr;
+    c_ptr += (N+1)*sizeof(struct blasfeo_dvec);
+
+    // blasfeo_mem align
+    align_char_to(64, &c_ptr);
+
+    // dzduxt
+    for (int ii = 0; ii <= N; ii++)
+    {
+        blasfeo_create_dmat(nu[ii]+nx[ii], nz[ii], mem->dzduxt+ii, c_ptr);
+        c_ptr += blasfeo_memsize_dmat(nu[ii]+nx[ii], nz[ii]);
+    }
+    // z_alg
+    for (int ii = 0; ii <= N; ii++)
+    {
+        blasfeo_create_dvec(nz[ii], mem->z_alg+ii, c_ptr);
+        c_ptr += blasfeo_memsize_dvec(nz[ii]);
+    }
+
+    mem->status = ACADOS_READY;
+
+    assert((char *) raw_memory + ocp_nlp_sqp_tree_memory_calculate_size(config, dims, opts) >= c_ptr);
+
+    return mem;
+}
+
+
+
+/************************************************
+ * workspace
+ ************************************************/
+
+int ocp_nlp_sqp_tree_workspace_calculate_size(void *config_, void *dims_, void *opts_)
+{
+    ocp_nlp_tree_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+    ocp_nlp_sqp_tree_opts *opts = opts_;
+
+    ocp_nlp_dynamics_config **dynamics = config->dynamics;
+    ocp_nlp_cost_config **cost = config->cost;
+    ocp_nlp_constraints_config **constraints = config->constraints;
+
+    ocp_nlp_dims *nlp_dims = dims->nlp_dims;
+
+    int ii;
+
+    int N = nlp_dims->N;
+
+    int size = 0;
+
+    size += sizeof(ocp_nlp_sqp_tree_work);
+
+    // array of pointers
+    size += N * sizeof(void *);        // dynamics
+    size += (N + 1) * sizeof(void *);  // cost
+    size += (N + 1) * sizeof(void *);  // constraints
+
+    // the nodes are linearized in parallel, no workspace reuse
+
+    // dynamics
+    for (ii = 0; ii < N; ii++)
+    {
+        size += dynamics[ii]->workspace_calculate_size(dynamics[ii], nlp_dims->dynamics[ii],
+                                                       opts->dynamics[ii]);
+    }
+
+    // cost
+    for (ii = 0; ii <= N; ii++)
+    {
+        size += cost[ii]->workspace_calculate_size(cost[ii], nlp_dims->cost[ii], opts->cost[ii]);
+    }
+
+    // constraints
+    for (ii = 0; ii <= N; ii++)
+    {
+        size += constraints[ii]->workspace_calculate_size(constraints[ii],
+                                                          nlp_dims->constraints[ii],
+                                                          opts->constraints[ii]);
+    }
+
+    return size;
+}
+
+
+
+static void ocp_nlp_sqp_tree_cast_workspace(ocp_nlp_config *config, ocp_nlp_tree_dims *dims,
+                                            ocp_nlp_sqp_tree_work *work,
+                                            ocp_nlp_sqp_tree_opts *opts)
+{
+    ocp_nlp_dynamics_config **dynamics = config->dynamics;
+    ocp_nlp_cost_config **cost = config->cost;
+    ocp_nlp_constraints_config **constraints = config->constraints;
+
+    ocp_nlp_dims *nlp_dims = dims->nlp_dims;
+
+    int N = nlp_dims->N;
+
+    char *c_ptr = (char *) work;
+    c_ptr += sizeof(ocp_nlp_sqp_tree_work);
+
+    // array of pointers
+    work->dynamics = (void **) c_ptr;
+    c_ptr += N * sizeof(void *);
+    work->cost = (void **) c_ptr;
+    c_ptr += (N + 1) * sizeof(void *);
+    work->constraints = (void **) c_ptr;
+    c_ptr += (N + 1) * sizeof(void *);
+
+    // dynamics
+    for (int ii = 0; ii < N; ii++)
+    {
+        work->dynamics[ii] = c_ptr;
+        c_ptr += dynamics[ii]->workspace_calculate_size(dynamics[ii], nlp_dims->dynamics[ii],
+                                                        opts->dynamics[ii]);
+    }
+
+    // cost
+    for (int ii = 0; ii <= N; ii++)
+    {
+        work->cost[ii] = c_ptr;
+        c_ptr += cost[ii]->workspace_calculate_size(cost[ii], nlp_dims->cost[ii], opts->cost[ii]);
+    }
+
+    // constraints
+    for (int ii = 0; ii <= N; ii++)
+    {
+        work->constraints[ii] = c_ptr;
+        c_ptr += constraints[ii]->workspace_calculate_size(constraints[ii],
+                                                           nlp_dims->constraints[ii],
+                                                           opts->constraints[ii]);
+    }
+
+    assert((char *) work + ocp_nlp_sqp_tree_workspace_calculate_size(config, dims, opts) >= c_ptr);
+
+    return;
+}
+
+
+
+/************************************************
+ * functions
+ ************************************************/
+
+// set the pointers of the stage modules into the tree qp and the nlp iterate
+static void tree_alias_memory(ocp_nlp_config *config, ocp_nlp_tree_dims *dims, ocp_nlp_in *nlp_in,
+                              ocp_nlp_out *nlp_out, ocp_nlp_sqp_tree_memory *mem)
+{
+    ocp_nlp_dims *nlp_dims = dims->nlp_dims;
+
+    int N = nlp_dims->N;
+
+    int ii, dad;
+
+    // dynamics: edge ii from the parent of node ii+1 to node ii+1
+    for (ii = 0; ii < N; ii++)
+    {
+        dad = ocp_nlp_tree_dims_get_parent(dims, ii+1);
+        config->dynamics[ii]->memory_set_ux_ptr(nlp_out->ux+dad, mem->dynamics[ii]);
+        config->dynamics[ii]->memory_set_ux1_ptr(nlp_out->ux+ii+1, mem->dynamics[ii]);
+        config->dynamics[ii]->memory_set_pi_ptr(nlp_out->pi+ii, mem->dynamics[ii]);
+        config->dynamics[ii]->memory_set_BAbt_ptr(mem->qp_in->BAbt+ii, mem->dynamics[ii]);
+        config->dynamics[ii]->memory_set_RSQrq_ptr(mem->qp_in->RSQrq+dad, mem->dynamics[ii]);
+        config->dynamics[ii]->memory_set_dzduxt_ptr(mem->dzduxt+dad, mem->dynamics[ii]);
+        // sibling edges share the parent node, no integrator guess on trees
+        config->dynamics[ii]->memory_set_sim_guess_ptr(NULL, NULL, mem->dynamics[ii]);
+        config->dynamics[ii]->memory_set_z_alg_ptr(mem->z_alg+dad, mem->dynamics[ii]);
+        config->dynamics[ii]->model_set(config->dynamics[ii], nlp_dims->dynamics[ii],
+                                        nlp_in->dynamics[ii], "T", nlp_in->Ts+ii);
+    }
+
+    // cost
+    for (ii = 0; ii <= N; ii++)
+    {
+        config->cost[ii]->memory_set_ux_ptr(nlp_out->ux+ii, mem->cost[ii]);
+        config->cost[ii]->memory_set_z_alg_ptr(mem->z_alg+ii, mem->cost[ii]);
+        config->cost[ii]->memory_set_dzdux_tran_ptr(mem->dzduxt+ii, mem->cost[ii]);
+        config->cost[ii]->memory_set_RSQrq_ptr(mem->qp_in->RSQrq+ii, mem->cost[ii]);
+        config->cost[ii]->memory_set_Z_ptr(mem->qp_in->Z+ii, mem->cost[ii]);
+    }
+
+    // constraints
+    for (ii = 0; ii <= N; ii++)
+    {
+        config->constraints[ii]->memory_set_ux_ptr(nlp_out->ux+ii, mem->constraints[ii]);
+        config->constraints[ii]->memory_set_z_alg_ptr(mem->z_alg+ii, mem->constraints[ii]);
+        config->constraints[ii]->memory_set_dzdux_tran_ptr(mem->dzduxt+ii, mem->constraints[ii]);
+        config->constraints[ii]->memory_set_lam_ptr(nlp_out->lam+ii, mem->constraints[ii]);
+        config->constraints[ii]->memory_set_DCt_ptr(mem->qp_in->DCt+ii, mem->constraints[ii]);
+        config->constraints[ii]->memory_set_RSQrq_ptr(mem->qp_in->RSQrq+ii, mem->constraints[ii]);
+        config->constraints[ii]->memory_set_idxb_ptr(mem->qp_in->idxb[ii], mem->constraints[ii]);
+        config->constraints[ii]->memory_set_idxs_ptr(mem->qp_in->idxs[ii], mem->constraints[ii]);
+    }
+
+    return;
+}
+
+
+
+static void tree_initialize_qp(ocp_nlp_config *config, ocp_nlp_tree_dims *dims, ocp_nlp_in *nlp_in,
+                               ocp_nlp_sqp_tree_opts *opts, ocp_nlp_sqp_tree_memory *mem,
+                               ocp_nlp_sqp_tree_work *work)
+{
+    ocp_nlp_dims *nlp_dims = dims->nlp_dims;
+
+    int N = nlp_dims->N;
+
+    int ii;
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for num_threads(opts->num_threads)
+#endif
+    for (ii = 0; ii <= N; ii++)
+    {
+        // cost
+        config->cost[ii]->initialize(config->cost[ii], nlp_dims->cost[ii], nlp_in->cost[ii],
+                                     opts->cost[ii], mem->cost[ii], work->cost[ii]);
+        // dynamics
+        if (ii < N)
+            config->dynamics[ii]->initialize(config->dynamics[ii], nlp_dims->dynamics[ii],
+                                             nlp_in->dynamics[ii], opts->dynamics[ii],
+                                             mem->dynamics[ii], work->dynamics[ii]);
+        // constraints
+        config->constraints[ii]->initialize(config->constraints[ii], nlp_dims->constraints[ii],
+                                            nlp_in->constraints[ii], opts->constraints[ii],
+                                            mem->constraints[ii], work->constraints[ii]);
+    }
+
+    return;
+}
+
+
+
+// linearize node-wise: each node evaluates its cost and constraints and the dynamics of the edges
+// to its kids, which all contribute to its own Hessian block
+static void tree_linearize_update_qp(ocp_nlp_config *config, ocp_nlp_tree_dims *dims,
+                                     ocp_nlp_in *nlp_in, ocp_nlp_sqp_tree_opts *opts,
+                                     ocp_nlp_sqp_tree_memory *mem, ocp_nlp_sqp_tree_work *work)
+{
+    ocp_nlp_dims *nlp_dims = dims->nlp_dims;
+    ocp_nlp_memory *nlp_mem = mem->nlp_mem;
+    struct node *root = dims->ttree->root;
+
+    int N = nlp_dims->N;
+    int *nv = nlp_dims->nv;
+    int *nx = nlp_dims->nx;
+    int *nu = nlp_dims->nu;
+    int *ni = nlp_dims->ni;
+
+    int i;
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for num_threads(opts->num_threads)
+#endif
+    for (i = 0; i <= N; i++)
+    {
+        int jj, edge;
+
+        // init Hessian to 0
+        blasfeo_dgese(nu[i] + nx[i], nu[i] + nx[i], 0.0, mem->qp_in->RSQrq+i, 0, 0);
+
+        // dynamics of the edges to the kids
+        for (jj = 0; jj < root[i].nkids; jj++)
+        {
+            edge = root[i].kids[jj] - 1;
+            config->dynamics[edge]->update_qp_matrices(config->dynamics[edge],
+                    nlp_dims->dynamics[edge], nlp_in->dynamics[edge], opts->dynamics[edge],
+                    mem->dynamics[edge], work->dynamics[edge]);
+        }
+
+        // cost
+        config->cost[i]->update_qp_matrices(config->cost[i], nlp_dims->cost[i], nlp_in->cost[i],
+                opts->cost[i], mem->cost[i], work->cost[i]);
+
+        // constraints
+        config->constraints[i]->update_qp_matrices(config->constraints[i],
+                nlp_dims->constraints[i], nlp_in->constraints[i], opts->constraints[i],
+                mem->constraints[i], work->constraints[i]);
+    }
+
+    /* collect node-wise evaluations */
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for num_threads(opts->num_threads)
+#endif
+    for (i = 0; i <= N; i++)
+    {
+        int jj, edge, dad;
+        struct blasfeo_dvec *dyn_adj;
+
+        // nlp mem: cost_grad
+        struct blasfeo_dvec *cost_grad = config->cost[i]->memory_get_grad_ptr(mem->cost[i]);
+        blasfeo_dveccp(nv[i], cost_grad, 0, nlp_mem->cost_grad + i, 0);
+
+        // nlp mem: dyn_fun and dyn_adj of the edges to the kids
+        blasfeo_dvecse(nu[i] + nx[i], 0.0, nlp_mem->dyn_adj + i, 0);
+        for (jj = 0; jj < root[i].nkids; jj++)
+        {
+            edge = root[i].kids[jj] - 1;
+            struct blasfeo_dvec *dyn_fun =
+                config->dynamics[edge]->memory_get_fun_ptr(mem->dynamics[edge]);
+            blasfeo_dveccp(nx[edge + 1], dyn_fun, 0, nlp_mem->dyn_fun + edge, 0);
+
+            dyn_adj = config->dynamics[edge]->memory_get_adj_ptr(mem->dynamics[edge]);
+            blasfeo_daxpy(nu[i] + nx[i], 1.0, dyn_adj, 0, nlp_mem->dyn_adj + i, 0,
+                          nlp_mem->dyn_adj + i, 0);
+        }
+
+        // nlp mem: dyn_adj of the edge from the parent
+        if (i > 0)
+        {
+            edge = i - 1;
+            dad = root[i].dad;
+            dyn_adj = config->dynamics[edge]->memory_get_adj_ptr(mem->dynamics[edge]);
+            blasfeo_daxpy(nx[i], 1.0, dyn_adj, nu[dad] + nx[dad], nlp_mem->dyn_adj + i, nu[i],
+                          nlp_mem->dyn_adj + i, nu[i]);
+        }
+
+        // nlp mem: ineq_fun
+        struct blasfeo_dvec *ineq_fun =
+            config->constraints[i]->memory_get_fun_ptr(mem->constraints[i]);
+        blasfeo_dveccp(2 * ni[i], ineq_fun, 0, nlp_mem->ineq_fun + i, 0);
+
+        // nlp mem: ineq_adj
+        struct blasfeo_dvec *ineq_adj =
+            config->constraints[i]->memory_get_adj_ptr(mem->constraints[i]);
+        blasfeo_dveccp(nv[i], ineq_adj, 0, nlp_mem->ineq_adj + i, 0);
+    }
+
+    return;
+}
+
+
+
+// update QP rhs for SQP (step prim var, abs dual var)
+static void tree_update_qp_vectors(ocp_nlp_tree_dims *dims, ocp_nlp_sqp_tree_memory *mem)
+{
+    ocp_nlp_dims *nlp_dims = dims->nlp_dims;
+    ocp_nlp_memory *nlp_mem = mem->nlp_mem;
+
+    int N = nlp_dims->N;
+    int *nv = nlp_dims->nv;
+    int *nx = nlp_dims->nx;
+    int *ni = nlp_dims->ni;
+
+    for (int i = 0; i <= N; i++)
+    {
+        // g
+        blasfeo_dveccp(nv[i], nlp_mem->cost_grad + i, 0, mem->qp_in->rqz + i, 0);
+
+        // b, of the edge into node i+1
+        if (i < N)
+            blasfeo_dveccp(nx[i + 1], nlp_mem->dyn_fun + i, 0, mem->qp_in->b + i, 0);
+
+        // d
+        blasfeo_dveccp(2 * ni[i], nlp_mem->ineq_fun + i, 0, mem->qp_in->d + i, 0);
+    }
+
+    return;
+}
+
+
+
+static void tree_update_variables(ocp_nlp_tree_dims *dims, ocp_nlp_out *nlp_out,
+                                  ocp_nlp_sqp_tree_opts *opts, ocp_nlp_sqp_tree_memory *mem)
+{
+    ocp_nlp_dims *nlp_dims = dims->nlp_dims;
+    struct node *root = dims->ttree->root;
+
+    int N = nlp_dims->N;
+    int *nv = nlp_dims->nv;
+    int *nx = nlp_dims->nx;
+    int *nu = nlp_dims->nu;
+    int *ni = nlp_dims->ni;
+    int *nz = nlp_dims->nz;
+
+    double alpha = opts->step_length;
+
+    for (int i = 0; i <= N; i++)
+    {
+        // (full) step in primal variables
+        blasfeo_daxpy(nv[i], alpha, mem->qp_out->ux + i, 0, nlp_out->ux + i, 0, nlp_out->ux + i, 0);
+
+        // absolute in dual variables
+        if (i < N)
+        {
+            blasfeo_dvecsc(nx[i+1], 1.0-alpha, nlp_out->pi+i, 0);
+            blasfeo_daxpy(nx[i+1], alpha, mem->qp_out->pi+i, 0, nlp_out->pi+i, 0, nlp_out->pi+i, 0);
+        }
+
+        blasfeo_dvecsc(2*ni[i], 1.0-alpha, nlp_out->lam+i, 0);
+        blasfeo_daxpy(2*ni[i], alpha, mem->qp_out->lam+i, 0, nlp_out->lam+i, 0, nlp_out->lam+i, 0);
+
+        blasfeo_dvecsc(2*ni[i], 1.0-alpha, nlp_out->t+i, 0);
+        blasfeo_daxpy(2*ni[i], alpha, mem->qp_out->t+i, 0, nlp_out->t+i, 0, nlp_out->t+i, 0);
+
+        // linear update of algebraic variables, computed by the dynamics of the outgoing edges
+        if (root[i].nkids > 0)
+        {
+            blasfeo_dgemv_t(nu[i]+nx[i], nz[i], 1.0, mem->dzduxt+i, 0, 0, nlp_out->ux+i, 0, 1.0,
+                            mem->z_alg+i, 0, nlp_out->z+i, 0);
+        }
+    }
+
+    return;
+}
+
+
+
+// fixed-step SQP on a scenario tree, the QPs are solved by the tree-structured Riccati IPM of hpipm
+int ocp_nlp_sqp_tree(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
+                     void *opts_, void *mem_, void *work_)
+{
+    // acados timer
+    acados_timer timer0, timer1;
+
+    // start timer
+    acados_tic(&timer0);
+
+    ocp_nlp_tree_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+    ocp_nlp_sqp_tree_opts *opts = opts_;
+    ocp_nlp_sqp_tree_memory *mem = mem_;
+    ocp_nlp_in *nlp_in = nlp_in_;
+    ocp_nlp_out *nlp_out = nlp_out_;
+    ocp_nlp_sqp_tree_work *work = work_;
+
+    ocp_nlp_dims *nlp_dims = dims->nlp_dims;
+
+    ocp_nlp_sqp_tree_cast_workspace(config, dims, work, opts);
+
+    // zero timers
+    double total_time = 0.0;
+    mem->time_qp_sol = 0.0;
+    mem->time_lin = 0.0;
+    mem->time_tot = 0.0;
+
+    int qp_iter = 0;
+    int qp_status = 0;
+
+    tree_alias_memory(config, dims, nlp_in, nlp_out, mem);
+
+    // initialize QP
+    tree_initialize_qp(config, dims, nlp_in, opts, mem, work);
+
+    // main sqp loop
+    int sqp_iter = 0;
+    for (; sqp_iter < opts->max_iter; sqp_iter++)
+    {
+        // linearize NLP and update QP matrices
+        acados_tic(&timer1);
+        tree_linearize_update_qp(config, dims, nlp_in, opts, mem, work);
+        mem->time_lin += acados_toc(&timer1);
+
+        // update QP rhs for SQP (step prim var, abs dual var)
+        tree_update_qp_vectors(dims, mem);
+
+        // compute nlp residuals
+        ocp_nlp_res_compute(nlp_dims, nlp_in, nlp_out, mem->nlp_res, mem->nlp_mem);
+
+        nlp_out->inf_norm_res = mem->nlp_res->inf_norm_res_g;
+        nlp_out->inf_norm_res = (mem->nlp_res->inf_norm_res_b > nlp_out->inf_norm_res) ?
+                                    mem->nlp_res->inf_norm_res_b :
+                                    nlp_out->inf_norm_res;
+        nlp_out->inf_norm_res = (mem->nlp_res->inf_norm_res_d > nlp_out->inf_norm_res) ?
+                                    mem->nlp_res->inf_norm_res_d :
+                                    nlp_out->inf_norm_res;
+        nlp_out->inf_norm_res = (mem->nlp_res->inf_norm_res_m > nlp_out->inf_norm_res) ?
+                                    mem->nlp_res->inf_norm_res_m :
+                                    nlp_out->inf_norm_res;
+
+        // save statistics
+        if (sqp_iter < mem->stat_m)
+        {
+            mem->stat[mem->stat_n*sqp_iter+0] = mem->nlp_res->inf_norm_res_g;
+            mem->stat[mem->stat_n*sqp_iter+1] = mem->nlp_res->inf_norm_res_b;
+            mem->stat[mem->stat_n*sqp_iter+2] = mem->nlp_res->inf_norm_res_d;
+            mem->stat[mem->stat_n*sqp_iter+3] = mem->nlp_res->inf_norm_res_m;
+            mem->stat[mem->stat_n*sqp_iter+4] = qp_status;
+            mem->stat[mem->stat_n*sqp_iter+5] = qp_iter;
+        }
+
+        // exit conditions on residuals
+        if ((mem->nlp_res->inf_norm_res_g < opts->tol_stat) &
+            (mem->nlp_res->inf_norm_res_b < opts->tol_eq) &
+            (mem->nlp_res->inf_norm_res_d < opts->tol_ineq) &
+            (mem->nlp_res->inf_norm_res_m < opts->tol_comp))
+        {
+            mem->status = ACADOS_SUCCESS;
+            break;
+        }
+
+        // solve tree QP
+        acados_tic(&timer1);
+        int hpipm_status;
+        d_tree_ocp_qp_ipm_solve(mem->qp_in, mem->qp_out, opts->qp_solver_opts, mem->qp_solver_mem);
+        d_tree_ocp_qp_ipm_get_status(mem->qp_solver_mem, &hpipm_status);
+        mem->time_qp_sol += acados_toc(&timer1);
+
+        qp_status = hpipm_status;
+        if (hpipm_status == 0) qp_status = ACADOS_SUCCESS;
+        if (hpipm_status == 1) qp_status = ACADOS_MAXITER;
+        if (hpipm_status == 2) qp_status = ACADOS_MINSTEP;
+
+        qp_iter = mem->qp_solver_mem->iter;
+        nlp_out->qp_iter = qp_iter;
+
+        if ((qp_status!=ACADOS_SUCCESS) & (qp_status!=ACADOS_MAXITER))
+        {
+            printf("QP solver returned error status %d in iteration %d\n", qp_status, sqp_iter);
+            mem->status = ACADOS_QP_FAILURE;
+            break;
+        }
+
+        tree_update_variables(dims, nlp_out, opts, mem);
+    }
+
+    if (sqp_iter == opts->max_iter)
+        mem->status = ACADOS_MAXITER;
+
+    // stop timer
+    total_time += acados_toc(&timer0);
+
+    // save sqp iterations number
+    mem->sqp_iter = sqp_iter;
+    nlp_out->sqp_iter = sqp_iter;
+
+    // save time
+    mem->time_tot = total_time;
+    nlp_out->total_time = total_time;
+
+    return mem->status;
+}
+
+
+
+int ocp_nlp_sqp_tree_precompute(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
+                                void *opts_, void *mem_, void *work_)
+{
+    ocp_nlp_tree_dims *dims = dims_;
+    ocp_nlp_config *config = config_;
+    ocp_nlp_sqp_tree_opts *opts = opts_;
+    ocp_nlp_sqp_tree_memory *mem = mem_;
+    ocp_nlp_in *nlp_in = nlp_in_;
+    ocp_nlp_sqp_tree_work *work = work_;
+
+    ocp_nlp_dims *nlp_dims = dims->nlp_dims;
+
+    ocp_nlp_sqp_tree_cast_workspace(config, dims, work, opts);
+
+    int N = nlp_dims->N;
+    int status = ACADOS_SUCCESS;
+
+    for (int ii = 0; ii < N; ii++)
+    {
+        // set T
+        config->dynamics[ii]->model_set(config->dynamics[ii], nlp_dims->dynamics[ii],
+                                        nlp_in->dynamics[ii], "T", nlp_in->Ts+ii);
+        // dynamics precompute
+        status = config->dynamics[ii]->precompute(config->dynamics[ii], nlp_dims->dynamics[ii],
+                                                  nlp_in->dynamics[ii], opts->dynamics[ii],
+                                                  mem->dynamics[ii], work->dynamics[ii]);
+        if (status != ACADOS_SUCCESS) return status;
+    }
+
+    return status;
+}
+
+
+
+void ocp_nlp_sqp_tree_get(void *config_, void *mem_, const char *field, void *return_value_)
+{
+    ocp_nlp_sqp_tree_memory *mem = mem_;
+
+    if (!strcmp("sqp_iter", field))
+    {
+        int *value = return_value_;
+        *value = mem->sqp_iter;
+    }
+    else if (!strcmp("status", field))
+    {
+        int *value = return_value_;
+        *value = mem->status;
+    }
+    else if (!strcmp("time_tot", field) || !strcmp("tot_time", field))
+    {
+        double *value = return_value_;
+        *value = mem->time_tot;
+    }
+    else if (!strcmp("time_qp_sol", field) || !strcmp("time_qp", field))
+    {
+        double *value = return_value_;
+        *value = mem->time_qp_sol;
+    }
+    else if (!strcmp("time_lin", field))
+    {
+        double *value = return_value_;
+        *value = mem->time_lin;
+    }
+    else if (!strcmp("nlp_res", field))
+    {
+        ocp_nlp_res **value = return_value_;
+        *value = mem->nlp_res;
+    }
+    else if (!strcmp("stat", field))
+    {
+        double **value = return_value_;
+        *value = mem->stat;
+    }
+    else if (!strcmp("stat_m", field))
+    {
+        int *value = return_value_;
+        *value = mem->stat_m;
+    }
+    else if (!strcmp("stat_n", field))
+    {
+        int *value = return_value_;
+        *value = mem->stat_n;
+    }
+    else if (!strcmp("nlp_mem", field))
+    {
+        void **value = return_value_;
+        *value = mem->nlp_mem;
+    }
+    else if (!strcmp("qp_in", field))
+    {
+        void **value = return_value_;
+        *value = mem->qp_in;
+    }
+    else if (!strcmp("qp_out", field))
+    {
+        void **value = return_value_;
+        *value = mem->qp_out;
+    }
+    else
+    {
+        printf("\nerror: field %s not available in ocp_nlp_sqp_tree_get\n", field);
+        exit(1);
+    }
+
+    return;
+}
+
+
+
+void ocp_nlp_sqp_tree_config_initialize_default(void *config_)
+{
+    ocp_nlp_config *config = (ocp_nlp_config *) config_;
+
+    config->opts_calculate_size = &ocp_nlp_sqp_tree_opts_calculate_size;
+    config->opts_assign = &ocp_nlp_sqp_tree_opts_assign;
+    config->opts_initialize_default = &ocp_nlp_sqp_tree_opts_initialize_default;
+    config->opts_update = &ocp_nlp_sqp_tree_opts_update;
+    config->opts_set = &ocp_nlp_sqp_tree_opts_set;
+    config->dynamics_opts_set = &ocp_nlp_sqp_tree_dynamics_opts_set;
+    config->cost_opts_set = &ocp_nlp_sqp_tree_cost_opts_set;
+    config->constraints_opts_set = &ocp_nlp_sqp_tree_constraints_opts_set;
+    config->memory_calculate_size = &ocp_nlp_sqp_tree_memory_calculate_size;
+    config->memory_assign = &ocp_nlp_sqp_tree_memory_assign;
+    config->workspace_calculate_size = &ocp_nlp_sqp_tree_workspace_calculate_size;
+    config->evaluate = &ocp_nlp_sqp_tree;
+    config->eval_param_sens = NULL;  // not available on trees
+    config->simulate_stage = NULL;
+    config->config_initialize_default = &ocp_nlp_sqp_tree_config_initialize_default;
+    config->precompute = &ocp_nlp_sqp_tree_precompute;
+    config->get = &ocp_nlp_sqp_tree_get;
+
+    return;
+}
@@ -0,0 +1,239 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+
+/// \addtogroup ocp_nlp
+/// @{
+/// \addtogroup ocp_nlp_solver
+/// @{
+/// \addtogroup ocp_nlp_sqp_tree ocp_nlp_sqp_tree
+/// @{
+
+#ifndef ACADOS_OCP_NLP_OCP_NLP_SQP_TREE_H_
+#define ACADOS_OCP_NLP_OCP_NLP_SQP_TREE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// hpipm
+#include "hpipm/include/hpipm_d_tree_ocp_qp.h"
+#include "hpipm/include/hpipm_d_tree_ocp_qp_dim.h"
+#include "hpipm/include/hpipm_d_tree_ocp_qp_ipm.h"
+#include "hpipm/include/hpipm_d_tree_ocp_qp_sol.h"
+#include "hpipm/include/hpipm_scenario_tree.h"
+#include "hpipm/include/hpipm_tree.h"
+// acados
+#include "acados/ocp_nlp/ocp_nlp_common.h"
+#include "acados/utils/types.h"
+
+
+
+/************************************************
+ * dims
+ ************************************************/
+
+// Multi-stage (scenario-tree) OCP: the nodes of the tree take the role of the stages,
+// i.e. the ocp_nlp_dims in nlp_dims have N = Nn-1, cost and constraints are indexed by node
+// and dynamics by edge, where edge ii connects node ii+1 to its parent.
+// The config has to be created with ocp_nlp_config_calculate_size(Nn-1).
+// ocp_nlp_in and ocp_nlp_out are created from nlp_dims, with pi[ii] the multiplier of edge ii.
+typedef struct
+{
+    ocp_nlp_dims *nlp_dims;
+    struct sctree *sctree;
+    struct tree *ttree;
+    struct d_tree_ocp_qp_dim *qp_dims;
+    // qp dims per node
+    int *nbx;
+    int *nbu;
+    int *ng;    // ng + nh
+    int *nsbx;
+    int *nsbu;
+    int *nsg;   // nsg + nsh
+    int Nn;     // number of nodes
+    int md;     // number of realizations at each branching
+    int Nr;     // robust horizon (number of stages with branching)
+    int Nh;     // horizon
+} ocp_nlp_tree_dims;
+
+// number of nodes of the scenario tree
+int ocp_nlp_tree_num_nodes(int md, int Nr, int Nh);
+//
+int ocp_nlp_tree_dims_calculate_size(void *config, int md, int Nr, int Nh);
+//
+ocp_nlp_tree_dims *ocp_nlp_tree_dims_assign(void *config, int md, int Nr, int Nh, void *raw_memory);
+// parent node, -1 for the root
+int ocp_nlp_tree_dims_get_parent(ocp_nlp_tree_dims *dims, int node);
+// stage of the node in the horizon
+int ocp_nlp_tree_dims_get_stage(ocp_nlp_tree_dims *dims, int node);
+// set nx, nu, nz, ns for all nodes
+void ocp_nlp_tree_dims_set_opt_vars(void *config, void *dims, const char *field,
+                                    const void *value_array);
+// set constraints dims of a node
+void ocp_nlp_tree_dims_set_constraints(void *config, void *dims, int node, const char *field,
+                                       const void *value);
+// set cost dims of a node
+void ocp_nlp_tree_dims_set_cost(void *config, void *dims, int node, const char *field,
+                                const void *value);
+// set dynamics dims of an edge
+void ocp_nlp_tree_dims_set_dynamics(void *config, void *dims, int edge, const char *field,
+                                    const void *value);
+
+
+
+/************************************************
+ * options
+ ************************************************/
+
+typedef struct
+{
+    struct d_tree_ocp_qp_ipm_arg *qp_solver_opts;
+    void **dynamics;     // dynamics_opts
+    void **cost;         // cost_opts
+    void **constraints;  // constraints_opts
+    double tol_stat;     // exit tolerance on stationarity condition
+    double tol_eq;       // exit tolerance on equality constraints
+    double tol_ineq;     // exit tolerance on inequality constraints
+    double tol_comp;     // exit tolerance on complemetarity condition
+    double step_length;  // (fixed) step length in SQP loop
+    int max_iter;
+    int num_threads;
+} ocp_nlp_sqp_tree_opts;
+
+//
+int ocp_nlp_sqp_tree_opts_calculate_size(void *config, void *dims);
+//
+void *ocp_nlp_sqp_tree_opts_assign(void *config, void *dims, void *raw_memory);
+//
+void ocp_nlp_sqp_tree_opts_initialize_default(void *config, void *dims, void *opts);
+//
+void ocp_nlp_sqp_tree_opts_update(void *config, void *dims, void *opts);
+//
+void ocp_nlp_sqp_tree_opts_set(void *config_, void *opts_, const char *field, void *value);
+// set dynamics opts of an edge
+void ocp_nlp_sqp_tree_dynamics_opts_set(void *config, void *opts, int edge, const char *field,
+                                        void *value);
+//
+void ocp_nlp_sqp_tree_cost_opts_set(void *config, void *opts, int node, const char *field,
+                                    void *value);
+//
+void ocp_nlp_sqp_tree_constraints_opts_set(void *config, void *opts, int node, const char *field,
+                                           void *value);
+
+
+
+/************************************************
+ * memory
+ ************************************************/
+
+typedef struct
+{
+    // tree qp in & out
+    struct d_tree_ocp_qp *qp_in;
+    struct d_tree_ocp_qp_sol *qp_out;
+    struct d_tree_ocp_qp_ipm_ws *qp_solver_mem;
+    // QP stuff not entering the qp_in struct
+    struct blasfeo_dmat *dzduxt; // dzdux transposed
+    struct blasfeo_dvec *z_alg; // z_alg, output algebraic variables
+
+    void **dynamics;     // dynamics memory
+    void **cost;         // cost memory
+    void **constraints;  // constraints memory
+
+    // residuals
+    ocp_nlp_res *nlp_res;
+
+    // nlp memory
+    ocp_nlp_memory *nlp_mem;
+
+    int status;
+
+    int sqp_iter;
+
+    double time_qp_sol;
+    double time_lin;
+    double time_tot;
+
+    double *stat;
+    int stat_m;
+    int stat_n;
+
+} ocp_nlp_sqp_tree_memory;
+
+//
+int ocp_nlp_sqp_tree_memory_calculate_size(void *config, void *dims, void *opts_);
+//
+void *ocp_nlp_sqp_tree_memory_assign(void *config, void *dims, void *opts_, void *raw_memory);
+
+
+
+/************************************************
+ * workspace
+ ************************************************/
+
+typedef struct
+{
+    void **dynamics;     // dynamics_workspace
+    void **cost;         // cost_workspace
+    void **constraints;  // constraints_workspace
+} ocp_nlp_sqp_tree_work;
+
+//
+int ocp_nlp_sqp_tree_workspace_calculate_size(void *config, void *dims, void *opts_);
+
+
+
+/************************************************
+ * functions
+ ************************************************/
+
+//
+int ocp_nlp_sqp_tree(void *config, void *dims, void *nlp_in, void *nlp_out,
+                     void *opts, void *mem, void *work);
+//
+int ocp_nlp_sqp_tree_precompute(void *config_, void *dims_, void *nlp_in_, void *nlp_out_,
+                                void *opts_, void *mem_, void *work_);
+//
+void ocp_nlp_sqp_tree_get(void *config_, void *mem_, const char *field, void *return_value_);
+//
+void ocp_nlp_sqp_tree_config_initialize_default(void *config_);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  // ACADOS_OCP_NLP_OCP_NLP_SQP_TREE_H_
+/// @}
+/// @}
+/// @}
@@ -33,13 +33,22 @@
 
 
 // external
+#include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+// blasfeo
+#include "blasfeo/include/blasfeo_d_aux.h"
+#include "blasfeo/include/blasfeo_d_blas.h"
+#include "blasfeo/include/blasfeo_s_aux.h"
 // hpipm
 #include "hpipm/include/hpipm_d_ocp_qp.h"
 #include "hpipm/include/hpipm_d_ocp_qp_ipm.h"
 #include "hpipm/include/hpipm_d_ocp_qp_sol.h"
+#include "hpipm/include/hpipm_s_ocp_qp.h"
+#include "hpipm/include/hpipm_s_ocp_qp_dim.h"
+#include "hpipm/include/hpipm_s_ocp_qp_ipm.h"
+#include "hpipm/include/hpipm_s_ocp_qp_sol.h"
 // acados
 #include "acados/ocp_qp/ocp_qp_common.h"
 #include "acados/ocp_qp/ocp_qp_hpipm.h"
@@ -111,6 +120,10 @@ void ocp_qp_hpipm_opts_initialize_default(void *config_, void *dims_, void *opts
     opts->hpipm_opts->alpha_min = 1e-8;
     opts->hpipm_opts->mu0 = 1e0;
 
+    opts->single_precision = false;
+    opts->ir_iter = 2;
+    opts->time_limit = 0.0;
+
     return;
 }
 
@@ -129,7 +142,25 @@ void ocp_qp_hpipm_opts_set(void *config_, void *opts_, const char *field, void *
 {
     ocp_qp_hpipm_opts *opts = opts_;
 
-	d_ocp_qp_ipm_arg_set((char *) field, value, opts->hpipm_opts);
+    if (!strcmp(field, "single_precision"))
+    {
+        int *single_precision = value;
+        opts->single_precision = *single_precision;
+    }
+    else if (!strcmp(field, "ir_iter"))
+    {
+        int *ir_iter = value;
+        opts->ir_iter = *ir_iter;
+    }
+    else if (!strcmp(field, "time_limit"))
+    {
+        double *time_limit = value;
+        opts->time_limit = *time_limit;
+    }
+    else
+    {
+        d_ocp_qp_ipm_arg_set((char *) field, value, opts->hpipm_opts);
+    }
 
 	return;
 }
@@ -152,6 +183,26 @@ int ocp_qp_hpipm_memory_calculate_size(void *config_, void *dims_, void *opts_)
 
     size += d_ocp_qp_ipm_ws_memsize(dims, opts->hpipm_opts);
 
+    if (opts->single_precision)
+    {
+        int N = dims->N;
+
+        size += sizeof(struct s_ocp_qp_dim);
+        size += sizeof(struct s_ocp_qp);
+        size += sizeof(struct s_ocp_qp_sol);
+        size += sizeof(struct s_ocp_qp_ipm_arg);
+        size += sizeof(struct s_ocp_qp_ipm_ws);
+
+        // the single precision structures are not created yet,
+        // their double precision counterparts are an upper bound on their size
+        size += s_ocp_qp_dim_memsize(N);
+        size += d_ocp_qp_memsize(dims);
+        size += d_ocp_qp_sol_memsize(dims);
+        size += d_ocp_qp_ipm_arg_memsize(dims);
+        size += d_ocp_qp_ipm_ws_memsize(dims, opts->hpipm_opts);
+        size += 4 * 8 + 1 * 64;
+    }
+
     size += 1 * 8;
     return size;
 }
@@ -182,6 +233,64 @@ void *ocp_qp_hpipm_memory_assign(void *config_, void *dims_, void *opts_, void *
     d_ocp_qp_ipm_ws_create(dims, opts->hpipm_opts, ipm_workspace, c_ptr);
     c_ptr += ipm_workspace->memsize;
 
+    if (opts->single_precision)
+    {
+        int N = dims->N;
+
+        mem->s_dims = (struct s_ocp_qp_dim *) c_ptr;
+        c_ptr += sizeof(struct s_ocp_qp_dim);
+        mem->s_qp_in = (struct s_ocp_qp *) c_ptr;
+        c_ptr += sizeof(struct s_ocp_qp);
+        mem->s_qp_out = (struct s_ocp_qp_sol *) c_ptr;
+        c_ptr += sizeof(struct s_ocp_qp_sol);
+        mem->s_hpipm_opts = (struct s_ocp_qp_ipm_arg *) c_ptr;
+        c_ptr += sizeof(struct s_ocp_qp_ipm_arg);
+        mem->s_hpipm_workspace = (struct s_ocp_qp_ipm_ws *) c_ptr;
+        c_ptr += sizeof(struct s_ocp_qp_ipm_ws);
+
+        align_char_to(8, &c_ptr);
+        s_ocp_qp_dim_create(N, mem->s_dims, c_ptr);
+        c_ptr += s_ocp_qp_dim_memsize(N);
+        for (int ii = 0; ii <= N; ii++)
+        {
+            s_ocp_qp_dim_set("nx", ii, dims->nx[ii], mem->s_dims);
+            s_ocp_qp_dim_set("nu", ii, dims->nu[ii], mem->s_dims);
+            s_ocp_qp_dim_set("nbx", ii, dims->nbx[ii], mem->s_dims);
+            s_ocp_qp_dim_set("nbu", ii, dims->nbu[ii], mem->s_dims);
+            s_ocp_qp_dim_set("ng", ii, dims->ng[ii], mem->s_dims);
+            s_ocp_qp_dim_set("nsbx", ii, dims->nsbx[ii], mem->s_dims);
+            s_ocp_qp_dim_set("nsbu", ii, dims->nsbu[ii], mem->s_dims);
+            s_ocp_qp_dim_set("nsg", ii, dims->nsg[ii], mem->s_dims);
+        }
+
+        align_char_to(8, &c_ptr);
+        s_ocp_qp_create(mem->s_dims, mem->s_qp_in, c_ptr);
+        c_ptr += mem->s_qp_in->memsize;
+
+        align_char_to(8, &c_ptr);
+        s_ocp_qp_sol_create(mem->s_dims, mem->s_qp_out, c_ptr);
+        c_ptr += mem->s_qp_out->memsize;
+
+        align_char_to(8, &c_ptr);
+        s_ocp_qp_ipm_arg_create(mem->s_dims, mem->s_hpipm_opts, c_ptr);
+        c_ptr += mem->s_hpipm_opts->memsize;
+        s_ocp_qp_ipm_arg_set_default(BALANCE, mem->s_hpipm_opts);
+
+        align_char_to(64, &c_ptr);
+        s_ocp_qp_ipm_ws_create(mem->s_dims, mem->s_hpipm_opts, mem->s_hpipm_workspace, c_ptr);
+        c_ptr += mem->s_hpipm_workspace->memsize;
+    }
+    else
+    {
+        mem->s_dims = NULL;
+        mem->s_qp_in = NULL;
+        mem->s_qp_out = NULL;
+        mem->s_hpipm_opts = NULL;
+        mem->s_hpipm_workspace = NULL;
+    }
+
+    mem->time_per_iter = 0.0;
+
     assert((char *) raw_memory + ocp_qp_hpipm_memory_calculate_size(config_, dims, opts_) >= c_ptr);
 
     return mem;
@@ -195,7 +304,252 @@ void *ocp_qp_hpipm_memory_assign(void *config_, void *dims_, void *opts_, void *
 
 int ocp_qp_hpipm_workspace_calculate_size(void *config_, void *dims_, void *opts_)
 {
-	return 0;
+    ocp_qp_dims *dims = dims_;
+    ocp_qp_hpipm_opts *opts = opts_;
+
+    if (!opts->single_precision)
+        return 0;
+
+    int N = dims->N;
+
+    // max size of residual vectors
+    int nM = 0;
+    for (int ii = 0; ii <= N; ii++)
+    {
+        nM = dims->nu[ii] + dims->nx[ii] > nM ? dims->nu[ii] + dims->nx[ii] : nM;
+        nM = dims->nb[ii] + dims->ng[ii] > nM ? dims->nb[ii] + dims->ng[ii] : nM;
+    }
+
+    int size = sizeof(ocp_qp_hpipm_workspace);
+
+    size += blasfeo_memsize_dvec(nM);
+
+    size += 1 * 64;
+    return size;
+}
+
+
+
+static void *ocp_qp_hpipm_cast_workspace(void *config_, void *dims_, void *opts_, void *raw_memory)
+{
+    ocp_qp_dims *dims = dims_;
+
+    int N = dims->N;
+
+    int nM = 0;
+    for (int ii = 0; ii <= N; ii++)
+    {
+        nM = dims->nu[ii] + dims->nx[ii] > nM ? dims->nu[ii] + dims->nx[ii] : nM;
+        nM = dims->nb[ii] + dims->ng[ii] > nM ? dims->nb[ii] + dims->ng[ii] : nM;
+    }
+
+    char *c_ptr = (char *) raw_memory;
+
+    ocp_qp_hpipm_workspace *work = (ocp_qp_hpipm_workspace *) c_ptr;
+    c_ptr += sizeof(ocp_qp_hpipm_workspace);
+
+    align_char_to(64, &c_ptr);
+
+    assign_and_advance_blasfeo_dvec_mem(nM, &work->tmp, &c_ptr);
+
+    assert((char *) raw_memory + ocp_qp_hpipm_workspace_calculate_size(config_, dims, opts_) >=
+           c_ptr);
+
+    return work;
+}
+
+
+
+/************************************************
+ * single precision
+ ************************************************/
+
+static void cvt_dmat_to_smat(int m, int n, struct blasfeo_dmat *A, struct blasfeo_smat *sA)
+{
+    for (int jj = 0; jj < n; jj++)
+        for (int ii = 0; ii < m; ii++)
+            BLASFEO_SMATEL(sA, ii, jj) = (float) BLASFEO_DMATEL(A, ii, jj);
+}
+
+
+
+static void cvt_dvec_to_svec(int m, struct blasfeo_dvec *a, int ai, struct blasfeo_svec *sa, int sai)
+{
+    for (int ii = 0; ii < m; ii++)
+        BLASFEO_SVECEL(sa, sai+ii) = (float) BLASFEO_DVECEL(a, ai+ii);
+}
+
+
+
+// copy matrices and index vectors of the QP to single precision
+static void cvt_ocp_qp_matrices_to_single(ocp_qp_in *qp_in, struct s_ocp_qp *s_qp_in)
+{
+    int N = qp_in->dim->N;
+    int *nx = qp_in->dim->nx;
+    int *nu = qp_in->dim->nu;
+    int *nb = qp_in->dim->nb;
+    int *ng = qp_in->dim->ng;
+    int *ns = qp_in->dim->ns;
+
+    for (int ii = 0; ii <= N; ii++)
+    {
+        if (ii < N)
+            cvt_dmat_to_smat(nu[ii]+nx[ii]+1, nx[ii+1], qp_in->BAbt+ii, s_qp_in->BAbt+ii);
+        cvt_dmat_to_smat(nu[ii]+nx[ii]+1, nu[ii]+nx[ii], qp_in->RSQrq+ii, s_qp_in->RSQrq+ii);
+        cvt_dmat_to_smat(nu[ii]+nx[ii], ng[ii], qp_in->DCt+ii, s_qp_in->DCt+ii);
+        cvt_dvec_to_svec(2*ns[ii], qp_in->Z+ii, 0, s_qp_in->Z+ii, 0);
+
+        for (int jj = 0; jj < nb[ii]; jj++)
+            s_qp_in->idxb[ii][jj] = qp_in->idxb[ii][jj];
+        for (int jj = 0; jj < ns[ii]; jj++)
+            s_qp_in->idxs[ii][jj] = qp_in->idxs[ii][jj];
+    }
+}
+
+
+
+// copy vectors of the QP shifted to the point ux to single precision,
+// i.e. the QP in the step d = ux_opt - ux
+static void cvt_ocp_qp_vectors_to_single(ocp_qp_in *qp_in, struct blasfeo_dvec *ux,
+    struct s_ocp_qp *s_qp_in, ocp_qp_hpipm_workspace *work)
+{
+    int N = qp_in->dim->N;
+    int *nx = qp_in->dim->nx;
+    int *nu = qp_in->dim->nu;
+    int *nb = qp_in->dim->nb;
+    int *ng = qp_in->dim->ng;
+    int *ns = qp_in->dim->ns;
+
+    struct blasfeo_dvec *tmp = &work->tmp;
+
+    for (int ii = 0; ii <= N; ii++)
+    {
+        int nv = nu[ii] + nx[ii];
+        int ni = nb[ii] + ng[ii];
+
+        // gradient: rq + RSQ * ux
+        blasfeo_dsymv_l(nv, nv, 1.0, qp_in->RSQrq+ii, 0, 0, ux+ii, 0, 1.0, qp_in->rqz+ii, 0,
+                        tmp, 0);
+        cvt_dvec_to_svec(nv, tmp, 0, s_qp_in->rqz+ii, 0);
+
+        // slack gradient: z + Z * s, Z is diagonal
+        for (int jj = 0; jj < 2*ns[ii]; jj++)
+            BLASFEO_SVECEL(s_qp_in->rqz+ii, nv+jj) = (float) (BLASFEO_DVECEL(qp_in->rqz+ii, nv+jj)
+                + BLASFEO_DVECEL(qp_in->Z+ii, jj) * BLASFEO_DVECEL(ux+ii, nv+jj));
+
+        // dynamics: b + BAbt^T * ux - x_next
+        if (ii < N)
+        {
+            blasfeo_dgemv_t(nv, nx[ii+1], 1.0, qp_in->BAbt+ii, 0, 0, ux+ii, 0, 1.0, qp_in->b+ii, 0,
+                            tmp, 0);
+            blasfeo_daxpy(nx[ii+1], -1.0, ux+ii+1, nu[ii+1], tmp, 0, tmp, 0);
+            cvt_dvec_to_svec(nx[ii+1], tmp, 0, s_qp_in->b+ii, 0);
+        }
+
+        // inequalities, upper bounds are stored with negative sign
+        blasfeo_dvecex_sp(nb[ii], 1.0, qp_in->idxb[ii], ux+ii, 0, tmp, 0);
+        blasfeo_dgemv_t(nv, ng[ii], 1.0, qp_in->DCt+ii, 0, 0, ux+ii, 0, 0.0, tmp, nb[ii], tmp,
+                        nb[ii]);
+        for (int jj = 0; jj < ni; jj++)
+        {
+            BLASFEO_SVECEL(s_qp_in->d+ii, jj) =
+                (float) (BLASFEO_DVECEL(qp_in->d+ii, jj) - BLASFEO_DVECEL(tmp, jj));
+            BLASFEO_SVECEL(s_qp_in->d+ii, ni+jj) =
+                (float) (BLASFEO_DVECEL(qp_in->d+ii, ni+jj) + BLASFEO_DVECEL(tmp, jj));
+        }
+
+        // soft constraints: lb - sl <= C * ux <= ub + su, with the slacks bounded below by ls, us
+        for (int jj = 0; jj < ns[ii]; jj++)
+        {
+            int idx = qp_in->idxs[ii][jj];
+            double sl = BLASFEO_DVECEL(ux+ii, nv+jj);
+            double su = BLASFEO_DVECEL(ux+ii, nv+ns[ii]+jj);
+
+            BLASFEO_SVECEL(s_qp_in->d+ii, idx) =
+                (float) (BLASFEO_DVECEL(qp_in->d+ii, idx) - BLASFEO_DVECEL(tmp, idx) - sl);
+            BLASFEO_SVECEL(s_qp_in->d+ii, ni+idx) =
+                (float) (BLASFEO_DVECEL(qp_in->d+ii, ni+idx) + BLASFEO_DVECEL(tmp, idx) - su);
+            BLASFEO_SVECEL(s_qp_in->d+ii, 2*ni+jj) =
+                (float) (BLASFEO_DVECEL(qp_in->d+ii, 2*ni+jj) - sl);
+            BLASFEO_SVECEL(s_qp_in->d+ii, 2*ni+ns[ii]+jj) =
+                (float) (BLASFEO_DVECEL(qp_in->d+ii, 2*ni+ns[ii]+jj) - su);
+        }
+        cvt_dvec_to_svec(2*ni+2*ns[ii], qp_in->m+ii, 0, s_qp_in->m+ii, 0);
+    }
+}
+
+
+
+// solve the QP in single precision and refine the primal solution in double precision:
+// each refinement step solves the QP shifted to the current iterate, whose solution is the step
+static int ocp_qp_hpipm_single(ocp_qp_in *qp_in, ocp_qp_out *qp_out, ocp_qp_hpipm_opts *opts,
+    ocp_qp_hpipm_memory *memory, ocp_qp_hpipm_workspace *work, int *num_iter)
+{
+    int N = qp_in->dim->N;
+    int *nx = qp_in->dim->nx;
+    int *nu = qp_in->dim->nu;
+    int *nb = qp_in->dim->nb;
+    int *ng = qp_in->dim->ng;
+    int *ns = qp_in->dim->ns;
+
+    struct s_ocp_qp *s_qp_in = memory->s_qp_in;
+    struct s_ocp_qp_sol *s_qp_out = memory->s_qp_out;
+    struct s_ocp_qp_ipm_arg *s_opts = memory->s_hpipm_opts;
+    struct d_ocp_qp_ipm_arg *d_opts = opts->hpipm_opts;
+
+    // tolerances below the single precision accuracy can not be reached
+    float tol_min = 1e-5;
+    s_opts->mu0 = d_opts->mu0;
+    s_opts->alpha_min = d_opts->alpha_min;
+    s_opts->res_g_max = d_opts->res_g_max > tol_min ? d_opts->res_g_max : tol_min;
+    s_opts->res_b_max = d_opts->res_b_max > tol_min ? d_opts->res_b_max : tol_min;
+    s_opts->res_d_max = d_opts->res_d_max > tol_min ? d_opts->res_d_max : tol_min;
+    s_opts->res_m_max = d_opts->res_m_max > tol_min ? d_opts->res_m_max : tol_min;
+    s_opts->iter_max = d_opts->iter_max;
+    s_opts->stat_max = d_opts->stat_max;
+
+    int ir_iter = opts->ir_iter;
+
+    cvt_ocp_qp_matrices_to_single(qp_in, s_qp_in);
+
+    // the primal solution is accumulated in qp_out->ux, the first QP is not shifted
+    for (int ii = 0; ii <= N; ii++)
+        blasfeo_dvecse(nu[ii]+nx[ii]+2*ns[ii], 0.0, qp_out->ux+ii, 0);
+
+    int hpipm_status = 0;
+    *num_iter = 0;
+
+    for (int kk = 0; kk <= ir_iter; kk++)
+    {
+        cvt_ocp_qp_vectors_to_single(qp_in, qp_out->ux, s_qp_in, work);
+
+        s_ocp_qp_ipm_solve(s_qp_in, s_qp_out, s_opts, memory->s_hpipm_workspace);
+        s_ocp_qp_ipm_get_status(memory->s_hpipm_workspace, &hpipm_status);
+        *num_iter += memory->s_hpipm_workspace->iter;
+
+        // primal step in double, multipliers of the shifted QP are the ones of the original QP
+        for (int ii = 0; ii <= N; ii++)
+        {
+            int nv = nu[ii] + nx[ii] + 2*ns[ii];
+            int ni = 2*nb[ii] + 2*ng[ii] + 2*ns[ii];
+
+            for (int jj = 0; jj < nv; jj++)
+                BLASFEO_DVECEL(qp_out->ux+ii, jj) += BLASFEO_SVECEL(s_qp_out->ux+ii, jj);
+            if (ii < N)
+                for (int jj = 0; jj < nx[ii+1]; jj++)
+                    BLASFEO_DVECEL(qp_out->pi+ii, jj) = BLASFEO_SVECEL(s_qp_out->pi+ii, jj);
+            for (int jj = 0; jj < ni; jj++)
+            {
+                BLASFEO_DVECEL(qp_out->lam+ii, jj) = BLASFEO_SVECEL(s_qp_out->lam+ii, jj);
+                BLASFEO_DVECEL(qp_out->t+ii, jj) = BLASFEO_SVECEL(s_qp_out->t+ii, jj);
+            }
+        }
+
+        if (hpipm_status != 0)
+            break;
+    }
+
+    return hpipm_status;
 }
 
 
@@ -229,19 +583,43 @@ int ocp_qp_hpipm(void *config_, void *qp_in_, void *qp_out_, void *opts_, void *
 		blasfeo_dvecse(nu[ii]+nx[ii]+2*ns[ii], 0.0, qp_out->ux+ii, 0);
 	}
 
+    // enforce the deadline by limiting the number of iterations, ipm iterations have a
+    // roughly constant cost so the time per iteration of the last solve is a good estimate
+    int iter_max = opts->hpipm_opts->iter_max;
+    if (opts->time_limit > 0.0 && memory->time_per_iter > 0.0)
+    {
+        int iter_deadline = (int) (opts->time_limit / memory->time_per_iter);
+        iter_deadline = iter_deadline > 1 ? iter_deadline : 1;
+        opts->hpipm_opts->iter_max = iter_deadline < iter_max ? iter_deadline : iter_max;
+    }
+
     // solve ipm
     acados_tic(&qp_timer);
     // print_ocp_qp_in(qp_in);
     int hpipm_status;
-	d_ocp_qp_ipm_solve(qp_in, qp_out, opts->hpipm_opts, memory->hpipm_workspace);
-	d_ocp_qp_ipm_get_status(memory->hpipm_workspace, &hpipm_status);
+    int num_iter;
+    if (opts->single_precision)
+    {
+        ocp_qp_hpipm_workspace *work = ocp_qp_hpipm_cast_workspace(config_, qp_in->dim, opts, work_);
+        hpipm_status = ocp_qp_hpipm_single(qp_in, qp_out, opts, memory, work, &num_iter);
+    }
+    else
+    {
+        d_ocp_qp_ipm_solve(qp_in, qp_out, opts->hpipm_opts, memory->hpipm_workspace);
+        d_ocp_qp_ipm_get_status(memory->hpipm_workspace, &hpipm_status);
+        num_iter = memory->hpipm_workspace->iter;
+    }
 
     info->solve_QP_time = acados_toc(&qp_timer);
     info->interface_time = 0;  // there are no conversions for hpipm
     info->total_time = acados_toc(&tot_timer);
-    info->num_iter = memory->hpipm_workspace->iter;
+    info->num_iter = num_iter;
     info->t_computed = 1;
 
+    opts->hpipm_opts->iter_max = iter_max;
+    if (num_iter > 0)
+        memory->time_per_iter = info->solve_QP_time / num_iter;
+
     // check exit conditions
     int acados_status = hpipm_status;
     if (hpipm_status == 0) acados_status = ACADOS_SUCCESS;
@@ -266,6 +644,12 @@ void ocp_qp_hpipm_eval_sens(void *config_, void *param_qp_in_, void *sens_qp_out
     ocp_qp_hpipm_opts *opts = opts_;
     ocp_qp_hpipm_memory *memory = mem_;
 
+    if (opts->single_precision)
+    {
+        printf("\nerror: ocp_qp_hpipm_eval_sens: not implemented in single precision\n");
+        exit(1);
+    }
+
     // solve ipm
 //    acados_tic(&qp_timer);
     // print_ocp_qp_in(param_qp_in);
@@ -41,6 +41,7 @@ extern "C" {
 
 // hpipm
 #include "hpipm/include/hpipm_d_ocp_qp_ipm.h"
+#include "hpipm/include/hpipm_s_ocp_qp_ipm.h"
 // acados
 #include "acados/ocp_qp/ocp_qp_common.h"
 #include "acados/utils/types.h"
@@ -52,6 +53,9 @@ extern "C" {
 typedef struct ocp_qp_hpipm_opts_
 {
     struct d_ocp_qp_ipm_arg *hpipm_opts;
+    bool single_precision;  // solve the QP in float, refine the primal solution in double
+    int ir_iter;            // number of iterative refinement steps in single precision mode
+    double time_limit;      // deadline of a solve in seconds, <= 0 for none
 } ocp_qp_hpipm_opts;
 
 
@@ -61,10 +65,24 @@ typedef struct ocp_qp_hpipm_opts_
 typedef struct ocp_qp_hpipm_memory_
 {
     struct d_ocp_qp_ipm_ws *hpipm_workspace;
+    // single precision
+    struct s_ocp_qp_dim *s_dims;
+    struct s_ocp_qp *s_qp_in;
+    struct s_ocp_qp_sol *s_qp_out;
+    struct s_ocp_qp_ipm_arg *s_hpipm_opts;
+    struct s_ocp_qp_ipm_ws *s_hpipm_workspace;
+    double time_per_iter;  // measured in the last solve, converts the deadline into iter_max
 } ocp_qp_hpipm_memory;
 
 
 
+typedef struct ocp_qp_hpipm_workspace_
+{
+    struct blasfeo_dvec tmp;  // residuals for iterative refinement
+} ocp_qp_hpipm_workspace;
+
+
+
 //
 int ocp_qp_hpipm_opts_calculate_size(void *config, void *dims);
 //
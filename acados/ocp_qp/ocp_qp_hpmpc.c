@@ -137,6 +137,11 @@ void ocp_qp_hpmpc_opts_set(void *config_, void *opts_, const char *field, void *
     else if (!strcmp(field, "warm_start"))
     {
 		// TODO set solver warm start
+    }
+    else if (!strcmp(field, "time_limit"))
+    {
+		// no-op: hpmpc has no timer, its ipm only stops at max_iter; the deadline is
+		// checked by the nlp solver between iterations
     }
 	else
 	{
@@ -887,6 +887,11 @@ void ocp_qp_ooqp_opts_set(void *config_, void *opts_, const char *field, void *v
     else if (!strcmp(field, "warm_start"))
     {
 		// TODO set solver warm start
+    }
+    else if (!strcmp(field, "time_limit"))
+    {
+		// no-op: OOQP cannot be interrupted, the solve runs to convergence or to its
+		// internal iteration limit
     }
 	else
 	{
@@ -169,6 +169,9 @@ static void cpy_osqp_settings(OSQPSettings *from, OSQPSettings *to)
     to->scaled_termination = from->scaled_termination;
     to->check_termination = from->check_termination;
     to->warm_start = from->warm_start;
+#ifdef PROFILING
+    to->time_limit = from->time_limit;
+#endif
 }
 
 
@@ -679,6 +682,14 @@ void ocp_qp_osqp_opts_set(void *config_, void *opts_, const char *field, void *v
     else if (!strcmp(field, "warm_start"))
     {
 		// TODO set solver warm start
+    }
+    else if (!strcmp(field, "time_limit"))
+    {
+#ifdef PROFILING
+		// osqp checks the time limit in each ADMM iteration, 0 disables it
+		double *time_limit = value;
+		opts->osqp_opts->time_limit = *time_limit > 0.0 ? *time_limit : 0.0;
+#endif
     }
 	else
 	{
@@ -1281,6 +1292,10 @@ int ocp_qp_osqp(void *config_, void *qp_in_, void *qp_out_, void *opts_, void *m
         osqp_init_data(mem->osqp_data, opts->osqp_opts, mem->osqp_work);
         mem->first_run = 0;
     }
+#ifdef PROFILING
+    // the deadline changes between solves, the other settings are only copied at setup
+    mem->osqp_work->settings->time_limit = opts->osqp_opts->time_limit;
+#endif
 
     // solve OSQP
     osqp_solve(mem->osqp_work);
@@ -1298,6 +1313,10 @@ int ocp_qp_osqp(void *config_, void *qp_in_, void *qp_out_, void *opts_, void *m
     // check exit conditions
     if (osqp_status == OSQP_SOLVED) acados_status = ACADOS_SUCCESS;
     if (osqp_status == OSQP_MAX_ITER_REACHED) acados_status = ACADOS_MAXITER;
+#ifdef PROFILING
+    // stopped by the deadline like an iteration limit, the last iterate is still returned
+    if (osqp_status == OSQP_TIME_LIMIT_REACHED) acados_status = ACADOS_MAXITER;
+#endif
     return acados_status;
 }
 
@@ -36,12 +36,18 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#if defined(ACADOS_WITH_OPENMP)
+#include <omp.h>
+#endif
 // acados
 #include "acados/ocp_qp/ocp_qp_common.h"
 #include "acados/ocp_qp/ocp_qp_partial_condensing.h"
 #include "acados/utils/mem.h"
+// blasfeo
+#include "blasfeo/include/blasfeo_d_aux.h"
 // hpipm
 #include "hpipm/include/hpipm_d_cond.h"
+#include "hpipm/include/hpipm_d_cond_aux.h"
 #include "hpipm/include/hpipm_d_dense_qp.h"
 #include "hpipm/include/hpipm_d_dense_qp_sol.h"
 #include "hpipm/include/hpipm_d_ocp_qp.h"
@@ -244,6 +250,12 @@ void ocp_qp_partial_condensing_opts_initialize_default(void *dims_, void *opts_)
 
 	opts->mem_qp_in = 1;
 
+#if defined(ACADOS_WITH_OPENMP)
+	opts->num_threads = ACADOS_NUM_THREADS;
+#else
+	opts->num_threads = 1;
+#endif
+
 	return;
 }
 
@@ -285,6 +297,11 @@ void ocp_qp_partial_condensing_opts_set(void *opts_, const char *field, void* va
 		int *tmp_ptr = value;
 		opts->ric_alg = *tmp_ptr;
 	}
+	else if(!strcmp(field, "num_threads"))
+	{
+		int *tmp_ptr = value;
+		opts->num_threads = *tmp_ptr;
+	}
 	else
 	{
 		printf("\nerror: field %s not available in ocp_qp_partial_condensing_opts_set\n", field);
@@ -324,7 +341,15 @@ int ocp_qp_partial_condensing_memory_calculate_size(void *dims_, void *opts_)
     size += sizeof(struct d_part_cond_qp_ws);
     size += d_part_cond_qp_ws_memsize(dims->orig_dims, dims->block_size, dims->pcond_dims, opts->hpipm_opts);
 
-    size += 2 * 8;
+	// block aliases
+	int N2 = opts->N2;
+	size += (N2 + 1) * sizeof(int); // block_offset
+	size += (N2 + 1) * sizeof(struct d_ocp_qp_dim);
+	size += (N2 + 1) * sizeof(struct d_ocp_qp);
+	size += (N2 + 1) * sizeof(struct d_ocp_qp_sol);
+	size += (N2 + 1) * sizeof(struct d_dense_qp_sol);
+
+    size += 3 * 8;
 
     return size;
 }
@@ -362,6 +387,27 @@ void *ocp_qp_partial_condensing_memory_assign(void *dims_, void *opts_, void *ra
 
 	mem->qp_out_info = (qp_info *) mem->pcond_qp_out->misc;
 
+	// block aliases
+	int N2 = opts->N2;
+
+    align_char_to(8, &c_ptr);
+
+	mem->block_dims = (struct d_ocp_qp_dim *) c_ptr;
+	c_ptr += (N2 + 1) * sizeof(struct d_ocp_qp_dim);
+	mem->block_qp = (struct d_ocp_qp *) c_ptr;
+	c_ptr += (N2 + 1) * sizeof(struct d_ocp_qp);
+	mem->block_qp_sol = (struct d_ocp_qp_sol *) c_ptr;
+	c_ptr += (N2 + 1) * sizeof(struct d_ocp_qp_sol);
+	mem->block_dense_sol = (struct d_dense_qp_sol *) c_ptr;
+	c_ptr += (N2 + 1) * sizeof(struct d_dense_qp_sol);
+
+	assign_and_advance_int(N2 + 1, &mem->block_offset, &c_ptr);
+
+	mem->block_size = dims->block_size;
+	mem->block_offset[0] = 0;
+	for (int ii = 0; ii < N2; ii++)
+		mem->block_offset[ii+1] = mem->block_offset[ii] + dims->block_size[ii];
+
     assert((char *) raw_memory + ocp_qp_partial_condensing_memory_calculate_size(dims, opts) >= c_ptr);
 
     return mem;
@@ -415,6 +461,90 @@ int ocp_qp_partial_condensing_workspace_calculate_size(void *dims_, void *opts_)
  * functions
  ************************************************/
 
+// alias the stages of each block of the original qp, as done inside hpipm's partial condensing
+static void partial_condensing_alias_blocks(ocp_qp_in *qp_in, ocp_qp_partial_condensing_opts *opts,
+	ocp_qp_partial_condensing_memory *mem)
+{
+	struct d_ocp_qp_dim *orig_dim = qp_in->dim;
+
+	int N2 = opts->N2;
+	int ii, N_tmp;
+
+	for (ii = 0; ii <= N2; ii++)
+	{
+		N_tmp = mem->block_offset[ii];
+
+		// dims
+		mem->block_dims[ii].N = mem->block_size[ii];
+		mem->block_dims[ii].nx = orig_dim->nx + N_tmp;
+		mem->block_dims[ii].nu = orig_dim->nu + N_tmp;
+		mem->block_dims[ii].nb = orig_dim->nb + N_tmp;
+		mem->block_dims[ii].nbx = orig_dim->nbx + N_tmp;
+		mem->block_dims[ii].nbu = orig_dim->nbu + N_tmp;
+		mem->block_dims[ii].ng = orig_dim->ng + N_tmp;
+		mem->block_dims[ii].ns = orig_dim->ns + N_tmp;
+		mem->block_dims[ii].nsbx = orig_dim->nsbx + N_tmp;
+		mem->block_dims[ii].nsbu = orig_dim->nsbu + N_tmp;
+		mem->block_dims[ii].nsg = orig_dim->nsg + N_tmp;
+
+		// qp
+		mem->block_qp[ii].dim = mem->block_dims + ii;
+		mem->block_qp[ii].idxb = qp_in->idxb + N_tmp;
+		mem->block_qp[ii].BAbt = qp_in->BAbt + N_tmp;
+		mem->block_qp[ii].b = qp_in->b + N_tmp;
+		mem->block_qp[ii].RSQrq = qp_in->RSQrq + N_tmp;
+		mem->block_qp[ii].rqz = qp_in->rqz + N_tmp;
+		mem->block_qp[ii].DCt = qp_in->DCt + N_tmp;
+		mem->block_qp[ii].d = qp_in->d + N_tmp;
+		mem->block_qp[ii].m = qp_in->m + N_tmp;
+		mem->block_qp[ii].Z = qp_in->Z + N_tmp;
+		mem->block_qp[ii].idxs = qp_in->idxs + N_tmp;
+	}
+
+	return;
+}
+
+
+
+// condense all blocks (matrices and rhs, or rhs only); the blocks write to disjoint stages of
+// pcond_qp_in, so the result does not depend on the number of threads
+static void partial_condensing_blocks(ocp_qp_in *pcond_qp_in, int rhs_only,
+	ocp_qp_partial_condensing_opts *opts, ocp_qp_partial_condensing_memory *mem)
+{
+	struct d_part_cond_qp_arg *arg = opts->hpipm_opts;
+	struct d_part_cond_qp_ws *ws = mem->hpipm_workspace;
+
+	int N2 = opts->N2;
+	int ii;
+
+#if defined(ACADOS_WITH_OPENMP)
+	#pragma omp parallel for num_threads(opts->num_threads)
+#endif
+	for (ii = 0; ii <= N2; ii++)
+	{
+		if (rhs_only)
+		{
+			d_cond_b(mem->block_qp+ii, pcond_qp_in->b+ii, arg->cond_arg+ii, ws->cond_workspace+ii);
+			d_cond_rq(mem->block_qp+ii, pcond_qp_in->rqz+ii, arg->cond_arg+ii, ws->cond_workspace+ii);
+			d_cond_d(mem->block_qp+ii, pcond_qp_in->d+ii, pcond_qp_in->rqz+ii, arg->cond_arg+ii,
+				ws->cond_workspace+ii);
+		}
+		else
+		{
+			d_cond_BAbt(mem->block_qp+ii, pcond_qp_in->BAbt+ii, pcond_qp_in->b+ii, arg->cond_arg+ii,
+				ws->cond_workspace+ii);
+			d_cond_RSQrq(mem->block_qp+ii, pcond_qp_in->RSQrq+ii, pcond_qp_in->rqz+ii,
+				arg->cond_arg+ii, ws->cond_workspace+ii);
+			d_cond_DCtd(mem->block_qp+ii, pcond_qp_in->idxb[ii], pcond_qp_in->DCt+ii,
+				pcond_qp_in->d+ii, pcond_qp_in->idxs[ii], pcond_qp_in->Z+ii, pcond_qp_in->rqz+ii,
+				arg->cond_arg+ii, ws->cond_workspace+ii);
+		}
+	}
+
+	return;
+}
+
+
 int ocp_qp_partial_condensing(void *qp_in_, void *pcond_qp_in_, void *opts_, void *mem_, void *work)
 {
 	ocp_qp_in *qp_in = qp_in_;
@@ -430,7 +560,15 @@ int ocp_qp_partial_condensing(void *qp_in_, void *pcond_qp_in_, void *opts_, voi
 
     // convert to partially condensed qp structure
 	// TODO only if N2<N
-    d_part_cond_qp_cond(qp_in, pcond_qp_in, opts->hpipm_opts, mem->hpipm_workspace);
+	if (opts->num_threads > 1)
+	{
+		partial_condensing_alias_blocks(qp_in, opts, mem);
+		partial_condensing_blocks(pcond_qp_in, 0, opts, mem);
+	}
+	else
+	{
+		d_part_cond_qp_cond(qp_in, pcond_qp_in, opts->hpipm_opts, mem->hpipm_workspace);
+	}
 
 	return ACADOS_SUCCESS;
 }
@@ -452,7 +590,15 @@ int ocp_qp_partial_condensing_rhs(void *qp_in_, void *pcond_qp_in_, void *opts_,
 
     // convert to partially condensed qp structure
 	// TODO only if N2<N
-    d_part_cond_qp_cond_rhs(qp_in, pcond_qp_in, opts->hpipm_opts, mem->hpipm_workspace);
+	if (opts->num_threads > 1)
+	{
+		partial_condensing_alias_blocks(qp_in, opts, mem);
+		partial_condensing_blocks(pcond_qp_in, 1, opts, mem);
+	}
+	else
+	{
+		d_part_cond_qp_cond_rhs(qp_in, pcond_qp_in, opts->hpipm_opts, mem->hpipm_workspace);
+	}
 
 	return ACADOS_SUCCESS;
 }
@@ -469,7 +615,48 @@ int ocp_qp_partial_expansion(void *pcond_qp_out_, void *qp_out_, void *opts_, vo
     assert(opts->N2 == opts->N2_bkp);
 
 	// TODO only if N2<N
-    d_part_cond_qp_expand_sol(mem->ptr_qp_in, mem->ptr_pcond_qp_in, pcond_qp_out, qp_out, opts->hpipm_opts, mem->hpipm_workspace);
+	if (opts->num_threads > 1)
+	{
+		struct d_part_cond_qp_arg *arg = opts->hpipm_opts;
+		struct d_part_cond_qp_ws *ws = mem->hpipm_workspace;
+
+		int N2 = opts->N2;
+		int ii;
+
+		// block aliases of qp_in are set in the condensing call
+#if defined(ACADOS_WITH_OPENMP)
+		#pragma omp parallel for num_threads(opts->num_threads)
+#endif
+		for (ii = 0; ii <= N2; ii++)
+		{
+			int N_tmp = mem->block_offset[ii];
+
+			mem->block_qp_sol[ii].dim = mem->block_dims + ii;
+			mem->block_qp_sol[ii].ux = qp_out->ux + N_tmp;
+			mem->block_qp_sol[ii].pi = qp_out->pi + N_tmp;
+			mem->block_qp_sol[ii].lam = qp_out->lam + N_tmp;
+			mem->block_qp_sol[ii].t = qp_out->t + N_tmp;
+
+			mem->block_dense_sol[ii].v = pcond_qp_out->ux + ii;
+			mem->block_dense_sol[ii].pi = pcond_qp_out->pi + ii;
+			mem->block_dense_sol[ii].lam = pcond_qp_out->lam + ii;
+			mem->block_dense_sol[ii].t = pcond_qp_out->t + ii;
+
+			d_expand_sol(mem->block_qp+ii, mem->block_dense_sol+ii, mem->block_qp_sol+ii,
+				arg->cond_arg+ii, ws->cond_workspace+ii);
+		}
+
+		// equality multipliers coupling the blocks
+		for (ii = 0; ii < N2; ii++)
+		{
+			int N_tmp = mem->block_offset[ii] + mem->block_size[ii] - 1;
+			blasfeo_dveccp(qp_out->dim->nx[N_tmp+1], pcond_qp_out->pi+ii, 0, qp_out->pi+N_tmp, 0);
+		}
+	}
+	else
+	{
+		d_part_cond_qp_expand_sol(mem->ptr_qp_in, mem->ptr_pcond_qp_in, pcond_qp_out, qp_out, opts->hpipm_opts, mem->hpipm_workspace);
+	}
 
 	return ACADOS_SUCCESS;
 }
@@ -64,6 +64,7 @@ typedef struct ocp_qp_partial_condensing_opts_
     int N2_bkp;
 	int ric_alg;
 	int mem_qp_in; // allocate qp_in in memory
+	int num_threads; // > 1: condense and expand the blocks in parallel (requires ACADOS_WITH_OPENMP)
 } ocp_qp_partial_condensing_opts;
 
 
@@ -78,6 +79,13 @@ typedef struct ocp_qp_partial_condensing_memory_
     ocp_qp_in *ptr_qp_in;
     ocp_qp_in *ptr_pcond_qp_in;
 	qp_info *qp_out_info; // info in pcond_qp_in
+	// block-wise aliases of the original qp (one per block, used by the parallel loops)
+	int *block_size;
+	int *block_offset; // first stage of each block
+	struct d_ocp_qp_dim *block_dims;
+	struct d_ocp_qp *block_qp;
+	struct d_ocp_qp_sol *block_qp_sol;
+	struct d_dense_qp_sol *block_dense_sol;
 } ocp_qp_partial_condensing_memory;
 
 
@@ -245,6 +245,10 @@ void ocp_qp_qpdunes_opts_set(void *config_, void *opts_, const char *field, void
     else if (!strcmp(field, "warm_start"))
     {
 		// TODO set solver warm start
+    }
+    else if (!strcmp(field, "time_limit"))
+    {
+		// no-op: qpDUNES has no time limit; bound the solve time with maxIter instead
     }
 	else
 	{
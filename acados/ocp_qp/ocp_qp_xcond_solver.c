@@ -34,9 +34,13 @@
 
 // external
 #include <assert.h>
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
+// blasfeo
+#include "blasfeo/include/blasfeo_d_aux.h"
+
 // acados
 #include "acados/ocp_qp/ocp_qp_common.h"
 #include "acados/ocp_qp/ocp_qp_xcond_solver.h"
@@ -95,9 +99,15 @@ int ocp_qp_xcond_solver_dims_calculate_size(void *config_, int N)
 	// orig_dims
     size += ocp_qp_dims_calculate_size(N);
 
+	// red_dims
+    size += ocp_qp_dims_calculate_size(N);
+
 	// xcond_dims
 	size += config->xcond->dims_calculate_size(config->xcond, N);
 
+	// mb_hold
+	size += (N+1)*sizeof(int);
+
     return size;
 }
 
@@ -114,12 +124,21 @@ ocp_qp_xcond_solver_dims *ocp_qp_xcond_solver_dims_assign(void *config_, int N,
 
 	// orig_dims
     dims->orig_dims = ocp_qp_dims_assign(N, c_ptr);
+    c_ptr += ocp_qp_dims_calculate_size(N);
+
+	// red_dims
+    dims->red_dims = ocp_qp_dims_assign(N, c_ptr);
     c_ptr += ocp_qp_dims_calculate_size(N);
 
 	// xcond_dims
 	dims->xcond_dims = config->xcond->dims_assign(config->xcond, N, c_ptr);
 	c_ptr += config->xcond->dims_calculate_size(config->xcond, N);
 
+	// mb_hold
+	assign_and_advance_int(N+1, &dims->mb_hold, &c_ptr);
+	for (int ii = 0; ii <= N; ii++)
+		dims->mb_hold[ii] = 0;
+
     assert((char *) raw_memory + ocp_qp_xcond_solver_dims_calculate_size(config_, N) == c_ptr);
 
     return dims;
@@ -127,15 +146,68 @@ ocp_qp_xcond_solver_dims *ocp_qp_xcond_solver_dims_assign(void *config_, int N,
 
 
 
+// set the dims of a stage of the move blocked qp: the held controls are appended to the state,
+// i.e. nu = 0 and x = [u_prev; x], and their bounds become state bounds
+static void set_red_dims_stage(void *config_, ocp_qp_xcond_solver_dims *dims, int stage)
+{
+	ocp_qp_xcond_solver_config *config = config_;
+	ocp_qp_dims *orig_dims = dims->orig_dims;
+
+	int hold = dims->mb_hold[stage];
+
+	int red_val[6];
+	red_val[0] = hold ? orig_dims->nx[stage] + orig_dims->nu[stage] : orig_dims->nx[stage];
+	red_val[1] = hold ? 0 : orig_dims->nu[stage];
+	red_val[2] = hold ? orig_dims->nbx[stage] + orig_dims->nbu[stage] : orig_dims->nbx[stage];
+	red_val[3] = hold ? 0 : orig_dims->nbu[stage];
+	red_val[4] = hold ? orig_dims->nsbx[stage] + orig_dims->nsbu[stage] : orig_dims->nsbx[stage];
+	red_val[5] = hold ? 0 : orig_dims->nsbu[stage];
+
+	const char *fields[6] = {"nx", "nu", "nbx", "nbu", "nsbx", "nsbu"};
+
+	for (int ii = 0; ii < 6; ii++)
+	{
+		ocp_qp_dims_set(config_, dims->red_dims, stage, fields[ii], &red_val[ii]);
+		config->xcond->dims_set(config->xcond, dims->xcond_dims, stage, fields[ii], &red_val[ii]);
+	}
+
+	return;
+}
+
+
+
 void ocp_qp_xcond_solver_dims_set(void *config_, ocp_qp_xcond_solver_dims *dims, int stage, const char *field, int* value)
 {
 	ocp_qp_xcond_solver_config *config = config_;
 
+	if (!strcmp(field, "mb_hold"))
+	{
+		if (*value != 0 && (stage <= 0 || stage >= dims->orig_dims->N))
+		{
+			printf("\nerror: ocp_qp_xcond_solver_dims_set: mb_hold only possible for 0 < stage < N, got %d\n", stage);
+			exit(1);
+		}
+		dims->mb_hold[stage] = *value != 0;
+		set_red_dims_stage(config_, dims, stage);
+		return;
+	}
+
 	// orig_dims
     ocp_qp_dims_set(config_, dims->orig_dims, stage, field, value);
 
-	// xcond_dims
-	config->xcond->dims_set(config->xcond, dims->xcond_dims, stage, field, value);
+	if (!strcmp(field, "nx") || !strcmp(field, "nu") || !strcmp(field, "nbx") ||
+		!strcmp(field, "nbu") || !strcmp(field, "nsbx") || !strcmp(field, "nsbu"))
+	{
+		// red_dims & xcond_dims
+		set_red_dims_stage(config_, dims, stage);
+	}
+	else
+	{
+		// red_dims
+		ocp_qp_dims_set(config_, dims->red_dims, stage, field, value);
+		// xcond_dims
+		config->xcond->dims_set(config->xcond, dims->xcond_dims, stage, field, value);
+	}
 
 	return;
 }
@@ -280,6 +352,31 @@ void ocp_qp_xcond_solver_opts_set(void *config_, void *opts_, const char *field,
  * memory
  ************************************************/
 
+// returns 1 if any stage is move blocked, checks the control dims of the held stages
+static int mb_hold_any(ocp_qp_xcond_solver_dims *dims)
+{
+	ocp_qp_dims *orig_dims = dims->orig_dims;
+
+	int any = 0;
+
+	for (int ii = 1; ii < orig_dims->N; ii++)
+	{
+		if (dims->mb_hold[ii])
+		{
+			if (orig_dims->nu[ii] != orig_dims->nu[ii-1])
+			{
+				printf("\nerror: ocp_qp_xcond_solver: mb_hold at stage %d requires nu[%d] == nu[%d]\n",
+					ii, ii, ii-1);
+				exit(1);
+			}
+			any = 1;
+		}
+	}
+
+	return any;
+}
+
+
 int ocp_qp_xcond_solver_memory_calculate_size(void *config_, ocp_qp_xcond_solver_dims *dims, void *opts_)
 {
     ocp_qp_xcond_solver_config *config = config_;
@@ -299,6 +396,15 @@ int ocp_qp_xcond_solver_memory_calculate_size(void *config_, ocp_qp_xcond_solver
 
     size += qp_solver->memory_calculate_size(qp_solver, xcond_qp_dims, opts->qp_solver_opts);
 
+	// move blocked qp
+	if (mb_hold_any(dims))
+	{
+		size += ocp_qp_in_calculate_size(dims->red_dims);
+		size += ocp_qp_out_calculate_size(dims->red_dims);
+	}
+
+	size += 1*8;  // align
+
     return size;
 }
 
@@ -332,6 +438,20 @@ void *ocp_qp_xcond_solver_memory_assign(void *config_, ocp_qp_xcond_solver_dims
     mem->solver_memory = qp_solver->memory_assign(qp_solver, xcond_qp_dims, opts->qp_solver_opts, c_ptr);
     c_ptr += qp_solver->memory_calculate_size(qp_solver, xcond_qp_dims, opts->qp_solver_opts);
 
+	// move blocked qp
+	mem->red_qp_in = NULL;
+	mem->red_qp_out = NULL;
+	if (mb_hold_any(dims))
+	{
+		align_char_to(8, &c_ptr);
+
+		mem->red_qp_in = ocp_qp_in_assign(dims->red_dims, c_ptr);
+		c_ptr += ocp_qp_in_calculate_size(dims->red_dims);
+
+		mem->red_qp_out = ocp_qp_out_assign(dims->red_dims, c_ptr);
+		c_ptr += ocp_qp_out_calculate_size(dims->red_dims);
+	}
+
 	xcond->memory_get(xcond, mem->xcond_memory, "xcond_qp_in", &mem->xcond_qp_in);
 	xcond->memory_get(xcond, mem->xcond_memory, "xcond_qp_out", &mem->xcond_qp_out);
 
@@ -402,6 +522,97 @@ static void cast_workspace(void *config_, ocp_qp_xcond_solver_dims *dims,
  * functions
  ************************************************/
 
+// move blocking: build the reduced qp, where the controls of a held stage are carried as additional
+// states, i.e. x_red[ii] = [u[ii-1]; x[ii]] and B_red[ii-1] = [I B[ii-1]]; the [u; x] layout of the
+// stage variables is unchanged, hence all the stage data but the dynamics is copied as is
+static void mb_reduce(ocp_qp_xcond_solver_dims *dims, ocp_qp_in *qp_in, ocp_qp_in *red_qp_in)
+{
+	ocp_qp_dims *orig_dims = dims->orig_dims;
+
+	int N = orig_dims->N;
+	int *nx = orig_dims->nx;
+	int *nu = orig_dims->nu;
+	int *nb = orig_dims->nb;
+	int *ng = orig_dims->ng;
+	int *ns = orig_dims->ns;
+	int *hold = dims->mb_hold;
+
+	int ii, jj;
+
+	for (ii = 0; ii <= N; ii++)
+	{
+		if (ii < N)
+		{
+			if (hold[ii+1])
+			{
+				// BAbt_red = [E BAbt], E = [I; 0; 0]
+				blasfeo_dgese(nu[ii]+nx[ii]+1, nu[ii+1], 0.0, red_qp_in->BAbt+ii, 0, 0);
+				for (jj = 0; jj < nu[ii+1]; jj++)
+					BLASFEO_DMATEL(red_qp_in->BAbt+ii, jj, jj) = 1.0;
+				blasfeo_dgecp(nu[ii]+nx[ii]+1, nx[ii+1], qp_in->BAbt+ii, 0, 0,
+					red_qp_in->BAbt+ii, 0, nu[ii+1]);
+				// b_red = [0; b]
+				blasfeo_dvecse(nu[ii+1], 0.0, red_qp_in->b+ii, 0);
+				blasfeo_dveccp(nx[ii+1], qp_in->b+ii, 0, red_qp_in->b+ii, nu[ii+1]);
+			}
+			else
+			{
+				blasfeo_dgecp(nu[ii]+nx[ii]+1, nx[ii+1], qp_in->BAbt+ii, 0, 0,
+					red_qp_in->BAbt+ii, 0, 0);
+				blasfeo_dveccp(nx[ii+1], qp_in->b+ii, 0, red_qp_in->b+ii, 0);
+			}
+		}
+
+		blasfeo_dgecp(nu[ii]+nx[ii]+1, nu[ii]+nx[ii], qp_in->RSQrq+ii, 0, 0,
+			red_qp_in->RSQrq+ii, 0, 0);
+		blasfeo_dveccp(nu[ii]+nx[ii]+2*ns[ii], qp_in->rqz+ii, 0, red_qp_in->rqz+ii, 0);
+		blasfeo_dgecp(nu[ii]+nx[ii], ng[ii], qp_in->DCt+ii, 0, 0, red_qp_in->DCt+ii, 0, 0);
+		blasfeo_dveccp(2*nb[ii]+2*ng[ii]+2*ns[ii], qp_in->d+ii, 0, red_qp_in->d+ii, 0);
+		blasfeo_dveccp(2*nb[ii]+2*ng[ii]+2*ns[ii], qp_in->m+ii, 0, red_qp_in->m+ii, 0);
+		blasfeo_dveccp(2*ns[ii], qp_in->Z+ii, 0, red_qp_in->Z+ii, 0);
+
+		for (jj = 0; jj < nb[ii]; jj++)
+			red_qp_in->idxb[ii][jj] = qp_in->idxb[ii][jj];
+		for (jj = 0; jj < ns[ii]; jj++)
+			red_qp_in->idxs[ii][jj] = qp_in->idxs[ii][jj];
+	}
+
+	return;
+}
+
+
+
+// move blocking: recover the solution of the original qp, only the multipliers of the dynamics
+// of the stages before a held one have to drop the entries of the held controls
+static void mb_expand(ocp_qp_xcond_solver_dims *dims, ocp_qp_out *red_qp_out, ocp_qp_out *qp_out)
+{
+	ocp_qp_dims *orig_dims = dims->orig_dims;
+
+	int N = orig_dims->N;
+	int *nx = orig_dims->nx;
+	int *nu = orig_dims->nu;
+	int *nb = orig_dims->nb;
+	int *ng = orig_dims->ng;
+	int *ns = orig_dims->ns;
+	int *hold = dims->mb_hold;
+
+	for (int ii = 0; ii <= N; ii++)
+	{
+		blasfeo_dveccp(nu[ii]+nx[ii]+2*ns[ii], red_qp_out->ux+ii, 0, qp_out->ux+ii, 0);
+		blasfeo_dveccp(2*nb[ii]+2*ng[ii]+2*ns[ii], red_qp_out->lam+ii, 0, qp_out->lam+ii, 0);
+		blasfeo_dveccp(2*nb[ii]+2*ng[ii]+2*ns[ii], red_qp_out->t+ii, 0, qp_out->t+ii, 0);
+
+		if (ii < N)
+		{
+			int offset = hold[ii+1] ? nu[ii+1] : 0;
+			blasfeo_dveccp(nx[ii+1], red_qp_out->pi+ii, offset, qp_out->pi+ii, 0);
+		}
+	}
+
+	return;
+}
+
+
 int ocp_qp_xcond_solver(void *config_, ocp_qp_xcond_solver_dims *dims, ocp_qp_in *qp_in, ocp_qp_out *qp_out,
                                      void *opts_, void *mem_, void *work_)
 {
@@ -423,9 +634,19 @@ int ocp_qp_xcond_solver(void *config_, ocp_qp_xcond_solver_dims *dims, ocp_qp_in
 
     int solver_status = ACADOS_SUCCESS;
 
+	// move blocking
+	ocp_qp_in *cond_qp_in = qp_in;
+	ocp_qp_out *cond_qp_out = qp_out;
+
 	// condensing
 	acados_tic(&cond_timer);
-	xcond->condensing(qp_in, memory->xcond_qp_in, opts->xcond_opts, memory->xcond_memory, work->xcond_work);
+	if (memory->red_qp_in != NULL)
+	{
+		mb_reduce(dims, qp_in, memory->red_qp_in);
+		cond_qp_in = memory->red_qp_in;
+		cond_qp_out = memory->red_qp_out;
+	}
+	xcond->condensing(cond_qp_in, memory->xcond_qp_in, opts->xcond_opts, memory->xcond_memory, work->xcond_work);
 	info->condensing_time = acados_toc(&cond_timer);
 
     // solve qp
@@ -433,7 +654,9 @@ int ocp_qp_xcond_solver(void *config_, ocp_qp_xcond_solver_dims *dims, ocp_qp_in
 
 	// expansion
 	acados_tic(&cond_timer);
-	xcond->expansion(memory->xcond_qp_out, qp_out, opts->xcond_opts, memory->xcond_memory, work->xcond_work);
+	xcond->expansion(memory->xcond_qp_out, cond_qp_out, opts->xcond_opts, memory->xcond_memory, work->xcond_work);
+	if (memory->red_qp_out != NULL)
+		mb_expand(dims, memory->red_qp_out, qp_out);
 	info->condensing_time += acados_toc(&cond_timer);
 
 	// output qp info
@@ -471,9 +694,19 @@ void ocp_qp_xcond_solver_eval_sens(void *config_, ocp_qp_xcond_solver_dims *dims
     cast_workspace(config_, dims, opts, memory, work);
 
 
+	// move blocking
+	ocp_qp_in *cond_qp_in = param_qp_in;
+	ocp_qp_out *cond_qp_out = sens_qp_out;
+	if (memory->red_qp_in != NULL)
+	{
+		mb_reduce(dims, param_qp_in, memory->red_qp_in);
+		cond_qp_in = memory->red_qp_in;
+		cond_qp_out = memory->red_qp_out;
+	}
+
 	// condensing
 //	acados_tic(&cond_timer);
-	xcond->condensing_rhs(param_qp_in, memory->xcond_qp_in, opts->xcond_opts, memory->xcond_memory, work->xcond_work);
+	xcond->condensing_rhs(cond_qp_in, memory->xcond_qp_in, opts->xcond_opts, memory->xcond_memory, work->xcond_work);
 //	info->condensing_time = acados_toc(&cond_timer);
 
     // qp evaluate sensitivity
@@ -481,7 +714,9 @@ void ocp_qp_xcond_solver_eval_sens(void *config_, ocp_qp_xcond_solver_dims *dims
 
 	// expansion
 //	acados_tic(&cond_timer);
-	xcond->expansion(memory->xcond_qp_out, sens_qp_out, opts->xcond_opts, memory->xcond_memory, work->xcond_work);
+	xcond->expansion(memory->xcond_qp_out, cond_qp_out, opts->xcond_opts, memory->xcond_memory, work->xcond_work);
+	if (memory->red_qp_out != NULL)
+		mb_expand(dims, memory->red_qp_out, sens_qp_out);
 //	info->condensing_time += acados_toc(&cond_timer);
 
 	// output qp info
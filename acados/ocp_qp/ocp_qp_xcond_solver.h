@@ -48,7 +48,9 @@ extern "C" {
 typedef struct
 {
 	ocp_qp_dims *orig_dims;
+	ocp_qp_dims *red_dims;  // dims after move blocking (equal to orig_dims if no stage is held)
 	void *xcond_dims;
+	int *mb_hold;  // move blocking: 1 if the controls of the stage equal the ones of the previous stage
 } ocp_qp_xcond_solver_dims;
 
 
@@ -67,6 +69,8 @@ typedef struct ocp_qp_xcond_solver_memory_
     void *solver_memory;
     void *xcond_qp_in;
     void *xcond_qp_out;
+    ocp_qp_in *red_qp_in;  // move blocked qp (NULL if no stage is held)
+    ocp_qp_out *red_qp_out;
 } ocp_qp_xcond_solver_memory;
 
 
@@ -297,6 +297,8 @@ sim_out *sim_out_assign(void *config_, void *dims, void *raw_memory)
     assign_and_advance_double(nz, &out->zn, &c_ptr);
     assign_and_advance_double(nz * NF, &out->S_algebraic, &c_ptr);
 
+    out->S_forw_tran = NULL;
+
     assert((char *) raw_memory + sim_out_calculate_size(config_, dims) >= c_ptr);
 
     return out;
@@ -402,6 +404,23 @@ int sim_out_get_(void *config_, void *dims_, sim_out *out, const char *field, vo
 
 
 
+// stores S_forw = [Sx, Su] (nx x nx+nu) either column-major into out->S_forw or, if provided,
+// transposed and reordered into out->S_forw_tran = [Su, Sx]^T
+void sim_out_store_forw_sens(sim_out *out, int nx, int nu, struct blasfeo_dmat *S_forw)
+{
+    if (out->S_forw_tran == NULL)
+    {
+        blasfeo_unpack_dmat(nx, nx + nu, S_forw, 0, 0, out->S_forw, nx);
+    }
+    else
+    {
+        blasfeo_dgetr(nx, nu, S_forw, 0, nx, out->S_forw_tran, 0, 0);
+        blasfeo_dgetr(nx, nx, S_forw, 0, 0, out->S_forw_tran, nu, 0);
+    }
+}
+
+
+
 /************************************************
 * sim_opts
 ************************************************/
@@ -429,6 +448,31 @@ int sim_opts_set_(sim_opts *opts, const char *field, void *value)
         bool *jac_reuse = (bool *) value;
         opts->jac_reuse = *jac_reuse;
     }
+    else if (!strcmp(field, "checkpoint_steps"))
+    {
+        int *checkpoint_steps = (int *) value;
+        opts->checkpoint_steps = *checkpoint_steps;
+    }
+    else if (!strcmp(field, "tol_abs"))
+    {
+        double *tol_abs = (double *) value;
+        opts->tol_abs = *tol_abs;
+    }
+    else if (!strcmp(field, "tol_rel"))
+    {
+        double *tol_rel = (double *) value;
+        opts->tol_rel = *tol_rel;
+    }
+    else if (!strcmp(field, "max_steps"))
+    {
+        int *max_steps = (int *) value;
+        opts->max_steps = *max_steps;
+    }
+    else if (!strcmp(field, "sparse_lu"))
+    {
+        bool *sparse_lu = (bool *) value;
+        opts->sparse_lu = *sparse_lu;
+    }
     else if (!strcmp(field, "sens_forw"))
     {
         bool *sens_forw = (bool *) value;
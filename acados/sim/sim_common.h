@@ -37,6 +37,8 @@
 
 #include <stdbool.h>
 
+#include "blasfeo/include/blasfeo_common.h"
+
 #include "acados/sim/sim_collocation_utils.h"
 #include "acados/utils/timing.h"
 #include "acados/utils/types.h"
@@ -81,7 +83,7 @@ typedef struct
     double *S_forw;  // forward seed [Sx, Su]
     double *S_adj;   // backward seed
 
-    bool identity_seed; // indicating if S_forw = [eye(nx), zeros(nx x nu)]
+    bool identity_seed; // S_forw = [eye(nx), zeros(nx x nu)], S_forw itself is not read
 
     void *model;
 
@@ -105,6 +107,8 @@ typedef struct
 {
     double *xn;      // xn[NX]
     double *S_forw;  // S_forw[NX*(NX+NU)]
+    struct blasfeo_dmat *S_forw_tran;  // optional: if not NULL, [Su, Sx]^T is written here
+                                       // (NU+NX x NX) instead of into S_forw
     double *S_adj;   //
     double *S_hess;  //
 
@@ -147,6 +151,21 @@ typedef struct
     bool jac_reuse;
     Newton_scheme *scheme;
 
+    // for explicit integrators with adjoint sensitivities: number of integration steps
+    // between two stored states, the stages are recomputed in the backward sweep;
+    // 0 stores the whole forward trajectory
+    int checkpoint_steps;
+
+    // for adaptive explicit integrators: local error tolerances and maximum number of
+    // accepted integration steps per call
+    double tol_abs;
+    double tol_rel;
+    int max_steps;
+
+    // for implicit integrators: factorize the Newton matrix with a sparse LU on its structural
+    // pattern instead of a dense one (set before memory creation)
+    bool sparse_lu;
+
     // workspace
     void *work;
 
@@ -208,6 +227,8 @@ int sim_out_calculate_size(void *config, void *dims);
 sim_out *sim_out_assign(void *config, void *dims, void *raw_memory);
 //
 int sim_out_get_(void *config, void *dims, sim_out *out, const char *field, void *value);
+//
+void sim_out_store_forw_sens(sim_out *out, int nx, int nu, struct blasfeo_dmat *S_forw);
 
 /* opts */
 //
@@ -0,0 +1,885 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+
+// standard
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+// blasfeo
+#include "blasfeo/include/blasfeo_d_aux.h"
+// acados
+#include "acados/sim/sim_common.h"
+#include "acados/sim/sim_erk_adaptive.h"
+#include "acados/sim/sim_erk_integrator.h"
+#include "acados/utils/mem.h"
+
+
+
+/************************************************
+ * embedded tableaus
+ ************************************************/
+
+// Bogacki-Shampine 3(2), row-major
+static const double bs32_A[16] = {
+    0.0,       0.0,       0.0,       0.0,
+    1.0 / 2.0, 0.0,       0.0,       0.0,
+    0.0,       3.0 / 4.0, 0.0,       0.0,
+    2.0 / 9.0, 1.0 / 3.0, 4.0 / 9.0, 0.0};
+static const double bs32_b[4] = {2.0 / 9.0, 1.0 / 3.0, 4.0 / 9.0, 0.0};
+static const double bs32_c[4] = {0.0, 1.0 / 2.0, 3.0 / 4.0, 1.0};
+// difference between the weights of the solution and of the embedded solution
+static const double bs32_e[4] = {-5.0 / 72.0, 1.0 / 12.0, 1.0 / 9.0, -1.0 / 8.0};
+
+// Dormand-Prince 5(4), row-major
+static const double dp54_A[49] = {
+    0.0,             0.0,              0.0,             0.0,           0.0,              0.0,        0.0,
+    1.0 / 5.0,       0.0,              0.0,             0.0,           0.0,              0.0,        0.0,
+    3.0 / 40.0,      9.0 / 40.0,       0.0,             0.0,           0.0,              0.0,        0.0,
+    44.0 / 45.0,     -56.0 / 15.0,     32.0 / 9.0,      0.0,           0.0,              0.0,        0.0,
+    19372.0 / 6561.0, -25360.0 / 2187.0, 64448.0 / 6561.0, -212.0 / 729.0, 0.0,           0.0,        0.0,
+    9017.0 / 3168.0, -355.0 / 33.0,    46732.0 / 5247.0, 49.0 / 176.0, -5103.0 / 18656.0, 0.0,        0.0,
+    35.0 / 384.0,    0.0,              500.0 / 1113.0,  125.0 / 192.0, -2187.0 / 6784.0, 11.0 / 84.0, 0.0};
+static const double dp54_b[7] = {35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0,
+                                 -2187.0 / 6784.0, 11.0 / 84.0, 0.0};
+static const double dp54_c[7] = {0.0, 1.0 / 5.0, 3.0 / 10.0, 4.0 / 5.0, 8.0 / 9.0, 1.0, 1.0};
+static const double dp54_e[7] = {71.0 / 57600.0, 0.0, -71.0 / 16695.0, 71.0 / 1920.0,
+                                 -17253.0 / 339200.0, 22.0 / 525.0, -1.0 / 40.0};
+
+
+
+// error weights and order of the embedded solution of the pair with ns stages
+static const double *sim_erk_adaptive_pair(int ns, int *order_emb)
+{
+    if (ns == 4)
+    {
+        *order_emb = 2;
+        return bs32_e;
+    }
+    else if (ns == 7)
+    {
+        *order_emb = 4;
+        return dp54_e;
+    }
+
+    printf("\nerror: sim_erk_adaptive: only number of stages = {4,7} implemented\n");
+    exit(1);
+}
+
+
+
+static void sim_erk_adaptive_set_tableau(sim_opts *opts)
+{
+    int ns = opts->ns;
+
+    const double *A_tab;
+    const double *b_tab;
+    const double *c_tab;
+
+    if (ns == 4)
+    {
+        A_tab = bs32_A;
+        b_tab = bs32_b;
+        c_tab = bs32_c;
+    }
+    else if (ns == 7)
+    {
+        A_tab = dp54_A;
+        b_tab = dp54_b;
+        c_tab = dp54_c;
+    }
+    else
+    {
+        printf("\nerror: sim_erk_adaptive: only number of stages = {4,7} implemented\n");
+        exit(1);
+    }
+
+    // A_mat is column-major
+    for (int ii = 0; ii < ns; ii++)
+    {
+        for (int jj = 0; jj < ns; jj++)
+            opts->A_mat[ii + ns * jj] = A_tab[ii * ns + jj];
+        opts->b_vec[ii] = b_tab[ii];
+        opts->c_vec[ii] = c_tab[ii];
+    }
+
+    opts->tableau_size = ns;
+
+    return;
+}
+
+
+
+/************************************************
+ * opts
+ ************************************************/
+
+void sim_erk_adaptive_opts_initialize_default(void *config_, void *dims_, void *opts_)
+{
+    sim_opts *opts = opts_;
+    sim_erk_dims *dims = (sim_erk_dims *) dims_;
+
+    opts->ns = 7;  // Dormand-Prince 5(4)
+    sim_erk_adaptive_set_tableau(opts);
+
+    // the initial step is T / num_steps, until a step sequence is available in memory
+    opts->num_steps = 1;
+    opts->num_forw_sens = dims->nx + dims->nu;
+    opts->sens_forw = true;
+    opts->sens_adj = false;
+    opts->sens_hess = false;
+
+    opts->output_z = false;
+    opts->sens_algebraic = false;
+
+    opts->checkpoint_steps = 0;
+
+    opts->tol_abs = 1e-8;
+    opts->tol_rel = 1e-6;
+    opts->max_steps = 100;
+
+    return;
+}
+
+
+
+void sim_erk_adaptive_opts_update(void *config_, void *dims, void *opts_)
+{
+    sim_opts *opts = opts_;
+
+    assert(opts->ns <= NS_MAX && "ns > NS_MAX!");
+
+    sim_erk_adaptive_set_tableau(opts);
+
+    return;
+}
+
+
+
+/************************************************
+ * memory
+ ************************************************/
+
+int sim_erk_adaptive_memory_calculate_size(void *config, void *dims, void *opts_)
+{
+    sim_opts *opts = opts_;
+
+    int size = sizeof(sim_erk_adaptive_memory);
+
+    size += opts->max_steps * sizeof(double);  // step_seq
+
+    make_int_multiple_of(8, &size);
+    size += 1 * 8;
+
+    return size;
+}
+
+
+
+void *sim_erk_adaptive_memory_assign(void *config, void *dims, void *opts_, void *raw_memory)
+{
+    sim_opts *opts = opts_;
+
+    char *c_ptr = (char *) raw_memory;
+
+    sim_erk_adaptive_memory *mem = (sim_erk_adaptive_memory *) c_ptr;
+    c_ptr += sizeof(sim_erk_adaptive_memory);
+
+    align_char_to(8, &c_ptr);
+
+    assign_and_advance_double(opts->max_steps, &mem->step_seq, &c_ptr);
+
+    mem->num_steps_seq = 0;
+    mem->T_seq = 0.0;
+    mem->num_rejected = 0;
+
+    assert((char *) raw_memory + sim_erk_adaptive_memory_calculate_size(config, dims, opts_) >=
+           c_ptr);
+
+    return mem;
+}
+
+
+
+int sim_erk_adaptive_memory_set(void *config_, void *dims_, void *mem_, const char *field,
+                                void *value)
+{
+    printf("sim_erk_adaptive_memory_set field %s is not supported! \n", field);
+    exit(1);
+}
+
+
+
+int sim_erk_adaptive_memory_set_to_zero(void *config_, void *dims_, void *opts_, void *mem_,
+                                        const char *field)
+{
+    sim_erk_adaptive_memory *mem = mem_;
+
+    int status = ACADOS_SUCCESS;
+
+    if (!strcmp(field, "guesses"))
+    {
+        // forget the step sequence
+        mem->num_steps_seq = 0;
+    }
+    else
+    {
+        printf("sim_erk_adaptive_memory_set_to_zero field %s is not supported! \n", field);
+        exit(1);
+    }
+
+    return status;
+}
+
+
+
+/************************************************
+ * workspace
+ ************************************************/
+
+int sim_erk_adaptive_workspace_calculate_size(void *config_, void *dims_, void *opts_)
+{
+    sim_opts *opts = opts_;
+    sim_erk_dims *dims = (sim_erk_dims *) dims_;
+
+    int ns = opts->ns;
+
+    int nx = dims->nx;
+    int nu = dims->nu;
+    int nf = opts->num_forw_sens;
+
+    int nX = nx * (1 + nf);  // (nx) for ODE and (nf*nx) for VDE
+    int nhess = (nf + 1) * nf / 2;
+    int max_steps = opts->max_steps;
+
+    int size = sizeof(sim_erk_adaptive_workspace);
+
+    size += (nX + nu) * sizeof(double);  // rhs_forw_in
+
+    if (opts->sens_adj | opts->sens_hess)
+    {
+        size += max_steps * ns * nX * sizeof(double);   // K_traj
+        size += (max_steps + 1) * nX * sizeof(double);  // out_forw_traj
+    }
+    else
+    {
+        size += ns * nX * sizeof(double);  // K_traj
+        size += 2 * nX * sizeof(double);   // out_forw_traj
+    }
+
+    if (opts->sens_hess)
+    {
+        size += (nX + nx + nu) * sizeof(double);          // rhs_adj_in
+        size += (nx + nu + nhess) * sizeof(double);       // out_adj_tmp
+        size += ns * (nx + nu + nhess) * sizeof(double);  // adj_traj
+    }
+    else if (opts->sens_adj)
+    {
+        size += (nx * 2 + nu) * sizeof(double);   // rhs_adj_in
+        size += (nx + nu) * sizeof(double);       // out_adj_tmp
+        size += ns * (nx + nu) * sizeof(double);  // adj_traj
+    }
+
+    make_int_multiple_of(8, &size);
+    size += 1 * 8;
+
+    return size;
+}
+
+
+
+static void *sim_erk_adaptive_cast_workspace(void *config_, void *dims_, void *opts_,
+                                             void *raw_memory)
+{
+    sim_opts *opts = opts_;
+    sim_erk_dims *dims = (sim_erk_dims *) dims_;
+
+    int ns = opts->ns;
+
+    int nx = dims->nx;
+    int nu = dims->nu;
+    int nf = opts->num_forw_sens;
+
+    int nX = nx * (1 + nf);  // (nx) for ODE and (nf*nx) for VDE
+    int nhess = (nf + 1) * nf / 2;
+    int max_steps = opts->max_steps;
+
+    char *c_ptr = (char *) raw_memory;
+
+    sim_erk_adaptive_workspace *workspace = (sim_erk_adaptive_workspace *) c_ptr;
+    c_ptr += sizeof(sim_erk_adaptive_workspace);
+
+    align_char_to(8, &c_ptr);
+
+    assign_and_advance_double(nX + nu, &workspace->rhs_forw_in, &c_ptr);
+
+    if (opts->sens_adj | opts->sens_hess)
+    {
+        assign_and_advance_double(max_steps * ns * nX, &workspace->K_traj, &c_ptr);
+        assign_and_advance_double((max_steps + 1) * nX, &workspace->out_forw_traj, &c_ptr);
+    }
+    else
+    {
+        assign_and_advance_double(ns * nX, &workspace->K_traj, &c_ptr);
+        assign_and_advance_double(2 * nX, &workspace->out_forw_traj, &c_ptr);
+    }
+
+    if (opts->sens_hess)
+    {
+        assign_and_advance_double(nx + nX + nu, &workspace->rhs_adj_in, &c_ptr);
+        assign_and_advance_double(nx + nu + nhess, &workspace->out_adj_tmp, &c_ptr);
+        assign_and_advance_double(ns * (nx + nu + nhess), &workspace->adj_traj, &c_ptr);
+    }
+    else if (opts->sens_adj)
+    {
+        assign_and_advance_double((nx * 2 + nu), &workspace->rhs_adj_in, &c_ptr);
+        assign_and_advance_double(nx + nu, &workspace->out_adj_tmp, &c_ptr);
+        assign_and_advance_double(ns * (nx + nu), &workspace->adj_traj, &c_ptr);
+    }
+
+    assert((char *) raw_memory + sim_erk_adaptive_workspace_calculate_size(config_, dims, opts_) >=
+           c_ptr);
+
+    return (void *) workspace;
+}
+
+
+
+/************************************************
+ * functions
+ ************************************************/
+
+// stages s0, ..., ns-1 of an ERK step of size step at x (nX);
+// rhs_forw_in has to contain the controls after the first nX entries
+static void sim_erk_adaptive_stages(erk_model *model, sim_opts *opts, int nx, int nu, int nX,
+                                    double step, double *x, double *K, double *rhs_forw_in,
+                                    int s0, double *timing_ad)
+{
+    int ns = opts->ns;
+    double *A_mat = opts->A_mat;
+
+    int i, j, s;
+    double a;
+
+    ext_fun_arg_t ext_fun_type_in[4];
+    void *ext_fun_in[4];
+    ext_fun_arg_t ext_fun_type_out[3];
+    void *ext_fun_out[3];
+
+    acados_timer timer_ad;
+
+    for (s = s0; s < ns; s++)
+    {
+        for (i = 0; i < nX; i++)
+            rhs_forw_in[i] = x[i];
+        for (j = 0; j < s; j++)
+        {
+            a = A_mat[j * ns + s];
+            if (a != 0)
+            {
+                a *= step;
+                for (i = 0; i < nX; i++)
+                    rhs_forw_in[i] += a * K[j * nX + i];
+            }
+        }
+
+        acados_tic(&timer_ad);
+        if (opts->sens_forw)
+        {  // simulation + forward sensitivities
+            ext_fun_type_in[0] = COLMAJ;
+            ext_fun_in[0] = rhs_forw_in + 0;  // x: nx
+            ext_fun_type_in[1] = COLMAJ;
+            ext_fun_in[1] = rhs_forw_in + nx;  // Sx: nx*nx
+            ext_fun_type_in[2] = COLMAJ;
+            ext_fun_in[2] = rhs_forw_in + nx + nx * nx;  // Su: nx*nu
+            ext_fun_type_in[3] = COLMAJ;
+            ext_fun_in[3] = rhs_forw_in + nx + nx * nx + nx * nu;  // u: nu
+
+            ext_fun_type_out[0] = COLMAJ;
+            ext_fun_out[0] = K + s * nX + 0;  // fun: nx
+            ext_fun_type_out[1] = COLMAJ;
+            ext_fun_out[1] = K + s * nX + nx;  // Sx: nx*nx
+            ext_fun_type_out[2] = COLMAJ;
+            ext_fun_out[2] = K + s * nX + nx + nx * nx;  // Su: nx*nu
+
+            // forward VDE evaluation
+            model->expl_vde_for->evaluate(model->expl_vde_for, ext_fun_type_in, ext_fun_in,
+                                          ext_fun_type_out, ext_fun_out);
+        }
+        else
+        {  // simulation only
+            ext_fun_type_in[0] = COLMAJ;
+            ext_fun_in[0] = rhs_forw_in + 0;  // x: nx
+            ext_fun_type_in[1] = COLMAJ;
+            ext_fun_in[1] = rhs_forw_in + nx;  // u: nu
+
+            ext_fun_type_out[0] = COLMAJ;
+            ext_fun_out[0] = K + s * nX + 0;  // fun: nx
+
+            model->expl_ode_fun->evaluate(model->expl_ode_fun, ext_fun_type_in, ext_fun_in,
+                                          ext_fun_type_out, ext_fun_out);  // ODE evaluation
+        }
+        *timing_ad += acados_toc(&timer_ad);
+    }
+
+    return;
+}
+
+
+
+// backward sweep through one accepted step of size step, starting at the forward variables
+// forw (nForw) with stages K; adds the contributions of the step to adj_tmp (nAdj)
+static void sim_erk_adaptive_adj_step(erk_model *model, sim_opts *opts, int nx, int nu, int nX,
+                                      int nForw, int nAdj, double step, double *forw, double *K,
+                                      sim_erk_adaptive_workspace *workspace, double *timing_ad)
+{
+    int ns = opts->ns;
+    double *A_mat = opts->A_mat;
+    double *b_vec = opts->b_vec;
+
+    double *adj_tmp = workspace->out_adj_tmp;
+    double *adj_traj = workspace->adj_traj;
+    double *rhs_adj_in = workspace->rhs_adj_in;
+
+    int i, j, s;
+    double a, b;
+
+    ext_fun_arg_t ext_fun_type_in[5];
+    void *ext_fun_in[5];
+    ext_fun_arg_t ext_fun_type_out[2];
+    void *ext_fun_out[2];
+
+    acados_timer timer_ad;
+
+    for (s = ns - 1; s >= 0; s--)
+    {
+        // forward variables
+        for (i = 0; i < nForw; i++)
+            rhs_adj_in[i] = forw[i];
+        for (j = 0; j < s; j++)
+        {
+            a = A_mat[j * ns + s];
+            if (a != 0)
+            {
+                a *= step;
+                for (i = 0; i < nForw; i++)
+                    rhs_adj_in[i] += a * K[j * nX + i];
+            }
+        }
+
+        // adjoint variables
+        b = step * b_vec[s];
+        for (i = 0; i < nx; i++)
+            rhs_adj_in[nForw + i] = b * adj_tmp[i];
+        for (j = s + 1; j < ns; j++)
+        {
+            a = A_mat[s * ns + j];
+            if (a != 0)
+            {
+                a *= step;
+                for (i = 0; i < nx; i++)
+                    rhs_adj_in[nForw + i] += a * adj_traj[j * nAdj + i];
+            }
+        }
+
+        acados_tic(&timer_ad);
+        if (!opts->sens_hess)
+        {
+            ext_fun_type_in[0] = COLMAJ;
+            ext_fun_in[0] = rhs_adj_in + 0;  // x: nx
+            ext_fun_type_in[1] = COLMAJ;
+            ext_fun_in[1] = rhs_adj_in + nx;  // lam: nx
+            ext_fun_type_in[2] = COLMAJ;
+            ext_fun_in[2] = rhs_adj_in + nx + nx;  // u: nu
+
+            ext_fun_type_out[0] = COLMAJ;
+            ext_fun_out[0] = adj_traj + s * nAdj + 0;  // adj: nx+nu
+
+            // adjoint VDE evaluation
+            model->expl_vde_adj->evaluate(model->expl_vde_adj, ext_fun_type_in, ext_fun_in,
+                                          ext_fun_type_out, ext_fun_out);
+        }
+        else
+        {
+            ext_fun_type_in[0] = COLMAJ;
+            ext_fun_in[0] = rhs_adj_in + 0;  // x: nx
+            ext_fun_type_in[1] = COLMAJ;
+            ext_fun_in[1] = rhs_adj_in + nx;  // Sx: nx*nx
+            ext_fun_type_in[2] = COLMAJ;
+            ext_fun_in[2] = rhs_adj_in + nx + nx * nx;  // Su: nx*nu
+            ext_fun_type_in[3] = COLMAJ;
+            ext_fun_in[3] = rhs_adj_in + nx + nx * nx + nx * nu;  // lam: nx
+            ext_fun_type_in[4] = COLMAJ;
+            ext_fun_in[4] = rhs_adj_in + nx + nx * nx + nx * nu + nx;  // u: nu
+
+            ext_fun_type_out[0] = COLMAJ;
+            ext_fun_out[0] = adj_traj + s * nAdj + 0;  // adj: nx+nu
+            ext_fun_type_out[1] = COLMAJ;
+            ext_fun_out[1] = adj_traj + s * nAdj + nx + nu;  // hess: (nx+nu)*(nx+nu)
+
+            model->expl_ode_hes->evaluate(model->expl_ode_hes, ext_fun_type_in, ext_fun_in,
+                                          ext_fun_type_out, ext_fun_out);
+        }
+        *timing_ad += acados_toc(&timer_ad);
+    }
+
+    for (s = 0; s < ns; s++)
+        for (i = 0; i < nAdj; i++)
+            adj_tmp[i] += adj_traj[s * nAdj + i];
+
+    return;
+}
+
+
+
+int sim_erk_adaptive_precompute(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_,
+                                void *work_)
+{
+    return ACADOS_SUCCESS;
+}
+
+
+
+// the step sizes are selected on the states only and are kept fixed for the sensitivities, which
+// are the exact derivatives of the discrete integrator along the accepted step sequence
+int sim_erk_adaptive(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_,
+                     void *work_)
+{
+    sim_config *config = config_;
+    sim_opts *opts = opts_;
+    sim_erk_adaptive_memory *mem = mem_;
+
+    if (opts->ns != opts->tableau_size)
+    {
+        printf("Error in sim_erk_adaptive: the Butcher tableau size does not match ns\n");
+        exit(1);
+    }
+    int ns = opts->ns;
+
+    int order_emb;
+    const double *e_vec = sim_erk_adaptive_pair(ns, &order_emb);
+
+    void *dims_ = in->dims;
+    sim_erk_dims *dims = (sim_erk_dims *) dims_;
+
+    sim_erk_adaptive_workspace *workspace =
+        (sim_erk_adaptive_workspace *) sim_erk_adaptive_cast_workspace(config, dims, opts, work_);
+
+    int i, s;
+    int nx = dims->nx;
+    int nu = dims->nu;
+
+    // assert - only use supported features
+    if (dims->nz != 0 || opts->output_z || opts->sens_algebraic)
+    {
+        printf("sim_erk_adaptive: DAEs are not supported by the adaptive ERK integrator\n");
+        exit(1);
+    }
+
+    int nf = opts->num_forw_sens;
+    if (!opts->sens_forw) nf = 0;
+
+    int nhess = (nf + 1) * nf / 2;
+    int nX = nx + nx * nf;
+
+    double *x0 = in->x;
+    double *u = in->u;
+    double *S_forw_in = in->S_forw;
+    double *S_adj_in = in->S_adj;
+    double T = in->T;
+
+    double *b_vec = opts->b_vec;
+
+    double *rhs_forw_in = workspace->rhs_forw_in;
+    double *adj_tmp = workspace->out_adj_tmp;
+
+    double *xn = out->xn;
+    double *S_forw_out = out->S_forw;
+    double *S_adj_out = out->S_adj;
+    double *S_hess_out = out->S_hess;
+
+    erk_model *model = in->model;
+
+    int store_traj = opts->sens_adj | opts->sens_hess;
+    int max_steps = opts->max_steps;
+    double *step_seq = mem->step_seq;
+
+    acados_timer timer;
+    double timing_ad = 0.0;
+
+    acados_tic(&timer);
+
+    /************************************************
+     * forward sweep
+     ************************************************/
+
+    double *x = workspace->out_forw_traj;
+    double *x_new = workspace->out_forw_traj + nX;
+    double *K = workspace->K_traj;
+    double *tmp_ptr;
+
+    // initialize integrator variables
+    for (i = 0; i < nx; i++) x[i] = x0[i];
+    if (opts->sens_forw)
+    {
+        if (in->identity_seed)
+        {
+            for (i = 0; i < nx * nf; i++) x[nx + i] = 0.0;
+            for (i = 0; i < nx; i++) x[nx + i * (nx + 1)] = 1.0;
+        }
+        else
+        {
+            for (i = 0; i < nx * nf; i++) x[nx + i] = S_forw_in[i];  // sensitivities
+        }
+    }
+    for (i = 0; i < nu; i++) rhs_forw_in[nX + i] = u[i];  // controls
+
+    // warm start: follow the step sequence of the last call until a step is rejected
+    int num_steps_prev = mem->num_steps_seq;
+    int follow_seq = num_steps_prev > 0 && mem->T_seq > 0.0;
+    double seq_scale = follow_seq ? T / mem->T_seq : 1.0;
+    double step = follow_seq ? seq_scale * step_seq[0] : T / opts->num_steps;
+
+    double step_min = 1e-10 * T;
+    double t = 0.0;
+    int num_acc = 0;
+    int num_rej = 0;
+    int stage0_valid = 0;  // K[0] = f(x) is still valid after a rejection and first-same-as-last
+    int status = ACADOS_SUCCESS;
+
+    double err, err_i, sc, fac;
+    int last, rejected_here = 0;
+
+    while (T - t > 1e-12 * T)
+    {
+        // the last step ends exactly at T, if the maximum number of steps is reached it is forced
+        last = 0;
+        if (step >= T - t || num_acc == max_steps - 1)
+        {
+            if (step < T - t)
+                status = ACADOS_MAXITER;
+            step = T - t;
+            last = 1;
+        }
+
+        sim_erk_adaptive_stages(model, opts, nx, nu, nX, step, x, K, rhs_forw_in,
+                                stage0_valid, &timing_ad);
+        stage0_valid = 1;
+
+        for (i = 0; i < nX; i++)
+            x_new[i] = x[i];
+        for (s = 0; s < ns; s++)
+        {
+            if (b_vec[s] != 0)
+                for (i = 0; i < nX; i++)
+                    x_new[i] += step * b_vec[s] * K[s * nX + i];
+        }
+
+        // local error estimate on the states, weighted rms norm
+        err = 0.0;
+        for (i = 0; i < nx; i++)
+        {
+            err_i = 0.0;
+            for (s = 0; s < ns; s++)
+                err_i += e_vec[s] * K[s * nX + i];
+            err_i *= step;
+            sc = opts->tol_abs + opts->tol_rel * fmax(fabs(x[i]), fabs(x_new[i]));
+            err += (err_i / sc) * (err_i / sc);
+        }
+        err = nx > 0 ? sqrt(err / nx) : 0.0;
+
+        // step size controller
+        fac = err > 0.0 ? 0.9 * pow(err, -1.0 / (order_emb + 1)) : 5.0;
+        fac = fac < 0.2 ? 0.2 : fac;
+        fac = fac > 5.0 ? 5.0 : fac;
+
+        if (err <= 1.0 || step <= step_min || (last && status == ACADOS_MAXITER))
+        {
+            // accept
+            step_seq[num_acc] = step;
+            num_acc++;
+            t = last ? T : t + step;
+
+            if (rejected_here && fac > 1.0)
+                fac = 1.0;
+            rejected_here = 0;
+
+            if (store_traj)
+            {
+                // keep the step in the trajectory for the adjoint sweep
+                x = x_new;
+                x_new += nX;
+                if (!last)
+                {
+                    // first same as last
+                    for (i = 0; i < nX; i++)
+                        K[ns * nX + i] = K[(ns - 1) * nX + i];
+                    K += ns * nX;
+                }
+            }
+            else
+            {
+                tmp_ptr = x;
+                x = x_new;
+                x_new = tmp_ptr;
+                // first same as last
+                for (i = 0; i < nX; i++)
+                    K[i] = K[(ns - 1) * nX + i];
+            }
+
+            if (follow_seq && num_acc < num_steps_prev)
+                step = seq_scale * step_seq[num_acc];
+            else
+                step *= fac;
+        }
+        else
+        {
+            // reject
+            num_rej++;
+            rejected_here = 1;
+            follow_seq = 0;
+            step *= fac;
+        }
+    }
+
+    mem->num_steps_seq = num_acc;
+    mem->T_seq = T;
+    mem->num_rejected = num_rej;
+
+    // store trajectory
+    for (i = 0; i < nx; i++) xn[i] = x[i];
+    // store forward sensitivities
+    if (opts->sens_forw)
+    {
+        if (out->S_forw_tran == NULL)
+        {
+            for (i = 0; i < nx * nf; i++) S_forw_out[i] = x[nx + i];
+        }
+        else
+        {
+            // [Su, Sx]^T directly from the trajectory
+            blasfeo_pack_tran_dmat(nx, nu, x + nx + nx * nx, nx, out->S_forw_tran, 0, 0);
+            blasfeo_pack_tran_dmat(nx, nx, x + nx, nx, out->S_forw_tran, nu, 0);
+        }
+    }
+
+    /************************************************
+     * adjoint sweep
+     ************************************************/
+
+    if (store_traj)
+    {
+        // initialize integrator variables
+        for (i = 0; i < nx; i++)
+            adj_tmp[i] = S_adj_in[i];
+        for (i = 0; i < nu; i++)
+            adj_tmp[nx + i] = 0.0;
+
+        int nForw = nx;
+        int nAdj = nx + nu;
+        if (opts->sens_hess)
+        {
+            nForw = nX;
+            nAdj = nx + nu + nhess;
+            for (i = 0; i < nhess; i++)
+                adj_tmp[nx + nu + i] = 0.0;
+        }
+
+        for (i = 0; i < nu; i++)
+            workspace->rhs_adj_in[nForw + nx + i] = u[i];
+
+        for (int istep = num_acc - 1; istep >= 0; istep--)
+        {
+            sim_erk_adaptive_adj_step(model, opts, nx, nu, nX, nForw, nAdj, step_seq[istep],
+                                      workspace->out_forw_traj + istep * nX,
+                                      workspace->K_traj + istep * ns * nX, workspace, &timing_ad);
+        }
+
+        // store adjoint sensitivities
+        for (i = 0; i < nx + nu; i++)
+            S_adj_out[i] = adj_tmp[i];
+        // store hessian
+        if (opts->sens_hess)
+        {
+            int count_upper = 0;
+            for (int jj = 0; jj < nx + nu; jj++)
+            {
+                for (int ii = jj; ii < nx + nu; ii++)
+                {
+                    S_hess_out[ii + nf * jj] = adj_tmp[nx + nu + count_upper];
+                    S_hess_out[jj + nf * ii] = adj_tmp[nx + nu + count_upper];
+                    count_upper++;
+                }
+            }
+        }
+    }
+
+    // store timings
+    out->info->CPUtime = acados_toc(&timer);
+    out->info->LAtime = 0.0;
+    out->info->ADtime = timing_ad;
+
+    return status;
+}
+
+
+
+void sim_erk_adaptive_config_initialize_default(void *config_)
+{
+    sim_config *config = config_;
+
+    config->opts_calculate_size = &sim_erk_opts_calculate_size;
+    config->opts_assign = &sim_erk_opts_assign;
+    config->opts_initialize_default = &sim_erk_adaptive_opts_initialize_default;
+    config->opts_update = &sim_erk_adaptive_opts_update;
+    config->opts_set = &sim_erk_opts_set;
+    config->memory_calculate_size = &sim_erk_adaptive_memory_calculate_size;
+    config->memory_assign = &sim_erk_adaptive_memory_assign;
+    config->memory_set = &sim_erk_adaptive_memory_set;
+    config->memory_set_to_zero = &sim_erk_adaptive_memory_set_to_zero;
+    config->workspace_calculate_size = &sim_erk_adaptive_workspace_calculate_size;
+    config->model_calculate_size = &sim_erk_model_calculate_size;
+    config->model_assign = &sim_erk_model_assign;
+    config->model_set = &sim_erk_model_set;
+    config->evaluate = &sim_erk_adaptive;
+    config->precompute = &sim_erk_adaptive_precompute;
+    config->config_initialize_default = &sim_erk_adaptive_config_initialize_default;
+    config->dims_calculate_size = &sim_erk_dims_calculate_size;
+    config->dims_assign = &sim_erk_dims_assign;
+    config->dims_set = &sim_erk_dims_set;
+    config->dims_get = &sim_erk_dims_get;
+
+    return;
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+
+#ifndef ACADOS_SIM_SIM_ERK_ADAPTIVE_H_
+#define ACADOS_SIM_SIM_ERK_ADAPTIVE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "acados/sim/sim_common.h"
+#include "acados/sim/sim_erk_integrator.h"
+#include "acados/utils/types.h"
+
+// embedded explicit Runge-Kutta pairs with local error control:
+// ns = 4: Bogacki-Shampine 3(2), ns = 7: Dormand-Prince 5(4);
+// dims and model are the ones of the ERK integrator
+
+
+
+typedef struct
+{
+    double *step_seq;   // accepted step sizes of the last call, warm start of the next one
+    int num_steps_seq;  // number of accepted steps of the last call, 0 for none
+    double T_seq;       // simulation time of the last call
+    int num_rejected;   // number of rejected steps in the last call
+} sim_erk_adaptive_memory;
+
+
+
+typedef struct
+{
+    double *rhs_forw_in;    // x + S + p
+    double *K_traj;         // (stages*nX) or (max_steps*stages*nX) for adj
+    double *out_forw_traj;  // 2*nX or (max_steps+1)*nX for adj
+
+    double *rhs_adj_in;
+    double *out_adj_tmp;
+    double *adj_traj;
+
+} sim_erk_adaptive_workspace;
+
+
+
+// opts
+void sim_erk_adaptive_opts_initialize_default(void *config, void *dims, void *opts_);
+//
+void sim_erk_adaptive_opts_update(void *config_, void *dims, void *opts_);
+
+// memory
+int sim_erk_adaptive_memory_calculate_size(void *config, void *dims, void *opts_);
+//
+void *sim_erk_adaptive_memory_assign(void *config, void *dims, void *opts_, void *raw_memory);
+//
+int sim_erk_adaptive_memory_set(void *config_, void *dims_, void *mem_, const char *field,
+                                void *value);
+//
+int sim_erk_adaptive_memory_set_to_zero(void *config_, void *dims_, void *opts_, void *mem_,
+                                        const char *field);
+
+// workspace
+int sim_erk_adaptive_workspace_calculate_size(void *config, void *dims, void *opts_);
+
+//
+int sim_erk_adaptive_precompute(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_,
+                                void *work_);
+//
+int sim_erk_adaptive(void *config, sim_in *in, sim_out *out, void *opts_, void *mem_,
+                     void *work_);
+//
+void sim_erk_adaptive_config_initialize_default(void *config);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif  // ACADOS_SIM_SIM_ERK_ADAPTIVE_H_
@@ -37,6 +37,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+// blasfeo
+#include "blasfeo/include/blasfeo_d_aux.h"
 // acados
 #include "acados/sim/sim_common.h"
 #include "acados/sim/sim_erk_integrator.h"
@@ -335,6 +337,8 @@ void sim_erk_opts_initialize_default(void *config_, void *dims_, void *opts_)
 
     opts->output_z = false;
     opts->sens_algebraic = false;
+
+    opts->checkpoint_steps = 0;
 }
 
 
@@ -472,6 +476,20 @@ int sim_erk_memory_set_to_zero(void *config_, void * dims_, void *opts_, void *m
  * workspace
  ************************************************/
 
+// number of integration steps whose stages are kept in the workspace for the adjoint sweep
+static int sim_erk_segment_steps(sim_opts *opts)
+{
+    int num_steps = opts->num_steps;
+    int checkpoint_steps = opts->checkpoint_steps;
+
+    if (checkpoint_steps <= 0 || checkpoint_steps >= num_steps)
+        return num_steps;
+
+    return checkpoint_steps;
+}
+
+
+
 int sim_erk_workspace_calculate_size(void *config_, void *dims_, void *opts_)
 {
     sim_opts *opts = opts_;
@@ -493,8 +511,13 @@ int sim_erk_workspace_calculate_size(void *config_, void *dims_, void *opts_)
 
     if (opts->sens_adj | opts->sens_hess)
     {
-        size += num_steps * ns * nX * sizeof(double);   // K_traj
-        size += (num_steps + 1) * nX * sizeof(double);  // out_forw_traj
+        int seg_steps = sim_erk_segment_steps(opts);
+        int num_seg = (num_steps + seg_steps - 1) / seg_steps;
+
+        size += seg_steps * ns * nX * sizeof(double);   // K_traj
+        size += (seg_steps + 1) * nX * sizeof(double);  // out_forw_traj
+        if (num_seg > 1)
+            size += num_seg * nX * sizeof(double);  // checkpoints
     }
     else
     {
@@ -549,13 +572,21 @@ static void *sim_erk_cast_workspace(void *config_, void *dims_, void *opts_, voi
 
     if (opts->sens_adj | opts->sens_hess)
     {
-        assign_and_advance_double(ns * num_steps * nX, &workspace->K_traj, &c_ptr);
-        assign_and_advance_double((num_steps + 1) * nX, &workspace->out_forw_traj, &c_ptr);
+        int seg_steps = sim_erk_segment_steps(opts);
+        int num_seg = (num_steps + seg_steps - 1) / seg_steps;
+
+        assign_and_advance_double(ns * seg_steps * nX, &workspace->K_traj, &c_ptr);
+        assign_and_advance_double((seg_steps + 1) * nX, &workspace->out_forw_traj, &c_ptr);
+        if (num_seg > 1)
+            assign_and_advance_double(num_seg * nX, &workspace->checkpoints, &c_ptr);
+        else
+            workspace->checkpoints = NULL;
     }
     else
     {
         assign_and_advance_double(ns * nX, &workspace->K_traj, &c_ptr);
         assign_and_advance_double(nX, &workspace->out_forw_traj, &c_ptr);
+        workspace->checkpoints = NULL;
     }
 
     if (opts->sens_hess) // && opts->sens_adj)
@@ -580,6 +611,89 @@ static void *sim_erk_cast_workspace(void *config_, void *dims_, void *opts_, voi
  * functions
  ************************************************/
 
+// one ERK step: computes the stages K (ns*nX) at x (nX) and overwrites x with the next state;
+// rhs_forw_in has to contain the controls after the first nX entries
+static void sim_erk_step(erk_model *model, sim_opts *opts, int nx, int nu, int nX, double step,
+                         double *x, double *K, double *rhs_forw_in, double *timing_ad)
+{
+    int ns = opts->ns;
+    double *A_mat = opts->A_mat;
+    double *b_vec = opts->b_vec;
+
+    int i, j, s;
+    double a, b;
+
+    ext_fun_arg_t ext_fun_type_in[4];
+    void *ext_fun_in[4];
+    ext_fun_arg_t ext_fun_type_out[3];
+    void *ext_fun_out[3];
+
+    acados_timer timer_ad;
+
+    for (s = 0; s < ns; s++)
+    {
+        for (i = 0; i < nX; i++)
+            rhs_forw_in[i] = x[i];
+        for (j = 0; j < s; j++)
+        {
+            a = A_mat[j * ns + s];
+            if (a != 0)
+            {
+                a *= step;
+                for (i = 0; i < nX; i++)
+                    rhs_forw_in[i] += a * K[j * nX + i];
+            }
+        }
+
+        acados_tic(&timer_ad);
+        if (opts->sens_forw)
+        {  // simulation + forward sensitivities
+            ext_fun_type_in[0] = COLMAJ;
+            ext_fun_in[0] = rhs_forw_in + 0;  // x: nx
+            ext_fun_type_in[1] = COLMAJ;
+            ext_fun_in[1] = rhs_forw_in + nx;  // Sx: nx*nx
+            ext_fun_type_in[2] = COLMAJ;
+            ext_fun_in[2] = rhs_forw_in + nx + nx * nx;  // Su: nx*nu
+            ext_fun_type_in[3] = COLMAJ;
+            ext_fun_in[3] = rhs_forw_in + nx + nx * nx + nx * nu;  // u: nu
+
+            ext_fun_type_out[0] = COLMAJ;
+            ext_fun_out[0] = K + s * nX + 0;  // fun: nx
+            ext_fun_type_out[1] = COLMAJ;
+            ext_fun_out[1] = K + s * nX + nx;  // Sx: nx*nx
+            ext_fun_type_out[2] = COLMAJ;
+            ext_fun_out[2] = K + s * nX + nx + nx * nx;  // Su: nx*nu
+
+            // forward VDE evaluation
+            model->expl_vde_for->evaluate(model->expl_vde_for, ext_fun_type_in, ext_fun_in,
+                                          ext_fun_type_out, ext_fun_out);
+        }
+        else
+        {  // simulation only
+            ext_fun_type_in[0] = COLMAJ;
+            ext_fun_in[0] = rhs_forw_in + 0;  // x: nx
+            ext_fun_type_in[1] = COLMAJ;
+            ext_fun_in[1] = rhs_forw_in + nx;  // u: nu
+
+            ext_fun_type_out[0] = COLMAJ;
+            ext_fun_out[0] = K + s * nX + 0;  // fun: nx
+
+            model->expl_ode_fun->evaluate(model->expl_ode_fun, ext_fun_type_in, ext_fun_in,
+                                          ext_fun_type_out, ext_fun_out);  // ODE evaluation
+        }
+        *timing_ad += acados_toc(&timer_ad);
+    }
+    for (s = 0; s < ns; s++)
+    {
+        b = step * b_vec[s];
+        for (i = 0; i < nX; i++) x[i] += b * K[s * nX + i];  // ERK step
+    }
+
+    return;
+}
+
+
+
 int sim_erk_precompute(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_,
                        void *work_)
 {
@@ -680,78 +794,52 @@ int sim_erk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
     for (i = 0; i < nx; i++) forw_traj[i] = x[i];  // x0
     if (opts->sens_forw)
     {
-        for (i = 0; i < nx * nf; i++) forw_traj[nx + i] = S_forw_in[i];  // sensitivities
+        if (in->identity_seed)
+        {
+            for (i = 0; i < nx * nf; i++) forw_traj[nx + i] = 0.0;
+            for (i = 0; i < nx; i++) forw_traj[nx + i * (nx + 1)] = 1.0;
+        }
+        else
+        {
+            for (i = 0; i < nx * nf; i++) forw_traj[nx + i] = S_forw_in[i];  // sensitivities
+        }
     }
     for (i = 0; i < nu; i++) rhs_forw_in[nX + i] = u[i];  // controls
 
+    // with checkpointing, the forward trajectory is stored in segments of seg_steps steps,
+    // only the state at the beginning of each segment is kept for the adjoint sweep
+    int seg_steps = num_steps;
+    if (opts->sens_adj | opts->sens_hess)
+        seg_steps = sim_erk_segment_steps(opts);
+    int num_seg = (num_steps + seg_steps - 1) / seg_steps;
+    double *checkpoints = workspace->checkpoints;
+
     for (istep = 0; istep < num_steps; istep++)
     {
         if (opts->sens_adj | opts->sens_hess)
         {
-            K_traj = workspace->K_traj + istep * ns * nX;
-            forw_traj = workspace->out_forw_traj + (istep + 1) * nX;
-            for (i = 0; i < nX; i++)
-                forw_traj[i] = forw_traj[i - nX];
-        }
+            int iseg = istep / seg_steps;
+            int jstep = istep - iseg * seg_steps;
 
-        for (s = 0; s < ns; s++)
-        {
-            for (i = 0; i < nX; i++)
-                rhs_forw_in[i] = forw_traj[i];
-            for (j = 0; j < s; j++)
+            if (jstep == 0 && iseg > 0)
             {
-                a = A_mat[j * ns + s];
-                if (a != 0)
-                {
-                    a *= step;
-                    for (i = 0; i < nX; i++)
-                        rhs_forw_in[i] += a * K_traj[j * nX + i];
-                }
-            }
-
-            acados_tic(&timer_ad);
-            if (opts->sens_forw)
-            {  // simulation + forward sensitivities
-                ext_fun_type_in[0] = COLMAJ;
-                ext_fun_in[0] = rhs_forw_in + 0;  // x: nx
-                ext_fun_type_in[1] = COLMAJ;
-                ext_fun_in[1] = rhs_forw_in + nx;  // Sx: nx*nx
-                ext_fun_type_in[2] = COLMAJ;
-                ext_fun_in[2] = rhs_forw_in + nx + nx * nx;  // Su: nx*nu
-                ext_fun_type_in[3] = COLMAJ;
-                ext_fun_in[3] = rhs_forw_in + nx + nx * nx + nx * nu;  // u: nu
-
-                ext_fun_type_out[0] = COLMAJ;
-                ext_fun_out[0] = K_traj + s * nX + 0;  // fun: nx
-                ext_fun_type_out[1] = COLMAJ;
-                ext_fun_out[1] = K_traj + s * nX + nx;  // Sx: nx*nx
-                ext_fun_type_out[2] = COLMAJ;
-                ext_fun_out[2] = K_traj + s * nX + nx + nx * nx;  // Su: nx*nu
-
-                // forward VDE evaluation
-                model->expl_vde_for->evaluate(model->expl_vde_for, ext_fun_type_in, ext_fun_in,
-                                              ext_fun_type_out, ext_fun_out);
+                // start new segment from the end of the previous one
+                for (i = 0; i < nX; i++)
+                    workspace->out_forw_traj[i] = workspace->out_forw_traj[seg_steps * nX + i];
             }
-            else
-            {  // simulation only
-                ext_fun_type_in[0] = COLMAJ;
-                ext_fun_in[0] = rhs_forw_in + 0;  // x: nx
-                ext_fun_type_in[1] = COLMAJ;
-                ext_fun_in[1] = rhs_forw_in + nx;  // u: nu
-
-                ext_fun_type_out[0] = COLMAJ;
-                ext_fun_out[0] = K_traj + s * nX + 0;  // fun: nx
-
-                model->expl_ode_fun->evaluate(model->expl_ode_fun, ext_fun_type_in, ext_fun_in,
-                                              ext_fun_type_out, ext_fun_out);  // ODE evaluation
+            if (jstep == 0 && num_seg > 1)
+            {
+                for (i = 0; i < nX; i++)
+                    checkpoints[iseg * nX + i] = workspace->out_forw_traj[i];
             }
-            timing_ad += acados_toc(&timer_ad);
-        }
-        for (s = 0; s < ns; s++)
-        {
-            b = step * b_vec[s];
-            for (i = 0; i < nX; i++) forw_traj[i] += b * K_traj[s * nX + i];  // ERK step
+
+            K_traj = workspace->K_traj + jstep * ns * nX;
+            forw_traj = workspace->out_forw_traj + (jstep + 1) * nX;
+            for (i = 0; i < nX; i++)
+                forw_traj[i] = forw_traj[i - nX];
         }
+
+        sim_erk_step(model, opts, nx, nu, nX, step, forw_traj, K_traj, rhs_forw_in, &timing_ad);
     }
 
     // store trajectory
@@ -759,7 +847,16 @@ int sim_erk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
     // store forward sensitivities
     if (opts->sens_forw)
     {
-        for (i = 0; i < nx * nf; i++) S_forw_out[i] = forw_traj[nx + i];
+        if (out->S_forw_tran == NULL)
+        {
+            for (i = 0; i < nx * nf; i++) S_forw_out[i] = forw_traj[nx + i];
+        }
+        else
+        {
+            // [Su, Sx]^T directly from the trajectory
+            blasfeo_pack_tran_dmat(nx, nu, forw_traj + nx + nx * nx, nx, out->S_forw_tran, 0, 0);
+            blasfeo_pack_tran_dmat(nx, nx, forw_traj + nx, nx, out->S_forw_tran, nu, 0);
+        }
     }
 
     /************************************************
@@ -791,9 +888,27 @@ int sim_erk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
 
         for (istep = num_steps - 1; istep >= 0; istep--)
         {
+            int iseg = istep / seg_steps;
+            int jstep = istep - iseg * seg_steps;
+
+            // recompute the stages of the segment from its checkpoint,
+            // the last segment is still in the workspace from the forward sweep
+            if (iseg < num_seg - 1 && jstep == seg_steps - 1)
+            {
+                for (i = 0; i < nX; i++)
+                    workspace->out_forw_traj[i] = checkpoints[iseg * nX + i];
+                for (j = 0; j < seg_steps; j++)
+                {
+                    forw_traj = workspace->out_forw_traj + (j + 1) * nX;
+                    for (i = 0; i < nX; i++)
+                        forw_traj[i] = forw_traj[i - nX];
+                    sim_erk_step(model, opts, nx, nu, nX, step, forw_traj,
+                                 workspace->K_traj + j * ns * nX, rhs_forw_in, &timing_ad);
+                }
+            }
 
-            K_traj = workspace->K_traj + istep * ns * nX;
-            forw_traj = workspace->out_forw_traj + istep*nX;
+            K_traj = workspace->K_traj + jstep * ns * nX;
+            forw_traj = workspace->out_forw_traj + jstep*nX;
 
             for (s = ns - 1; s >= 0; s--)
             {
@@ -81,8 +81,9 @@ typedef struct
 {
     double *rhs_forw_in;  // x + S + p
 
-    double *K_traj;         // (stages*nX) or (steps*stages*nX) for adj
-    double *out_forw_traj;  // S or (steps+1)*nX for adj
+    double *K_traj;         // (stages*nX) or (seg_steps*stages*nX) for adj
+    double *out_forw_traj;  // S or (seg_steps+1)*nX for adj
+    double *checkpoints;    // num_seg*nX, states at the beginning of each segment (checkpointing)
 
     double *rhs_adj_in;
     double *out_adj_tmp;
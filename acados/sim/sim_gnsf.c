@@ -1964,10 +1964,18 @@ int sim_gnsf(void *config, sim_in *in, sim_out *out, void *args, void *mem_, voi
     }
     else
     {
-        // pack seed into S_forw, permute
-        blasfeo_pack_dmat(nx, nx + nu, &in->S_forw[0], nx, S_forw, 0, 0);
-        blasfeo_drowpe(nx, ipiv_x, S_forw);
-        blasfeo_dcolpe(nx, ipiv_x, S_forw);
+        // pack seed into S_forw, permute (identity is invariant under the permutation)
+        if (in->identity_seed)
+        {
+            blasfeo_dgese(nx, nx + nu, 0.0, S_forw, 0, 0);
+            blasfeo_ddiare(nx, 1.0, S_forw, 0, 0);
+        }
+        else
+        {
+            blasfeo_pack_dmat(nx, nx + nu, &in->S_forw[0], nx, S_forw, 0, 0);
+            blasfeo_drowpe(nx, ipiv_x, S_forw);
+            blasfeo_dcolpe(nx, ipiv_x, S_forw);
+        }
 
         // initialize vv for first step, for further steps initialize with last vv value in step loop
         for (int i = 0; i < num_stages; i++)
@@ -2880,7 +2888,7 @@ int sim_gnsf(void *config, sim_in *in, sim_out *out, void *args, void *mem_, voi
 // blasfeo_print_exp_dmat(nx, nx+nu, S_forw_new, 0, 0);
         blasfeo_drowpei(nx, ipiv_x, S_forw_new);
         blasfeo_dcolpei(nx, ipiv_x, S_forw_new);
-        blasfeo_unpack_dmat(nx, nx + nu, S_forw_new, 0, 0, out->S_forw, nx);
+        sim_out_store_forw_sens(out, nx, nu, S_forw_new);
     }
     if (opts->sens_adj)
     {
@@ -36,6 +36,7 @@
 
 // standard
 #include <assert.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -286,6 +287,7 @@ void sim_irk_opts_initialize_default(void *config_, void *dims_, void *opts_)
     opts->sens_adj = false;
     opts->sens_hess = false;
     opts->jac_reuse = true;
+    opts->sparse_lu = false;
 
     if (dims->nz > 0) {
         opts->output_z = true;
@@ -333,11 +335,12 @@ int sim_irk_memory_calculate_size(void *config, void *dims_, void *opts_)
 {
     // typecast
     sim_irk_dims *dims = (sim_irk_dims *) dims_;
-    // sim_opts *opts = opts_;
+    sim_opts *opts = opts_;
 
     // necessary integers
     int nx = dims->nx;
     int nz = dims->nz;
+    int nK = (nx + nz) * opts->ns;
 
     int size = sizeof(sim_irk_memory);
 
@@ -345,6 +348,14 @@ int sim_irk_memory_calculate_size(void *config, void *dims_, void *opts_)
     size += nz * sizeof(double); // z
     size += 8;  // corresponds to memory alignment
 
+    if (opts->sparse_lu)
+    {
+        size += 2 * nK * sizeof(int);              // lu_rp, lu_cp
+        size += 2 * (nK + 1) * sizeof(int);        // lu_l_ptr, lu_u_ptr
+        size += nK * (nK - 1) * sizeof(int);       // lu_l_idx, lu_u_idx
+        size += nK * nK * sizeof(char);            // lu_pat
+    }
+
     return size;
 }
 
@@ -355,11 +366,13 @@ void *sim_irk_memory_assign(void *config, void *dims_, void *opts_, void *raw_me
 
     // typecast
     sim_irk_dims *dims = (sim_irk_dims *) dims_;
-    // sim_opts *opts = opts_;
+    sim_opts *opts = opts_;
 
     // necessary integers
     int nx = dims->nx;
     int nz = dims->nz;
+    int ns = opts->ns;
+    int nK = (nx + nz) * ns;
 
     // struct
     sim_irk_memory *mem = (sim_irk_memory *) c_ptr;
@@ -377,6 +390,34 @@ void *sim_irk_memory_assign(void *config, void *dims_, void *opts_, void *raw_me
     for (int ii = 0; ii < nz; ii++)
         mem->z[ii] = 0.0;
 
+    // sparse LU of dG_dK
+    mem->lu_nnz = 0;
+    if (opts->sparse_lu)
+    {
+        assign_and_advance_int(nK, &mem->lu_rp, &c_ptr);
+        assign_and_advance_int(nK, &mem->lu_cp, &c_ptr);
+        assign_and_advance_int(nK + 1, &mem->lu_l_ptr, &c_ptr);
+        assign_and_advance_int(nK * (nK - 1) / 2, &mem->lu_l_idx, &c_ptr);
+        assign_and_advance_int(nK + 1, &mem->lu_u_ptr, &c_ptr);
+        assign_and_advance_int(nK * (nK - 1) / 2, &mem->lu_u_idx, &c_ptr);
+        assign_and_advance_char(nK * nK, &mem->lu_pat, &c_ptr);
+
+        // equations and variables interleaved over the stages, which keeps the pattern banded
+        // for chain-like models; pivot k pairs equation v of stage s with variable v of stage s
+        for (int v = 0; v < nx + nz; v++)
+        {
+            for (int s = 0; s < ns; s++)
+            {
+                mem->lu_rp[v*ns+s] = s * (nx + nz) + v;
+                mem->lu_cp[v*ns+s] = v < nx ? s * nx + v : ns * nx + s * nz + v - nx;
+            }
+        }
+        for (int ii = 0; ii < nK * nK; ii++)
+            mem->lu_pat[ii] = 0;
+    }
+
+    assert((char *) raw_memory + sim_irk_memory_calculate_size(config, dims, opts) >= c_ptr);
+
     return mem;
 }
 
@@ -535,6 +576,13 @@ int sim_irk_workspace_calculate_size(void *config_, void *dims_, void *opts_)
     size += blasfeo_memsize_dmat(nx + nz, nu);      // df_du
     size += blasfeo_memsize_dmat(nx + nz, nz);      // df_dz
 
+    if (opts->sparse_lu)
+    {
+        size += blasfeo_memsize_dmat(nK, nK);           // dG_dK_bkp
+        size += nK * sizeof(double);                    // lu_tmp
+        size += (opts->sens_hess ? steps : 1) * sizeof(int);  // lu_sparse
+    }
+
     // if (opts->sens_algebraic){
     //     size += blasfeo_memsize_dmat(nx + nz, nx + nz);  // df_dxdotz
     //     size += blasfeo_memsize_dmat(nx + nz, nx + nu);  // dk0_dxu
@@ -627,6 +675,8 @@ static void *sim_irk_workspace_cast(void *config_, void *dims_, void *opts_, voi
     assign_and_advance_blasfeo_dmat_mem(nx + nz, nx, &workspace->df_dxdot, &c_ptr);
     assign_and_advance_blasfeo_dmat_mem(nx + nz, nu, &workspace->df_du, &c_ptr);
     assign_and_advance_blasfeo_dmat_mem(nx + nz, nz, &workspace->df_dz, &c_ptr);
+    if (opts->sparse_lu)
+        assign_and_advance_blasfeo_dmat_mem(nK, nK, &workspace->dG_dK_bkp, &c_ptr);
 
     // if (opts->sens_algebraic){
     //     assign_and_advance_blasfeo_dmat_mem(nx + nz, nx + nz, &workspace->df_dxdotz, &c_ptr);
@@ -650,6 +700,9 @@ static void *sim_irk_workspace_cast(void *config_, void *dims_, void *opts_, voi
         }
     }
 
+    if (opts->sparse_lu)
+        assign_and_advance_double(nK, &workspace->lu_tmp, &c_ptr);
+
     if (opts->sens_algebraic || opts->output_z){
         assign_and_advance_double(ns, &workspace->Z_work, &c_ptr);
         assign_and_advance_int((nx + nz), &workspace->ipiv_one_stage, &c_ptr);
@@ -661,6 +714,9 @@ static void *sim_irk_workspace_cast(void *config_, void *dims_, void *opts_, voi
         assign_and_advance_int(steps * nK, &workspace->ipiv, &c_ptr);
     }
 
+    if (opts->sparse_lu)
+        assign_and_advance_int(opts->sens_hess ? steps : 1, &workspace->lu_sparse, &c_ptr);
+
     // printf("\npointer moved - size calculated = %d bytes\n", c_ptr- (char*)raw_memory -
     // sim_irk_calculate_workspace_size(dims, opts_));
 
@@ -679,6 +735,190 @@ int sim_irk_precompute(void *config_, sim_in *in, sim_out *out, void *opts_, voi
 
 
 
+/************************************************
+ * sparse LU of dG_dK
+ ************************************************/
+
+// pivots below this fraction of the largest entry in their column of L fall back to the dense LU
+#define IRK_SPARSE_LU_PIV_TOL 1e-1
+
+// adds the nonzeros of dG_dK outside of the current pattern and, if any, repeats the symbolic
+// analysis (fill of the LU without pivoting, row lists of L and column lists of U)
+static void irk_sparse_lu_analyze(int nK, struct blasfeo_dmat *dG_dK, sim_irk_memory *mem)
+{
+    int *rp = mem->lu_rp;
+    int *cp = mem->lu_cp;
+    char *pat = mem->lu_pat;
+    int *l_ptr = mem->lu_l_ptr;
+    int *l_idx = mem->lu_l_idx;
+    int *u_ptr = mem->lu_u_ptr;
+    int *u_idx = mem->lu_u_idx;
+
+    int ii, jj, kk, nl, nu;
+    int changed = mem->lu_nnz == 0;
+
+    for (jj = 0; jj < nK; jj++)
+    {
+        for (ii = 0; ii < nK; ii++)
+        {
+            if (!pat[ii+jj*nK] && BLASFEO_DMATEL(dG_dK, rp[ii], cp[jj]) != 0.0)
+            {
+                pat[ii+jj*nK] = 1;
+                changed = 1;
+            }
+        }
+    }
+
+    if (!changed)
+        return;
+
+    // the diagonal is always kept, also if structurally zero
+    for (kk = 0; kk < nK; kk++)
+        pat[kk+kk*nK] = 1;
+
+    nl = 0;
+    nu = 0;
+    l_ptr[0] = 0;
+    u_ptr[0] = 0;
+    for (kk = 0; kk < nK; kk++)
+    {
+        for (ii = kk+1; ii < nK; ii++)
+        {
+            if (pat[ii+kk*nK])
+                l_idx[nl++] = ii;
+        }
+        for (jj = kk+1; jj < nK; jj++)
+        {
+            if (pat[kk+jj*nK])
+                u_idx[nu++] = jj;
+        }
+        l_ptr[kk+1] = nl;
+        u_ptr[kk+1] = nu;
+
+        // fill of the rank-one update of pivot kk
+        for (ii = l_ptr[kk]; ii < nl; ii++)
+            for (jj = u_ptr[kk]; jj < nu; jj++)
+                pat[l_idx[ii]+u_idx[jj]*nK] = 1;
+    }
+
+    mem->lu_nnz = nK + nl + nu;
+}
+
+
+
+// numerical LU without pivoting on the analyzed pattern, in place; returns 1 on a small pivot
+static int irk_sparse_lu_factorize(int nK, struct blasfeo_dmat *dG_dK, sim_irk_memory *mem)
+{
+    int *rp = mem->lu_rp;
+    int *cp = mem->lu_cp;
+    int *l_ptr = mem->lu_l_ptr;
+    int *l_idx = mem->lu_l_idx;
+    int *u_ptr = mem->lu_u_ptr;
+    int *u_idx = mem->lu_u_idx;
+
+    int ii, jj, kk, ri;
+    double piv, amax, lik;
+
+    for (kk = 0; kk < nK; kk++)
+    {
+        piv = BLASFEO_DMATEL(dG_dK, rp[kk], cp[kk]);
+        amax = fabs(piv);
+        for (ii = l_ptr[kk]; ii < l_ptr[kk+1]; ii++)
+            amax = fmax(amax, fabs(BLASFEO_DMATEL(dG_dK, rp[l_idx[ii]], cp[kk])));
+        if (piv == 0.0 || fabs(piv) < IRK_SPARSE_LU_PIV_TOL * amax)
+            return 1;
+
+        for (ii = l_ptr[kk]; ii < l_ptr[kk+1]; ii++)
+        {
+            ri = rp[l_idx[ii]];
+            lik = BLASFEO_DMATEL(dG_dK, ri, cp[kk]) / piv;
+            BLASFEO_DMATEL(dG_dK, ri, cp[kk]) = lik;
+            for (jj = u_ptr[kk]; jj < u_ptr[kk+1]; jj++)
+                BLASFEO_DMATEL(dG_dK, ri, cp[u_idx[jj]]) -= lik * BLASFEO_DMATEL(dG_dK, rp[kk], cp[u_idx[jj]]);
+        }
+    }
+
+    return 0;
+}
+
+
+
+// solves dG_dK * x = b (trans == 0) or dG_dK^T * x = b (trans == 1) with the sparse LU, in place
+static void irk_sparse_lu_solve(int nK, int trans, struct blasfeo_dmat *dG_dK, sim_irk_memory *mem,
+                                double *tmp, struct blasfeo_dvec *b, int bi)
+{
+    int *rp = mem->lu_rp;
+    int *cp = mem->lu_cp;
+    int *l_ptr = mem->lu_l_ptr;
+    int *l_idx = mem->lu_l_idx;
+    int *u_ptr = mem->lu_u_ptr;
+    int *u_idx = mem->lu_u_idx;
+
+    int ii, kk;
+
+    if (!trans)
+    {
+        // L*U*x = b in pivot order: rows rp, columns cp
+        for (kk = 0; kk < nK; kk++)
+            tmp[kk] = BLASFEO_DVECEL(b, bi+rp[kk]);
+        for (kk = 0; kk < nK; kk++)
+        {
+            for (ii = l_ptr[kk]; ii < l_ptr[kk+1]; ii++)
+                tmp[l_idx[ii]] -= BLASFEO_DMATEL(dG_dK, rp[l_idx[ii]], cp[kk]) * tmp[kk];
+        }
+        for (kk = nK-1; kk >= 0; kk--)
+        {
+            for (ii = u_ptr[kk]; ii < u_ptr[kk+1]; ii++)
+                tmp[kk] -= BLASFEO_DMATEL(dG_dK, rp[kk], cp[u_idx[ii]]) * tmp[u_idx[ii]];
+            tmp[kk] /= BLASFEO_DMATEL(dG_dK, rp[kk], cp[kk]);
+        }
+        for (kk = 0; kk < nK; kk++)
+            BLASFEO_DVECEL(b, bi+cp[kk]) = tmp[kk];
+    }
+    else
+    {
+        // U^T*L^T*x = b in pivot order: rows cp, columns rp
+        for (kk = 0; kk < nK; kk++)
+            tmp[kk] = BLASFEO_DVECEL(b, bi+cp[kk]);
+        for (kk = 0; kk < nK; kk++)
+        {
+            tmp[kk] /= BLASFEO_DMATEL(dG_dK, rp[kk], cp[kk]);
+            for (ii = u_ptr[kk]; ii < u_ptr[kk+1]; ii++)
+                tmp[u_idx[ii]] -= BLASFEO_DMATEL(dG_dK, rp[kk], cp[u_idx[ii]]) * tmp[kk];
+        }
+        for (kk = nK-1; kk >= 0; kk--)
+        {
+            for (ii = l_ptr[kk]; ii < l_ptr[kk+1]; ii++)
+                tmp[kk] -= BLASFEO_DMATEL(dG_dK, rp[l_idx[ii]], cp[kk]) * tmp[l_idx[ii]];
+        }
+        for (kk = 0; kk < nK; kk++)
+            BLASFEO_DVECEL(b, bi+rp[kk]) = tmp[kk];
+    }
+}
+
+
+
+// factorizes dG_dK_ss, with the sparse LU if enabled and numerically safe, else with the dense one
+static void irk_factorize(sim_opts *opts, sim_irk_memory *mem, sim_irk_workspace *work, int nK,
+                          struct blasfeo_dmat *dG_dK_ss, int *ipiv_ss, int *lu_sparse_ss)
+{
+    if (opts->sparse_lu)
+    {
+        irk_sparse_lu_analyze(nK, dG_dK_ss, mem);
+        blasfeo_dgecp(nK, nK, dG_dK_ss, 0, 0, &work->dG_dK_bkp, 0, 0);
+        if (!irk_sparse_lu_factorize(nK, dG_dK_ss, mem))
+        {
+            *lu_sparse_ss = 1;
+            return;
+        }
+        blasfeo_dgecp(nK, nK, &work->dG_dK_bkp, 0, 0, dG_dK_ss, 0, 0);
+        *lu_sparse_ss = 0;
+    }
+    blasfeo_dgetrf_rp(nK, nK, dG_dK_ss, 0, 0, dG_dK_ss, 0, 0, ipiv_ss);
+}
+
+
+
 /************************************************
  * integrator
  ************************************************/
@@ -756,7 +996,6 @@ int sim_irk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
     struct blasfeo_dmat *Hess = &workspace->Hess;
 
     double *x_out = out->xn;
-    double *S_forw_out = out->S_forw;
     double *S_adj_out = out->S_adj;
     double *S_algebraic = out->S_algebraic;
 
@@ -769,6 +1008,8 @@ int sim_irk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
     struct blasfeo_dmat *dK_dxu_ss;
     struct blasfeo_dmat *S_forw_ss = S_forw;
     int *ipiv_ss;
+    int *lu_sparse_ss = NULL;
+    int lu_dense = 0;  // used as lu_sparse_ss if !opts->sparse_lu
 
 
 	// SET FUNCTION IN- & OUTPUT TYPES
@@ -866,7 +1107,15 @@ int sim_irk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
 
     // pack
     blasfeo_pack_dvec(nx, in->x, xn, 0);
-    blasfeo_pack_dmat(nx, nx + nu, in->S_forw, nx, S_forw, 0, 0);
+    if (in->identity_seed)
+    {
+        blasfeo_dgese(nx, nx + nu, 0.0, S_forw, 0, 0);
+        blasfeo_ddiare(nx, 1.0, S_forw, 0, 0);
+    }
+    else
+    {
+        blasfeo_pack_dmat(nx, nx + nu, in->S_forw, nx, S_forw, 0, 0);
+    }
     blasfeo_pack_dvec(nx + nu, in->S_adj, lambda, 0); // TODO set to zero u-part ???
 
     // initialize integration variables
@@ -902,6 +1151,7 @@ int sim_irk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
             dG_dK_ss = &dG_dK[ss];
             dG_dxu_ss = &dG_dxu[ss];
             ipiv_ss = &ipiv[ss*nK];
+            lu_sparse_ss = opts->sparse_lu ? &workspace->lu_sparse[ss] : &lu_dense;
             S_forw_ss = &S_forw[ss+1];
             // copy current S_forw into S_forw_ss
             blasfeo_dgecp(nx, nx + nu, &S_forw[ss], 0, 0, S_forw_ss, 0, 0);
@@ -912,6 +1162,8 @@ int sim_irk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
                 for (int ii = 0; ii < nK; ii++) {
                     ipiv_ss[ii] = ipiv[nK*(ss-1) + ii];
                 }
+                if (opts->sparse_lu)
+                    *lu_sparse_ss = workspace->lu_sparse[ss-1];
             }
         }
         else
@@ -920,6 +1172,7 @@ int sim_irk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
             dG_dK_ss = dG_dK;
             dG_dxu_ss = dG_dxu;
             ipiv_ss = ipiv;
+            lu_sparse_ss = opts->sparse_lu ? workspace->lu_sparse : &lu_dense;
             S_forw_ss = S_forw;
         }
 
@@ -993,19 +1246,26 @@ int sim_irk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
             // blasfeo_print_exp_dmat((nz+nx) *ns, (nz+nx) *ns, dG_dK_ss, 0, 0);
             if ((opts->jac_reuse && (ss == 0) && (iter == 0)) || (!opts->jac_reuse))
             {
-                blasfeo_dgetrf_rp(nK, nK, dG_dK_ss, 0, 0, dG_dK_ss, 0, 0, ipiv_ss);
+                irk_factorize(opts, mem, workspace, nK, dG_dK_ss, ipiv_ss, lu_sparse_ss);
             }
 
-            // permute also the r.h.s
-            blasfeo_dvecpe(nK, ipiv_ss, rG, 0);
+            if (*lu_sparse_ss)
+            {
+                irk_sparse_lu_solve(nK, 0, dG_dK_ss, mem, workspace->lu_tmp, rG, 0);
+            }
+            else
+            {
+                // permute also the r.h.s
+                blasfeo_dvecpe(nK, ipiv_ss, rG, 0);
 
-            // solve dG_dK_ss * y = rG, dG_dK_ss on the (l)eft, (l)ower-trian, (n)o-trans
-            // (u)nit trian
-            blasfeo_dtrsv_lnu(nK, dG_dK_ss, 0, 0, rG, 0, rG, 0);
+                // solve dG_dK_ss * y = rG, dG_dK_ss on the (l)eft, (l)ower-trian, (n)o-trans
+                // (u)nit trian
+                blasfeo_dtrsv_lnu(nK, dG_dK_ss, 0, 0, rG, 0, rG, 0);
 
-            // solve dG_dK_ss * x = rG, dG_dK_ss on the (l)eft, (u)pper-trian, (n)o-trans
-            // (n)o unit trian , and store x in rG
-            blasfeo_dtrsv_unn(nK, dG_dK_ss, 0, 0, rG, 0, rG, 0);
+                // solve dG_dK_ss * x = rG, dG_dK_ss on the (l)eft, (u)pper-trian, (n)o-trans
+                // (n)o unit trian , and store x in rG
+                blasfeo_dtrsv_unn(nK, dG_dK_ss, 0, 0, rG, 0, rG, 0);
+            }
 
             timing_la += acados_toc(&timer_la);
 
@@ -1066,7 +1326,7 @@ int sim_irk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
 
             // factorize dG_dK_ss
             acados_tic(&timer_la);
-            blasfeo_dgetrf_rp(nK, nK, dG_dK_ss, 0, 0, dG_dK_ss, 0, 0, ipiv_ss);
+            irk_factorize(opts, mem, workspace, nK, dG_dK_ss, ipiv_ss, lu_sparse_ss);
             timing_la += acados_toc(&timer_la);
 
             // obtain dK_dxu
@@ -1085,9 +1345,21 @@ int sim_irk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
             }
             // solve linear system
             acados_tic(&timer_la);
-            blasfeo_drowpe(nK, ipiv_ss, dK_dxu_ss);
-            blasfeo_dtrsm_llnu(nK, nx + nu, 1.0, dG_dK_ss, 0, 0, dK_dxu_ss, 0, 0, dK_dxu_ss, 0, 0);
-            blasfeo_dtrsm_lunn(nK, nx + nu, 1.0, dG_dK_ss, 0, 0, dK_dxu_ss, 0, 0, dK_dxu_ss, 0, 0);
+            if (*lu_sparse_ss)
+            {
+                for (int jj = 0; jj < nx + nu; jj++)
+                {
+                    blasfeo_dcolex(nK, dK_dxu_ss, 0, jj, rG, 0);
+                    irk_sparse_lu_solve(nK, 0, dG_dK_ss, mem, workspace->lu_tmp, rG, 0);
+                    blasfeo_dcolin(nK, rG, 0, dK_dxu_ss, 0, jj);
+                }
+            }
+            else
+            {
+                blasfeo_drowpe(nK, ipiv_ss, dK_dxu_ss);
+                blasfeo_dtrsm_llnu(nK, nx + nu, 1.0, dG_dK_ss, 0, 0, dK_dxu_ss, 0, 0, dK_dxu_ss, 0, 0);
+                blasfeo_dtrsm_lunn(nK, nx + nu, 1.0, dG_dK_ss, 0, 0, dK_dxu_ss, 0, 0, dK_dxu_ss, 0, 0);
+            }
             timing_la += acados_toc(&timer_la);
 
             // printf("dK_dxu (solved) = (IRK, ss = %d) \n", ss);
@@ -1219,7 +1491,7 @@ int sim_irk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
     blasfeo_unpack_dvec(nx, xn, 0, x_out);
 
     if  ( opts->sens_forw || opts->sens_hess )
-        blasfeo_unpack_dmat(nx, nx + nu, S_forw_ss, 0, 0, S_forw_out, nx);
+        sim_out_store_forw_sens(out, nx, nu, S_forw_ss);
 
 /*****************************************************************************
 * Backward Sweep 
@@ -1236,6 +1508,7 @@ int sim_irk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
                 dG_dK_ss = &dG_dK[ss];
                 dG_dxu_ss = &dG_dxu[ss];
                 ipiv_ss = &ipiv[ss*nK];
+                lu_sparse_ss = opts->sparse_lu ? &workspace->lu_sparse[ss] : &lu_dense;
                 S_forw_ss = &S_forw[ss];
                 // lambdaK_ss = &lambdaK[ss];
                 // lambda_ss_old = &lambda[ss+1];
@@ -1247,6 +1520,7 @@ int sim_irk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
                 dG_dK_ss = dG_dK;
                 dG_dxu_ss = dG_dxu;
                 ipiv_ss = ipiv;
+                lu_sparse_ss = opts->sparse_lu ? workspace->lu_sparse : &lu_dense;
             }
             impl_ode_xdot_in.x = &K_traj[ss];              // use K values of step ss
             impl_ode_z_in.x = &K_traj[ss];                 // use Z values of step ss
@@ -1301,7 +1575,7 @@ int sim_irk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
 
                 // factorize dG_dK_ss - already done in forw if hessian is active
                 acados_tic(&timer_la);
-                blasfeo_dgetrf_rp(nK, nK, dG_dK_ss, 0, 0, dG_dK_ss, 0, 0, ipiv_ss);
+                irk_factorize(opts, mem, workspace, nK, dG_dK_ss, ipiv_ss, lu_sparse_ss);
                 timing_la += acados_toc(&timer_la);
 
             }  // end if( !opts->sens_hess )
@@ -1317,9 +1591,16 @@ int sim_irk(void *config_, sim_in *in, sim_out *out, void *opts_, void *mem_, vo
             acados_tic(&timer_la);
             // dG_dK_ss - already factorized
             // solve linear system
-            blasfeo_dtrsv_utn(nK, dG_dK_ss, 0, 0, lambdaK, 0, lambdaK, 0);
-            blasfeo_dtrsv_ltu(nK, dG_dK_ss, 0, 0, lambdaK, 0, lambdaK, 0);
-            blasfeo_dvecpei(nK, ipiv_ss, lambdaK, 0);
+            if (*lu_sparse_ss)
+            {
+                irk_sparse_lu_solve(nK, 1, dG_dK_ss, mem, workspace->lu_tmp, lambdaK, 0);
+            }
+            else
+            {
+                blasfeo_dtrsv_utn(nK, dG_dK_ss, 0, 0, lambdaK, 0, lambdaK, 0);
+                blasfeo_dtrsv_ltu(nK, dG_dK_ss, 0, 0, lambdaK, 0, lambdaK, 0);
+                blasfeo_dvecpei(nK, ipiv_ss, lambdaK, 0);
+            }
             timing_la += acados_toc(&timer_la);
 
             // update adjoint sensitivities lambda 
@@ -121,6 +121,11 @@ typedef struct
     //              pivot vectors for dG_dxu
     int *ipiv;  // index of pivot vector
 
+    // only allocated if (opts->sparse_lu)
+    int *lu_sparse;  // 1 if dG_dK of the step is factorized by the sparse LU (1 or num_steps)
+    double *lu_tmp;  // permuted right hand side (ns * (nx + nz))
+    struct blasfeo_dmat dG_dK_bkp;  // copy of dG_dK, to fall back to the dense LU
+
     // xn_traj, K_traj only available if( opts->sens_adj || opts->sens_hess )
     struct blasfeo_dvec *xn_traj;  // xn trajectory
     struct blasfeo_dvec *K_traj;   // K trajectory
@@ -141,6 +146,17 @@ typedef struct
     double *xdot;  // xdot[NX] - initialization for state derivatives k within the integrator
     double *z;     // z[NZ] - initialization for algebraic variables z
 
+    // symbolic analysis of the sparse LU of dG_dK, reused across steps and calls
+    // (only allocated if opts->sparse_lu)
+    int *lu_rp;     // row of dG_dK of each pivot (ns * (nx + nz))
+    int *lu_cp;     // column of dG_dK of each pivot (ns * (nx + nz))
+    char *lu_pat;   // pattern of L+U in pivot order, column-major
+    int *lu_l_ptr;  // L(:,k) below the diagonal: rows lu_l_idx[lu_l_ptr[k] ... lu_l_ptr[k+1]-1]
+    int *lu_l_idx;
+    int *lu_u_ptr;  // U(k,:) right of the diagonal: columns lu_u_idx[lu_u_ptr[k] ... lu_u_ptr[k+1]-1]
+    int *lu_u_idx;
+    int lu_nnz;     // number of nonzeros of L+U, 0 before the first analysis
+
 } sim_irk_memory;
 
 
@@ -650,7 +650,6 @@ int sim_lifted_irk(void *config_, sim_in *in, sim_out *out, void *opts_, void *m
     struct blasfeo_dvec *w = workspace->w;
 
     double *x_out = out->xn;
-    double *S_forw_out = out->S_forw;
 
     struct blasfeo_dvec_args ext_fun_in_K;
 
@@ -681,7 +680,18 @@ int sim_lifted_irk(void *config_, sim_in *in, sim_out *out, void *opts_, void *m
     blasfeo_dvecse(nx * ns, 0.0, rG, 0);
 
     // TODO(dimitris): shouldn't this be NF instead of nx+nu??
-    if (update_sens) blasfeo_pack_dmat(nx, nx + nu, S_forw_in, nx, S_forw, 0, 0);
+    if (update_sens)
+    {
+        if (in->identity_seed)
+        {
+            blasfeo_dgese(nx, nx + nu, 0.0, S_forw, 0, 0);
+            blasfeo_ddiare(nx, 1.0, S_forw, 0, 0);
+        }
+        else
+        {
+            blasfeo_pack_dmat(nx, nx + nu, S_forw_in, nx, S_forw, 0, 0);
+        }
+    }
 
     blasfeo_dvecse(nx * ns, 0.0, rG, 0);
     blasfeo_pack_dvec(nx, x, xn, 0);
@@ -870,7 +880,9 @@ int sim_lifted_irk(void *config_, sim_in *in, sim_out *out, void *opts_, void *m
     // extract output
     blasfeo_unpack_dvec(nx, xn_out, 0, x_out);
 
-    blasfeo_unpack_dmat(nx, nx + nu, S_forw, 0, 0, S_forw_out, nx);
+    // the sensitivities are always propagated, but only stored if requested
+    if (opts->sens_forw)
+        sim_out_store_forw_sens(out, nx, nu, S_forw);
 
     out->info->CPUtime = acados_toc(&timer);
     out->info->ADtime = timing_ad;
@@ -32,10 +32,18 @@
  */
 
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE  // madvise, MADV_HUGEPAGE
+#endif
+
 // external
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/mman.h>
+#endif
 
 // blasfeo
 #include "blasfeo/include/blasfeo_d_aux.h"
@@ -87,6 +95,88 @@ void *acados_calloc(size_t nitems, size_t size)
     return ptr;
 }
 
+
+
+#define ACADOS_PAGE_SIZE 4096
+
+void *acados_arena_calloc(size_t size, size_t alignment, int flags, void **raw_ptr)
+{
+    // over-allocate to align by hand, posix_memalign is not available everywhere
+    char *raw = calloc(size + alignment, 1);
+    *raw_ptr = raw;
+    if (raw == NULL)
+        return NULL;
+
+    char *ptr = raw;
+    align_char_to(alignment, &ptr);
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (flags & ACADOS_ARENA_HUGEPAGES)
+    {
+        // requires ptr to be page aligned, only whole huge pages inside the block are backed
+        if (madvise(ptr, size, MADV_HUGEPAGE))
+            printf("\nwarning: acados_arena_calloc: madvise(MADV_HUGEPAGE) failed\n");
+    }
+#endif
+
+    if (flags & ACADOS_ARENA_PREFAULT)
+    {
+        // calloc may map zero pages lazily, write to every page to fault it in now
+        volatile char *v_ptr = ptr;
+        for (size_t ii = 0; ii < size; ii += ACADOS_PAGE_SIZE)
+            v_ptr[ii] = 0;
+    }
+
+#if defined(__linux__) || defined(__APPLE__)
+    if (flags & ACADOS_ARENA_MLOCK)
+    {
+        if (mlock(ptr, size))
+            printf("\nwarning: acados_arena_calloc: mlock failed, check RLIMIT_MEMLOCK\n");
+    }
+#endif
+
+    return ptr;
+}
+
+
+
+void acados_arena_free(void *raw_ptr, void *ptr, size_t size, int flags)
+{
+#if defined(__linux__) || defined(__APPLE__)
+    if ((flags & ACADOS_ARENA_MLOCK) && ptr != NULL)
+        munlock(ptr, size);
+#endif
+    free(raw_ptr);
+}
+
+
+
+void acados_static_mem_init(acados_static_mem *mem, void *buffer, size_t size)
+{
+    mem->buffer = buffer;
+    mem->size = size;
+    mem->used = 0;
+}
+
+
+
+void *acados_static_mem_calloc(acados_static_mem *mem, size_t size)
+{
+    // align relative to the absolute address, the buffer itself may be less aligned; computed
+    // on offsets, so that no pointer past the end of the buffer is formed once it is exhausted
+    size_t addr = (size_t) mem->buffer + mem->used;
+    size_t offset = mem->used + (64 - addr % 64) % 64;
+
+    // keep counting when exhausted, so that the required size can be read back
+    mem->used = offset + size;
+    if (offset > mem->size || size > mem->size - offset)
+        return NULL;
+
+    char *ptr = mem->buffer + offset;
+    memset(ptr, 0, size);
+    return ptr;
+}
+
 void assign_and_advance_double_ptrs(int n, double ***v, char **ptr)
 {
 #ifndef WINDOWS_SKIP_PTR_ALIGNMENT_CHECK
@@ -71,6 +71,33 @@ void *acados_malloc(size_t nitems, size_t size);
 // uses always calloc
 void *acados_calloc(size_t nitems, size_t size);
 
+// flags for acados_arena_calloc
+#define ACADOS_ARENA_HUGEPAGES 1  // advise the kernel to back the block with huge pages (linux only)
+#define ACADOS_ARENA_PREFAULT 2   // touch all pages at allocation time
+#define ACADOS_ARENA_MLOCK 4      // lock the block in RAM (POSIX only)
+
+// allocate zeroed block of size bytes aligned to alignment bytes;
+// the returned raw pointer has to be passed to acados_arena_free
+void *acados_arena_calloc(size_t size, size_t alignment, int flags, void **raw_ptr);
+
+// free block allocated with acados_arena_calloc
+void acados_arena_free(void *raw_ptr, void *ptr, size_t size, int flags);
+
+// linear allocator on a caller-provided buffer (e.g. a static array), for builds without heap
+typedef struct
+{
+    char *buffer;
+    size_t size;  // capacity of buffer in bytes
+    size_t used;  // bytes consumed so far, including alignment padding
+} acados_static_mem;
+
+// initialize allocator on buffer of size bytes
+void acados_static_mem_init(acados_static_mem *mem, void *buffer, size_t size);
+
+// take zeroed block of size bytes aligned to 64 bytes from the buffer;
+// returns NULL if the buffer is exhausted (used then holds the required size)
+void *acados_static_mem_calloc(acados_static_mem *mem, size_t size);
+
 // allocate vector of pointers to vectors of doubles and advance pointer
 void assign_and_advance_double_ptrs(int n, double ***v, char **ptr);
 
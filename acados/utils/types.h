@@ -67,6 +67,8 @@ enum return_values
     ACADOS_MINSTEP,
     ACADOS_QP_FAILURE,
     ACADOS_READY,
+    ACADOS_TIMEOUT,
+    ACADOS_CANCELLED,
 };
 
 
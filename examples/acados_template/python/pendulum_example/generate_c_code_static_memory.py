@@ -0,0 +1,166 @@
+#
+# Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+# Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+# Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+# Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+#
+# This file is part of acados.
+#
+# The 2-Clause BSD License
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+# this list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation
+# and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.;
+#
+
+# builds the pendulum solver once on the heap and once with static memory
+# (solver_config.static_memory) and checks that both give the same closed loop
+
+from acados_template import *
+import acados_template as at
+from export_ode_model import *
+import numpy as np
+import scipy.linalg
+from ctypes import *
+
+Tf = 2.0
+N = 50
+Fmax = 2.0
+
+def create_solver(static_memory):
+    # generate_solver modifies the ocp, so every build gets a fresh one
+    ocp = acados_ocp_nlp()
+
+    # export model, the static build needs its own name for the generated library
+    model = export_ode_model()
+    if static_memory:
+        model.name = model.name + '_static'
+
+    # set model_name
+    ocp.model_name = model.name
+
+    nx = model.x.size()[0]
+    nu = model.u.size()[0]
+    ny = nx + nu
+    ny_e = nx
+
+    # set ocp_nlp_dimensions
+    nlp_dims     = ocp.dims
+    nlp_dims.nx  = nx
+    nlp_dims.ny  = ny
+    nlp_dims.ny_e = ny_e
+    nlp_dims.nbx = 0
+    nlp_dims.nbu = nu
+    nlp_dims.nu  = nu
+    nlp_dims.N   = N
+
+    # set weighting matrices
+    nlp_cost = ocp.cost
+    Q = np.eye(4)
+    Q[0,0] = 1e0
+    Q[1,1] = 1e2
+    Q[2,2] = 1e-3
+    Q[3,3] = 1e-2
+
+    R = np.eye(1)
+    R[0,0] = 1e0
+
+    nlp_cost.W = scipy.linalg.block_diag(Q, R)
+
+    Vx = np.zeros((ny, nx))
+    Vx[0,0] = 1.0
+    Vx[1,1] = 1.0
+    Vx[2,2] = 1.0
+    Vx[3,3] = 1.0
+
+    nlp_cost.Vx = Vx
+
+    Vu = np.zeros((ny, nu))
+    Vu[4,0] = 1.0
+    nlp_cost.Vu = Vu
+
+    nlp_cost.W_e = Q
+
+    Vx_e = np.zeros((ny_e, nx))
+    Vx_e[0,0] = 1.0
+    Vx_e[1,1] = 1.0
+    Vx_e[2,2] = 1.0
+    Vx_e[3,3] = 1.0
+
+    nlp_cost.Vx_e = Vx_e
+
+    nlp_cost.yref  = np.zeros((ny, ))
+    nlp_cost.yref_e = np.zeros((ny_e, ))
+
+    # setting bounds
+    nlp_con = ocp.constraints
+    nlp_con.lbu = np.array([-Fmax])
+    nlp_con.ubu = np.array([+Fmax])
+    nlp_con.x0 = np.array([0.0, 3.14, 0.0, 0.0])
+    nlp_con.idxbu = np.array([0])
+
+    # set QP solver
+    ocp.solver_config.qp_solver = 'FULL_CONDENSING_QPOASES'
+    ocp.solver_config.hessian_approx = 'GAUSS_NEWTON'
+    ocp.solver_config.integrator_type = 'ERK'
+
+    # set prediction horizon
+    ocp.solver_config.tf = Tf
+    ocp.solver_config.nlp_solver_type = 'SQP'
+
+    # place all solver memory in one static buffer, its size is measured at generation time
+    ocp.solver_config.static_memory = static_memory
+
+    # set header path
+    ocp.acados_include_path  = '/usr/local/include'
+    ocp.acados_lib_path      = '/usr/local/lib'
+
+    return generate_solver(model, ocp, json_file = 'acados_ocp_' + model.name + '.json')
+
+heap_solver = create_solver(False)
+static_solver = create_solver(True)
+
+Nsim = 100
+nx = 4
+nu = 1
+
+simX = np.ndarray((2, Nsim, nx))
+simU = np.ndarray((2, Nsim, nu))
+
+for k, acados_solver in enumerate([heap_solver, static_solver]):
+    for i in range(Nsim):
+        status = acados_solver.solve()
+
+        # get solution
+        simX[k,i,:] = acados_solver.get(0, "x")
+        simU[k,i,:] = acados_solver.get(0, "u")
+
+        # update initial condition
+        x0 = acados_solver.get(1, "x")
+
+        acados_solver.set(0, "lbx", x0)
+        acados_solver.set(0, "ubx", x0)
+
+# the same code runs on differently placed memory
+max_diff = max(np.max(np.abs(simX[1] - simX[0])), np.max(np.abs(simU[1] - simU[0])))
+print('max difference static vs heap memory: {}'.format(max_diff))
+if max_diff > 1e-10:
+    raise Exception('static memory build differs from heap build by {}.\n\nExiting.'.format(max_diff))
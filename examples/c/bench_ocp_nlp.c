@@ -0,0 +1,663 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+// standard
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// blasfeo
+#include "blasfeo/include/blasfeo_d_aux_ext_dep.h"
+
+// acados
+#include "acados_c/external_function_interface.h"
+#include "acados_c/ocp_nlp_interface.h"
+#include "acados/utils/mem.h"
+#include "acados/utils/timing.h"
+#include "acados/utils/types.h"
+
+// model
+#include "examples/c/chain_model/chain_model.h"
+#include "examples/c/implicit_chain_model/chain_model_impl.h"
+
+// x0, xN (3 free masses)
+#include "examples/c/chain_model/x0_nm4.c"
+#include "examples/c/chain_model/xN_nm4.c"
+
+/*
+ * Closed-loop latency benchmark of the ocp_nlp solver on the chain model.
+ *
+ * For every point of the sweep (horizon length, integrator and number of stages,
+ * QP solver, partial condensing horizon N2, number of threads) the solver is run
+ * in closed loop for NSAMPLES samples and the latency distribution of each phase
+ * (linearization, regularization, QP solution, total) is reported as p50/p99/max.
+ *
+ * usage: bench_ocp_nlp [num_samples]
+ */
+
+#define NMF 3  // number of free masses
+#define NX (6*NMF)
+#define NU 3
+#define TF 3.75
+
+#define NSAMPLES 2000
+#define RESET_PERIOD 200  // re-excite the plant every RESET_PERIOD samples
+
+
+
+typedef struct
+{
+    int N;
+    sim_solver_t sim_solver;
+    int ns;  // number of integrator stages
+    ocp_qp_solver_t qp_solver;
+    int cond_N;  // partial condensing horizon
+    int num_threads;
+} bench_case;
+
+
+
+typedef struct
+{
+    double *time_lin;
+    double *time_reg;
+    double *time_qp_sol;
+    double *time_tot;
+    int num_samples;
+    int num_failures;
+} bench_samples;
+
+
+
+static int compare_double(const void *a_, const void *b_)
+{
+    double a = *(const double *) a_;
+    double b = *(const double *) b_;
+    return (a > b) - (a < b);
+}
+
+
+
+// sorts the samples in place and returns the p-th percentile (nearest rank)
+static double sorted_percentile(int n, double *samples, double p)
+{
+    qsort(samples, n, sizeof(double), compare_double);
+
+    int idx = (int) ceil(p * n) - 1;
+    idx = idx < 0 ? 0 : idx;
+    idx = idx >= n ? n - 1 : idx;
+
+    return samples[idx];
+}
+
+
+
+static void print_phase(const char *name, int n, double *samples)
+{
+    double p50 = sorted_percentile(n, samples, 0.50);
+    double p99 = sorted_percentile(n, samples, 0.99);
+    double max = samples[n - 1];
+
+    printf("    %-8s p50 %9.3f ms   p99 %9.3f ms   max %9.3f ms\n", name, p50*1e3, p99*1e3,
+           max*1e3);
+}
+
+
+
+static const char *sim_solver_name(sim_solver_t sim_solver)
+{
+    switch (sim_solver)
+    {
+        case ERK:
+            return "ERK";
+        case IRK:
+            return "IRK";
+        case LIFTED_IRK:
+            return "LIFTED_IRK";
+        default:
+            return "INVALID";
+    }
+}
+
+
+
+static const char *qp_solver_name(ocp_qp_solver_t qp_solver)
+{
+    switch (qp_solver)
+    {
+        case PARTIAL_CONDENSING_HPIPM:
+            return "PARTIAL_CONDENSING_HPIPM";
+        case FULL_CONDENSING_HPIPM:
+            return "FULL_CONDENSING_HPIPM";
+#ifdef ACADOS_WITH_QPOASES
+        case FULL_CONDENSING_QPOASES:
+            return "FULL_CONDENSING_QPOASES";
+#endif
+        default:
+            return "OTHER";
+    }
+}
+
+
+
+static void select_dynamics_casadi_nm4(int N,
+    external_function_casadi *expl_vde_for,
+    external_function_casadi *impl_ode_fun,
+    external_function_casadi *impl_ode_fun_jac_x_xdot,
+    external_function_casadi *impl_ode_fun_jac_x_xdot_u,
+    external_function_casadi *impl_ode_jac_x_xdot_u)
+{
+    for (int ii = 0; ii < N; ii++)
+    {
+        expl_vde_for[ii].casadi_fun = &vde_chain_nm4;
+        expl_vde_for[ii].casadi_work = &vde_chain_nm4_work;
+        expl_vde_for[ii].casadi_sparsity_in = &vde_chain_nm4_sparsity_in;
+        expl_vde_for[ii].casadi_sparsity_out = &vde_chain_nm4_sparsity_out;
+        expl_vde_for[ii].casadi_n_in = &vde_chain_nm4_n_in;
+        expl_vde_for[ii].casadi_n_out = &vde_chain_nm4_n_out;
+
+        impl_ode_fun[ii].casadi_fun = &casadi_impl_ode_fun_chain_nm4;
+        impl_ode_fun[ii].casadi_work = &casadi_impl_ode_fun_chain_nm4_work;
+        impl_ode_fun[ii].casadi_sparsity_in = &casadi_impl_ode_fun_chain_nm4_sparsity_in;
+        impl_ode_fun[ii].casadi_sparsity_out = &casadi_impl_ode_fun_chain_nm4_sparsity_out;
+        impl_ode_fun[ii].casadi_n_in = &casadi_impl_ode_fun_chain_nm4_n_in;
+        impl_ode_fun[ii].casadi_n_out = &casadi_impl_ode_fun_chain_nm4_n_out;
+
+        impl_ode_fun_jac_x_xdot[ii].casadi_fun = &casadi_impl_ode_fun_jac_x_xdot_chain_nm4;
+        impl_ode_fun_jac_x_xdot[ii].casadi_work = &casadi_impl_ode_fun_jac_x_xdot_chain_nm4_work;
+        impl_ode_fun_jac_x_xdot[ii].casadi_sparsity_in = &casadi_impl_ode_fun_jac_x_xdot_chain_nm4_sparsity_in;
+        impl_ode_fun_jac_x_xdot[ii].casadi_sparsity_out = &casadi_impl_ode_fun_jac_x_xdot_chain_nm4_sparsity_out;
+        impl_ode_fun_jac_x_xdot[ii].casadi_n_in = &casadi_impl_ode_fun_jac_x_xdot_chain_nm4_n_in;
+        impl_ode_fun_jac_x_xdot[ii].casadi_n_out = &casadi_impl_ode_fun_jac_x_xdot_chain_nm4_n_out;
+
+        impl_ode_fun_jac_x_xdot_u[ii].casadi_fun = &casadi_impl_ode_fun_jac_x_xdot_u_chain_nm4;
+        impl_ode_fun_jac_x_xdot_u[ii].casadi_work = &casadi_impl_ode_fun_jac_x_xdot_u_chain_nm4_work;
+        impl_ode_fun_jac_x_xdot_u[ii].casadi_sparsity_in = &casadi_impl_ode_fun_jac_x_xdot_u_chain_nm4_sparsity_in;
+        impl_ode_fun_jac_x_xdot_u[ii].casadi_sparsity_out = &casadi_impl_ode_fun_jac_x_xdot_u_chain_nm4_sparsity_out;
+        impl_ode_fun_jac_x_xdot_u[ii].casadi_n_in = &casadi_impl_ode_fun_jac_x_xdot_u_chain_nm4_n_in;
+        impl_ode_fun_jac_x_xdot_u[ii].casadi_n_out = &casadi_impl_ode_fun_jac_x_xdot_u_chain_nm4_n_out;
+
+        impl_ode_jac_x_xdot_u[ii].casadi_fun = &casadi_impl_ode_jac_x_xdot_u_chain_nm4;
+        impl_ode_jac_x_xdot_u[ii].casadi_work = &casadi_impl_ode_jac_x_xdot_u_chain_nm4_work;
+        impl_ode_jac_x_xdot_u[ii].casadi_sparsity_in = &casadi_impl_ode_jac_x_xdot_u_chain_nm4_sparsity_in;
+        impl_ode_jac_x_xdot_u[ii].casadi_sparsity_out = &casadi_impl_ode_jac_x_xdot_u_chain_nm4_sparsity_out;
+        impl_ode_jac_x_xdot_u[ii].casadi_n_in = &casadi_impl_ode_jac_x_xdot_u_chain_nm4_n_in;
+        impl_ode_jac_x_xdot_u[ii].casadi_n_out = &casadi_impl_ode_jac_x_xdot_u_chain_nm4_n_out;
+    }
+}
+
+
+
+static void bench_run(const bench_case *bc, bench_samples *samples)
+{
+    int N = bc->N;
+
+    /************************************************
+    * dimensions
+    ************************************************/
+
+    int *nx = calloc(N+1, sizeof(int));
+    int *nu = calloc(N+1, sizeof(int));
+    int *nz = calloc(N+1, sizeof(int));
+    int *ns = calloc(N+1, sizeof(int));
+    int *nbx = calloc(N+1, sizeof(int));
+    int *nbu = calloc(N+1, sizeof(int));
+    int *ng = calloc(N+1, sizeof(int));
+    int *nh = calloc(N+1, sizeof(int));
+    int *ny = calloc(N+1, sizeof(int));
+
+    for (int i = 0; i <= N; i++)
+    {
+        nx[i] = NX;
+        nu[i] = i < N ? NU : 0;
+        ny[i] = nx[i] + nu[i];
+    }
+    // stage 0: initial state and input bounds
+    nbx[0] = NX;
+    nbu[0] = NU;
+    // path: input bounds and wall constraint on the masses
+    for (int i = 1; i < N; i++)
+    {
+        nbx[i] = NMF;
+        nbu[i] = NU;
+    }
+
+    /************************************************
+    * problem data
+    ************************************************/
+
+    double wall_pos = -0.01;
+    double UMAX = 10;
+
+    double x0[NX];
+    double xref[NX];
+    double yref[NX+NU];
+    for (int j = 0; j < NX; j++)
+    {
+        x0[j] = x0_nm4[j];
+        xref[j] = xN_nm4[j];
+        yref[j] = xN_nm4[j];
+    }
+    for (int j = 0; j < NU; j++)
+        yref[NX+j] = 0.0;
+
+    int idxbu[NU];
+    for (int j = 0; j < NU; j++)
+        idxbu[j] = j;
+    double lbu[NU], ubu[NU];
+    for (int j = 0; j < NU; j++)
+    {
+        lbu[j] = -UMAX;
+        ubu[j] = +UMAX;
+    }
+
+    int idxbx0[NX];
+    for (int j = 0; j < NX; j++)
+        idxbx0[j] = j;
+
+    int idxbx1[NMF];
+    double lbx1[NMF], ubx1[NMF];
+    for (int j = 0; j < NMF; j++)
+    {
+        idxbx1[j] = 6*j + 1;
+        lbx1[j] = wall_pos;
+        ubx1[j] = 1e4;
+    }
+
+    double *Cyt = calloc((NX+NU)*(NX+NU), sizeof(double));
+    for (int j = 0; j < NU; j++)
+        Cyt[j+(NX+NU)*(j+NX)] = 1.0;
+    for (int j = 0; j < NX; j++)
+        Cyt[NU+j+(NX+NU)*j] = 1.0;
+
+    double *CytN = calloc(NX*NX, sizeof(double));
+    for (int j = 0; j < NX; j++)
+        CytN[j+NX*j] = 1.0;
+
+    double *W = calloc((NX+NU)*(NX+NU), sizeof(double));
+    for (int j = 0; j < NX; j++)
+        W[j+(NX+NU)*j] = 1e-2;
+    for (int j = 0; j < NU; j++)
+        W[NX+j+(NX+NU)*(NX+j)] = 1.0;
+
+    double *WN = calloc(NX*NX, sizeof(double));
+    for (int j = 0; j < NX; j++)
+        WN[j+NX*j] = 1e-2;
+
+    /************************************************
+    * plan + config + dims
+    ************************************************/
+
+    ocp_nlp_plan *plan = ocp_nlp_plan_create(N);
+
+    plan->nlp_solver = SQP_RTI;
+    plan->regularization = NO_REGULARIZE;
+    plan->ocp_qp_solver_plan.qp_solver = bc->qp_solver;
+
+    for (int i = 0; i <= N; i++)
+    {
+        plan->nlp_cost[i] = LINEAR_LS;
+        plan->nlp_constraints[i] = BGH;
+    }
+    for (int i = 0; i < N; i++)
+    {
+        plan->nlp_dynamics[i] = CONTINUOUS_MODEL;
+        plan->sim_solver_plan[i].sim_solver = bc->sim_solver;
+    }
+
+    ocp_nlp_config *config = ocp_nlp_config_create(*plan);
+
+    ocp_nlp_dims *dims = ocp_nlp_dims_create(config);
+
+    ocp_nlp_dims_set_opt_vars(config, dims, "nx", nx);
+    ocp_nlp_dims_set_opt_vars(config, dims, "nu", nu);
+    ocp_nlp_dims_set_opt_vars(config, dims, "nz", nz);
+    ocp_nlp_dims_set_opt_vars(config, dims, "ns", ns);
+
+    for (int i = 0; i <= N; i++)
+    {
+        ocp_nlp_dims_set_cost(config, dims, i, "ny", &ny[i]);
+        ocp_nlp_dims_set_constraints(config, dims, i, "nbx", &nbx[i]);
+        ocp_nlp_dims_set_constraints(config, dims, i, "nbu", &nbu[i]);
+        ocp_nlp_dims_set_constraints(config, dims, i, "ng", &ng[i]);
+        ocp_nlp_dims_set_constraints(config, dims, i, "nh", &nh[i]);
+    }
+
+    /************************************************
+    * external functions
+    ************************************************/
+
+    external_function_casadi *expl_vde_for = malloc(N*sizeof(external_function_casadi));
+    external_function_casadi *impl_ode_fun = malloc(N*sizeof(external_function_casadi));
+    external_function_casadi *impl_ode_fun_jac_x_xdot = malloc(N*sizeof(external_function_casadi));
+    external_function_casadi *impl_ode_fun_jac_x_xdot_u = malloc(N*sizeof(external_function_casadi));
+    external_function_casadi *impl_ode_jac_x_xdot_u = malloc(N*sizeof(external_function_casadi));
+
+    select_dynamics_casadi_nm4(N, expl_vde_for, impl_ode_fun, impl_ode_fun_jac_x_xdot,
+                               impl_ode_fun_jac_x_xdot_u, impl_ode_jac_x_xdot_u);
+
+    external_function_casadi_create_array(N, expl_vde_for);
+    external_function_casadi_create_array(N, impl_ode_fun);
+    external_function_casadi_create_array(N, impl_ode_fun_jac_x_xdot);
+    external_function_casadi_create_array(N, impl_ode_fun_jac_x_xdot_u);
+    external_function_casadi_create_array(N, impl_ode_jac_x_xdot_u);
+
+    /************************************************
+    * nlp_in
+    ************************************************/
+
+    ocp_nlp_in *nlp_in = ocp_nlp_in_create(config, dims);
+
+    double Ts = TF/N;
+    for (int ii = 0; ii < N; ii++)
+        ocp_nlp_in_set(config, dims, nlp_in, ii, "Ts", &Ts);
+
+    // cost
+    for (int i = 0; i <= N; i++)
+    {
+        ocp_nlp_cost_model_set(config, dims, nlp_in, i, "Cyt", i < N ? Cyt : CytN);
+        ocp_nlp_cost_model_set(config, dims, nlp_in, i, "W", i < N ? W : WN);
+        ocp_nlp_cost_model_set(config, dims, nlp_in, i, "yref", yref);
+    }
+
+    // dynamics
+    for (int i = 0; i < N; i++)
+    {
+        switch (bc->sim_solver)
+        {
+            case ERK:
+                ocp_nlp_dynamics_model_set(config, dims, nlp_in, i, "expl_vde_for", &expl_vde_for[i]);
+                break;
+            case IRK:
+                ocp_nlp_dynamics_model_set(config, dims, nlp_in, i, "impl_ode_fun", &impl_ode_fun[i]);
+                ocp_nlp_dynamics_model_set(config, dims, nlp_in, i, "impl_ode_fun_jac_x_xdot",
+                                           &impl_ode_fun_jac_x_xdot[i]);
+                ocp_nlp_dynamics_model_set(config, dims, nlp_in, i, "impl_ode_jac_x_xdot_u",
+                                           &impl_ode_jac_x_xdot_u[i]);
+                break;
+            case LIFTED_IRK:
+                ocp_nlp_dynamics_model_set(config, dims, nlp_in, i, "impl_ode_fun", &impl_ode_fun[i]);
+                ocp_nlp_dynamics_model_set(config, dims, nlp_in, i, "impl_ode_fun_jac_x_xdot_u",
+                                           &impl_ode_fun_jac_x_xdot_u[i]);
+                break;
+            default:
+                printf("\nbench_ocp_nlp: integrator not supported\n");
+                exit(1);
+        }
+    }
+
+    // constraints
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "idxbu", idxbu);
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "lbu", lbu);
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "ubu", ubu);
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "idxbx", idxbx0);
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "lbx", x0);
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "ubx", x0);
+    for (int i = 1; i < N; i++)
+    {
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, i, "idxbu", idxbu);
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, i, "lbu", lbu);
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, i, "ubu", ubu);
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, i, "idxbx", idxbx1);
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, i, "lbx", lbx1);
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, i, "ubx", ubx1);
+    }
+
+    /************************************************
+    * opts
+    ************************************************/
+
+    void *nlp_opts = ocp_nlp_opts_create(config, dims);
+
+    for (int i = 0; i < N; i++)
+    {
+        int ns_sim = bc->ns;
+        ocp_nlp_dynamics_opts_set(config, nlp_opts, i, "ns", &ns_sim);
+    }
+
+    if (bc->qp_solver == PARTIAL_CONDENSING_HPIPM)
+    {
+        int cond_N = bc->cond_N;
+        ocp_nlp_opts_set(config, nlp_opts, "qp_cond_N", &cond_N);
+    }
+
+    int num_threads = bc->num_threads;
+    ocp_nlp_opts_set(config, nlp_opts, "num_threads", &num_threads);
+
+    /************************************************
+    * solver
+    ************************************************/
+
+    ocp_nlp_out *nlp_out = ocp_nlp_out_create(config, dims);
+
+    ocp_nlp_solver *solver = ocp_nlp_solver_create(config, dims, nlp_opts);
+
+    int status = ocp_nlp_precompute(solver, nlp_in, nlp_out);
+    if (status != ACADOS_SUCCESS)
+    {
+        printf("\nbench_ocp_nlp: precompute failed with status %d\n", status);
+        exit(1);
+    }
+
+    // initial guess: reference
+    double u0[NU] = {0.0};
+    for (int i = 0; i <= N; i++)
+    {
+        ocp_nlp_out_set(config, dims, nlp_out, i, "x", xref);
+        if (i < N)
+            ocp_nlp_out_set(config, dims, nlp_out, i, "u", u0);
+    }
+
+    /************************************************
+    * closed loop
+    ************************************************/
+
+    samples->num_failures = 0;
+
+    for (int k = 0; k < samples->num_samples; k++)
+    {
+        // re-excite the plant periodically, otherwise the loop settles at the reference
+        if (k % RESET_PERIOD == 0)
+        {
+            for (int j = 0; j < NX; j++)
+                x0[j] = x0_nm4[j];
+        }
+
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "lbx", x0);
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "ubx", x0);
+
+        status = ocp_nlp_solve(solver, nlp_in, nlp_out);
+        if (status != ACADOS_SUCCESS && status != ACADOS_MAXITER)
+            samples->num_failures++;
+
+        ocp_nlp_get(config, solver, "time_lin", samples->time_lin + k);
+        ocp_nlp_get(config, solver, "time_reg", samples->time_reg + k);
+        ocp_nlp_get(config, solver, "time_qp_sol", samples->time_qp_sol + k);
+        ocp_nlp_get(config, solver, "time_tot", samples->time_tot + k);
+
+        // nominal plant: apply the first control, i.e. move to the predicted state
+        ocp_nlp_out_get(config, dims, nlp_out, 1, "x", x0);
+    }
+
+    /************************************************
+    * free memory
+    ************************************************/
+
+    ocp_nlp_opts_destroy(nlp_opts);
+    ocp_nlp_in_destroy(nlp_in);
+    ocp_nlp_out_destroy(nlp_out);
+    ocp_nlp_solver_destroy(solver);
+    ocp_nlp_dims_destroy(dims);
+    ocp_nlp_config_destroy(config);
+    ocp_nlp_plan_destroy(plan);
+
+    external_function_casadi_free_array(N, expl_vde_for);
+    external_function_casadi_free_array(N, impl_ode_fun);
+    external_function_casadi_free_array(N, impl_ode_fun_jac_x_xdot);
+    external_function_casadi_free_array(N, impl_ode_fun_jac_x_xdot_u);
+    external_function_casadi_free_array(N, impl_ode_jac_x_xdot_u);
+
+    free(expl_vde_for);
+    free(impl_ode_fun);
+    free(impl_ode_fun_jac_x_xdot);
+    free(impl_ode_fun_jac_x_xdot_u);
+    free(impl_ode_jac_x_xdot_u);
+
+    free(Cyt);
+    free(CytN);
+    free(W);
+    free(WN);
+
+    free(nx);
+    free(nu);
+    free(nz);
+    free(ns);
+    free(nbx);
+    free(nbu);
+    free(ng);
+    free(nh);
+    free(ny);
+
+    return;
+}
+
+
+
+/************************************************
+* main
+************************************************/
+
+int main(int argc, char *argv[])
+{
+    int num_samples = NSAMPLES;
+    if (argc > 1)
+        num_samples = atoi(argv[1]);
+    if (num_samples <= 0)
+    {
+        printf("\nbench_ocp_nlp: number of samples has to be positive\n");
+        exit(1);
+    }
+
+    /************************************************
+    * sweep
+    ************************************************/
+
+    int N_values[] = {20, 40, 80};
+
+    sim_solver_t sim_solver_values[] = {ERK, IRK, LIFTED_IRK};
+
+    // number of integrator stages, per integrator type
+    int ns_erk_values[] = {2, 4};
+    int ns_irk_values[] = {1, 2};
+
+    ocp_qp_solver_t qp_solver_values[] = {
+        PARTIAL_CONDENSING_HPIPM,
+        FULL_CONDENSING_HPIPM,
+#ifdef ACADOS_WITH_QPOASES
+        FULL_CONDENSING_QPOASES,
+#endif
+    };
+
+    // partial condensing horizon as divisor of N
+    int cond_N_div_values[] = {1, 4, 10};
+
+#if defined(ACADOS_WITH_OPENMP)
+    int num_threads_values[] = {1, ACADOS_NUM_THREADS};
+#else
+    int num_threads_values[] = {1};
+#endif
+
+    int n_N = sizeof(N_values) / sizeof(int);
+    int n_sim = sizeof(sim_solver_values) / sizeof(sim_solver_t);
+    int n_qp = sizeof(qp_solver_values) / sizeof(ocp_qp_solver_t);
+    int n_cond = sizeof(cond_N_div_values) / sizeof(int);
+    int n_thr = sizeof(num_threads_values) / sizeof(int);
+
+    bench_samples samples;
+    samples.num_samples = num_samples;
+    samples.time_lin = malloc(num_samples*sizeof(double));
+    samples.time_reg = malloc(num_samples*sizeof(double));
+    samples.time_qp_sol = malloc(num_samples*sizeof(double));
+    samples.time_tot = malloc(num_samples*sizeof(double));
+
+    printf("\nbench_ocp_nlp: chain model, %d free masses, nx = %d, nu = %d, %d samples per case\n",
+           NMF, NX, NU, num_samples);
+
+    for (int iN = 0; iN < n_N; iN++)
+    for (int isim = 0; isim < n_sim; isim++)
+    {
+        sim_solver_t sim_solver = sim_solver_values[isim];
+        int *ns_values = sim_solver == ERK ? ns_erk_values : ns_irk_values;
+        int n_ns = sim_solver == ERK ? sizeof(ns_erk_values) / sizeof(int)
+                                     : sizeof(ns_irk_values) / sizeof(int);
+
+        for (int ins = 0; ins < n_ns; ins++)
+        for (int iqp = 0; iqp < n_qp; iqp++)
+        {
+            // condensing horizon only matters for partial condensing
+            int n_cond_qp = qp_solver_values[iqp] == PARTIAL_CONDENSING_HPIPM ? n_cond : 1;
+
+            for (int icond = 0; icond < n_cond_qp; icond++)
+            for (int ithr = 0; ithr < n_thr; ithr++)
+            {
+                bench_case bc;
+                bc.N = N_values[iN];
+                bc.sim_solver = sim_solver;
+                bc.ns = ns_values[ins];
+                bc.qp_solver = qp_solver_values[iqp];
+                bc.cond_N = N_values[iN] / cond_N_div_values[icond];
+                bc.num_threads = num_threads_values[ithr];
+
+                bench_run(&bc, &samples);
+
+                printf("\nN %3d  %-10s ns %d  %-24s N2 %3d  threads %d  (%d failures)\n", bc.N,
+                       sim_solver_name(bc.sim_solver), bc.ns, qp_solver_name(bc.qp_solver),
+                       bc.qp_solver == PARTIAL_CONDENSING_HPIPM ? bc.cond_N : 0, bc.num_threads,
+                       samples.num_failures);
+                print_phase("lin", num_samples, samples.time_lin);
+                print_phase("reg", num_samples, samples.time_reg);
+                print_phase("qp_sol", num_samples, samples.time_qp_sol);
+                print_phase("tot", num_samples, samples.time_tot);
+            }
+        }
+    }
+
+    free(samples.time_lin);
+    free(samples.time_reg);
+    free(samples.time_qp_sol);
+    free(samples.time_tot);
+
+    return 0;
+}
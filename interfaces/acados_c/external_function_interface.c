@@ -41,6 +41,7 @@
 #include "acados/utils/external_function_generic.h"
 
 #include "acados/utils/mem.h"
+#include "acados/utils/types.h"
 
 /************************************************
  * casadi external function
@@ -113,6 +114,22 @@ void external_function_casadi_free_array(int size, external_function_casadi *fun
 
 
 
+int external_function_casadi_create_array_static(int size, external_function_casadi *funs,
+                                                 acados_static_mem *mem)
+{
+    for (int ii = 0; ii < size; ii++)
+    {
+        void *fun_mem = acados_static_mem_calloc(mem, external_function_casadi_calculate_size(funs + ii));
+        if (fun_mem == NULL)
+            return ACADOS_FAILURE;
+        external_function_casadi_assign(funs + ii, fun_mem);
+    }
+
+    return ACADOS_SUCCESS;
+}
+
+
+
 /************************************************
  * casadi external parametric function
  ************************************************/
@@ -182,3 +199,21 @@ void external_function_param_casadi_free_array(int size, external_function_param
 
     return;
 }
+
+
+
+int external_function_param_casadi_create_array_static(int size,
+                                                       external_function_param_casadi *funs, int np,
+                                                       acados_static_mem *mem)
+{
+    for (int ii = 0; ii < size; ii++)
+    {
+        void *fun_mem =
+            acados_static_mem_calloc(mem, external_function_param_casadi_calculate_size(funs + ii, np));
+        if (fun_mem == NULL)
+            return ACADOS_FAILURE;
+        external_function_param_casadi_assign(funs + ii, fun_mem);
+    }
+
+    return ACADOS_SUCCESS;
+}
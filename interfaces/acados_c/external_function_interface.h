@@ -40,6 +40,7 @@ extern "C" {
 #endif
 
 #include "acados/utils/external_function_generic.h"
+#include "acados/utils/mem.h"
 
 /************************************************
  * casadi external function
@@ -53,6 +54,9 @@ void external_function_casadi_free(external_function_casadi *fun);
 void external_function_casadi_create_array(int size, external_function_casadi *funs);
 //
 void external_function_casadi_free_array(int size, external_function_casadi *funs);
+// assigns each function into mem (no heap), returns ACADOS_FAILURE if mem is exhausted
+int external_function_casadi_create_array_static(int size, external_function_casadi *funs,
+                                                 acados_static_mem *mem);
 
 /************************************************
  * casadi external parametric function
@@ -67,6 +71,10 @@ void external_function_param_casadi_create_array(int size, external_function_par
                                                  int np);
 //
 void external_function_param_casadi_free_array(int size, external_function_param_casadi *funs);
+// assigns each function into mem (no heap), returns ACADOS_FAILURE if mem is exhausted
+int external_function_param_casadi_create_array_static(int size,
+                                                       external_function_param_casadi *funs, int np,
+                                                       acados_static_mem *mem);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -56,6 +56,7 @@
 #include "acados/ocp_nlp/ocp_nlp_reg_noreg.h"
 #include "acados/ocp_nlp/ocp_nlp_sqp.h"
 #include "acados/ocp_nlp/ocp_nlp_sqp_rti.h"
+#include "acados/ocp_nlp/ocp_nlp_sqp_tree.h"
 #include "acados/utils/mem.h"
 
 
@@ -168,18 +169,10 @@ void ocp_nlp_plan_destroy(void* plan_)
 * config
 ************************************************/
 
-ocp_nlp_config *ocp_nlp_config_create(ocp_nlp_plan plan)
+static void ocp_nlp_config_initialize_from_plan(ocp_nlp_config *config, ocp_nlp_plan plan)
 {
     int N = plan.N;
 
-    /* calculate_size & malloc & assign */
-
-    int bytes = ocp_nlp_config_calculate_size(N);
-    void *config_mem = acados_calloc(1, bytes);
-    ocp_nlp_config *config = ocp_nlp_config_assign(N, config_mem);
-
-    /* initialize config according plan */
-
 	// NLP solver
     switch (plan.nlp_solver)
 	{
@@ -189,6 +182,9 @@ ocp_nlp_config *ocp_nlp_config_create(ocp_nlp_plan plan)
 		case SQP_RTI:
 			ocp_nlp_sqp_rti_config_initialize_default(config);
 			break;
+		case SQP_TREE:
+			ocp_nlp_sqp_tree_config_initialize_default(config);
+			break;
 		case INVALID_NLP_SOLVER:
 			break;
             printf("\nerror: ocp_nlp_config_create: forgot to initialize plan->nlp_solver\n");
@@ -199,8 +195,9 @@ ocp_nlp_config *ocp_nlp_config_create(ocp_nlp_plan plan)
             exit(1);
 	}
 
-    // QP solver
-    ocp_qp_xcond_solver_config_initialize_from_plan(plan.ocp_qp_solver_plan.qp_solver, config->qp_solver);
+    // QP solver (the tree QPs are solved by hpipm directly)
+    if (plan.nlp_solver != SQP_TREE)
+        ocp_qp_xcond_solver_config_initialize_from_plan(plan.ocp_qp_solver_plan.qp_solver, config->qp_solver);
 
     // regularization
     switch (plan.regularization)
@@ -273,6 +270,9 @@ ocp_nlp_config *ocp_nlp_config_create(ocp_nlp_plan plan)
                     case LIFTED_IRK:
                         sim_lifted_irk_config_initialize_default(config->dynamics[i]->sim_solver);
                         break;
+                    case ERK_ADAPTIVE:
+                        sim_erk_adaptive_config_initialize_default(config->dynamics[i]->sim_solver);
+                        break;
                     default:
 						printf("\nerror: ocp_nlp_config_create: unsupported plan->sim_solver\n");
                         exit(1);
@@ -313,6 +313,25 @@ ocp_nlp_config *ocp_nlp_config_create(ocp_nlp_plan plan)
         }
     }
 
+    return;
+}
+
+
+
+ocp_nlp_config *ocp_nlp_config_create(ocp_nlp_plan plan)
+{
+    int N = plan.N;
+
+    /* calculate_size & malloc & assign */
+
+    int bytes = ocp_nlp_config_calculate_size(N);
+    void *config_mem = acados_calloc(1, bytes);
+    ocp_nlp_config *config = ocp_nlp_config_assign(N, config_mem);
+
+    /* initialize config according plan */
+
+    ocp_nlp_config_initialize_from_plan(config, plan);
+
     return config;
 }
 
@@ -350,6 +369,26 @@ void ocp_nlp_dims_destroy(void *dims_)
 
 
 
+ocp_nlp_tree_dims *ocp_nlp_tree_dims_create(ocp_nlp_config *config, int md, int Nr, int Nh)
+{
+    int bytes = ocp_nlp_tree_dims_calculate_size(config, md, Nr, Nh);
+
+    void *ptr = acados_calloc(1, bytes);
+
+    ocp_nlp_tree_dims *dims = ocp_nlp_tree_dims_assign(config, md, Nr, Nh, ptr);
+
+    return dims;
+}
+
+
+
+void ocp_nlp_tree_dims_destroy(void *dims_)
+{
+    free(dims_);
+}
+
+
+
 /************************************************
 * NLP inputs
 ************************************************/
@@ -377,15 +416,23 @@ void ocp_nlp_in_destroy(void *in)
 void ocp_nlp_in_set(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in, int stage,
 		const char *field, void *value)
 {
-    int ii;
-
     int N = dims->N;
 
     if (!strcmp(field, "Ts"))
+    {
+        if (stage < 0 || stage >= N)
+        {
+            printf("\nerror: ocp_nlp_in_set: field Ts: stage %d out of range [0, %d)\n", stage, N);
+            exit(1);
+        }
+        double *Ts_value = value;
+        in->Ts[stage] = *Ts_value;
+    }
+    else if (!strcmp(field, "Ts_all"))
     {
         double *Ts_values = value;
-        for (ii=0; ii<N; ii++)
-            in->Ts[ii] = *Ts_values;
+        for (int ii = 0; ii < N; ii++)
+            in->Ts[ii] = Ts_values[ii];
     }
     else
     {
@@ -589,6 +636,21 @@ void *ocp_nlp_opts_create(ocp_nlp_config *config, ocp_nlp_dims *dims)
 
 
 
+void *ocp_nlp_tree_opts_create(ocp_nlp_config *config, ocp_nlp_tree_dims *dims)
+{
+    int bytes = config->opts_calculate_size(config, dims);
+
+    void *ptr = acados_calloc(1, bytes);
+
+    void *opts = config->opts_assign(config, dims, ptr);
+
+    config->opts_initialize_default(config, dims, opts);
+
+    return opts;
+}
+
+
+
 void ocp_nlp_opts_set(ocp_nlp_config *config, void *opts_, const char *field, void *value)
 {
     config->opts_set(config, opts_, field, value);
@@ -641,7 +703,7 @@ void ocp_nlp_opts_destroy(void *opts)
 * solver
 ************************************************/
 
-static int ocp_nlp_calculate_size(ocp_nlp_config *config, ocp_nlp_dims *dims, void *opts_)
+static int ocp_nlp_calculate_size(ocp_nlp_config *config, void *dims, void *opts_)
 {
     int bytes = sizeof(ocp_nlp_solver);
 
@@ -653,7 +715,7 @@ static int ocp_nlp_calculate_size(ocp_nlp_config *config, ocp_nlp_dims *dims, vo
 
 
 
-static ocp_nlp_solver *ocp_nlp_assign(ocp_nlp_config *config, ocp_nlp_dims *dims,
+static ocp_nlp_solver *ocp_nlp_assign(ocp_nlp_config *config, void *dims,
                                       void *opts_, void *raw_memory)
 {
     char *c_ptr = (char *) raw_memory;
@@ -693,6 +755,22 @@ ocp_nlp_solver *ocp_nlp_solver_create(ocp_nlp_config *config, ocp_nlp_dims *dims
 }
 
 
+ocp_nlp_solver *ocp_nlp_tree_solver_create(ocp_nlp_config *config, ocp_nlp_tree_dims *dims,
+                                           void *opts_)
+{
+    config->opts_update(config, dims, opts_);
+
+    int bytes = ocp_nlp_calculate_size(config, dims, opts_);
+
+    void *ptr = acados_calloc(1, bytes);
+
+    ocp_nlp_solver *solver = ocp_nlp_assign(config, dims, opts_, ptr);
+
+    return solver;
+}
+
+
+
 void ocp_nlp_solver_destroy(void *solver)
 {
     free(solver);
@@ -707,6 +785,100 @@ int ocp_nlp_solve(ocp_nlp_solver *solver, ocp_nlp_in *nlp_in, ocp_nlp_out *nlp_o
 
 
 
+int ocp_nlp_solve_multistart(ocp_nlp_solver **solvers, ocp_nlp_in **nlp_in, ocp_nlp_out **nlp_out,
+                             int K, double deadline, int *winner)
+{
+    int ii;
+
+    // shared between the instances, written and read with omp atomic
+    int cancel = 0;
+    int first = -1;
+    double *time_budget_bkp = acados_malloc(K, sizeof(double));
+
+    for (ii = 0; ii < K; ii++)
+    {
+        if (solvers[ii]->config->evaluate != &ocp_nlp_sqp)
+        {
+            printf("\nerror: ocp_nlp_solve_multistart: only available for SQP\n");
+            exit(1);
+        }
+        ocp_nlp_sqp_opts *opts = solvers[ii]->opts;
+        time_budget_bkp[ii] = opts->time_budget;
+
+        solvers[ii]->config->opts_set(solvers[ii]->config, opts, "cancel", (void *) &cancel);
+        if (deadline > 0.0)
+            solvers[ii]->config->opts_set(solvers[ii]->config, opts, "time_budget", &deadline);
+    }
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for num_threads(K) schedule(static, 1)
+#endif
+    for (ii = 0; ii < K; ii++)
+    {
+        int cancelled;
+#if defined(ACADOS_WITH_OPENMP)
+        #pragma omp atomic read
+#endif
+        cancelled = cancel;
+
+        if (cancelled)
+        {
+            // not started, another instance converged before
+            ((ocp_nlp_sqp_memory *) solvers[ii]->mem)->status = ACADOS_CANCELLED;
+            continue;
+        }
+
+        int status = ocp_nlp_solve(solvers[ii], nlp_in[ii], nlp_out[ii]);
+        if (status == ACADOS_SUCCESS)
+        {
+#if defined(ACADOS_WITH_OPENMP)
+            #pragma omp critical
+#endif
+            {
+                if (first < 0)
+                    first = ii;
+            }
+#if defined(ACADOS_WITH_OPENMP)
+            #pragma omp atomic write
+#endif
+            cancel = 1;
+        }
+    }
+
+    // no instance converged: select the one closest to a KKT point
+    int best = first;
+    if (best < 0)
+    {
+        int status;
+        for (ii = 0; ii < K; ii++)
+        {
+            solvers[ii]->config->get(solvers[ii]->config, solvers[ii]->mem, "status", &status);
+            if (status == ACADOS_QP_FAILURE || status == ACADOS_READY)
+                continue;
+            if (best < 0 || nlp_out[ii]->inf_norm_res < nlp_out[best]->inf_norm_res)
+                best = ii;
+        }
+    }
+
+    for (ii = 0; ii < K; ii++)
+    {
+        ocp_nlp_sqp_opts *opts = solvers[ii]->opts;
+        solvers[ii]->config->opts_set(solvers[ii]->config, opts, "cancel", NULL);
+        solvers[ii]->config->opts_set(solvers[ii]->config, opts, "time_budget", &time_budget_bkp[ii]);
+    }
+    free(time_budget_bkp);
+
+    *winner = best;
+    if (best < 0)
+        return ACADOS_QP_FAILURE;
+
+    int status;
+    solvers[best]->config->get(solvers[best]->config, solvers[best]->mem, "status", &status);
+    return status;
+}
+
+
+
 int ocp_nlp_precompute(ocp_nlp_solver *solver, ocp_nlp_in *nlp_in, ocp_nlp_out *nlp_out)
 {
     return solver->config->precompute(solver->config, solver->dims, nlp_in, nlp_out, solver->opts, solver->mem, solver->work);
@@ -770,4 +942,537 @@ void ocp_nlp_set(ocp_nlp_config *config, ocp_nlp_solver *solver,
         exit(1);
     }
     // printf("exit ocp_nlp_set\n");
-}
\ No newline at end of file
+}
+
+
+/************************************************
+* shift
+************************************************/
+
+void ocp_nlp_shift(ocp_nlp_solver *solver, ocp_nlp_in *nlp_in, ocp_nlp_out *nlp_out,
+                   ocp_nlp_shift_t mode)
+{
+    ocp_nlp_config *config = solver->config;
+    ocp_nlp_dims *dims = solver->dims;
+    int N = dims->N;
+
+    int *nv = dims->nv;
+    int *nx = dims->nx;
+    int *nu = dims->nu;
+    int *nz = dims->nz;
+    int *ni = dims->ni;
+    int *ns = dims->ns;
+
+    if (config->simulate_stage == NULL)
+    {
+        printf("\nerror: ocp_nlp_shift: not available for this nlp solver\n");
+        exit(1);
+    }
+
+    ocp_nlp_memory *nlp_mem;
+    config->get(config, solver->mem, "nlp_mem", &nlp_mem);
+    ocp_qp_out *qp_out;
+    config->get(config, solver->mem, "qp_out", &qp_out);
+    ocp_qp_dims *qp_dims = qp_out->dim;
+
+    int ii;
+
+    // one pass from the first to the last stage, every vector is overwritten by its successor;
+    // at stage N-1 only the state is moved, the control of stage N-1 is kept
+    for (ii = 0; ii < N; ii++)
+    {
+        // nlp iterate
+        if (nu[ii] == nu[ii+1] && nx[ii] == nx[ii+1] && ns[ii] == ns[ii+1])
+        {
+            blasfeo_dveccp(nv[ii], nlp_out->ux+ii+1, 0, nlp_out->ux+ii, 0);
+        }
+        else if (nx[ii] == nx[ii+1])
+        {
+            blasfeo_dveccp(nx[ii], nlp_out->ux+ii+1, nu[ii+1], nlp_out->ux+ii, nu[ii]);
+            if (nu[ii] == nu[ii+1])
+                blasfeo_dveccp(nu[ii], nlp_out->ux+ii+1, 0, nlp_out->ux+ii, 0);
+        }
+        if (nz[ii] == nz[ii+1])
+            blasfeo_dveccp(nz[ii], nlp_out->z+ii+1, 0, nlp_out->z+ii, 0);
+        if (ni[ii] == ni[ii+1])
+        {
+            blasfeo_dveccp(2*ni[ii], nlp_out->lam+ii+1, 0, nlp_out->lam+ii, 0);
+            blasfeo_dveccp(2*ni[ii], nlp_out->t+ii+1, 0, nlp_out->t+ii, 0);
+        }
+        if (ii < N-1 && nx[ii+1] == nx[ii+2])
+            blasfeo_dveccp(nx[ii+1], nlp_out->pi+ii+1, 0, nlp_out->pi+ii, 0);
+
+        // qp solution, used to warm start the qp solver
+        int qp_nv = qp_dims->nu[ii] + qp_dims->nx[ii] + 2*qp_dims->ns[ii];
+        int qp_nv1 = qp_dims->nu[ii+1] + qp_dims->nx[ii+1] + 2*qp_dims->ns[ii+1];
+        int qp_ni = 2*qp_dims->nb[ii] + 2*qp_dims->ng[ii] + 2*qp_dims->ns[ii];
+        int qp_ni1 = 2*qp_dims->nb[ii+1] + 2*qp_dims->ng[ii+1] + 2*qp_dims->ns[ii+1];
+        if (qp_nv == qp_nv1 && qp_dims->nx[ii] == qp_dims->nx[ii+1])
+            blasfeo_dveccp(qp_nv, qp_out->ux+ii+1, 0, qp_out->ux+ii, 0);
+        else if (qp_dims->nx[ii] == qp_dims->nx[ii+1])
+            blasfeo_dveccp(qp_dims->nx[ii], qp_out->ux+ii+1, qp_dims->nu[ii+1], qp_out->ux+ii,
+                           qp_dims->nu[ii]);
+        if (qp_ni == qp_ni1 && qp_dims->nb[ii] == qp_dims->nb[ii+1])
+        {
+            blasfeo_dveccp(qp_ni, qp_out->lam+ii+1, 0, qp_out->lam+ii, 0);
+            blasfeo_dveccp(qp_ni, qp_out->t+ii+1, 0, qp_out->t+ii, 0);
+        }
+        if (ii < N-1 && qp_dims->nx[ii+1] == qp_dims->nx[ii+2])
+            blasfeo_dveccp(qp_dims->nx[ii+1], qp_out->pi+ii+1, 0, qp_out->pi+ii, 0);
+
+        // integrator guesses, passed to the integrator memory at the next call
+        if (ii < N-1 && nx[ii] + nz[ii] == nx[ii+1] + nz[ii+1])
+        {
+            blasfeo_dveccp(nx[ii] + nz[ii], nlp_mem->sim_guess+ii+1, 0, nlp_mem->sim_guess+ii, 0);
+            nlp_mem->set_sim_guess[ii] = nlp_mem->set_sim_guess[ii+1];
+        }
+    }
+
+    // last stage: the state is kept as it is or simulated from the shifted stage N-1
+    if (mode == OCP_NLP_SHIFT_SIMULATE)
+    {
+        config->simulate_stage(config, dims, nlp_in, nlp_out, solver->opts, solver->mem,
+                               solver->work, N-1);
+    }
+    else if (mode != OCP_NLP_SHIFT_DUPLICATE)
+    {
+        printf("\nerror: ocp_nlp_shift: unknown mode %d\n", mode);
+        exit(1);
+    }
+
+    return;
+}
+
+
+
+/************************************************
+* arena
+************************************************/
+
+#define ARENA_ALIGNMENT 64  // as in acados_static_mem_calloc
+#define ARENA_HUGEPAGE_SIZE (2 * 1024 * 1024)
+
+ocp_nlp_arena *ocp_nlp_arena_create(ocp_nlp_config *config, ocp_nlp_dims *dims, void *opts_,
+                                    int flags)
+{
+    config->opts_update(config, dims, opts_);
+
+    ocp_nlp_arena *arena = acados_calloc(1, sizeof(ocp_nlp_arena));
+
+    arena->flags = flags;
+
+    arena->in_bytes = ocp_nlp_in_calculate_size(config, dims);
+    arena->out_bytes = ocp_nlp_out_calculate_size(config, dims);
+    arena->memory_bytes = config->memory_calculate_size(config, dims, opts_);
+    arena->workspace_bytes = config->workspace_calculate_size(config, dims, opts_);
+
+    int solver_bytes = ocp_nlp_calculate_size(config, dims, opts_);
+
+    // every part starts on its own cache line
+    int bytes = 0;
+    bytes += arena->in_bytes;
+    make_int_multiple_of(ARENA_ALIGNMENT, &bytes);
+    bytes += arena->out_bytes;
+    make_int_multiple_of(ARENA_ALIGNMENT, &bytes);
+    bytes += solver_bytes;
+    make_int_multiple_of(ARENA_ALIGNMENT, &bytes);
+
+    size_t alignment = ARENA_ALIGNMENT;
+    if (flags & ACADOS_ARENA_HUGEPAGES)
+    {
+        // madvise works on whole pages
+        alignment = ARENA_HUGEPAGE_SIZE;
+        bytes = (bytes + ARENA_HUGEPAGE_SIZE - 1) / ARENA_HUGEPAGE_SIZE * ARENA_HUGEPAGE_SIZE;
+    }
+    arena->total_bytes = bytes;
+
+    arena->memory = acados_arena_calloc(bytes, alignment, flags, &arena->raw_memory);
+    if (arena->memory == NULL)
+    {
+        printf("\nerror: ocp_nlp_arena_create: allocation of %d bytes failed\n", bytes);
+        exit(1);
+    }
+
+    // place the parts with the static memory allocator, which starts each on a new cache line
+    acados_static_mem mem;
+    acados_static_mem_init(&mem, arena->memory, arena->total_bytes);
+
+    arena->nlp_in = ocp_nlp_in_create_static(config, dims, &mem);
+    arena->nlp_out = ocp_nlp_out_create_static(config, dims, &mem);
+    arena->solver = ocp_nlp_solver_create_static(config, dims, opts_, &mem);
+
+    assert(arena->solver != NULL);
+
+    return arena;
+}
+
+
+
+void ocp_nlp_arena_print_footprint(ocp_nlp_config *config, ocp_nlp_dims *dims,
+                                   ocp_nlp_arena *arena)
+{
+    int N = dims->N;
+
+    int dynamics_bytes = 0;
+    for (int ii = 0; ii < N; ii++)
+        dynamics_bytes +=
+            config->dynamics[ii]->model_calculate_size(config->dynamics[ii], dims->dynamics[ii]);
+    int cost_bytes = 0;
+    for (int ii = 0; ii <= N; ii++)
+        cost_bytes += config->cost[ii]->model_calculate_size(config->cost[ii], dims->cost[ii]);
+    int constraints_bytes = 0;
+    for (int ii = 0; ii <= N; ii++)
+        constraints_bytes += config->constraints[ii]->model_calculate_size(config->constraints[ii],
+                                                                          dims->constraints[ii]);
+
+    int used_bytes = arena->in_bytes + arena->out_bytes + sizeof(ocp_nlp_solver) +
+                     arena->memory_bytes + arena->workspace_bytes;
+
+    printf("\nocp_nlp arena footprint (bytes)\n");
+    printf("  outside arena\n");
+    printf("    config            %10d\n", ocp_nlp_config_calculate_size(N));
+    printf("    dims              %10d\n", ocp_nlp_dims_calculate_size(config));
+    printf("    opts              %10d\n", config->opts_calculate_size(config, dims));
+    printf("  arena\n");
+    printf("    nlp_in            %10d\n", arena->in_bytes);
+    printf("      dynamics models %10d\n", dynamics_bytes);
+    printf("      cost models     %10d\n", cost_bytes);
+    printf("      constr. models  %10d\n", constraints_bytes);
+    printf("    nlp_out           %10d\n", arena->out_bytes);
+    printf("    solver memory     %10d\n", arena->memory_bytes);
+    printf("    solver workspace  %10d\n", arena->workspace_bytes);
+    printf("    alignment         %10d\n", arena->total_bytes - used_bytes);
+    printf("    total             %10d\n", arena->total_bytes);
+    printf("  flags:%s%s%s\n", arena->flags & ACADOS_ARENA_HUGEPAGES ? " hugepages" : "",
+           arena->flags & ACADOS_ARENA_PREFAULT ? " prefault" : "",
+           arena->flags & ACADOS_ARENA_MLOCK ? " mlock" : "");
+
+    return;
+}
+
+
+
+void ocp_nlp_arena_destroy(ocp_nlp_arena *arena)
+{
+    acados_arena_free(arena->raw_memory, arena->memory, arena->total_bytes, arena->flags);
+    free(arena);
+}
+
+
+
+/************************************************
+* static memory
+************************************************/
+
+ocp_nlp_plan *ocp_nlp_plan_create_static(int N, acados_static_mem *mem)
+{
+    void *ptr = acados_static_mem_calloc(mem, ocp_nlp_plan_calculate_size(N));
+    if (ptr == NULL)
+        return NULL;
+
+    ocp_nlp_plan *plan = ocp_nlp_plan_assign(N, ptr);
+
+    ocp_nlp_plan_initialize_default(plan);
+
+    return plan;
+}
+
+
+
+ocp_nlp_config *ocp_nlp_config_create_static(ocp_nlp_plan plan, acados_static_mem *mem)
+{
+    void *ptr = acados_static_mem_calloc(mem, ocp_nlp_config_calculate_size(plan.N));
+    if (ptr == NULL)
+        return NULL;
+
+    ocp_nlp_config *config = ocp_nlp_config_assign(plan.N, ptr);
+
+    ocp_nlp_config_initialize_from_plan(config, plan);
+
+    return config;
+}
+
+
+
+ocp_nlp_dims *ocp_nlp_dims_create_static(ocp_nlp_config *config, acados_static_mem *mem)
+{
+    void *ptr = acados_static_mem_calloc(mem, ocp_nlp_dims_calculate_size(config));
+    if (ptr == NULL)
+        return NULL;
+
+    return ocp_nlp_dims_assign(config, ptr);
+}
+
+
+
+ocp_nlp_in *ocp_nlp_in_create_static(ocp_nlp_config *config, ocp_nlp_dims *dims,
+                                     acados_static_mem *mem)
+{
+    void *ptr = acados_static_mem_calloc(mem, ocp_nlp_in_calculate_size(config, dims));
+    if (ptr == NULL)
+        return NULL;
+
+    return ocp_nlp_in_assign(config, dims, ptr);
+}
+
+
+
+ocp_nlp_out *ocp_nlp_out_create_static(ocp_nlp_config *config, ocp_nlp_dims *dims,
+                                       acados_static_mem *mem)
+{
+    void *ptr = acados_static_mem_calloc(mem, ocp_nlp_out_calculate_size(config, dims));
+    if (ptr == NULL)
+        return NULL;
+
+    return ocp_nlp_out_assign(config, dims, ptr);
+}
+
+
+
+void *ocp_nlp_opts_create_static(ocp_nlp_config *config, ocp_nlp_dims *dims,
+                                 acados_static_mem *mem)
+{
+    void *ptr = acados_static_mem_calloc(mem, config->opts_calculate_size(config, dims));
+    if (ptr == NULL)
+        return NULL;
+
+    void *opts = config->opts_assign(config, dims, ptr);
+
+    config->opts_initialize_default(config, dims, opts);
+
+    return opts;
+}
+
+
+
+ocp_nlp_solver *ocp_nlp_solver_create_static(ocp_nlp_config *config, ocp_nlp_dims *dims,
+                                             void *opts_, acados_static_mem *mem)
+{
+    config->opts_update(config, dims, opts_);
+
+    void *ptr = acados_static_mem_calloc(mem, ocp_nlp_calculate_size(config, dims, opts_));
+    if (ptr == NULL)
+        return NULL;
+
+    return ocp_nlp_assign(config, dims, opts_, ptr);
+}
+
+
+/************************************************
+* snapshot
+************************************************/
+
+#define OCP_NLP_SNAPSHOT_MAGIC 0x61636164  // "acad"
+#define OCP_NLP_SNAPSHOT_VERSION 1
+
+typedef struct
+{
+    int magic;
+    int version;
+    int size;      // total size of the snapshot in bytes
+    int N;
+    int dims_hash;  // hash of the nlp and qp dimensions
+    int sqp_iter;
+    int qp_iter;
+    int pad;
+} ocp_nlp_snapshot_header;
+
+
+
+typedef enum
+{
+    SNAPSHOT_SIZE,
+    SNAPSHOT_SAVE,
+    SNAPSHOT_RESTORE
+} snapshot_mode_t;
+
+
+
+// copies n elements from/to data at the byte offset, data is only accessed when saving or
+// restoring; the buffer does not need to be aligned, so data is copied element-wise
+static int snapshot_dvec(int n, struct blasfeo_dvec *v, int vi, char *data, int offset,
+                         snapshot_mode_t mode)
+{
+    double tmp;
+    if (mode == SNAPSHOT_SAVE)
+    {
+        for (int ii = 0; ii < n; ii++)
+        {
+            tmp = BLASFEO_DVECEL(v, vi+ii);
+            memcpy(data + offset + ii*sizeof(double), &tmp, sizeof(double));
+        }
+    }
+    else if (mode == SNAPSHOT_RESTORE)
+    {
+        for (int ii = 0; ii < n; ii++)
+        {
+            memcpy(&tmp, data + offset + ii*sizeof(double), sizeof(double));
+            BLASFEO_DVECEL(v, vi+ii) = tmp;
+        }
+    }
+    return n * sizeof(double);
+}
+
+
+
+static int snapshot_dims_hash(ocp_nlp_dims *dims, ocp_qp_dims *qp_dims)
+{
+    unsigned int hash = 17;
+    for (int ii = 0; ii <= dims->N; ii++)
+    {
+        hash = 31 * hash + dims->nx[ii];
+        hash = 31 * hash + dims->nu[ii];
+        hash = 31 * hash + dims->nz[ii];
+        hash = 31 * hash + dims->ni[ii];
+        hash = 31 * hash + dims->ns[ii];
+    }
+    for (int ii = 0; ii <= qp_dims->N; ii++)
+    {
+        hash = 31 * hash + qp_dims->nx[ii];
+        hash = 31 * hash + qp_dims->nu[ii];
+        hash = 31 * hash + qp_dims->nb[ii];
+        hash = 31 * hash + qp_dims->ng[ii];
+        hash = 31 * hash + qp_dims->ns[ii];
+    }
+    return (int) (hash & 0x7fffffff);
+}
+
+
+
+// walks through the solver state in a fixed order, returns the number of bytes
+static int snapshot_traverse(ocp_nlp_solver *solver, ocp_nlp_out *nlp_out, char *data,
+                             snapshot_mode_t mode)
+{
+    ocp_nlp_config *config = solver->config;
+    ocp_nlp_dims *dims = solver->dims;
+    int N = dims->N;
+
+    ocp_nlp_memory *nlp_mem;
+    config->get(config, solver->mem, "nlp_mem", &nlp_mem);
+    ocp_qp_out *qp_out;
+    config->get(config, solver->mem, "qp_out", &qp_out);
+    ocp_qp_dims *qp_dims = qp_out->dim;
+
+    // byte offset into data, which is NULL when only the size is computed
+    int size = 0;
+    double flag;
+
+    // nlp iterate
+    for (int ii = 0; ii <= N; ii++)
+    {
+        size += snapshot_dvec(dims->nv[ii], nlp_out->ux+ii, 0, data, size, mode);
+        size += snapshot_dvec(dims->nz[ii], nlp_out->z+ii, 0, data, size, mode);
+        size += snapshot_dvec(2*dims->ni[ii], nlp_out->lam+ii, 0, data, size, mode);
+        size += snapshot_dvec(2*dims->ni[ii], nlp_out->t+ii, 0, data, size, mode);
+        if (ii < N)
+            size += snapshot_dvec(dims->nx[ii+1], nlp_out->pi+ii, 0, data, size, mode);
+    }
+
+    // qp solution, used to warm start the qp solver
+    for (int ii = 0; ii <= N; ii++)
+    {
+        int nv = qp_dims->nu[ii] + qp_dims->nx[ii] + 2*qp_dims->ns[ii];
+        int ni = 2*qp_dims->nb[ii] + 2*qp_dims->ng[ii] + 2*qp_dims->ns[ii];
+        size += snapshot_dvec(nv, qp_out->ux+ii, 0, data, size, mode);
+        size += snapshot_dvec(ni, qp_out->lam+ii, 0, data, size, mode);
+        size += snapshot_dvec(ni, qp_out->t+ii, 0, data, size, mode);
+        if (ii < N)
+            size += snapshot_dvec(qp_dims->nx[ii+1], qp_out->pi+ii, 0, data, size, mode);
+    }
+
+    // integrator guesses
+    for (int ii = 0; ii <= N; ii++)
+    {
+        if (mode == SNAPSHOT_SAVE)
+        {
+            flag = nlp_mem->set_sim_guess[ii] ? 1.0 : 0.0;
+            memcpy(data + size, &flag, sizeof(double));
+        }
+        else if (mode == SNAPSHOT_RESTORE)
+        {
+            memcpy(&flag, data + size, sizeof(double));
+            nlp_mem->set_sim_guess[ii] = flag != 0.0;
+        }
+        size += sizeof(double);
+        size += snapshot_dvec(dims->nx[ii] + dims->nz[ii], nlp_mem->sim_guess+ii, 0, data, size,
+                              mode);
+    }
+
+    return size;
+}
+
+
+
+int ocp_nlp_solver_snapshot_calculate_size(ocp_nlp_solver *solver, ocp_nlp_out *nlp_out)
+{
+    int size = sizeof(ocp_nlp_snapshot_header);
+    size += snapshot_traverse(solver, nlp_out, NULL, SNAPSHOT_SIZE);
+
+    return size;
+}
+
+
+
+int ocp_nlp_solver_snapshot(ocp_nlp_solver *solver, ocp_nlp_out *nlp_out, void *buffer, int size)
+{
+    ocp_nlp_dims *dims = solver->dims;
+    ocp_qp_out *qp_out;
+    solver->config->get(solver->config, solver->mem, "qp_out", &qp_out);
+
+    int snapshot_size = ocp_nlp_solver_snapshot_calculate_size(solver, nlp_out);
+    if (size < snapshot_size)
+        return ACADOS_FAILURE;
+
+    ocp_nlp_snapshot_header header;
+    header.magic = OCP_NLP_SNAPSHOT_MAGIC;
+    header.version = OCP_NLP_SNAPSHOT_VERSION;
+    header.size = snapshot_size;
+    header.N = dims->N;
+    header.dims_hash = snapshot_dims_hash(dims, qp_out->dim);
+    header.sqp_iter = nlp_out->sqp_iter;
+    header.qp_iter = nlp_out->qp_iter;
+    header.pad = 0;
+
+    char *c_ptr = buffer;
+    memcpy(c_ptr, &header, sizeof(ocp_nlp_snapshot_header));
+    c_ptr += sizeof(ocp_nlp_snapshot_header);
+
+    snapshot_traverse(solver, nlp_out, c_ptr, SNAPSHOT_SAVE);
+
+    return ACADOS_SUCCESS;
+}
+
+
+
+int ocp_nlp_solver_restore(ocp_nlp_solver *solver, ocp_nlp_out *nlp_out, const void *buffer,
+                           int size)
+{
+    ocp_nlp_dims *dims = solver->dims;
+    ocp_qp_out *qp_out;
+    solver->config->get(solver->config, solver->mem, "qp_out", &qp_out);
+
+    if (size < (int) sizeof(ocp_nlp_snapshot_header))
+        return ACADOS_FAILURE;
+
+    ocp_nlp_snapshot_header header;
+    char *c_ptr = (char *) buffer;
+    memcpy(&header, c_ptr, sizeof(ocp_nlp_snapshot_header));
+    c_ptr += sizeof(ocp_nlp_snapshot_header);
+
+    int snapshot_size = ocp_nlp_solver_snapshot_calculate_size(solver, nlp_out);
+
+    // only restore snapshots taken from a solver with the same dimensions
+    if (header.magic != OCP_NLP_SNAPSHOT_MAGIC || header.version != OCP_NLP_SNAPSHOT_VERSION ||
+        header.size != snapshot_size || size < snapshot_size || header.N != dims->N ||
+        header.dims_hash != snapshot_dims_hash(dims, qp_out->dim))
+    {
+        return ACADOS_FAILURE;
+    }
+
+    snapshot_traverse(solver, nlp_out, c_ptr, SNAPSHOT_RESTORE);
+
+    nlp_out->sqp_iter = header.sqp_iter;
+    nlp_out->qp_iter = header.qp_iter;
+
+    return ACADOS_SUCCESS;
+}
@@ -42,10 +42,13 @@ extern "C" {
 // acados
 #include "acados/ocp_nlp/ocp_nlp_common.h"
 #include "acados/ocp_nlp/ocp_nlp_constraints_bgh.h"
+#include "acados/ocp_nlp/ocp_nlp_sqp_tree.h"
+#include "acados/sim/sim_erk_adaptive.h"
 #include "acados/sim/sim_erk_integrator.h"
 #include "acados/sim/sim_irk_integrator.h"
 #include "acados/sim/sim_lifted_irk_integrator.h"
 #include "acados/sim/sim_gnsf.h"
+#include "acados/utils/mem.h"
 // acados_c
 #include "acados_c/ocp_qp_interface.h"
 #include "acados_c/sim_interface.h"
@@ -56,6 +59,7 @@ typedef enum
 {
     SQP,
     SQP_RTI,
+    SQP_TREE,
     INVALID_NLP_SOLVER,
 } ocp_nlp_solver_t;
 
@@ -181,6 +185,24 @@ ocp_nlp_dims *ocp_nlp_dims_create(void *config_);
 void ocp_nlp_dims_destroy(void *dims_);
 
 
+/// Constructs the dimensions of a scenario-tree OCP (plan->nlp_solver = SQP_TREE).
+/// The plan has to be created with N = ocp_nlp_tree_num_nodes(md, Nr, Nh) - 1: cost and
+/// constraints are indexed by node, dynamics by edge, where edge ii leads into node ii+1.
+/// The dimensions are set with ocp_nlp_tree_dims_set_*, nlp_in and nlp_out are created from
+/// tree_dims->nlp_dims.
+///
+/// \param config The configuration struct.
+/// \param md Number of realizations at each branching.
+/// \param Nr Robust horizon (number of stages with branching).
+/// \param Nh Horizon length.
+ocp_nlp_tree_dims *ocp_nlp_tree_dims_create(ocp_nlp_config *config, int md, int Nr, int Nh);
+
+/// Destructor of the scenario-tree dimensions struct.
+///
+/// \param dims_ The dimensions struct.
+void ocp_nlp_tree_dims_destroy(void *dims_);
+
+
 /// Constructs an input struct for a non-linear programs.
 ///
 /// \param config The configuration struct.
@@ -199,8 +221,9 @@ void ocp_nlp_in_destroy(void *in);
 /// \param dims The dimensions struct.
 /// \param in The inputs struct.
 /// \param stage Stage number.
-/// \param field Has to be "Ts" (TBC other options).
-/// \param value The sampling times (floating point).
+/// \param field "Ts" sets the sampling time of the given stage,
+///     "Ts_all" sets all N sampling times from an array (stage is ignored).
+/// \param value The sampling time(s) (floating point).
 void ocp_nlp_in_set(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *in, int stage,
         const char *field, void *value);
 
@@ -275,6 +298,12 @@ int ocp_nlp_dims_get_from_attr(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_n
 /// \param dims The dimensions struct.
 void *ocp_nlp_opts_create(ocp_nlp_config *config, ocp_nlp_dims *dims);
 
+/// Creates an options struct for a scenario-tree OCP.
+///
+/// \param config The configuration struct.
+/// \param dims The scenario-tree dimensions struct.
+void *ocp_nlp_tree_opts_create(ocp_nlp_config *config, ocp_nlp_tree_dims *dims);
+
 /// Destructor of the options.
 ///
 /// \param opts The options struct.
@@ -340,6 +369,15 @@ void ocp_nlp_opts_update(ocp_nlp_config *config, ocp_nlp_dims *dims, void *opts_
 /// \return The solver.
 ocp_nlp_solver *ocp_nlp_solver_create(ocp_nlp_config *config, ocp_nlp_dims *dims, void *opts_);
 
+/// Creates a scenario-tree SQP solver; solve, precompute and get as for the other solvers.
+///
+/// \param config The configuration struct.
+/// \param dims The scenario-tree dimensions struct.
+/// \param opts_ The options struct.
+/// \return The solver.
+ocp_nlp_solver *ocp_nlp_tree_solver_create(ocp_nlp_config *config, ocp_nlp_tree_dims *dims,
+                                           void *opts_);
+
 /// Destructor of the solver.
 ///
 /// \param solver The solver struct.
@@ -353,6 +391,23 @@ void ocp_nlp_solver_destroy(void *solver);
 /// \param nlp_out The outputs struct.
 int ocp_nlp_solve(ocp_nlp_solver *solver, ocp_nlp_in *nlp_in, ocp_nlp_out *nlp_out);
 
+/// Runs K instances of the SQP solver in parallel (one thread per instance if built with
+/// OpenMP), each starting from the initialization in its nlp_out. The first instance that
+/// converges cancels the others, which then report the status ACADOS_CANCELLED (also if they
+/// were not started); if none converges within the deadline, the instance with the
+/// smallest NLP residual is selected. The solvers share config and dims, but each needs its
+/// own opts, nlp_in (external functions keep their work in the struct) and nlp_out.
+///
+/// \param solvers K SQP solvers.
+/// \param nlp_in K inputs structs.
+/// \param nlp_out K outputs structs, holding the initializations.
+/// \param K Number of instances.
+/// \param deadline Wall-clock time budget in seconds, <= 0 for none (overrides time_budget).
+/// \param winner Index of the selected instance.
+/// \return The status of the selected instance.
+int ocp_nlp_solve_multistart(ocp_nlp_solver **solvers, ocp_nlp_in **nlp_in, ocp_nlp_out **nlp_out,
+                             int K, double deadline, int *winner);
+
 /// Performs precomputations for the solver. Needs to be called before
 /// ocl_nlp_solve (TBC).
 ///
@@ -381,6 +436,113 @@ void ocp_nlp_get(ocp_nlp_config *config, ocp_nlp_solver *solver,
 void ocp_nlp_set(ocp_nlp_config *config, ocp_nlp_solver *solver,
 		int stage, const char *field, void *value);
 
+/* shift */
+/// Filling of the last stage in ocp_nlp_shift.
+typedef enum
+{
+    OCP_NLP_SHIFT_DUPLICATE,  // keep the last state and control
+    OCP_NLP_SHIFT_SIMULATE,   // simulate the last state through the dynamics of stage N-1
+} ocp_nlp_shift_t;
+
+/// Shifts the iterate in nlp_out, the QP solution used for warm starting and the integrator
+/// guesses by one stage towards the beginning of the horizon. Vectors of stages with different
+/// dimensions are not moved. Call after a solve, e.g. between two RTI iterations.
+///
+/// \param solver The solver struct.
+/// \param nlp_in The inputs struct (needed for OCP_NLP_SHIFT_SIMULATE).
+/// \param nlp_out The outputs struct.
+/// \param mode Filling of the last stage.
+void ocp_nlp_shift(ocp_nlp_solver *solver, ocp_nlp_in *nlp_in, ocp_nlp_out *nlp_out,
+                   ocp_nlp_shift_t mode);
+
+/* arena */
+/// Solver with inputs and outputs placed in a single aligned memory block.
+typedef struct
+{
+    ocp_nlp_in *nlp_in;
+    ocp_nlp_out *nlp_out;
+    ocp_nlp_solver *solver;
+
+    // footprint in bytes
+    int in_bytes;
+    int out_bytes;
+    int memory_bytes;
+    int workspace_bytes;
+    int total_bytes;  // including alignment
+
+    int flags;
+    void *raw_memory;
+    void *memory;
+} ocp_nlp_arena;
+
+/// Creates nlp_in, nlp_out and the solver in one aligned block, optionally backed by huge
+/// pages, prefaulted and locked in RAM. The members must not be destroyed individually.
+///
+/// \param config The configuration struct.
+/// \param dims The dimensions struct.
+/// \param opts_ The options struct.
+/// \param flags Combination of ACADOS_ARENA_HUGEPAGES, ACADOS_ARENA_PREFAULT, ACADOS_ARENA_MLOCK.
+ocp_nlp_arena *ocp_nlp_arena_create(ocp_nlp_config *config, ocp_nlp_dims *dims, void *opts_,
+                                    int flags);
+
+/// Prints the memory footprint of the arena by module.
+void ocp_nlp_arena_print_footprint(ocp_nlp_config *config, ocp_nlp_dims *dims,
+                                   ocp_nlp_arena *arena);
+
+/// Destructor of the arena.
+void ocp_nlp_arena_destroy(ocp_nlp_arena *arena);
+
+/* static memory */
+/// Counterparts of the *_create functions that take their memory from a caller-provided
+/// buffer (see acados_static_mem) instead of the heap. They return NULL if the buffer is
+/// exhausted, mem->used then holds the size needed so far. The structs must not be destroyed.
+/// ocp_nlp_arena_create places nlp_in, nlp_out and the solver with these on its heap block.
+ocp_nlp_plan *ocp_nlp_plan_create_static(int N, acados_static_mem *mem);
+//
+ocp_nlp_config *ocp_nlp_config_create_static(ocp_nlp_plan plan, acados_static_mem *mem);
+//
+ocp_nlp_dims *ocp_nlp_dims_create_static(ocp_nlp_config *config, acados_static_mem *mem);
+//
+ocp_nlp_in *ocp_nlp_in_create_static(ocp_nlp_config *config, ocp_nlp_dims *dims,
+                                     acados_static_mem *mem);
+//
+ocp_nlp_out *ocp_nlp_out_create_static(ocp_nlp_config *config, ocp_nlp_dims *dims,
+                                       acados_static_mem *mem);
+//
+void *ocp_nlp_opts_create_static(ocp_nlp_config *config, ocp_nlp_dims *dims,
+                                 acados_static_mem *mem);
+/// Calls ocp_nlp_opts_update before sizing the solver memory, like ocp_nlp_solver_create.
+ocp_nlp_solver *ocp_nlp_solver_create_static(ocp_nlp_config *config, ocp_nlp_dims *dims,
+                                             void *opts_, acados_static_mem *mem);
+
+/* snapshot */
+/// Returns the size in bytes of a snapshot of the solver state.
+///
+/// \param solver The solver struct.
+/// \param nlp_out The outputs struct.
+int ocp_nlp_solver_snapshot_calculate_size(ocp_nlp_solver *solver, ocp_nlp_out *nlp_out);
+
+/// Writes the iterate, the QP solution used for warm starting and the integrator guesses
+/// into a flat buffer. The buffer contains no pointers and can be copied or sent to another
+/// process running a solver with the same dimensions on the same architecture.
+///
+/// \param solver The solver struct.
+/// \param nlp_out The outputs struct.
+/// \param buffer The buffer, no alignment required.
+/// \param size Size of the buffer in bytes.
+/// \return ACADOS_SUCCESS, or ACADOS_FAILURE if the buffer is too small.
+int ocp_nlp_solver_snapshot(ocp_nlp_solver *solver, ocp_nlp_out *nlp_out, void *buffer, int size);
+
+/// Restores the solver state from a buffer written by ocp_nlp_solver_snapshot.
+///
+/// \param solver The solver struct.
+/// \param nlp_out The outputs struct.
+/// \param buffer The buffer, no alignment required.
+/// \param size Size of the buffer in bytes.
+/// \return ACADOS_SUCCESS, or ACADOS_FAILURE if the snapshot does not match the solver dimensions.
+int ocp_nlp_solver_restore(ocp_nlp_solver *solver, ocp_nlp_out *nlp_out, const void *buffer,
+                           int size);
+
 
 
 #ifdef __cplusplus
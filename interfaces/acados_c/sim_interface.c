@@ -33,6 +33,7 @@
 
 
 #include "acados/sim/sim_common.h"
+#include "acados/sim/sim_erk_adaptive.h"
 #include "acados/sim/sim_erk_integrator.h"
 #include "acados/sim/sim_gnsf.h"
 #include "acados/sim/sim_irk_integrator.h"
@@ -44,6 +45,9 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
+#if defined(ACADOS_WITH_OPENMP)
+#include <omp.h>
+#endif
 
 #include "acados/utils/mem.h"
 
@@ -78,6 +82,9 @@ sim_config *sim_config_create(sim_solver_plan plan)
             break;
         case LIFTED_IRK:
             sim_lifted_irk_config_initialize_default(solver_config);
+            break;
+        case ERK_ADAPTIVE:
+            sim_erk_adaptive_config_initialize_default(solver_config);
             break;
 		case INVALID_SIM_SOLVER:
             printf("\nerror: sim_config_create: forgot to initialize plan->sim_solver\n");
@@ -315,3 +322,217 @@ int sim_solver_set(sim_solver *solver, const char *field, void *value)
 {
     return solver->config->memory_set(solver->config, solver->dims, solver->mem, field, value);
 }
+
+
+
+/************************************************
+* batch solver
+************************************************/
+
+static int sim_batch_thread_size(sim_config *config, void *dims, void *opts_)
+{
+    int bytes = 0;
+
+    bytes += sim_in_calculate_size(config, dims);
+    bytes += sim_out_calculate_size(config, dims);
+    bytes += config->memory_calculate_size(config, dims, opts_);
+    bytes += config->workspace_calculate_size(config, dims, opts_);
+
+    bytes += 4 * 8;  // align each block
+
+    return bytes;
+}
+
+
+
+int sim_batch_calculate_size(sim_config *config, void *dims, void *opts_, int num_threads)
+{
+    int bytes = sizeof(sim_batch_solver);
+
+    bytes += 2 * num_threads * sizeof(void *);  // in, out
+    bytes += 2 * num_threads * sizeof(void *);  // mem, work
+
+    // start each worker on its own cache line
+    bytes += num_threads * (sim_batch_thread_size(config, dims, opts_) + 64);
+
+    make_int_multiple_of(8, &bytes);
+    bytes += 1 * 8;
+
+    return bytes;
+}
+
+
+
+sim_batch_solver *sim_batch_assign(sim_config *config, void *dims, void *opts_, int num_threads,
+                                   void *raw_memory)
+{
+    char *c_ptr = (char *) raw_memory;
+
+    sim_batch_solver *solver = (sim_batch_solver *) c_ptr;
+    c_ptr += sizeof(sim_batch_solver);
+
+    solver->config = config;
+    solver->dims = dims;
+    solver->opts = opts_;
+    solver->num_threads = num_threads;
+
+    solver->in = (sim_in **) c_ptr;
+    c_ptr += num_threads * sizeof(void *);
+    solver->out = (sim_out **) c_ptr;
+    c_ptr += num_threads * sizeof(void *);
+    solver->mem = (void **) c_ptr;
+    c_ptr += num_threads * sizeof(void *);
+    solver->work = (void **) c_ptr;
+    c_ptr += num_threads * sizeof(void *);
+
+    int nx, nu;
+    config->dims_get(config, dims, "nx", &nx);
+    config->dims_get(config, dims, "nu", &nu);
+
+    for (int ii = 0; ii < num_threads; ii++)
+    {
+        align_char_to(64, &c_ptr);
+
+        solver->in[ii] = sim_in_assign(config, dims, c_ptr);
+        c_ptr += sim_in_calculate_size(config, dims);
+        align_char_to(8, &c_ptr);
+
+        solver->out[ii] = sim_out_assign(config, dims, c_ptr);
+        c_ptr += sim_out_calculate_size(config, dims);
+        align_char_to(8, &c_ptr);
+
+        solver->mem[ii] = config->memory_assign(config, dims, opts_, c_ptr);
+        c_ptr += config->memory_calculate_size(config, dims, opts_);
+        align_char_to(8, &c_ptr);
+
+        solver->work[ii] = (void *) c_ptr;
+        c_ptr += config->workspace_calculate_size(config, dims, opts_);
+
+        // default forward seed [eye(nx), zeros(nx x nu)]
+        for (int jj = 0; jj < nx * (nx + nu); jj++)
+            solver->in[ii]->S_forw[jj] = 0.0;
+        for (int jj = 0; jj < nx; jj++)
+            solver->in[ii]->S_forw[jj * (nx + 1)] = 1.0;
+    }
+
+    assert((char *) raw_memory + sim_batch_calculate_size(config, dims, opts_, num_threads) >=
+           c_ptr);
+
+    return solver;
+}
+
+
+
+sim_batch_solver *sim_batch_solver_create(sim_config *config, void *dims, void *opts_,
+                                          int num_threads)
+{
+    // update Butcher tableau (needed if the user changed ns)
+    config->opts_update(config, dims, opts_);
+
+#if defined(ACADOS_WITH_OPENMP)
+    if (num_threads <= 0)
+        num_threads = omp_get_max_threads();
+#else
+    num_threads = 1;
+#endif
+
+    int bytes = sim_batch_calculate_size(config, dims, opts_, num_threads);
+
+    void *ptr = calloc(1, bytes);
+
+    sim_batch_solver *solver = sim_batch_assign(config, dims, opts_, num_threads, ptr);
+
+    return solver;
+}
+
+
+
+void sim_batch_solver_destroy(void *solver)
+{
+    free(solver);
+}
+
+
+
+int sim_batch_in_set(sim_batch_solver *solver, int thread, const char *field, void *value)
+{
+    if (thread < 0 || thread >= solver->num_threads)
+    {
+        printf("\nerror: sim_batch_in_set: thread %d out of range [0, %d)\n", thread,
+               solver->num_threads);
+        exit(1);
+    }
+
+    return sim_in_set_(solver->config, solver->dims, solver->in[thread], field, value);
+}
+
+
+
+int sim_batch_precompute(sim_batch_solver *solver)
+{
+    sim_config *config = solver->config;
+
+    int status = ACADOS_SUCCESS;
+
+    // every worker owns its memory, so the precomputed quantities are set up once per worker
+    for (int ii = 0; ii < solver->num_threads; ii++)
+    {
+        int flag = config->precompute(config, solver->in[ii], solver->out[ii], solver->opts,
+                                      solver->mem[ii], solver->work[ii]);
+        if (flag != ACADOS_SUCCESS)
+            status = flag;
+    }
+
+    return status;
+}
+
+
+
+int sim_solve_batch(sim_batch_solver *solver, int M, double *x0, double *u, double *xn,
+                    double *S_forw)
+{
+    sim_config *config = solver->config;
+    sim_opts *opts = solver->opts;
+
+    int nx, nu;
+    config->dims_get(config, solver->dims, "nx", &nx);
+    config->dims_get(config, solver->dims, "nu", &nu);
+
+    int nS = opts->sens_forw && S_forw != NULL ? nx * opts->num_forw_sens : 0;
+
+    int status = ACADOS_SUCCESS;
+    int jj;
+
+#if defined(ACADOS_WITH_OPENMP)
+    #pragma omp parallel for num_threads(solver->num_threads) schedule(static) \
+        reduction(max: status)
+#endif
+    for (jj = 0; jj < M; jj++)
+    {
+#if defined(ACADOS_WITH_OPENMP)
+        int thread = omp_get_thread_num();
+#else
+        int thread = 0;
+#endif
+        sim_in *in = solver->in[thread];
+        sim_out *out = solver->out[thread];
+
+        int ii;
+        for (ii = 0; ii < nx; ii++)
+            in->x[ii] = x0[ii * M + jj];
+        for (ii = 0; ii < nu; ii++)
+            in->u[ii] = u[ii * M + jj];
+
+        int flag = config->evaluate(config, in, out, opts, solver->mem[thread],
+                                    solver->work[thread]);
+        if (flag > status)
+            status = flag;
+
+        for (ii = 0; ii < nx; ii++)
+            xn[ii * M + jj] = out->xn[ii];
+        for (ii = 0; ii < nS; ii++)
+            S_forw[ii * M + jj] = out->S_forw[ii];
+    }
+
+    return status;
+}
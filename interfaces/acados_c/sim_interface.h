@@ -49,6 +49,7 @@ typedef enum
 	IRK,
 	GNSF,
 	LIFTED_IRK,
+	ERK_ADAPTIVE,
 	INVALID_SIM_SOLVER,
 } sim_solver_t;
 
@@ -72,6 +73,22 @@ typedef struct
 
 
 
+// batch of trajectories sharing config, dims and opts, with one sim_in / sim_out / memory /
+// workspace per worker thread, all placed in a single arena
+typedef struct
+{
+    sim_config *config;
+    void *dims;
+    void *opts;
+    int num_threads;
+    sim_in **in;    // model and seeds of each worker
+    sim_out **out;
+    void **mem;
+    void **work;
+} sim_batch_solver;
+
+
+
 /* config */
 //
 sim_config *sim_config_create(sim_solver_plan plan);
@@ -129,6 +146,28 @@ int sim_precompute(sim_solver *solver, sim_in *in, sim_out *out);
 //
 int sim_solver_set(sim_solver *solver, const char *field, void *value);
 
+/* batch solver */
+//
+int sim_batch_calculate_size(sim_config *config, void *dims, void *opts_, int num_threads);
+//
+sim_batch_solver *sim_batch_assign(sim_config *config, void *dims, void *opts_, int num_threads,
+                                   void *raw_memory);
+//
+sim_batch_solver *sim_batch_solver_create(sim_config *config, void *dims, void *opts_,
+                                          int num_threads);
+//
+void sim_batch_solver_destroy(void *solver);
+// sets a field of the sim_in of one worker; the external functions must not be shared between
+// workers, since they carry their own workspace
+int sim_batch_in_set(sim_batch_solver *solver, int thread, const char *field, void *value);
+//
+int sim_batch_precompute(sim_batch_solver *solver);
+// simulates M trajectories; structure-of-arrays layout, e.g. x0[ii*M + jj] is state ii of
+// trajectory jj, S_forw[ii*M + jj] entry ii of the column-major forward sensitivities;
+// S_forw can be NULL if no forward sensitivities are requested
+int sim_solve_batch(sim_batch_solver *solver, int M, double *x0, double *u, double *xn,
+                    double *S_forw);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
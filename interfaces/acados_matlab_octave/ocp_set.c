@@ -405,9 +405,11 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
                         int stage = mxGetScalar( prhs[6] );
                         if (stage>=Nf_sum & stage<Nf_sum+NN[jj])
                         {
-                            acados_size = (ext_fun_param_ptr+stage)->np;
+                            // pointers are stored per phase, index relative to the phase start
+                            int kk = stage - Nf_sum;
+                            acados_size = (ext_fun_param_ptr+kk)->np;
                             MEX_DIM_CHECK_VEC(fun_name, field, matlab_size, acados_size);
-                            (ext_fun_param_ptr+stage)->set_param(ext_fun_param_ptr+stage, value);
+                            (ext_fun_param_ptr+kk)->set_param(ext_fun_param_ptr+kk, value);
                         }
                     }
                 }
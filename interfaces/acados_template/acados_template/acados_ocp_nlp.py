@@ -974,7 +974,10 @@ class ocp_nlp_solver_config:
         self.__hessian_approx   = 'GAUSS_NEWTON'              #: hessian approximation
         self.__integrator_type  = 'ERK'                       #: integrator type
         self.__tf               = None                        #: prediction horizon
+        self.__time_steps       = None                        #: (optional) non-uniform sampling times, N entries summing up to tf
         self.__nlp_solver_type  = 'SQP_RTI'                   #: NLP solver 
+        self.__static_memory    = False                       #: place all solver memory in one static buffer instead of the heap
+        self.__static_memory_size = None                      #: (optional) size of the static buffer in bytes, measured at generation time if None
 
     @property
     def qp_solver(self):
@@ -1006,6 +1009,18 @@ class ocp_nlp_solver_config:
     def tf(self):
         return self.__tf
 
+    @property
+    def time_steps(self):
+        return self.__time_steps
+
+    @property
+    def static_memory(self):
+        return self.__static_memory
+
+    @property
+    def static_memory_size(self):
+        return self.__static_memory_size
+
     @hessian_approx.setter
     def hessian_approx(self, hessian_approx):
         hessian_approxs = ('GAUSS_NEWTON')
@@ -1030,6 +1045,27 @@ class ocp_nlp_solver_config:
     def tf(self, tf):
         self.__tf = tf
 
+    @time_steps.setter
+    def time_steps(self, time_steps):
+        time_steps = np.array(time_steps, dtype=float).flatten()
+        if np.any(time_steps <= 0):
+            raise Exception('Invalid time_steps value, all sampling times have to be positive.\n\nExiting.')
+        self.__time_steps = time_steps
+
+    @static_memory.setter
+    def static_memory(self, static_memory):
+        if type(static_memory) == bool:
+            self.__static_memory = static_memory
+        else:
+            raise Exception('Invalid static_memory value, expected bool.\n\nExiting.')
+
+    @static_memory_size.setter
+    def static_memory_size(self, static_memory_size):
+        if type(static_memory_size) == int and static_memory_size > 0:
+            self.__static_memory_size = static_memory_size
+        else:
+            raise Exception('Invalid static_memory_size value, expected positive int.\n\nExiting.')
+
     @nlp_solver_type.setter
     def nlp_solver_type(self, nlp_solver_type):
         nlp_solver_types = ('SQP', 'SQP_RTI')
@@ -77,6 +77,13 @@
 #define NPDN_ {{ dims.npd_e }}
 #define NH_   {{ dims.nh }}
 #define NHN_  {{ dims.nh_e }}
+{%- if solver_config.static_memory %}
+
+// size of the static solver memory in bytes, measured at generation time
+#ifndef ACADOS_STATIC_MEM_SIZE
+#define ACADOS_STATIC_MEM_SIZE {{ solver_config.static_memory_size }}
+#endif
+{%- endif %}
 
 #if NX_ < 1
 #define NX   1
@@ -174,9 +181,59 @@
 #define NHN   NHN_
 #endif
 
+{%- if solver_config.static_memory %}
+// ** static memory **
+// 64 bytes of slack for the alignment of the buffer itself
+static char acados_static_buffer[ACADOS_STATIC_MEM_SIZE + 64];
+static acados_static_mem acados_static_memory;
+{% if solver_config.integrator_type == "ERK" %}
+{% if dims.np < 1 %}
+static external_function_casadi forw_vde_casadi_static[N];
+{% else %}
+static external_function_param_casadi forw_vde_casadi_static[N];
+{% endif %}
+{% if solver_config.hessian_approx == "EXACT" %}
+{% if dims.np < 1 %}
+static external_function_casadi hess_vde_casadi_static[N];
+{% else %}
+static external_function_param_casadi hess_vde_casadi_static[N];
+{% endif %}
+{% endif %}
+{% endif %}
+{% if solver_config.integrator_type == "IRK" %}
+{% if dims.np < 1 %}
+static external_function_casadi impl_dae_fun_static[N];
+static external_function_casadi impl_dae_fun_jac_x_xdot_z_static[N];
+static external_function_casadi impl_dae_jac_x_xdot_u_z_static[N];
+{% else %}
+static external_function_param_casadi impl_dae_fun_static[N];
+static external_function_param_casadi impl_dae_fun_jac_x_xdot_z_static[N];
+static external_function_param_casadi impl_dae_jac_x_xdot_u_z_static[N];
+{% endif %}
+{% endif %}
+{% if dims.npd > 0 %}
+static external_function_casadi p_constraint_static[N];
+{% endif %}
+{% if dims.nh > 0 %}
+static external_function_casadi h_constraint_static[N];
+{% endif %}
+
+int acados_static_mem_used() { return (int) acados_static_memory.used; }
+
+static int acados_static_mem_exhausted(const char *what)
+{
+    printf("\nerror: acados_create: static memory exhausted at %s, ACADOS_STATIC_MEM_SIZE is %d,"
+           " at least %d bytes needed\n", what, ACADOS_STATIC_MEM_SIZE, acados_static_mem_used());
+    return 1;
+}
+{%- endif %}
+
 int acados_create() {
 
     int status = 0;
+    {%- if solver_config.static_memory %}
+    acados_static_mem_init(&acados_static_memory, acados_static_buffer, sizeof(acados_static_buffer));
+    {%- endif %}
 
     double Tf = {{ solver_config.tf }};
 
@@ -420,7 +477,13 @@ int acados_create() {
     nb[N]  = NBXN_;
 
     // Make plan
+    {%- if solver_config.static_memory %}
+    nlp_solver_plan = ocp_nlp_plan_create_static(N, &acados_static_memory);
+    if (nlp_solver_plan == NULL)
+        return acados_static_mem_exhausted("nlp_solver_plan");
+    {%- else %}
     nlp_solver_plan = ocp_nlp_plan_create(N);
+    {%- endif %}
     {% if solver_config.nlp_solver_type == "SQP" %}
     nlp_solver_plan->nlp_solver = SQP;
     {% else %}
@@ -452,10 +515,22 @@ int acados_create() {
     {% if solver_config.hessian_approx == "EXACT" %} 
     nlp_solver_plan->regularization = CONVEXIFICATION;
     {% endif %}
+    {%- if solver_config.static_memory %}
+    nlp_config = ocp_nlp_config_create_static(*nlp_solver_plan, &acados_static_memory);
+    if (nlp_config == NULL)
+        return acados_static_mem_exhausted("nlp_config");
+    {%- else %}
     nlp_config = ocp_nlp_config_create(*nlp_solver_plan);
+    {%- endif %}
 
     /* create and set ocp_nlp_dims */
-	nlp_dims = ocp_nlp_dims_create(nlp_config);
+    {%- if solver_config.static_memory %}
+    nlp_dims = ocp_nlp_dims_create_static(nlp_config, &acados_static_memory);
+    if (nlp_dims == NULL)
+        return acados_static_mem_exhausted("nlp_dims");
+    {%- else %}
+    nlp_dims = ocp_nlp_dims_create(nlp_config);
+    {%- endif %}
 
     ocp_nlp_dims_set_opt_vars(nlp_config, nlp_dims, "nx", nx);
     ocp_nlp_dims_set_opt_vars(nlp_config, nlp_dims, "nu", nu);
@@ -479,7 +554,11 @@ int acados_create() {
     {% endif %}
 
     {% if dims.npd > 0 %}
+    {%- if solver_config.static_memory %}
+    p_constraint = p_constraint_static;
+    {%- else %}
     p_constraint = (external_function_casadi *) malloc(sizeof(external_function_casadi)*N);
+    {%- endif %}
     for (int i = 0; i < N; ++i) {
         // nonlinear part of convex-composite constraint
         p_constraint[i].casadi_fun = &{{ con_p_name }}_p_constraint;
@@ -489,7 +568,12 @@ int acados_create() {
         p_constraint[i].casadi_sparsity_out = &{{ con_p_name }}_p_constraint_sparsity_out;
         p_constraint[i].casadi_work = &{{ con_p_name }}_p_constraint_work;
 
+        {%- if solver_config.static_memory %}
+        if (external_function_casadi_create_array_static(1, &p_constraint[i], &acados_static_memory))
+            return acados_static_mem_exhausted("p_constraint");
+        {%- else %}
         external_function_casadi_create(&p_constraint[i]);
+        {%- endif %}
     }
     {% endif %}
 
@@ -503,11 +587,20 @@ int acados_create() {
 	p_constraint_e.casadi_sparsity_out = &{{ con_p_e_name }}_p_constraint_e_sparsity_out;
 	p_constraint_e.casadi_work = &{{ con_p_e_name }}_p_constraint_e_work;
 
+    {%- if solver_config.static_memory %}
+    if (external_function_casadi_create_array_static(1, &p_constraint_e, &acados_static_memory))
+        return acados_static_mem_exhausted("p_constraint_e");
+    {%- else %}
     external_function_casadi_create(p_constraint_e);
+    {%- endif %}
     {% endif %}
 
     {% if dims.nh > 0 %}
+    {%- if solver_config.static_memory %}
+    h_constraint = h_constraint_static;
+    {%- else %}
     h_constraint = (external_function_casadi *) malloc(sizeof(external_function_casadi)*N);
+    {%- endif %}
     for (int i = 0; i < N; ++i) {
         // nonlinear constraint
         h_constraint[i].casadi_fun = &{{ con_h_name }}_h_constraint;
@@ -517,7 +610,12 @@ int acados_create() {
         h_constraint[i].casadi_sparsity_out = &{{ con_h_name }}_h_constraint_sparsity_out;
         h_constraint[i].casadi_work = &{{ con_h_name }}_h_constraint_work;
 
+        {%- if solver_config.static_memory %}
+        if (external_function_casadi_create_array_static(1, &h_constraint[i], &acados_static_memory))
+            return acados_static_mem_exhausted("h_constraint");
+        {%- else %}
         external_function_casadi_create(&h_constraint[i]);
+        {%- endif %}
     }
     {% endif %}
 
@@ -531,15 +629,28 @@ int acados_create() {
 	h_constraint_e.casadi_sparsity_out = &{{ con_h_e_name }}_h_constraint_e_sparsity_out;
 	p_constraint_e.casadi_work = &{{ con_h_e_name }}_h_constraint_e_work;
 
+    {%- if solver_config.static_memory %}
+    if (external_function_casadi_create_array_static(1, &h_constraint_e, &acados_static_memory))
+        return acados_static_mem_exhausted("h_constraint_e");
+    {%- else %}
     external_function_casadi_create(h_constraint_e);
+    {%- endif %}
     {% endif %}
 
     {% if solver_config.integrator_type == "ERK" %}
     // explicit ode
     {% if dims.np < 1 %}
+    {%- if solver_config.static_memory %}
+    forw_vde_casadi = forw_vde_casadi_static;
+    {%- else %}
     forw_vde_casadi = (external_function_casadi *) malloc(sizeof(external_function_casadi)*N);
+    {%- endif %}
     {% else %}
+    {%- if solver_config.static_memory %}
+    forw_vde_casadi = forw_vde_casadi_static;
+    {%- else %}
     forw_vde_casadi = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    {%- endif %}
     {% endif %}
 
     for (int i = 0; i < N; ++i) {
@@ -549,15 +660,28 @@ int acados_create() {
         forw_vde_casadi[i].casadi_sparsity_in = &{{ model_name }}_expl_vde_forw_sparsity_in;
         forw_vde_casadi[i].casadi_sparsity_out = &{{ model_name }}_expl_vde_forw_sparsity_out;
         forw_vde_casadi[i].casadi_work = &{{ model_name }}_expl_vde_forw_work;
+        {%- if solver_config.static_memory %}
+        if (external_function_casadi_create_array_static(1, &forw_vde_casadi[i], &acados_static_memory))
+            return acados_static_mem_exhausted("forw_vde_casadi");
+        {%- else %}
         external_function_casadi_create(&forw_vde_casadi[i]);
+        {%- endif %}
     }
 
     {% if solver_config.hessian_approx == "EXACT" %} 
     external_function_casadi * hess_vde_casadi;
     {% if dims.np < 1 %}
+    {%- if solver_config.static_memory %}
+    hess_vde_casadi = hess_vde_casadi_static;
+    {%- else %}
     hess_vde_casadi = (external_function_casadi *) malloc(sizeof(external_function_casadi)*N);
+    {%- endif %}
     {% else %}
+    {%- if solver_config.static_memory %}
+    hess_vde_casadi = hess_vde_casadi_static;
+    {%- else %}
     hess_vde_casadi = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    {%- endif %}
     {% endif %}
     for (int i = 0; i < N; ++i) {
         hess_vde_casadi[i].casadi_fun = &{{ model_name }}_expl_ode_hess;
@@ -566,15 +690,28 @@ int acados_create() {
         hess_vde_casadi[i].casadi_sparsity_in = &{{ model_name }}_expl_ode_hess_sparsity_in;
         hess_vde_casadi[i].casadi_sparsity_out = &{{ model_name }}_expl_ode_hess_sparsity_out;
         hess_vde_casadi[i].casadi_work = &{{ model_name }}_expl_ode_hess_work;
+        {%- if solver_config.static_memory %}
+        if (external_function_casadi_create_array_static(1, &hess_vde_casadi[i], &acados_static_memory))
+            return acados_static_mem_exhausted("hess_vde_casadi");
+        {%- else %}
         external_function_casadi_create(&hess_vde_casadi[i]);
+        {%- endif %}
     }
     {% endif %}
     {% elif solver_config.integrator_type == "IRK" %}
     // implicit dae
     {% if dims.np < 1 %}
+    {%- if solver_config.static_memory %}
+    impl_dae_fun = impl_dae_fun_static;
+    {%- else %}
     impl_dae_fun = (external_function_casadi *) malloc(sizeof(external_function_casadi)*N);
+    {%- endif %}
     {% else %}
+    {%- if solver_config.static_memory %}
+    impl_dae_fun = impl_dae_fun_static;
+    {%- else %}
     impl_dae_fun = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    {%- endif %}
     {% endif %}
     for (int i = 0; i < N; ++i) {
         impl_dae_fun[i].casadi_fun = &{{ model_name }}_impl_dae_fun;
@@ -585,16 +722,34 @@ int acados_create() {
         impl_dae_fun[i].casadi_n_out = &{{ model_name }}_impl_dae_fun_n_out;
         // TODO(fix this!!)
         {% if dims.np < 1 %}
+        {%- if solver_config.static_memory %}
+        if (external_function_casadi_create_array_static(1, &impl_dae_fun[i], &acados_static_memory))
+            return acados_static_mem_exhausted("impl_dae_fun");
+        {%- else %}
         external_function_casadi_create(&impl_dae_fun[i]);
+        {%- endif %}
         {% else %}
+        {%- if solver_config.static_memory %}
+        if (external_function_param_casadi_create_array_static(1, &impl_dae_fun[i], {{dims.np}}, &acados_static_memory))
+            return acados_static_mem_exhausted("impl_dae_fun");
+        {%- else %}
         external_function_param_casadi_create(&impl_dae_fun[i], {{dims.np}});
+        {%- endif %}
         {% endif %}
     }
 
     {% if dims.np < 1 %}
+    {%- if solver_config.static_memory %}
+    impl_dae_fun_jac_x_xdot_z = impl_dae_fun_jac_x_xdot_z_static;
+    {%- else %}
     impl_dae_fun_jac_x_xdot_z = (external_function_casadi *) malloc(sizeof(external_function_casadi)*N);
+    {%- endif %}
     {% else %}
+    {%- if solver_config.static_memory %}
+    impl_dae_fun_jac_x_xdot_z = impl_dae_fun_jac_x_xdot_z_static;
+    {%- else %}
     impl_dae_fun_jac_x_xdot_z = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    {%- endif %}
     {% endif %}
     for (int i = 0; i < N; ++i) {
         impl_dae_fun_jac_x_xdot_z[i].casadi_fun = &{{ model_name }}_impl_dae_fun_jac_x_xdot_z;
@@ -604,16 +759,34 @@ int acados_create() {
         impl_dae_fun_jac_x_xdot_z[i].casadi_n_in = &{{ model_name }}_impl_dae_fun_jac_x_xdot_z_n_in;
         impl_dae_fun_jac_x_xdot_z[i].casadi_n_out = &{{ model_name }}_impl_dae_fun_jac_x_xdot_z_n_out;
         {% if dims.np < 1 %}
+        {%- if solver_config.static_memory %}
+        if (external_function_casadi_create_array_static(1, &impl_dae_fun_jac_x_xdot_z[i], &acados_static_memory))
+            return acados_static_mem_exhausted("impl_dae_fun_jac_x_xdot_z");
+        {%- else %}
         external_function_casadi_create(&impl_dae_fun_jac_x_xdot_z[i]);
+        {%- endif %}
         {% else %}
+        {%- if solver_config.static_memory %}
+        if (external_function_param_casadi_create_array_static(1, &impl_dae_fun_jac_x_xdot_z[i], {{dims.np}}, &acados_static_memory))
+            return acados_static_mem_exhausted("impl_dae_fun_jac_x_xdot_z");
+        {%- else %}
         external_function_param_casadi_create(&impl_dae_fun_jac_x_xdot_z[i], {{dims.np}});
+        {%- endif %}
         {% endif %}
     }
 
     {% if dims.np < 1 %}
+    {%- if solver_config.static_memory %}
+    impl_dae_jac_x_xdot_u_z = impl_dae_jac_x_xdot_u_z_static;
+    {%- else %}
     impl_dae_jac_x_xdot_u_z = (external_function_casadi *) malloc(sizeof(external_function_casadi)*N);
+    {%- endif %}
     {% else %}
+    {%- if solver_config.static_memory %}
+    impl_dae_jac_x_xdot_u_z = impl_dae_jac_x_xdot_u_z_static;
+    {%- else %}
     impl_dae_jac_x_xdot_u_z = (external_function_param_casadi *) malloc(sizeof(external_function_param_casadi)*N);
+    {%- endif %}
     {% endif %}
     for (int i = 0; i < N; ++i) {
         impl_dae_jac_x_xdot_u_z[i].casadi_fun = &{{ model_name }}_impl_dae_jac_x_xdot_u_z;
@@ -623,17 +796,41 @@ int acados_create() {
         impl_dae_jac_x_xdot_u_z[i].casadi_n_in = &{{ model_name }}_impl_dae_jac_x_xdot_u_z_n_in;
         impl_dae_jac_x_xdot_u_z[i].casadi_n_out = &{{ model_name }}_impl_dae_jac_x_xdot_u_z_n_out;
         {% if dims.np < 1 %}
+        {%- if solver_config.static_memory %}
+        if (external_function_casadi_create_array_static(1, &impl_dae_jac_x_xdot_u_z[i], &acados_static_memory))
+            return acados_static_mem_exhausted("impl_dae_jac_x_xdot_u_z");
+        {%- else %}
         external_function_casadi_create(&impl_dae_jac_x_xdot_u_z[i]);
+        {%- endif %}
         {% else %}
+        {%- if solver_config.static_memory %}
+        if (external_function_param_casadi_create_array_static(1, &impl_dae_jac_x_xdot_u_z[i], {{dims.np}}, &acados_static_memory))
+            return acados_static_mem_exhausted("impl_dae_jac_x_xdot_u_z");
+        {%- else %}
         external_function_param_casadi_create(&impl_dae_jac_x_xdot_u_z[i], {{dims.np}});
+        {%- endif %}
         {% endif %}
     }
     {% endif %}
 
+    {%- if solver_config.static_memory %}
+    nlp_in = ocp_nlp_in_create_static(nlp_config, nlp_dims, &acados_static_memory);
+    if (nlp_in == NULL)
+        return acados_static_mem_exhausted("nlp_in");
+    {%- else %}
     nlp_in = ocp_nlp_in_create(nlp_config, nlp_dims);
+    {%- endif %}
 
+    {%- if solver_config.time_steps %}
+    double time_steps[N];
+    {%- for item in solver_config.time_steps %}
+    time_steps[{{ loop.index0 }}] = {{ item }};
+    {%- endfor %}
+    ocp_nlp_in_set(nlp_config, nlp_dims, nlp_in, 0, "Ts_all", time_steps);
+    {%- else %}
     for (int i = 0; i < N; ++i)
         nlp_in->Ts[i] = Tf/N;
+    {%- endif %}
 
     // NLP cost linear least squares
     // C  // TODO(oj) this can be done using
@@ -760,7 +957,13 @@ int acados_create() {
     ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, N, "uh", uh_e);
     {% endif %}
 
+    {%- if solver_config.static_memory %}
+    nlp_opts = ocp_nlp_opts_create_static(nlp_config, nlp_dims, &acados_static_memory);
+    if (nlp_opts == NULL)
+        return acados_static_mem_exhausted("nlp_opts");
+    {%- else %}
     nlp_opts = ocp_nlp_opts_create(nlp_config, nlp_dims);
+    {%- endif %}
     
     {% if dims.nz > 0 %}
     bool output_z_val = true; 
@@ -808,12 +1011,24 @@ int acados_create() {
     }
     {% endif %}
 
+    {%- if solver_config.static_memory %}
+    nlp_out = ocp_nlp_out_create_static(nlp_config, nlp_dims, &acados_static_memory);
+    if (nlp_out == NULL)
+        return acados_static_mem_exhausted("nlp_out");
+    {%- else %}
     nlp_out = ocp_nlp_out_create(nlp_config, nlp_dims);
+    {%- endif %}
     for (int i = 0; i <= N; ++i) {
         blasfeo_dvecse(nu[i]+nx[i], 0.0, nlp_out->ux+i, 0);
     }
     
+    {%- if solver_config.static_memory %}
+    nlp_solver = ocp_nlp_solver_create_static(nlp_config, nlp_dims, nlp_opts, &acados_static_memory);
+    if (nlp_solver == NULL)
+        return acados_static_mem_exhausted("nlp_solver");
+    {%- else %}
     nlp_solver = ocp_nlp_solver_create(nlp_config, nlp_dims, nlp_opts);
+    {%- endif %}
 
     // initialize parameters to nominal value
     {% if dims.np > 0%}
@@ -846,6 +1061,10 @@ int acados_solve() {
 }
 
 int acados_free() {
+    {%- if solver_config.static_memory %}
+
+    // all memory is in the static buffer, the next acados_create starts over at its beginning
+    {%- else %}
 
     // free memory
     ocp_nlp_opts_destroy(nlp_opts);
@@ -885,7 +1104,8 @@ int acados_free() {
     {% endif %}
     }
     {% endif %}
-    
+    {%- endif %}
+
     return 0;
 }
 
@@ -895,3 +1115,56 @@ ocp_nlp_solver * acados_get_nlp_solver() { return  nlp_solver; }
 ocp_nlp_config * acados_get_nlp_config() { return  nlp_config; }
 void * acados_get_nlp_opts() { return  nlp_opts; }
 ocp_nlp_dims * acados_get_nlp_dims() { return  nlp_dims; }
+
+
+
+/* zero-copy access to the solver memory */
+
+double * acados_get_ux_ptr(int stage) { return  nlp_out->ux[stage].pa; }
+
+double * acados_get_yref_ptr(int stage)
+{
+    ocp_nlp_cost_ls_model *cost_ls = (ocp_nlp_cost_ls_model *) nlp_in->cost[stage];
+    return cost_ls->y_ref.pa;
+}
+
+
+
+/* one copy per field over the whole horizon */
+
+void acados_get_x_traj(double *x)
+{
+    int offset = 0;
+    for (int i = 0; i <= N; i++)
+    {
+        blasfeo_unpack_dvec(nlp_dims->nx[i], &nlp_out->ux[i], nlp_dims->nu[i], x + offset);
+        offset += nlp_dims->nx[i];
+    }
+}
+
+void acados_get_u_traj(double *u)
+{
+    int offset = 0;
+    for (int i = 0; i < N; i++)
+    {
+        blasfeo_unpack_dvec(nlp_dims->nu[i], &nlp_out->ux[i], 0, u + offset);
+        offset += nlp_dims->nu[i];
+    }
+}
+
+void acados_set_yref_traj(double *yref)
+{
+    int offset = 0;
+    for (int i = 0; i <= N; i++)
+    {
+        ocp_nlp_cost_ls_model *cost_ls = (ocp_nlp_cost_ls_model *) nlp_in->cost[i];
+        blasfeo_pack_dvec(cost_ls->y_ref.m, yref + offset, &cost_ls->y_ref, 0);
+        offset += cost_ls->y_ref.m;
+    }
+}
+
+void acados_set_x0(double *x0)
+{
+    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, 0, "lbx", x0);
+    ocp_nlp_constraints_model_set(nlp_config, nlp_dims, nlp_in, 0, "ubx", x0);
+}
@@ -40,6 +40,10 @@
 int acados_create();
 int acados_solve();
 int acados_free();
+{%- if solver_config.static_memory %}
+// bytes of the static buffer used by acados_create
+int acados_static_mem_used();
+{%- endif %}
 
 ocp_nlp_in * acados_get_nlp_in();
 ocp_nlp_out * acados_get_nlp_out();
@@ -48,6 +52,15 @@ ocp_nlp_config * acados_get_nlp_config();
 void * acados_get_nlp_opts();
 ocp_nlp_dims * acados_get_nlp_dims();
 
+// pointers into the solver memory: [u, x] of nlp_out and yref of the ls cost at a stage
+double * acados_get_ux_ptr(int stage);
+double * acados_get_yref_ptr(int stage);
+// bulk copies, stage after stage: x (N+1 stages), u (N stages), yref (N stages and terminal)
+void acados_get_x_traj(double *x);
+void acados_get_u_traj(double *u);
+void acados_set_yref_traj(double *yref);
+void acados_set_x0(double *x0);
+
 // ** global data **
 extern ocp_nlp_in * nlp_in;
 extern ocp_nlp_out * nlp_out;
@@ -37,10 +37,20 @@ from .generate_c_code_implicit_ode import *
 from .generate_c_code_constraint import *
 from .acados_ocp_nlp import *
 from ctypes import *
+import shutil
+
+# buffer size of the build that measures the static memory of the solver
+STATIC_MEMORY_PROBE_SIZE = 2**26
 
 def generate_solver(model, acados_ocp, con_h=None, con_hN=None, con_p=None, con_pN=None, json_file='acados_ocp_nlp.json'):
     USE_TERA = 0 # EXPERIMENTAL: use Tera standalone parser instead of Jinja2
 
+    # static memory of unknown size: build once with a large buffer and measure it
+    static_memory_probe = acados_ocp.solver_config.static_memory and \
+            acados_ocp.solver_config.static_memory_size is None
+    if static_memory_probe:
+        acados_ocp.solver_config.static_memory_size = STATIC_MEMORY_PROBE_SIZE
+
     ocp_nlp = acados_ocp
     ocp_nlp.cost = acados_ocp.cost.__dict__
     ocp_nlp.constraints = acados_ocp.constraints.__dict__
@@ -119,25 +129,28 @@ def generate_solver(model, acados_ocp, con_h=None, con_hN=None, con_p=None, con_
         os.system(os_cmd)
         os.chdir('..')
         
-    if USE_TERA == 0:
-        # render source template
-        template = env.get_template('acados_solver.in.c')
-        output = template.render(ocp=acados_ocp)
-        # output file
-        out_file = open('./c_generated_code/acados_solver_' + model.name + '.c', 'w+')
-        out_file.write(output)
-    else:
-        os.chdir('c_generated_code')
-        # render source template
-        template_file = 'acados_solver.in.c'
-        out_file = 'acados_solver_' + model.name + '.c'
-        # output file
-        os_cmd = 't_renderer ' + "\"" + template_glob + "\"" + ' ' + "\"" \
-                + template_file + "\"" + ' ' + "\"" + '../' + json_file + \
-                "\"" + ' ' + "\"" + out_file + "\""
+    def render_acados_solver_c():
+        if USE_TERA == 0:
+            # render source template
+            template = env.get_template('acados_solver.in.c')
+            output = template.render(ocp=acados_ocp)
+            # output file
+            with open('./c_generated_code/acados_solver_' + model.name + '.c', 'w+') as out_file:
+                out_file.write(output)
+        else:
+            os.chdir('c_generated_code')
+            # render source template
+            template_file = 'acados_solver.in.c'
+            out_file = 'acados_solver_' + model.name + '.c'
+            # output file
+            os_cmd = 't_renderer ' + "\"" + template_glob + "\"" + ' ' + "\"" \
+                    + template_file + "\"" + ' ' + "\"" + '../' + json_file + \
+                    "\"" + ' ' + "\"" + out_file + "\""
 
-        os.system(os_cmd)
-        os.chdir('..')
+            os.system(os_cmd)
+            os.chdir('..')
+
+    render_acados_solver_c()
 
     if USE_TERA == 0:
         # render source template
@@ -330,7 +343,37 @@ def generate_solver(model, acados_ocp, con_h=None, con_hN=None, con_p=None, con_
     os.system('make shared_lib')
     os.chdir('..')
 
-    solver = acados_solver(acados_ocp, 'c_generated_code/libacados_solver_' + model.name + '.so')
+    shared_lib = 'c_generated_code/libacados_solver_' + model.name + '.so'
+
+    if static_memory_probe:
+        # run acados_create of the probe build on this host; the size depends on the
+        # ABI, so the generated code has to target a compatible platform
+        # (otherwise set solver_config.static_memory_size by hand)
+        probe_lib = 'c_generated_code/libacados_solver_' + model.name + '_probe.so'
+        shutil.copyfile(shared_lib, probe_lib)
+        probe = CDLL(os.path.abspath(probe_lib))
+        if probe.acados_create() != 0:
+            raise Exception('static memory probe failed, the solver needs more than {} bytes: ' \
+                    'set solver_config.static_memory_size.\n\nExiting.'.format(STATIC_MEMORY_PROBE_SIZE))
+        static_memory_size = probe.acados_static_mem_used()
+        os.remove(probe_lib)
+
+        acados_ocp.solver_config.static_memory_size = static_memory_size
+        if USE_TERA != 0:
+            with open(json_file, 'r') as f:
+                ocp_nlp_json = json.load(f)
+            ocp_nlp_json['solver_config']['static_memory_size'] = static_memory_size
+            with open(json_file, 'w') as f:
+                json.dump(ocp_nlp_json, f)
+
+        render_acados_solver_c()
+
+        os.chdir('c_generated_code')
+        os.system('make')
+        os.system('make shared_lib')
+        os.chdir('..')
+
+    solver = acados_solver(acados_ocp, shared_lib)
     return solver
 
 class acados_solver:
@@ -355,6 +398,42 @@ class acados_solver:
 
         self.acados_ocp = acados_ocp
 
+        # argument types of the bulk transfers, set once
+        self.shared_lib.acados_get_ux_ptr.argtypes = [c_int]
+        self.shared_lib.acados_get_ux_ptr.restype = POINTER(c_double)
+        self.shared_lib.acados_get_yref_ptr.argtypes = [c_int]
+        self.shared_lib.acados_get_yref_ptr.restype = POINTER(c_double)
+        self.shared_lib.acados_get_x_traj.argtypes = [c_void_p]
+        self.shared_lib.acados_get_u_traj.argtypes = [c_void_p]
+        self.shared_lib.acados_set_yref_traj.argtypes = [c_void_p]
+        self.shared_lib.acados_set_x0.argtypes = [c_void_p]
+
+        N = acados_ocp.dims.N
+        nx = acados_ocp.dims.nx
+        nu = acados_ocp.dims.nu
+        ny = acados_ocp.dims.ny
+        ny_e = acados_ocp.dims.ny_e
+
+        # NumPy views on the solver memory: writing to x_view, u_view, yref_view changes the
+        # solver data directly, reading them after solve() returns the solution without copies
+        self.x_view = []
+        self.u_view = []
+        self.yref_view = []
+        for i in range(N + 1):
+            nu_i = nu if i < N else 0
+            ux = np.ctypeslib.as_array(self.shared_lib.acados_get_ux_ptr(i), shape=(nu_i + nx,))
+            if i < N:
+                self.u_view.append(ux[:nu_i])
+            self.x_view.append(ux[nu_i:])
+            ny_i = ny if i < N else ny_e
+            self.yref_view.append(np.ctypeslib.as_array(
+                self.shared_lib.acados_get_yref_ptr(i), shape=(ny_i,)))
+
+        # buffers of the bulk copies
+        self._x_traj = np.zeros((N + 1, nx))
+        self._u_traj = np.zeros((N, nu))
+        self._yref_traj = np.zeros((N * ny + ny_e,))
+
     def solve(self):
         status = self.shared_lib.acados_solve()
         return status
@@ -379,6 +458,31 @@ class acados_solver:
 
         return out
 
+    def get_x_traj(self):
+        """returns the states of all stages as (N+1, nx) array, one copy per call"""
+        self.shared_lib.acados_get_x_traj(self._x_traj.ctypes.data)
+        return self._x_traj.copy()
+
+    def get_u_traj(self):
+        """returns the controls of all stages as (N, nu) array, one copy per call"""
+        self.shared_lib.acados_get_u_traj(self._u_traj.ctypes.data)
+        return self._u_traj.copy()
+
+    def set_yref_traj(self, yref, yref_e):
+        """sets yref of stages 0 to N-1 from a (N, ny) array and the terminal one from yref_e"""
+        N = self.acados_ocp.dims.N
+        ny = self.acados_ocp.dims.ny
+        self._yref_traj[:N * ny] = np.asarray(yref, dtype=np.float64).reshape(N * ny)
+        self._yref_traj[N * ny:] = yref_e
+        self.shared_lib.acados_set_yref_traj(self._yref_traj.ctypes.data)
+
+    def set_x0(self, x0):
+        """sets the initial state constraint lbx = ubx = x0 at stage 0"""
+        x0 = np.ascontiguousarray(x0, dtype=np.float64)
+        if x0.shape[0] != self.acados_ocp.dims.nx:
+            raise Exception('acados_solver.set_x0(): mismatching dimension {} (you have {})'.format(self.acados_ocp.dims.nx, x0.shape[0]))
+        self.shared_lib.acados_set_x0(x0.ctypes.data)
+
     def set(self, stage_, field_, value_):
         
         cost = ['y_ref', 'yref']
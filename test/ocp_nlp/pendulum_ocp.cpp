@@ -0,0 +1,421 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+
+#include "test/ocp_nlp/pendulum_ocp.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "acados_c/external_function_interface.h"
+
+#include "blasfeo/include/blasfeo_d_aux.h"
+
+// pendulum_model
+#include "examples/c/pendulum_model/pendulum_model.h"
+
+#define PENDULUM_L 0.8
+#define PENDULUM_TIP_MAX 1.0
+
+
+
+static void pendulum_tip_evaluate(void *self, ext_fun_arg_t *type_in, void **in,
+                                  ext_fun_arg_t *type_out, void **out)
+{
+    int nu = PENDULUM_NU;
+    int nx = PENDULUM_NX;
+
+    struct blasfeo_dvec_args *x_in = (struct blasfeo_dvec_args *) in[0];
+    struct blasfeo_dvec_args *fun_out = (struct blasfeo_dvec_args *) out[0];
+    struct blasfeo_dmat_args *jac_out = (struct blasfeo_dmat_args *) out[1];
+
+    ((pendulum_tip_fun *) self)->n_eval++;
+
+    double p = BLASFEO_DVECEL(x_in->x, x_in->xi+0);
+    double theta = BLASFEO_DVECEL(x_in->x, x_in->xi+2);
+
+    BLASFEO_DVECEL(fun_out->x, fun_out->xi) = p - PENDULUM_L * sin(theta);
+
+    // transposed Jacobian w.r.t. (u, x)
+    for (int ii = 0; ii < nu+nx; ii++)
+        BLASFEO_DMATEL(jac_out->A, jac_out->ai+ii, jac_out->aj) = 0.0;
+    BLASFEO_DMATEL(jac_out->A, jac_out->ai+nu+0, jac_out->aj) = 1.0;
+    BLASFEO_DMATEL(jac_out->A, jac_out->ai+nu+2, jac_out->aj) = - PENDULUM_L * cos(theta);
+}
+
+
+
+void pendulum_ocp_select_casadi(int n, external_function_casadi *expl_ode_fun,
+                                external_function_casadi *expl_vde_for,
+                                external_function_casadi *expl_vde_adj,
+                                external_function_casadi *expl_ode_hes)
+{
+    for (int ii = 0; ii < n; ii++)
+    {
+        expl_ode_fun[ii].casadi_fun = &pendulum_ode_expl_ode_fun;
+        expl_ode_fun[ii].casadi_work = &pendulum_ode_expl_ode_fun_work;
+        expl_ode_fun[ii].casadi_sparsity_in = &pendulum_ode_expl_ode_fun_sparsity_in;
+        expl_ode_fun[ii].casadi_sparsity_out = &pendulum_ode_expl_ode_fun_sparsity_out;
+        expl_ode_fun[ii].casadi_n_in = &pendulum_ode_expl_ode_fun_n_in;
+        expl_ode_fun[ii].casadi_n_out = &pendulum_ode_expl_ode_fun_n_out;
+
+        expl_vde_for[ii].casadi_fun = &pendulum_ode_expl_vde_forw;
+        expl_vde_for[ii].casadi_work = &pendulum_ode_expl_vde_forw_work;
+        expl_vde_for[ii].casadi_sparsity_in = &pendulum_ode_expl_vde_forw_sparsity_in;
+        expl_vde_for[ii].casadi_sparsity_out = &pendulum_ode_expl_vde_forw_sparsity_out;
+        expl_vde_for[ii].casadi_n_in = &pendulum_ode_expl_vde_forw_n_in;
+        expl_vde_for[ii].casadi_n_out = &pendulum_ode_expl_vde_forw_n_out;
+
+        expl_vde_adj[ii].casadi_fun = &pendulum_ode_expl_vde_adj;
+        expl_vde_adj[ii].casadi_work = &pendulum_ode_expl_vde_adj_work;
+        expl_vde_adj[ii].casadi_sparsity_in = &pendulum_ode_expl_vde_adj_sparsity_in;
+        expl_vde_adj[ii].casadi_sparsity_out = &pendulum_ode_expl_vde_adj_sparsity_out;
+        expl_vde_adj[ii].casadi_n_in = &pendulum_ode_expl_vde_adj_n_in;
+        expl_vde_adj[ii].casadi_n_out = &pendulum_ode_expl_vde_adj_n_out;
+
+        expl_ode_hes[ii].casadi_fun = &pendulum_ode_expl_ode_hess;
+        expl_ode_hes[ii].casadi_work = &pendulum_ode_expl_ode_hess_work;
+        expl_ode_hes[ii].casadi_sparsity_in = &pendulum_ode_expl_ode_hess_sparsity_in;
+        expl_ode_hes[ii].casadi_sparsity_out = &pendulum_ode_expl_ode_hess_sparsity_out;
+        expl_ode_hes[ii].casadi_n_in = &pendulum_ode_expl_ode_hess_n_in;
+        expl_ode_hes[ii].casadi_n_out = &pendulum_ode_expl_ode_hess_n_out;
+    }
+}
+
+
+
+static void select_pendulum_casadi(pendulum_ocp *ocp)
+{
+    pendulum_ocp_select_casadi(PENDULUM_N, ocp->expl_ode_fun, ocp->expl_vde_for,
+                               ocp->expl_vde_adj, ocp->expl_ode_hes);
+
+    for (int ii = 0; ii < PENDULUM_N; ii++)
+    {
+        external_function_casadi *fun = &ocp->impl_ode_fun[ii];
+        fun->casadi_fun = &pendulum_ode_impl_ode_fun;
+        fun->casadi_work = &pendulum_ode_impl_ode_fun_work;
+        fun->casadi_sparsity_in = &pendulum_ode_impl_ode_fun_sparsity_in;
+        fun->casadi_sparsity_out = &pendulum_ode_impl_ode_fun_sparsity_out;
+        fun->casadi_n_in = &pendulum_ode_impl_ode_fun_n_in;
+        fun->casadi_n_out = &pendulum_ode_impl_ode_fun_n_out;
+
+        fun = &ocp->impl_ode_fun_jac_x_xdot_u[ii];
+        fun->casadi_fun = &pendulum_ode_impl_ode_fun_jac_x_xdot_u;
+        fun->casadi_work = &pendulum_ode_impl_ode_fun_jac_x_xdot_u_work;
+        fun->casadi_sparsity_in = &pendulum_ode_impl_ode_fun_jac_x_xdot_u_sparsity_in;
+        fun->casadi_sparsity_out = &pendulum_ode_impl_ode_fun_jac_x_xdot_u_sparsity_out;
+        fun->casadi_n_in = &pendulum_ode_impl_ode_fun_jac_x_xdot_u_n_in;
+        fun->casadi_n_out = &pendulum_ode_impl_ode_fun_jac_x_xdot_u_n_out;
+    }
+
+    for (int ii = 0; ii <= PENDULUM_N; ii++)
+    {
+        ocp->tip[ii].evaluate = &pendulum_tip_evaluate;
+        ocp->tip[ii].n_eval = 0;
+    }
+}
+
+
+
+void pendulum_ocp_create_plan(pendulum_ocp *ocp, int nh)
+{
+    int N = PENDULUM_N;
+
+    ocp->nh = nh;
+
+    ocp->x0[0] = 0.0;
+    ocp->x0[1] = 0.0;
+    ocp->x0[2] = 0.6;
+    ocp->x0[3] = 0.0;
+
+    ocp->plan = ocp_nlp_plan_create(N);
+
+    ocp->plan->nlp_solver = SQP;
+    ocp->plan->regularization = NO_REGULARIZE;
+    ocp->plan->ocp_qp_solver_plan.qp_solver = PARTIAL_CONDENSING_HPIPM;
+
+    for (int ii = 0; ii <= N; ii++)
+    {
+        ocp->plan->nlp_cost[ii] = LINEAR_LS;
+        ocp->plan->nlp_constraints[ii] = BGH;
+    }
+
+    for (int ii = 0; ii < N; ii++)
+    {
+        ocp->plan->nlp_dynamics[ii] = CONTINUOUS_MODEL;
+        ocp->plan->sim_solver_plan[ii].sim_solver = ERK;
+    }
+
+    ocp->config = NULL;
+    ocp->dims = NULL;
+    ocp->nlp_in = NULL;
+    ocp->nlp_out = NULL;
+    ocp->nlp_opts = NULL;
+    ocp->solver = NULL;
+}
+
+
+
+void pendulum_ocp_set_stage(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *nlp_in,
+                            int stage, int terminal, double umax)
+{
+    const int nx = PENDULUM_NX;
+    const int nu = PENDULUM_NU;
+    const int ny = nx + nu;
+
+    // cost
+    double diag_w[] = {1.0, 0.1, 10.0, 0.1, 1e-2};
+    double W[ny * ny] = {0};
+    double WN[nx * nx] = {0};
+    double Vx[ny * nx] = {0};
+    double Vu[ny * nu] = {0};
+    double VxN[nx * nx] = {0};
+    double yref[ny] = {0};
+
+    for (int ii = 0; ii < ny; ii++)
+        W[ii * (ny + 1)] = diag_w[ii];
+    for (int ii = 0; ii < nx; ii++)
+    {
+        WN[ii * (nx + 1)] = 10.0 * diag_w[ii];
+        Vx[ii * (ny + 1)] = 1.0;
+        VxN[ii * (nx + 1)] = 1.0;
+    }
+    Vu[nx] = 1.0;
+
+    if (terminal)
+    {
+        ocp_nlp_cost_model_set(config, dims, nlp_in, stage, "W", WN);
+        ocp_nlp_cost_model_set(config, dims, nlp_in, stage, "Vx", VxN);
+        ocp_nlp_cost_model_set(config, dims, nlp_in, stage, "yref", yref);
+        return;
+    }
+
+    ocp_nlp_cost_model_set(config, dims, nlp_in, stage, "W", W);
+    ocp_nlp_cost_model_set(config, dims, nlp_in, stage, "Vx", Vx);
+    ocp_nlp_cost_model_set(config, dims, nlp_in, stage, "Vu", Vu);
+    ocp_nlp_cost_model_set(config, dims, nlp_in, stage, "yref", yref);
+
+    // input bounds
+    int idxbu[] = {0};
+    double lbu[] = {-umax};
+    double ubu[] = {umax};
+
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, stage, "idxbu", idxbu);
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, stage, "lbu", lbu);
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, stage, "ubu", ubu);
+}
+
+
+
+void pendulum_ocp_set_model(pendulum_ocp *ocp, ocp_nlp_in *nlp_in)
+{
+    const int N = PENDULUM_N;
+
+    ocp_nlp_config *config = ocp->config;
+    ocp_nlp_dims *dims = ocp->dims;
+
+    double Ts = PENDULUM_TF / N;
+    for (int ii = 0; ii < N; ii++)
+        ocp_nlp_in_set(config, dims, nlp_in, ii, "Ts", &Ts);
+
+    for (int ii = 0; ii <= N; ii++)
+        pendulum_ocp_set_stage(config, dims, nlp_in, ii, ii == N, PENDULUM_UMAX);
+
+    // dynamics
+    for (int ii = 0; ii < N; ii++)
+    {
+        if (ocp->plan->sim_solver_plan[ii].sim_solver == LIFTED_IRK)
+        {
+            ocp_nlp_dynamics_model_set(config, dims, nlp_in, ii, "impl_ode_fun", &ocp->impl_ode_fun[ii]);
+            ocp_nlp_dynamics_model_set(config, dims, nlp_in, ii, "impl_ode_fun_jac_x_xdot_u",
+                                       &ocp->impl_ode_fun_jac_x_xdot_u[ii]);
+            continue;
+        }
+        ocp_nlp_dynamics_model_set(config, dims, nlp_in, ii, "expl_ode_fun", &ocp->expl_ode_fun[ii]);
+        ocp_nlp_dynamics_model_set(config, dims, nlp_in, ii, "expl_vde_for", &ocp->expl_vde_for[ii]);
+        ocp_nlp_dynamics_model_set(config, dims, nlp_in, ii, "expl_vde_adj", &ocp->expl_vde_adj[ii]);
+        ocp_nlp_dynamics_model_set(config, dims, nlp_in, ii, "expl_ode_hes", &ocp->expl_ode_hes[ii]);
+    }
+
+    // constraints
+    int idxbx0[] = {0, 1, 2, 3};
+    double lh[] = {-PENDULUM_TIP_MAX};
+    double uh[] = {PENDULUM_TIP_MAX};
+
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "idxbx", idxbx0);
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "lbx", ocp->x0);
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "ubx", ocp->x0);
+
+    for (int ii = 1; ii <= N && ocp->nh > 0; ii++)
+    {
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, ii, "nl_constr_h_fun_jac", &ocp->tip[ii]);
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, ii, "lh", lh);
+        ocp_nlp_constraints_model_set(config, dims, nlp_in, ii, "uh", uh);
+    }
+}
+
+
+
+void pendulum_ocp_create(pendulum_ocp *ocp)
+{
+    int N = PENDULUM_N;
+
+    int nx[PENDULUM_N+1], nu[PENDULUM_N+1], nz[PENDULUM_N+1], ns[PENDULUM_N+1];
+    int ny[PENDULUM_N+1], nbx[PENDULUM_N+1], nbu[PENDULUM_N+1], ng[PENDULUM_N+1];
+    int nh[PENDULUM_N+1];
+
+    for (int ii = 0; ii <= N; ii++)
+    {
+        nx[ii] = PENDULUM_NX;
+        nu[ii] = ii < N ? PENDULUM_NU : 0;
+        nz[ii] = 0;
+        ns[ii] = 0;
+        ny[ii] = nx[ii] + nu[ii];
+        nbx[ii] = ii == 0 ? PENDULUM_NX : 0;
+        nbu[ii] = nu[ii];
+        ng[ii] = 0;
+        nh[ii] = ii > 0 ? ocp->nh : 0;
+    }
+
+    ocp->config = ocp_nlp_config_create(*ocp->plan);
+
+    ocp->dims = ocp_nlp_dims_create(ocp->config);
+
+    ocp_nlp_dims_set_opt_vars(ocp->config, ocp->dims, "nx", nx);
+    ocp_nlp_dims_set_opt_vars(ocp->config, ocp->dims, "nu", nu);
+    ocp_nlp_dims_set_opt_vars(ocp->config, ocp->dims, "nz", nz);
+    ocp_nlp_dims_set_opt_vars(ocp->config, ocp->dims, "ns", ns);
+
+    for (int ii = 0; ii <= N; ii++)
+    {
+        ocp_nlp_dims_set_cost(ocp->config, ocp->dims, ii, "ny", &ny[ii]);
+        ocp_nlp_dims_set_constraints(ocp->config, ocp->dims, ii, "nbx", &nbx[ii]);
+        ocp_nlp_dims_set_constraints(ocp->config, ocp->dims, ii, "nbu", &nbu[ii]);
+        ocp_nlp_dims_set_constraints(ocp->config, ocp->dims, ii, "ng", &ng[ii]);
+        ocp_nlp_dims_set_constraints(ocp->config, ocp->dims, ii, "nh", &nh[ii]);
+    }
+
+    select_pendulum_casadi(ocp);
+    external_function_casadi_create_array(N, ocp->expl_ode_fun);
+    external_function_casadi_create_array(N, ocp->expl_vde_for);
+    external_function_casadi_create_array(N, ocp->expl_vde_adj);
+    external_function_casadi_create_array(N, ocp->expl_ode_hes);
+    external_function_casadi_create_array(N, ocp->impl_ode_fun);
+    external_function_casadi_create_array(N, ocp->impl_ode_fun_jac_x_xdot_u);
+
+    ocp->nlp_in = ocp_nlp_in_create(ocp->config, ocp->dims);
+    pendulum_ocp_set_model(ocp, ocp->nlp_in);
+
+    ocp->nlp_out = ocp_nlp_out_create(ocp->config, ocp->dims);
+    pendulum_ocp_init_out(ocp, ocp->nlp_out, 0.0);
+
+    ocp->nlp_opts = ocp_nlp_opts_create(ocp->config, ocp->dims);
+
+    int max_iter = 100;
+    double tol = 1e-8;
+
+    ocp_nlp_opts_set(ocp->config, ocp->nlp_opts, "max_iter", &max_iter);
+    ocp_nlp_opts_set(ocp->config, ocp->nlp_opts, "tol_stat", &tol);
+    ocp_nlp_opts_set(ocp->config, ocp->nlp_opts, "tol_eq", &tol);
+    ocp_nlp_opts_set(ocp->config, ocp->nlp_opts, "tol_ineq", &tol);
+    ocp_nlp_opts_set(ocp->config, ocp->nlp_opts, "tol_comp", &tol);
+}
+
+
+
+void pendulum_ocp_create_solver(pendulum_ocp *ocp)
+{
+    ocp->solver = ocp_nlp_solver_create(ocp->config, ocp->dims, ocp->nlp_opts);
+    ocp_nlp_precompute(ocp->solver, ocp->nlp_in, ocp->nlp_out);
+}
+
+
+
+void pendulum_ocp_set_x0(pendulum_ocp *ocp, ocp_nlp_in *nlp_in, const double *x0)
+{
+    for (int ii = 0; ii < PENDULUM_NX; ii++)
+        ocp->x0[ii] = x0[ii];
+
+    ocp_nlp_constraints_model_set(ocp->config, ocp->dims, nlp_in, 0, "lbx", ocp->x0);
+    ocp_nlp_constraints_model_set(ocp->config, ocp->dims, nlp_in, 0, "ubx", ocp->x0);
+}
+
+
+
+void pendulum_ocp_init_out(pendulum_ocp *ocp, ocp_nlp_out *nlp_out, double u)
+{
+    for (int ii = 0; ii <= PENDULUM_N; ii++)
+    {
+        ocp_nlp_out_set(ocp->config, ocp->dims, nlp_out, ii, "x", ocp->x0);
+        if (ii < PENDULUM_N)
+            ocp_nlp_out_set(ocp->config, ocp->dims, nlp_out, ii, "u", &u);
+    }
+}
+
+
+
+void pendulum_ocp_free(pendulum_ocp *ocp)
+{
+    if (ocp->solver != NULL)
+        ocp_nlp_solver_destroy(ocp->solver);
+    ocp_nlp_opts_destroy(ocp->nlp_opts);
+    ocp_nlp_out_destroy(ocp->nlp_out);
+    ocp_nlp_in_destroy(ocp->nlp_in);
+    ocp_nlp_dims_destroy(ocp->dims);
+    ocp_nlp_config_destroy(ocp->config);
+    ocp_nlp_plan_destroy(ocp->plan);
+
+    external_function_casadi_free_array(PENDULUM_N, ocp->expl_ode_fun);
+    external_function_casadi_free_array(PENDULUM_N, ocp->expl_vde_for);
+    external_function_casadi_free_array(PENDULUM_N, ocp->expl_vde_adj);
+    external_function_casadi_free_array(PENDULUM_N, ocp->expl_ode_hes);
+    external_function_casadi_free_array(PENDULUM_N, ocp->impl_ode_fun);
+    external_function_casadi_free_array(PENDULUM_N, ocp->impl_ode_fun_jac_x_xdot_u);
+}
+
+
+
+double pendulum_ocp_max_diff(pendulum_ocp *ocp, ocp_nlp_out *out_a, ocp_nlp_out *out_b)
+{
+    double max_diff = 0.0;
+    for (int ii = 0; ii <= PENDULUM_N; ii++)
+    {
+        int nv = ocp->dims->nv[ii];
+        for (int jj = 0; jj < nv; jj++)
+        {
+            double diff = fabs(BLASFEO_DVECEL(out_a->ux+ii, jj) - BLASFEO_DVECEL(out_b->ux+ii, jj));
+            max_diff = diff > max_diff ? diff : max_diff;
+        }
+    }
+    return max_diff;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+
+#ifndef TEST_OCP_NLP_PENDULUM_OCP_H_
+#define TEST_OCP_NLP_PENDULUM_OCP_H_
+
+#include "acados/utils/external_function_generic.h"
+#include "acados_c/ocp_nlp_interface.h"
+
+// cart-pole stabilization from a tilted pendulum, states (p, v, theta, omega), force u
+#define PENDULUM_NX 4
+#define PENDULUM_NU 1
+#define PENDULUM_N 20
+#define PENDULUM_TF 1.0
+#define PENDULUM_UMAX 8.0
+
+// horizontal position of the pendulum tip, h(x) = p - l * sin(theta)
+typedef struct
+{
+    void (*evaluate)(void *, ext_fun_arg_t *, void **, ext_fun_arg_t *, void **);
+    int n_eval;  // number of evaluations
+} pendulum_tip_fun;
+
+typedef struct
+{
+    ocp_nlp_plan *plan;
+    ocp_nlp_config *config;
+    ocp_nlp_dims *dims;
+    ocp_nlp_in *nlp_in;
+    ocp_nlp_out *nlp_out;
+    void *nlp_opts;
+    ocp_nlp_solver *solver;
+
+    int nh;  // 1 to bound the tip position on stages 1 to N
+    double x0[PENDULUM_NX];
+
+    external_function_casadi expl_ode_fun[PENDULUM_N];
+    external_function_casadi expl_vde_for[PENDULUM_N];
+    external_function_casadi expl_vde_adj[PENDULUM_N];
+    external_function_casadi expl_ode_hes[PENDULUM_N];
+    external_function_casadi impl_ode_fun[PENDULUM_N];  // for LIFTED_IRK
+    external_function_casadi impl_ode_fun_jac_x_xdot_u[PENDULUM_N];
+    pendulum_tip_fun tip[PENDULUM_N+1];
+} pendulum_ocp;
+
+// default plan: SQP, partial condensing HPIPM, ERK, no regularization;
+// the plan can be modified before pendulum_ocp_create (ERK or LIFTED_IRK dynamics)
+void pendulum_ocp_create_plan(pendulum_ocp *ocp, int nh);
+
+// creates config, dims, nlp_in, nlp_out and opts from the plan and sets the model;
+// options can be set before pendulum_ocp_create_solver
+void pendulum_ocp_create(pendulum_ocp *ocp);
+
+void pendulum_ocp_create_solver(pendulum_ocp *ocp);
+
+// selects the casadi functions of the pendulum ode for n stages
+void pendulum_ocp_select_casadi(int n, external_function_casadi *expl_ode_fun,
+                                external_function_casadi *expl_vde_for,
+                                external_function_casadi *expl_vde_adj,
+                                external_function_casadi *expl_ode_hes);
+
+// sets the least-squares cost and the input bounds of a stage (only the cost if terminal)
+void pendulum_ocp_set_stage(ocp_nlp_config *config, ocp_nlp_dims *dims, ocp_nlp_in *nlp_in,
+                            int stage, int terminal, double umax);
+
+// sets cost, dynamics and constraints, e.g. of a second nlp_in of the same dims
+void pendulum_ocp_set_model(pendulum_ocp *ocp, ocp_nlp_in *nlp_in);
+
+void pendulum_ocp_set_x0(pendulum_ocp *ocp, ocp_nlp_in *nlp_in, const double *x0);
+
+// initializes the states with x0 and the controls with u
+void pendulum_ocp_init_out(pendulum_ocp *ocp, ocp_nlp_out *nlp_out, double u);
+
+void pendulum_ocp_free(pendulum_ocp *ocp);
+
+// largest absolute difference of the primal variables of two iterates
+double pendulum_ocp_max_diff(pendulum_ocp *ocp, ocp_nlp_out *out_a, ocp_nlp_out *out_b);
+
+#endif  // TEST_OCP_NLP_PENDULUM_OCP_H_
@@ -0,0 +1,1250 @@
+/*
+ * Copyright 2019 Gianluca Frison, Dimitris Kouzoupis, Robin Verschueren,
+ * Andrea Zanelli, Niels van Duijkeren, Jonathan Frey, Tommaso Sartor,
+ * Branimir Novoselnik, Rien Quirynen, Rezart Qelibari, Dang Doan,
+ * Jonas Koenemann, Yutao Chen, Tobias Schöls, Jonas Schlagenhauf, Moritz Diehl
+ *
+ * This file is part of acados.
+ *
+ * The 2-Clause BSD License
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.;
+ */
+
+
+// behavioural tests of solver features on the pendulum OCP
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "catch/include/catch.hpp"
+
+#include "acados/ocp_nlp/ocp_nlp_sqp.h"
+#include "acados/ocp_nlp/ocp_nlp_sqp_rti.h"
+#include "acados/utils/types.h"
+#include "acados_c/external_function_interface.h"
+#include "acados_c/ocp_nlp_interface.h"
+#include "acados_c/sim_interface.h"
+
+#include "blasfeo/include/blasfeo_d_aux.h"
+
+#include "test/ocp_nlp/pendulum_ocp.h"
+
+using std::vector;
+
+
+
+// primal variables of all stages, concatenated
+static vector<double> pendulum_ux(pendulum_ocp *ocp, ocp_nlp_out *nlp_out)
+{
+    vector<double> ux;
+    for (int ii = 0; ii <= PENDULUM_N; ii++)
+        for (int jj = 0; jj < ocp->dims->nv[ii]; jj++)
+            ux.push_back(BLASFEO_DVECEL(nlp_out->ux+ii, jj));
+    return ux;
+}
+
+
+
+TEST_CASE("pendulum snapshot and restore", "[ocp_nlp]")
+{
+    pendulum_ocp ocp;
+    pendulum_ocp_create_plan(&ocp, 0);
+    pendulum_ocp_create(&ocp);
+    pendulum_ocp_create_solver(&ocp);
+
+    REQUIRE(ocp_nlp_solve(ocp.solver, ocp.nlp_in, ocp.nlp_out) == ACADOS_SUCCESS);
+
+    int size = ocp_nlp_solver_snapshot_calculate_size(ocp.solver, ocp.nlp_out);
+    vector<char> buffer(size);
+    REQUIRE(ocp_nlp_solver_snapshot(ocp.solver, ocp.nlp_out, buffer.data(), size) ==
+            ACADOS_SUCCESS);
+
+    // re-solve from the snapshot for a perturbed initial state, twice
+    double x0[PENDULUM_NX] = {0.1, 0.0, 0.5, 0.2};
+    pendulum_ocp_set_x0(&ocp, ocp.nlp_in, x0);
+
+    int status_1 = ocp_nlp_solve(ocp.solver, ocp.nlp_in, ocp.nlp_out);
+    vector<double> ux_1 = pendulum_ux(&ocp, ocp.nlp_out);
+    int sqp_iter_1;
+    ocp_nlp_get(ocp.config, ocp.solver, "sqp_iter", &sqp_iter_1);
+
+    REQUIRE(ocp_nlp_solver_restore(ocp.solver, ocp.nlp_out, buffer.data(), size) ==
+            ACADOS_SUCCESS);
+
+    int status_2 = ocp_nlp_solve(ocp.solver, ocp.nlp_in, ocp.nlp_out);
+    vector<double> ux_2 = pendulum_ux(&ocp, ocp.nlp_out);
+    int sqp_iter_2;
+    ocp_nlp_get(ocp.config, ocp.solver, "sqp_iter", &sqp_iter_2);
+
+    REQUIRE(status_1 == ACADOS_SUCCESS);
+    REQUIRE(status_2 == status_1);
+    REQUIRE(sqp_iter_2 == sqp_iter_1);
+    REQUIRE(ux_2.size() == ux_1.size());
+    REQUIRE(memcmp(ux_2.data(), ux_1.data(), ux_1.size() * sizeof(double)) == 0);
+
+    // a buffer that is too small is rejected
+    REQUIRE(ocp_nlp_solver_restore(ocp.solver, ocp.nlp_out, buffer.data(), size - 1) ==
+            ACADOS_FAILURE);
+
+    pendulum_ocp_free(&ocp);
+}
+
+
+
+TEST_CASE("pendulum arena solve", "[ocp_nlp]")
+{
+    pendulum_ocp ocp;
+    pendulum_ocp_create_plan(&ocp, 0);
+    pendulum_ocp_create(&ocp);
+    pendulum_ocp_create_solver(&ocp);
+
+    REQUIRE(ocp_nlp_solve(ocp.solver, ocp.nlp_in, ocp.nlp_out) == ACADOS_SUCCESS);
+
+    // same problem with inputs, outputs and solver in one block
+    ocp_nlp_arena *arena = ocp_nlp_arena_create(ocp.config, ocp.dims, ocp.nlp_opts, 0);
+    REQUIRE(arena != NULL);
+
+    pendulum_ocp_set_model(&ocp, arena->nlp_in);
+    pendulum_ocp_init_out(&ocp, arena->nlp_out, 0.0);
+    ocp_nlp_precompute(arena->solver, arena->nlp_in, arena->nlp_out);
+
+    REQUIRE(ocp_nlp_solve(arena->solver, arena->nlp_in, arena->nlp_out) == ACADOS_SUCCESS);
+
+    int sqp_iter_heap, sqp_iter_arena;
+    ocp_nlp_get(ocp.config, ocp.solver, "sqp_iter", &sqp_iter_heap);
+    ocp_nlp_get(ocp.config, arena->solver, "sqp_iter", &sqp_iter_arena);
+
+    REQUIRE(sqp_iter_arena == sqp_iter_heap);
+    REQUIRE(pendulum_ocp_max_diff(&ocp, arena->nlp_out, ocp.nlp_out) == 0.0);
+
+    ocp_nlp_arena_destroy(arena);
+    pendulum_ocp_free(&ocp);
+}
+
+
+
+TEST_CASE("pendulum multi-level iterations", "[ocp_nlp]")
+{
+    // reference: full SQP
+    pendulum_ocp ref;
+    pendulum_ocp_create_plan(&ref, 0);
+    pendulum_ocp_create(&ref);
+    pendulum_ocp_create_solver(&ref);
+
+    REQUIRE(ocp_nlp_solve(ref.solver, ref.nlp_in, ref.nlp_out) == ACADOS_SUCCESS);
+
+    // RTI with exact adjoints for level C
+    pendulum_ocp rti;
+    pendulum_ocp_create_plan(&rti, 0);
+    rti.plan->nlp_solver = SQP_RTI;
+    pendulum_ocp_create(&rti);
+
+    int compute_adj = 1;
+    for (int ii = 0; ii < PENDULUM_N; ii++)
+        ocp_nlp_dynamics_opts_set(rti.config, rti.nlp_opts, ii, "compute_adj", &compute_adj);
+
+    pendulum_ocp_create_solver(&rti);
+
+    int mli_level;
+
+    // full linearizations to get close to the solution
+    for (int ii = 0; ii < 5; ii++)
+    {
+        REQUIRE(ocp_nlp_solve(rti.solver, rti.nlp_in, rti.nlp_out) == ACADOS_SUCCESS);
+        ocp_nlp_get(rti.config, rti.solver, "mli_level", &mli_level);
+        REQUIRE(mli_level == MLI_LEVEL_D);
+    }
+
+    SECTION("level C converges to the NLP solution")
+    {
+        // the adjoint-based gradient correction makes the NLP solution a fixed point, even with
+        // the Jacobians of the last level D iteration
+        int level = MLI_LEVEL_C;
+        ocp_nlp_opts_set(rti.config, rti.nlp_opts, "mli_level", &level);
+
+        for (int ii = 0; ii < 50; ii++)
+        {
+            REQUIRE(ocp_nlp_solve(rti.solver, rti.nlp_in, rti.nlp_out) == ACADOS_SUCCESS);
+            ocp_nlp_get(rti.config, rti.solver, "mli_level", &mli_level);
+            REQUIRE(mli_level == MLI_LEVEL_C);
+        }
+
+        double diff = pendulum_ocp_max_diff(&ref, rti.nlp_out, ref.nlp_out);
+        std::cout << "\n---> MLI level C, max difference to SQP: " << diff << "\n";
+        REQUIRE(diff <= 1e-6);
+    }
+
+    SECTION("full period")
+    {
+        // level B in between level D iterations every third call
+        int level = MLI_LEVEL_B;
+        int period = 3;
+        ocp_nlp_opts_set(rti.config, rti.nlp_opts, "mli_level", &level);
+        ocp_nlp_opts_set(rti.config, rti.nlp_opts, "mli_full_period", &period);
+
+        for (int ii = 0; ii < 2 * period; ii++)
+        {
+            REQUIRE(ocp_nlp_solve(rti.solver, rti.nlp_in, rti.nlp_out) == ACADOS_SUCCESS);
+            ocp_nlp_get(rti.config, rti.solver, "mli_level", &mli_level);
+            // the counter includes the 5 level D iterations above
+            REQUIRE(mli_level == ((5 + ii) % period == 0 ? MLI_LEVEL_D : MLI_LEVEL_B));
+        }
+    }
+
+    pendulum_ocp_free(&rti);
+    pendulum_ocp_free(&ref);
+}
+
+
+
+TEST_CASE("pendulum multi-level iterations with lifted IRK", "[ocp_nlp]")
+{
+    // lifted IRK always propagates forward sensitivities, they must not reach the fixed BAbt
+    pendulum_ocp rti;
+    pendulum_ocp_create_plan(&rti, 0);
+    rti.plan->nlp_solver = SQP_RTI;
+    for (int ii = 0; ii < PENDULUM_N; ii++)
+        rti.plan->sim_solver_plan[ii].sim_solver = LIFTED_IRK;
+    pendulum_ocp_create(&rti);
+    pendulum_ocp_create_solver(&rti);
+
+    for (int ii = 0; ii < 5; ii++)
+        REQUIRE(ocp_nlp_solve(rti.solver, rti.nlp_in, rti.nlp_out) == ACADOS_SUCCESS);
+
+    ocp_qp_in *qp_in = ((ocp_nlp_sqp_rti_memory *) rti.solver->mem)->qp_in;
+    int nux = PENDULUM_NU + PENDULUM_NX;
+
+    vector<double> BAbt_lin(PENDULUM_N * nux * PENDULUM_NX);
+    for (int ii = 0; ii < PENDULUM_N; ii++)
+        blasfeo_unpack_dmat(nux, PENDULUM_NX, qp_in->BAbt+ii, 0, 0,
+                            &BAbt_lin[ii * nux * PENDULUM_NX], nux);
+
+    int level = MLI_LEVEL_B;
+    ocp_nlp_opts_set(rti.config, rti.nlp_opts, "mli_level", &level);
+
+    vector<double> BAbt(nux * PENDULUM_NX);
+    for (int kk = 0; kk < 6; kk++)
+    {
+        // the last calls also predict x0 over a delay with the stage 0 integrator
+        if (kk == 3)
+        {
+            double delay = 0.4 * PENDULUM_TF / PENDULUM_N;
+            ocp_nlp_opts_set(rti.config, rti.nlp_opts, "delay", &delay);
+        }
+
+        REQUIRE(ocp_nlp_solve(rti.solver, rti.nlp_in, rti.nlp_out) == ACADOS_SUCCESS);
+
+        for (int ii = 0; ii < PENDULUM_N; ii++)
+        {
+            blasfeo_unpack_dmat(nux, PENDULUM_NX, qp_in->BAbt+ii, 0, 0, BAbt.data(), nux);
+            for (int jj = 0; jj < nux * PENDULUM_NX; jj++)
+                REQUIRE(BAbt[jj] == BAbt_lin[ii * nux * PENDULUM_NX + jj]);
+        }
+    }
+
+    pendulum_ocp_free(&rti);
+}
+
+
+
+TEST_CASE("pendulum quasi-Newton SQP", "[ocp_nlp]")
+{
+    // reference: exact Hessian, mirrored to be positive definite
+    pendulum_ocp ref;
+    pendulum_ocp_create_plan(&ref, 0);
+    ref.plan->regularization = MIRROR;
+    pendulum_ocp_create(&ref);
+
+    int exact_hess = 1;
+    ocp_nlp_opts_set(ref.config, ref.nlp_opts, "exact_hess", &exact_hess);
+
+    pendulum_ocp_create_solver(&ref);
+
+    REQUIRE(ocp_nlp_solve(ref.solver, ref.nlp_in, ref.nlp_out) == ACADOS_SUCCESS);
+
+    for (int qn_update : {QN_BFGS, QN_SR1})
+    {
+        SECTION(qn_update == QN_BFGS ? "BFGS" : "SR1")
+        {
+            pendulum_ocp qn;
+            pendulum_ocp_create_plan(&qn, 0);
+            qn.plan->regularization = MIRROR;
+            pendulum_ocp_create(&qn);
+
+            int max_iter = 200;
+            ocp_nlp_opts_set(qn.config, qn.nlp_opts, "max_iter", &max_iter);
+            ocp_nlp_opts_set(qn.config, qn.nlp_opts, "qn_update", &qn_update);
+            // has no effect with a quasi-Newton update, the modules skip the exact Hessian
+            ocp_nlp_opts_set(qn.config, qn.nlp_opts, "exact_hess", &exact_hess);
+
+            pendulum_ocp_create_solver(&qn);
+
+            REQUIRE(ocp_nlp_solve(qn.solver, qn.nlp_in, qn.nlp_out) == ACADOS_SUCCESS);
+
+            int sqp_iter;
+            ocp_nlp_get(qn.config, qn.solver, "sqp_iter", &sqp_iter);
+            double diff = pendulum_ocp_max_diff(&ref, qn.nlp_out, ref.nlp_out);
+            std::cout << "\n---> quasi-Newton SQP: " << sqp_iter
+                      << " iterations, max difference to exact Hessian SQP: " << diff << "\n";
+            REQUIRE(diff <= 1e-6);
+
+            pendulum_ocp_free(&qn);
+        }
+    }
+
+    pendulum_ocp_free(&ref);
+}
+
+
+
+TEST_CASE("pendulum SQP time budget", "[ocp_nlp]")
+{
+    pendulum_ocp ocp;
+    pendulum_ocp_create_plan(&ocp, 0);
+    pendulum_ocp_create(&ocp);
+
+    int sqp_iter;
+
+    SECTION("exceeded")
+    {
+        // less than a single linearization of the 20 stages
+        double time_budget = 1e-6;
+        ocp_nlp_opts_set(ocp.config, ocp.nlp_opts, "time_budget", &time_budget);
+        pendulum_ocp_create_solver(&ocp);
+
+        REQUIRE(ocp_nlp_solve(ocp.solver, ocp.nlp_in, ocp.nlp_out) == ACADOS_TIMEOUT);
+
+        ocp_nlp_get(ocp.config, ocp.solver, "sqp_iter", &sqp_iter);
+        REQUIRE(sqp_iter == 0);
+    }
+
+    SECTION("sufficient")
+    {
+        double time_budget = 10.0;
+        ocp_nlp_opts_set(ocp.config, ocp.nlp_opts, "time_budget", &time_budget);
+        pendulum_ocp_create_solver(&ocp);
+
+        REQUIRE(ocp_nlp_solve(ocp.solver, ocp.nlp_in, ocp.nlp_out) == ACADOS_SUCCESS);
+
+        ocp_nlp_get(ocp.config, ocp.solver, "sqp_iter", &sqp_iter);
+        REQUIRE(sqp_iter > 0);
+    }
+
+    pendulum_ocp_free(&ocp);
+}
+
+
+// independent ERK simulation of the pendulum over T
+static void pendulum_simulate(pendulum_ocp *ocp, const double *x, const double *u, double T,
+                              double *xn)
+{
+    int nx = PENDULUM_NX;
+    int nu = PENDULUM_NU;
+
+    sim_solver_plan plan;
+    plan.sim_solver = ERK;
+    sim_config *config = sim_config_create(plan);
+    void *dims = sim_dims_create(config);
+    sim_dims_set(config, dims, "nx", &nx);
+    sim_dims_set(config, dims, "nu", &nu);
+    void *opts = sim_opts_create(config, dims);
+    bool sens_forw = false;
+    sim_opts_set(config, opts, "sens_forw", &sens_forw);
+    sim_in *in = sim_in_create(config, dims);
+    sim_out *out = sim_out_create(config, dims);
+
+    sim_in_set(config, dims, in, "T", &T);
+    sim_in_set(config, dims, in, "expl_ode_fun", &ocp->expl_ode_fun[0]);
+    sim_in_set(config, dims, in, "expl_vde_for", &ocp->expl_vde_for[0]);
+    sim_in_set(config, dims, in, "x", (void *) x);
+    sim_in_set(config, dims, in, "u", (void *) u);
+
+    sim_solver *solver = sim_solver_create(config, dims, opts);
+    REQUIRE(sim_solve(solver, in, out) == ACADOS_SUCCESS);
+    sim_out_get(config, dims, out, "xn", xn);
+
+    sim_solver_destroy(solver);
+    sim_out_destroy(out);
+    sim_in_destroy(in);
+    sim_opts_destroy(opts);
+    sim_dims_destroy(dims);
+    sim_config_destroy(config);
+}
+
+
+
+TEST_CASE("pendulum state transition to a reduced terminal state", "[ocp_nlp]")
+{
+    const int nx = PENDULUM_NX;
+    const int nu = PENDULUM_NU;
+    const int nx1 = 2;
+    const double Ts = PENDULUM_TF / PENDULUM_N;
+
+    // provides the pendulum model and the reference integration
+    pendulum_ocp ref;
+    pendulum_ocp_create_plan(&ref, 0);
+    pendulum_ocp_create(&ref);
+
+    // one pendulum stage mapped to (tip position, angular velocity) at the terminal stage
+    double T_tr[nx1 * nx] = {0};
+    T_tr[0 + nx1 * 0] = 1.0;
+    T_tr[0 + nx1 * 2] = -0.8;
+    T_tr[1 + nx1 * 3] = 1.0;
+
+    ocp_nlp_plan *plan = ocp_nlp_plan_create(1);
+    plan->nlp_solver = SQP_RTI;
+    plan->regularization = NO_REGULARIZE;
+    plan->ocp_qp_solver_plan.qp_solver = PARTIAL_CONDENSING_HPIPM;
+    for (int ii = 0; ii <= 1; ii++)
+    {
+        plan->nlp_cost[ii] = LINEAR_LS;
+        plan->nlp_constraints[ii] = BGH;
+    }
+    plan->nlp_dynamics[0] = CONTINUOUS_MODEL;
+    plan->sim_solver_plan[0].sim_solver = ERK;
+
+    ocp_nlp_config *config = ocp_nlp_config_create(*plan);
+    ocp_nlp_dims *dims = ocp_nlp_dims_create(config);
+
+    int nx_v[] = {nx, nx1};
+    int nu_v[] = {nu, 0};
+    int zero_v[] = {0, 0};
+    int ny_v[] = {nx + nu, nx1};
+    int nbx_v[] = {nx, 0};
+
+    ocp_nlp_dims_set_opt_vars(config, dims, "nx", nx_v);
+    ocp_nlp_dims_set_opt_vars(config, dims, "nu", nu_v);
+    ocp_nlp_dims_set_opt_vars(config, dims, "nz", zero_v);
+    ocp_nlp_dims_set_opt_vars(config, dims, "ns", zero_v);
+    for (int ii = 0; ii <= 1; ii++)
+    {
+        ocp_nlp_dims_set_cost(config, dims, ii, "ny", &ny_v[ii]);
+        ocp_nlp_dims_set_constraints(config, dims, ii, "nbx", &nbx_v[ii]);
+        ocp_nlp_dims_set_constraints(config, dims, ii, "nbu", &nu_v[ii]);
+        ocp_nlp_dims_set_constraints(config, dims, ii, "ng", &zero_v[ii]);
+        ocp_nlp_dims_set_constraints(config, dims, ii, "nh", &zero_v[ii]);
+    }
+
+    ocp_nlp_in *nlp_in = ocp_nlp_in_create(config, dims);
+    ocp_nlp_in_set(config, dims, nlp_in, 0, "Ts", (void *) &Ts);
+
+    pendulum_ocp_set_stage(config, dims, nlp_in, 0, 0, PENDULUM_UMAX);
+
+    double W1[nx1 * nx1] = {1.0, 0.0, 0.0, 1.0};
+    double yref1[nx1] = {0.0, 0.0};
+    ocp_nlp_cost_model_set(config, dims, nlp_in, 1, "W", W1);
+    ocp_nlp_cost_model_set(config, dims, nlp_in, 1, "Vx", W1);
+    ocp_nlp_cost_model_set(config, dims, nlp_in, 1, "yref", yref1);
+
+    ocp_nlp_dynamics_model_set(config, dims, nlp_in, 0, "expl_ode_fun", &ref.expl_ode_fun[0]);
+    ocp_nlp_dynamics_model_set(config, dims, nlp_in, 0, "expl_vde_for", &ref.expl_vde_for[0]);
+    ocp_nlp_dynamics_model_set(config, dims, nlp_in, 0, "expl_vde_adj", &ref.expl_vde_adj[0]);
+    ocp_nlp_dynamics_model_set(config, dims, nlp_in, 0, "expl_ode_hes", &ref.expl_ode_hes[0]);
+    ocp_nlp_dynamics_model_set(config, dims, nlp_in, 0, "state_transition", T_tr);
+
+    int idxbx0[] = {0, 1, 2, 3};
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "idxbx", idxbx0);
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "lbx", ref.x0);
+    ocp_nlp_constraints_model_set(config, dims, nlp_in, 0, "ubx", ref.x0);
+
+    // linearization point, the terminal state is off the transition
+    double u0[nu] = {1.5};
+    double x1[nx1] = {0.1, -0.2};
+    ocp_nlp_out *nlp_out = ocp_nlp_out_create(config, dims);
+    ocp_nlp_out_set(config, dims, nlp_out, 0, "x", ref.x0);
+    ocp_nlp_out_set(config, dims, nlp_out, 0, "u", u0);
+    ocp_nlp_out_set(config, dims, nlp_out, 1, "x", x1);
+
+    void *nlp_opts = ocp_nlp_opts_create(config, dims);
+    ocp_nlp_solver *solver = ocp_nlp_solver_create(config, dims, nlp_opts);
+    ocp_nlp_precompute(solver, nlp_in, nlp_out);
+
+    // a single RTI call linearizes at the initial guess
+    REQUIRE(ocp_nlp_solve(solver, nlp_in, nlp_out) == ACADOS_SUCCESS);
+
+    ocp_nlp_sqp_rti_memory *mem = (ocp_nlp_sqp_rti_memory *) solver->mem;
+
+    vector<double> BAbt((nu + nx) * nx1), fun(nx1);
+    blasfeo_unpack_dmat(nu + nx, nx1, mem->qp_in->BAbt, 0, 0, BAbt.data(), nu + nx);
+    blasfeo_unpack_dvec(nx1, mem->nlp_mem->dyn_fun, 0, fun.data());
+
+    // reference: fun = T_tr * xn(u0, x0) - x1, BAbt by central differences in (u, x)
+    vector<double> ux0(nu + nx), ux_p(nu + nx), ux_m(nu + nx);
+    ux0[0] = u0[0];
+    for (int jj = 0; jj < nx; jj++)
+        ux0[nu + jj] = ref.x0[jj];
+
+    vector<double> xn(nx), xn_p(nx), xn_m(nx);
+    pendulum_simulate(&ref, &ux0[nu], &ux0[0], Ts, xn.data());
+
+    double fun_err = 0.0;
+    for (int kk = 0; kk < nx1; kk++)
+    {
+        double fun_ref = - x1[kk];
+        for (int jj = 0; jj < nx; jj++)
+            fun_ref += T_tr[kk + nx1 * jj] * xn[jj];
+        fun_err = fabs(fun[kk] - fun_ref) > fun_err ? fabs(fun[kk] - fun_ref) : fun_err;
+    }
+
+    double h = 1e-5;
+    double BAbt_err = 0.0;
+    for (int jj = 0; jj < nu + nx; jj++)
+    {
+        ux_p = ux0;
+        ux_m = ux0;
+        ux_p[jj] += h;
+        ux_m[jj] -= h;
+        pendulum_simulate(&ref, &ux_p[nu], &ux_p[0], Ts, xn_p.data());
+        pendulum_simulate(&ref, &ux_m[nu], &ux_m[0], Ts, xn_m.data());
+
+        for (int kk = 0; kk < nx1; kk++)
+        {
+            double d_ref = 0.0;
+            for (int ll = 0; ll < nx; ll++)
+                d_ref += T_tr[kk + nx1 * ll] * (xn_p[ll] - xn_m[ll]) / (2 * h);
+            double err = fabs(BAbt[jj + (nu + nx) * kk] - d_ref);
+            BAbt_err = err > BAbt_err ? err : BAbt_err;
+        }
+    }
+
+    std::cout << "\n---> state transition: max error of dyn_fun " << fun_err
+              << ", of BAbt to finite differences " << BAbt_err << "\n";
+    REQUIRE(fun_err <= 1e-12);
+    REQUIRE(BAbt_err <= 1e-6);
+
+    ocp_nlp_solver_destroy(solver);
+    ocp_nlp_opts_destroy(nlp_opts);
+    ocp_nlp_out_destroy(nlp_out);
+    ocp_nlp_in_destroy(nlp_in);
+    ocp_nlp_dims_destroy(dims);
+    ocp_nlp_config_destroy(config);
+    ocp_nlp_plan_destroy(plan);
+
+    pendulum_ocp_free(&ref);
+}
+
+
+
+TEST_CASE("pendulum non-uniform sampling times", "[ocp_nlp]")
+{
+    const int N = PENDULUM_N;
+    const int nx = PENDULUM_NX;
+    const int nu = PENDULUM_NU;
+
+    pendulum_ocp rti;
+    pendulum_ocp_create_plan(&rti, 0);
+    rti.plan->nlp_solver = SQP_RTI;
+    pendulum_ocp_create(&rti);
+
+    // from half to one and a half times the uniform step, the horizon is unchanged
+    vector<double> Ts(N);
+    for (int ii = 0; ii < N; ii++)
+    {
+        Ts[ii] = PENDULUM_TF / N * (0.5 + ii / (N - 1.0));
+        ocp_nlp_in_set(rti.config, rti.dims, rti.nlp_in, ii, "Ts", &Ts[ii]);
+    }
+
+    double u0 = 1.5;
+    pendulum_ocp_init_out(&rti, rti.nlp_out, u0);
+    pendulum_ocp_create_solver(&rti);
+
+    // a single RTI call linearizes at the initial guess
+    REQUIRE(ocp_nlp_solve(rti.solver, rti.nlp_in, rti.nlp_out) == ACADOS_SUCCESS);
+
+    ocp_nlp_sqp_rti_memory *mem = (ocp_nlp_sqp_rti_memory *) rti.solver->mem;
+
+    // reference: every stage integrated over its own Ts, BAbt by central differences in (u, x)
+    vector<double> ux0(nu + nx), ux_p(nu + nx), ux_m(nu + nx);
+    ux0[0] = u0;
+    for (int jj = 0; jj < nx; jj++)
+        ux0[nu + jj] = rti.x0[jj];
+
+    vector<double> BAbt((nu + nx) * nx), fun(nx);
+    vector<double> xn(nx), xn_p(nx), xn_m(nx);
+    double h = 1e-5;
+    double fun_err = 0.0;
+    double BAbt_err = 0.0;
+    for (int ii = 0; ii < N; ii++)
+    {
+        blasfeo_unpack_dmat(nu + nx, nx, mem->qp_in->BAbt+ii, 0, 0, BAbt.data(), nu + nx);
+        blasfeo_unpack_dvec(nx, mem->nlp_mem->dyn_fun+ii, 0, fun.data());
+
+        // all stages start from x0, the next state of the initial guess is x0 as well
+        pendulum_simulate(&rti, &ux0[nu], &ux0[0], Ts[ii], xn.data());
+        for (int kk = 0; kk < nx; kk++)
+        {
+            double err = fabs(fun[kk] - (xn[kk] - rti.x0[kk]));
+            fun_err = err > fun_err ? err : fun_err;
+        }
+
+        for (int jj = 0; jj < nu + nx; jj++)
+        {
+            ux_p = ux0;
+            ux_m = ux0;
+            ux_p[jj] += h;
+            ux_m[jj] -= h;
+            pendulum_simulate(&rti, &ux_p[nu], &ux_p[0], Ts[ii], xn_p.data());
+            pendulum_simulate(&rti, &ux_m[nu], &ux_m[0], Ts[ii], xn_m.data());
+
+            for (int kk = 0; kk < nx; kk++)
+            {
+                double err = fabs(BAbt[jj + (nu + nx) * kk] - (xn_p[kk] - xn_m[kk]) / (2 * h));
+                BAbt_err = err > BAbt_err ? err : BAbt_err;
+            }
+        }
+    }
+
+    std::cout << "\n---> non-uniform Ts: max error of dyn_fun " << fun_err
+              << ", of BAbt to finite differences " << BAbt_err << "\n";
+    REQUIRE(fun_err <= 1e-12);
+    REQUIRE(BAbt_err <= 1e-6);
+
+    pendulum_ocp_free(&rti);
+}
+
+
+
+TEST_CASE("pendulum shift", "[ocp_nlp]")
+{
+    const int N = PENDULUM_N;
+    const int nx = PENDULUM_NX;
+    const int nu = PENDULUM_NU;
+
+    pendulum_ocp ocp;
+    pendulum_ocp_create_plan(&ocp, 0);
+    pendulum_ocp_create(&ocp);
+    pendulum_ocp_create_solver(&ocp);
+
+    REQUIRE(ocp_nlp_solve(ocp.solver, ocp.nlp_in, ocp.nlp_out) == ACADOS_SUCCESS);
+
+    // solution before the shift
+    vector<vector<double>> x(N+1, vector<double>(nx)), u(N, vector<double>(nu));
+    vector<vector<double>> pi(N, vector<double>(nx));
+    for (int ii = 0; ii <= N; ii++)
+    {
+        ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, ii, "x", x[ii].data());
+        if (ii < N)
+        {
+            ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, ii, "u", u[ii].data());
+            ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, ii, "pi", pi[ii].data());
+        }
+    }
+
+    vector<double> x_new(nx), u_new(nu), pi_new(nx);
+
+    SECTION("duplicate")
+    {
+        ocp_nlp_shift(ocp.solver, ocp.nlp_in, ocp.nlp_out, OCP_NLP_SHIFT_DUPLICATE);
+
+        // every stage holds the values of its successor
+        for (int ii = 0; ii < N; ii++)
+        {
+            ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, ii, "x", x_new.data());
+            REQUIRE(x_new == x[ii+1]);
+
+            ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, ii, "u", u_new.data());
+            REQUIRE(u_new == u[ii < N-1 ? ii+1 : N-1]);
+
+            if (ii < N-1)
+            {
+                ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, ii, "pi", pi_new.data());
+                REQUIRE(pi_new == pi[ii+1]);
+            }
+        }
+
+        ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, N, "x", x_new.data());
+        REQUIRE(x_new == x[N]);
+    }
+
+    SECTION("simulate")
+    {
+        ocp_nlp_shift(ocp.solver, ocp.nlp_in, ocp.nlp_out, OCP_NLP_SHIFT_SIMULATE);
+
+        for (int ii = 0; ii < N; ii++)
+        {
+            ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, ii, "x", x_new.data());
+            REQUIRE(x_new == x[ii+1]);
+        }
+
+        // the last state is x_N simulated with the last control
+        vector<double> xn(nx);
+        pendulum_simulate(&ocp, x[N].data(), u[N-1].data(), PENDULUM_TF / N, xn.data());
+
+        ocp_nlp_out_get(ocp.config, ocp.dims, ocp.nlp_out, N, "x", x_new.data());
+        for (int jj = 0; jj < nx; jj++)
+            REQUIRE(fabs(x_new[jj] - xn[jj]) <= 1e-12);
+    }
+
+    pendulum_ocp_free(&ocp);
+}
+
+
+TEST_CASE("pendulum warm start database", "[ocp_nlp]")
+{
+    double x0_a[PENDULUM_NX] = {0.0, 0.0, 0.6, 0.0};
+    double x0_b[PENDULUM_NX] = {0.0, 0.0, -0.5, 0.0};
+
+    // same sequence of initial states with and without the database
+    pendulum_ocp ocp_db, ocp_ref;
+    pendulum_ocp_create_plan(&ocp_db, 0);
+    pendulum_ocp_create(&ocp_db);
+    int ws_db_size = 4;
+    double ws_db_jump = 0.1;
+    ocp_nlp_opts_set(ocp_db.config, ocp_db.nlp_opts, "ws_db_size", &ws_db_size);
+    ocp_nlp_opts_set(ocp_db.config, ocp_db.nlp_opts, "ws_db_jump", &ws_db_jump);
+    pendulum_ocp_create_solver(&ocp_db);
+
+    pendulum_ocp_create_plan(&ocp_ref, 0);
+    pendulum_ocp_create(&ocp_ref);
+    pendulum_ocp_create_solver(&ocp_ref);
+
+    int ws_db_hit, iter_db, iter_ref;
+
+    for (pendulum_ocp *ocp : {&ocp_db, &ocp_ref})
+    {
+        pendulum_ocp_set_x0(ocp, ocp->nlp_in, x0_a);
+        REQUIRE(ocp_nlp_solve(ocp->solver, ocp->nlp_in, ocp->nlp_out) == ACADOS_SUCCESS);
+        pendulum_ocp_set_x0(ocp, ocp->nlp_in, x0_b);
+        REQUIRE(ocp_nlp_solve(ocp->solver, ocp->nlp_in, ocp->nlp_out) == ACADOS_SUCCESS);
+    }
+
+    // the jump to x0_b found no closer entry than the previous solution
+    ocp_nlp_get(ocp_db.config, ocp_db.solver, "ws_db_hit", &ws_db_hit);
+    REQUIRE(ws_db_hit == 0);
+
+    // jumping back to x0_a starts from its stored solution
+    for (pendulum_ocp *ocp : {&ocp_db, &ocp_ref})
+    {
+        pendulum_ocp_set_x0(ocp, ocp->nlp_in, x0_a);
+        REQUIRE(ocp_nlp_solve(ocp->solver, ocp->nlp_in, ocp->nlp_out) == ACADOS_SUCCESS);
+    }
+
+    ocp_nlp_get(ocp_db.config, ocp_db.solver, "ws_db_hit", &ws_db_hit);
+    ocp_nlp_get(ocp_db.config, ocp_db.solver, "sqp_iter", &iter_db);
+    ocp_nlp_get(ocp_ref.config, ocp_ref.solver, "sqp_iter", &iter_ref);
+
+    double diff = pendulum_ocp_max_diff(&ocp_db, ocp_db.nlp_out, ocp_ref.nlp_out);
+    std::cout << "\n---> warm start database: " << iter_db << " SQP iterations, without "
+              << iter_ref << ", max difference " << diff << "\n";
+
+    REQUIRE(ws_db_hit == 1);
+    REQUIRE(iter_db < iter_ref);
+    REQUIRE(diff <= 1e-6);
+
+    pendulum_ocp_free(&ocp_ref);
+    pendulum_ocp_free(&ocp_db);
+}
+
+
+TEST_CASE("pendulum multistart", "[ocp_nlp]")
+{
+    const int K = 3;
+
+    pendulum_ocp ref;
+    pendulum_ocp_create_plan(&ref, 0);
+    pendulum_ocp_create(&ref);
+    pendulum_ocp_create_solver(&ref);
+    REQUIRE(ocp_nlp_solve(ref.solver, ref.nlp_in, ref.nlp_out) == ACADOS_SUCCESS);
+
+    // start 0 cannot converge within its iteration limit, starts 1 and 2 converge to the
+    // reference solution
+    pendulum_ocp ocp[K];
+    ocp_nlp_solver *solvers[K];
+    ocp_nlp_in *nlp_in[K];
+    ocp_nlp_out *nlp_out[K];
+    double u_init[K] = {0.0, 0.0, 1.0};
+    for (int ii = 0; ii < K; ii++)
+    {
+        pendulum_ocp_create_plan(&ocp[ii], 0);
+        pendulum_ocp_create(&ocp[ii]);
+        if (ii == 0)
+        {
+            int max_iter = 1;
+            ocp_nlp_opts_set(ocp[ii].config, ocp[ii].nlp_opts, "max_iter", &max_iter);
+        }
+        pendulum_ocp_create_solver(&ocp[ii]);
+        pendulum_ocp_init_out(&ocp[ii], ocp[ii].nlp_out, u_init[ii]);
+
+        solvers[ii] = ocp[ii].solver;
+        nlp_in[ii] = ocp[ii].nlp_in;
+        nlp_out[ii] = ocp[ii].nlp_out;
+    }
+
+    int winner = -1;
+    int status = ocp_nlp_solve_multistart(solvers, nlp_in, nlp_out, K, 0.0, &winner);
+
+    REQUIRE(status == ACADOS_SUCCESS);
+    REQUIRE(winner > 0);
+
+    double diff = pendulum_ocp_max_diff(&ref, nlp_out[winner], ref.nlp_out);
+    std::cout << "\n---> multistart: winner " << winner << ", max difference to SQP " << diff
+              << "\n";
+    REQUIRE(diff <= 1e-6);
+
+    int status_ii[K];
+    for (int ii = 0; ii < K; ii++)
+        ocp_nlp_get(ocp[ii].config, solvers[ii], "status", &status_ii[ii]);
+
+#if defined(ACADOS_WITH_OPENMP)
+    // the instances run concurrently, the others may finish before the winner cancels them
+    REQUIRE((status_ii[0] == ACADOS_MAXITER || status_ii[0] == ACADOS_CANCELLED));
+    for (int ii = 1; ii < K; ii++)
+        if (ii != winner)
+            REQUIRE((status_ii[ii] == ACADOS_SUCCESS || status_ii[ii] == ACADOS_CANCELLED));
+#else
+    // sequential: start 1 converges and cancels start 2 before it is run
+    REQUIRE(winner == 1);
+    REQUIRE(status_ii[0] == ACADOS_MAXITER);
+    REQUIRE(status_ii[2] == ACADOS_CANCELLED);
+#endif
+
+    for (int ii = 0; ii < K; ii++)
+        pendulum_ocp_free(&ocp[ii]);
+    pendulum_ocp_free(&ref);
+}
+
+
+TEST_CASE("pendulum RTI delay compensation", "[ocp_nlp]")
+{
+    const int nx = PENDULUM_NX;
+    const int nu = PENDULUM_NU;
+    double Ts = PENDULUM_TF / PENDULUM_N;
+
+    pendulum_ocp rti;
+    pendulum_ocp_create_plan(&rti, 0);
+    rti.plan->nlp_solver = SQP_RTI;
+    pendulum_ocp_create(&rti);
+
+    // the predicted x0 is the first state of the QP solution
+    vector<double> x0_meas(rti.x0, rti.x0 + nx), x0_sol(nx), x0_sim(nx);
+    vector<double> u_prev(nu, 1.0);
+
+    SECTION("integrator")
+    {
+        double delay = 0.4 * Ts;
+        ocp_nlp_opts_set(rti.config, rti.nlp_opts, "delay", &delay);
+        pendulum_ocp_create_solver(&rti);
+
+        // the first call predicts with the initialization of u
+        pendulum_ocp_init_out(&rti, rti.nlp_out, u_prev[0]);
+
+        for (int ii = 0; ii < 3; ii++)
+        {
+            REQUIRE(ocp_nlp_solve(rti.solver, rti.nlp_in, rti.nlp_out) == ACADOS_SUCCESS);
+
+            ocp_nlp_out_get(rti.config, rti.dims, rti.nlp_out, 0, "x", x0_sol.data());
+            pendulum_simulate(&rti, x0_meas.data(), u_prev.data(), delay, x0_sim.data());
+
+            double diff = 0.0;
+            for (int jj = 0; jj < nx; jj++)
+                diff = fabs(x0_sol[jj] - x0_sim[jj]) > diff ? fabs(x0_sol[jj] - x0_sim[jj]) : diff;
+            std::cout << "\n---> delay compensation, call " << ii
+                      << ": max difference to the simulated x0 " << diff << "\n";
+            REQUIRE(diff <= 1e-7);
+
+            // the next call predicts with the first control of this one
+            ocp_nlp_out_get(rti.config, rti.dims, rti.nlp_out, 0, "u", u_prev.data());
+        }
+    }
+
+    SECTION("linearization")
+    {
+        // a delay of one sampling time reuses the stage 0 sensitivities of the last
+        // linearization, which is first order accurate around the previous prediction
+        ocp_nlp_opts_set(rti.config, rti.nlp_opts, "delay", &Ts);
+        pendulum_ocp_create_solver(&rti);
+
+        for (int ii = 0; ii < 20; ii++)
+        {
+            ocp_nlp_out_get(rti.config, rti.dims, rti.nlp_out, 0, "u", u_prev.data());
+            REQUIRE(ocp_nlp_solve(rti.solver, rti.nlp_in, rti.nlp_out) == ACADOS_SUCCESS);
+        }
+
+        ocp_nlp_out_get(rti.config, rti.dims, rti.nlp_out, 0, "x", x0_sol.data());
+        pendulum_simulate(&rti, x0_meas.data(), u_prev.data(), Ts, x0_sim.data());
+
+        double diff = 0.0;
+        double displacement = 0.0;
+        for (int jj = 0; jj < nx; jj++)
+        {
+            diff = fabs(x0_sol[jj] - x0_sim[jj]) > diff ? fabs(x0_sol[jj] - x0_sim[jj]) : diff;
+            displacement = fabs(x0_meas[jj] - x0_sim[jj]) > displacement ?
+                           fabs(x0_meas[jj] - x0_sim[jj]) : displacement;
+        }
+        std::cout << "\n---> delay compensation, first order: max difference to the simulated x0 "
+                  << diff << ", displacement over the delay " << displacement << "\n";
+        REQUIRE(diff <= 0.1 * displacement);
+    }
+
+    pendulum_ocp_free(&rti);
+}
+
+
+static int pendulum_tip_evaluations(pendulum_ocp *ocp)
+{
+    int n_eval = 0;
+    for (int ii = 0; ii <= PENDULUM_N; ii++)
+        n_eval += ocp->tip[ii].n_eval;
+    return n_eval;
+}
+
+
+
+TEST_CASE("pendulum constraint screening", "[ocp_nlp]")
+{
+    // the tip bound is far from active on most stages
+    pendulum_ocp ref, ocp;
+    pendulum_ocp_create_plan(&ref, 1);
+    pendulum_ocp_create(&ref);
+    pendulum_ocp_create_solver(&ref);
+
+    pendulum_ocp_create_plan(&ocp, 1);
+    pendulum_ocp_create(&ocp);
+    double screen_margin = 0.2;
+    ocp_nlp_opts_set(ocp.config, ocp.nlp_opts, "screen_margin", &screen_margin);
+    pendulum_ocp_create_solver(&ocp);
+
+    REQUIRE(ocp_nlp_solve(ref.solver, ref.nlp_in, ref.nlp_out) == ACADOS_SUCCESS);
+    REQUIRE(ocp_nlp_solve(ocp.solver, ocp.nlp_in, ocp.nlp_out) == ACADOS_SUCCESS);
+
+    int n_eval_ref = pendulum_tip_evaluations(&ref);
+    int n_eval = pendulum_tip_evaluations(&ocp);
+
+    // the final verification evaluates all constraints, the solution is the same
+    double diff = pendulum_ocp_max_diff(&ocp, ocp.nlp_out, ref.nlp_out);
+    std::cout << "\n---> screening: " << n_eval << " evaluations of h, without " << n_eval_ref
+              << ", max difference " << diff << "\n";
+
+    REQUIRE(n_eval < n_eval_ref);
+    REQUIRE(diff <= 1e-6);
+
+    pendulum_ocp_free(&ocp);
+    pendulum_ocp_free(&ref);
+}
+
+
+// pendulum OCP on a scenario tree with branching at the root only; the nodes of the second
+// branch have the input bound umax_b instead of PENDULUM_UMAX
+typedef struct
+{
+    ocp_nlp_plan *plan;
+    ocp_nlp_config *config;
+    ocp_nlp_tree_dims *dims;
+    ocp_nlp_in *nlp_in;
+    ocp_nlp_out *nlp_out;
+    void *nlp_opts;
+    ocp_nlp_solver *solver;
+
+    int Nn;
+    vector<int> branch;  // child of the root the node descends from, -1 for the root
+
+    vector<external_function_casadi> expl_ode_fun;
+    vector<external_function_casadi> expl_vde_for;
+    vector<external_function_casadi> expl_vde_adj;
+    vector<external_function_casadi> expl_ode_hes;
+} pendulum_tree;
+
+
+
+static void pendulum_tree_create(pendulum_tree *tree, int md, double umax_b, const double *x0)
+{
+    int Nh = PENDULUM_N;
+    int Nr = 1;
+    int Nn = ocp_nlp_tree_num_nodes(md, Nr, Nh);
+    int Ne = Nn - 1;
+
+    tree->Nn = Nn;
+
+    // plan: cost and constraints by node, dynamics by edge
+    tree->plan = ocp_nlp_plan_create(Ne);
+    tree->plan->nlp_solver = SQP_TREE;
+    tree->plan->regularization = NO_REGULARIZE;
+    for (int ii = 0; ii < Nn; ii++)
+    {
+        tree->plan->nlp_cost[ii] = LINEAR_LS;
+        tree->plan->nlp_constraints[ii] = BGH;
+    }
+    for (int ii = 0; ii < Ne; ii++)
+    {
+        tree->plan->nlp_dynamics[ii] = CONTINUOUS_MODEL;
+        tree->plan->sim_solver_plan[ii].sim_solver = ERK;
+    }
+
+    tree->config = ocp_nlp_config_create(*tree->plan);
+    tree->dims = ocp_nlp_tree_dims_create(tree->config, md, Nr, Nh);
+
+    ocp_nlp_config *config = tree->config;
+    ocp_nlp_tree_dims *dims = tree->dims;
+
+    // dims
+    vector<int> nx(Nn), nu(Nn), nz(Nn), ns(Nn);
+    tree->branch.resize(Nn);
+    int n_branch = 0;
+    for (int ii = 0; ii < Nn; ii++)
+    {
+        int leaf = ocp_nlp_tree_dims_get_stage(dims, ii) == Nh;
+        nx[ii] = PENDULUM_NX;
+        nu[ii] = leaf ? 0 : PENDULUM_NU;
+        nz[ii] = 0;
+        ns[ii] = 0;
+
+        int dad = ocp_nlp_tree_dims_get_parent(dims, ii);
+        if (dad < 0)
+            tree->branch[ii] = -1;
+        else
+            tree->branch[ii] = dad == 0 ? n_branch++ : tree->branch[dad];
+    }
+
+    ocp_nlp_tree_dims_set_opt_vars(config, dims, "nx", nx.data());
+    ocp_nlp_tree_dims_set_opt_vars(config, dims, "nu", nu.data());
+    ocp_nlp_tree_dims_set_opt_vars(config, dims, "nz", nz.data());
+    ocp_nlp_tree_dims_set_opt_vars(config, dims, "ns", ns.data());
+
+    for (int ii = 0; ii < Nn; ii++)
+    {
+        int ny = nx[ii] + nu[ii];
+        int nbx = ii == 0 ? PENDULUM_NX : 0;
+        int zero = 0;
+        ocp_nlp_tree_dims_set_cost(config, dims, ii, "ny", &ny);
+        ocp_nlp_tree_dims_set_constraints(config, dims, ii, "nbx", &nbx);
+        ocp_nlp_tree_dims_set_constraints(config, dims, ii, "nbu", &nu[ii]);
+        ocp_nlp_tree_dims_set_constraints(config, dims, ii, "ng", &zero);
+        ocp_nlp_tree_dims_set_constraints(config, dims, ii, "nh", &zero);
+    }
+
+    // one set of external functions per edge, the edges are linearized in parallel
+    tree->expl_ode_fun.resize(Ne);
+    tree->expl_vde_for.resize(Ne);
+    tree->expl_vde_adj.resize(Ne);
+    tree->expl_ode_hes.resize(Ne);
+    pendulum_ocp_select_casadi(Ne, tree->expl_ode_fun.data(), tree->expl_vde_for.data(),
+                               tree->expl_vde_adj.data(), tree->expl_ode_hes.data());
+    external_function_casadi_create_array(Ne, tree->expl_ode_fun.data());
+    external_function_casadi_create_array(Ne, tree->expl_vde_for.data());
+    external_function_casadi_create_array(Ne, tree->expl_vde_adj.data());
+    external_function_casadi_create_array(Ne, tree->expl_ode_hes.data());
+
+    // model
+    ocp_nlp_dims *nlp_dims = dims->nlp_dims;
+    tree->nlp_in = ocp_nlp_in_create(config, nlp_dims);
+
+    double Ts = PENDULUM_TF / Nh;
+    for (int ii = 0; ii < Ne; ii++)
+    {
+        ocp_nlp_in_set(config, nlp_dims, tree->nlp_in, ii, "Ts", &Ts);
+        ocp_nlp_dynamics_model_set(config, nlp_dims, tree->nlp_in, ii, "expl_ode_fun",
+                                   &tree->expl_ode_fun[ii]);
+        ocp_nlp_dynamics_model_set(config, nlp_dims, tree->nlp_in, ii, "expl_vde_for",
+                                   &tree->expl_vde_for[ii]);
+        ocp_nlp_dynamics_model_set(config, nlp_dims, tree->nlp_in, ii, "expl_vde_adj",
+                                   &tree->expl_vde_adj[ii]);
+        ocp_nlp_dynamics_model_set(config, nlp_dims, tree->nlp_in, ii, "expl_ode_hes",
+                                   &tree->expl_ode_hes[ii]);
+    }
+
+    for (int ii = 0; ii < Nn; ii++)
+    {
+        double umax = tree->branch[ii] == 1 ? umax_b : PENDULUM_UMAX;
+        pendulum_ocp_set_stage(config, nlp_dims, tree->nlp_in, ii, nu[ii] == 0, umax);
+    }
+
+    int idxbx0[] = {0, 1, 2, 3};
+    ocp_nlp_constraints_model_set(config, nlp_dims, tree->nlp_in, 0, "idxbx", idxbx0);
+    ocp_nlp_constraints_model_set(config, nlp_dims, tree->nlp_in, 0, "lbx", (void *) x0);
+    ocp_nlp_constraints_model_set(config, nlp_dims, tree->nlp_in, 0, "ubx", (void *) x0);
+
+    // initialization
+    tree->nlp_out = ocp_nlp_out_create(config, nlp_dims);
+    double u0 = 0.0;
+    for (int ii = 0; ii < Nn; ii++)
+    {
+        ocp_nlp_out_set(config, nlp_dims, tree->nlp_out, ii, "x", (void *) x0);
+        if (nu[ii] > 0)
+            ocp_nlp_out_set(config, nlp_dims, tree->nlp_out, ii, "u", &u0);
+    }
+
+    // solver
+    tree->nlp_opts = ocp_nlp_tree_opts_create(config, dims);
+
+    int max_iter = 100;
+    double tol = 1e-8;
+    ocp_nlp_opts_set(config, tree->nlp_opts, "max_iter", &max_iter);
+    ocp_nlp_opts_set(config, tree->nlp_opts, "tol_stat", &tol);
+    ocp_nlp_opts_set(config, tree->nlp_opts, "tol_eq", &tol);
+    ocp_nlp_opts_set(config, tree->nlp_opts, "tol_ineq", &tol);
+    ocp_nlp_opts_set(config, tree->nlp_opts, "tol_comp", &tol);
+
+    tree->solver = ocp_nlp_tree_solver_create(config, dims, tree->nlp_opts);
+    ocp_nlp_precompute(tree->solver, tree->nlp_in, tree->nlp_out);
+}
+
+
+
+static void pendulum_tree_free(pendulum_tree *tree)
+{
+    int Ne = tree->Nn - 1;
+
+    ocp_nlp_solver_destroy(tree->solver);
+    ocp_nlp_opts_destroy(tree->nlp_opts);
+    ocp_nlp_out_destroy(tree->nlp_out);
+    ocp_nlp_in_destroy(tree->nlp_in);
+    ocp_nlp_tree_dims_destroy(tree->dims);
+    ocp_nlp_config_destroy(tree->config);
+    ocp_nlp_plan_destroy(tree->plan);
+
+    external_function_casadi_free_array(Ne, tree->expl_ode_fun.data());
+    external_function_casadi_free_array(Ne, tree->expl_vde_for.data());
+    external_function_casadi_free_array(Ne, tree->expl_vde_adj.data());
+    external_function_casadi_free_array(Ne, tree->expl_ode_hes.data());
+}
+
+
+
+// largest difference of a tree node to a stage of the linear-horizon solution
+static double pendulum_tree_node_diff(pendulum_tree *tree, int node, ocp_nlp_out *ref_out)
+{
+    int stage = ocp_nlp_tree_dims_get_stage(tree->dims, node);
+    int nv = tree->dims->nlp_dims->nv[node];
+
+    double max_diff = 0.0;
+    for (int jj = 0; jj < nv; jj++)
+    {
+        double diff = fabs(BLASFEO_DVECEL(tree->nlp_out->ux+node, jj)
+                           - BLASFEO_DVECEL(ref_out->ux+stage, jj));
+        max_diff = diff > max_diff ? diff : max_diff;
+    }
+    return max_diff;
+}
+
+
+
+TEST_CASE("pendulum scenario tree SQP", "[ocp_nlp]")
+{
+    pendulum_ocp ref;
+    pendulum_ocp_create_plan(&ref, 0);
+    pendulum_ocp_create(&ref);
+    pendulum_ocp_create_solver(&ref);
+
+    REQUIRE(ocp_nlp_solve(ref.solver, ref.nlp_in, ref.nlp_out) == ACADOS_SUCCESS);
+
+    pendulum_tree tree;
+    int status;
+
+    SECTION("single branch")
+    {
+        // md = 1 is a chain, node ii is stage ii
+        pendulum_tree_create(&tree, 1, PENDULUM_UMAX, ref.x0);
+        REQUIRE(tree.Nn == PENDULUM_N + 1);
+
+        status = ocp_nlp_solve(tree.solver, tree.nlp_in, tree.nlp_out);
+        REQUIRE(status == ACADOS_SUCCESS);
+
+        double diff = 0.0;
+        for (int ii = 0; ii < tree.Nn; ii++)
+        {
+            REQUIRE(ocp_nlp_tree_dims_get_stage(tree.dims, ii) == ii);
+            double diff_ii = pendulum_tree_node_diff(&tree, ii, ref.nlp_out);
+            diff = diff_ii > diff ? diff_ii : diff;
+        }
+        std::cout << "\n---> tree md = 1, max difference to SQP: " << diff << "\n";
+        REQUIRE(diff <= 1e-6);
+
+        pendulum_tree_free(&tree);
+    }
+
+    SECTION("two identical branches")
+    {
+        // both scenarios are the nominal problem, each path reproduces its solution
+        pendulum_tree_create(&tree, 2, PENDULUM_UMAX, ref.x0);
+        REQUIRE(tree.Nn == 2 * PENDULUM_N + 1);
+
+        status = ocp_nlp_solve(tree.solver, tree.nlp_in, tree.nlp_out);
+        REQUIRE(status == ACADOS_SUCCESS);
+
+        double diff = 0.0;
+        for (int ii = 0; ii < tree.Nn; ii++)
+        {
+            double diff_ii = pendulum_tree_node_diff(&tree, ii, ref.nlp_out);
+            diff = diff_ii > diff ? diff_ii : diff;
+        }
+        std::cout << "\n---> tree md = 2, max difference to SQP: " << diff << "\n";
+        REQUIRE(diff <= 1e-6);
+
+        pendulum_tree_free(&tree);
+    }
+
+    SECTION("two different branches")
+    {
+        // the second scenario has a tighter input bound that is active in the nominal solution
+        double umax_b = 2.0;
+        double u_nom_max = 0.0;
+        for (int ii = 1; ii < PENDULUM_N; ii++)
+        {
+            double u = fabs(BLASFEO_DVECEL(ref.nlp_out->ux+ii, 0));
+            u_nom_max = u > u_nom_max ? u : u_nom_max;
+        }
+        REQUIRE(u_nom_max > umax_b);
+
+        pendulum_tree_create(&tree, 2, umax_b, ref.x0);
+
+        status = ocp_nlp_solve(tree.solver, tree.nlp_in, tree.nlp_out);
+        REQUIRE(status == ACADOS_SUCCESS);
+
+        // nodes of the two scenarios by stage
+        vector<int> node_a(PENDULUM_N + 1, 0), node_b(PENDULUM_N + 1, 0);
+        for (int ii = 1; ii < tree.Nn; ii++)
+        {
+            int stage = ocp_nlp_tree_dims_get_stage(tree.dims, ii);
+            if (tree.branch[ii] == 0)
+                node_a[stage] = ii;
+            else
+                node_b[stage] = ii;
+        }
+
+        double branch_diff = 0.0;
+        for (int ss = 1; ss < PENDULUM_N; ss++)
+        {
+            double u_b = BLASFEO_DVECEL(tree.nlp_out->ux+node_b[ss], 0);
+            REQUIRE(fabs(u_b) <= umax_b + 1e-6);
+
+            double u_a = BLASFEO_DVECEL(tree.nlp_out->ux+node_a[ss], 0);
+            branch_diff = fabs(u_a - u_b) > branch_diff ? fabs(u_a - u_b) : branch_diff;
+        }
+        std::cout << "\n---> tree md = 2, max control difference of the scenarios: "
+                  << branch_diff << "\n";
+        REQUIRE(branch_diff > 1e-3);
+
+        // the root control hedges against the restricted scenario
+        double u0_diff = fabs(BLASFEO_DVECEL(tree.nlp_out->ux+0, 0)
+                              - BLASFEO_DVECEL(ref.nlp_out->ux+0, 0));
+        REQUIRE(u0_diff > 1e-6);
+
+        pendulum_tree_free(&tree);
+    }
+
+    pendulum_ocp_free(&ref);
+}
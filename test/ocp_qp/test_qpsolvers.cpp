@@ -32,6 +32,7 @@
  */
 
 
+#include <cmath>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -41,6 +42,13 @@
 
 #include "acados_c/ocp_qp_interface.h"
 
+#include "blasfeo/include/blasfeo_d_aux.h"
+
+#ifdef ACADOS_WITH_OSQP
+// osqp only has a timer when it is built with PROFILING, which its headers define
+#include "acados/ocp_qp/ocp_qp_osqp.h"
+#endif
+
 extern "C" {
 ocp_qp_xcond_solver_dims *create_ocp_qp_dims_mass_spring(ocp_qp_xcond_solver_config *config, int N, int nx_, int nu_, int nb_, int ng_, int ngN);
 ocp_qp_in *create_ocp_qp_in_mass_spring(ocp_qp_dims *dims);
@@ -273,3 +281,546 @@ TEST_CASE("mass spring example", "[QP solvers]")
     }  // END_FOR_SOLVERS
 
 }  // END_TEST_CASE
+
+
+
+// soften the state bounds of stages 1 to N with an L1 and L2 penalty on the slacks
+static void soften_state_bounds_mass_spring(ocp_qp_xcond_solver_config *config,
+                                            ocp_qp_xcond_solver_dims *dims)
+{
+    int N = dims->orig_dims->N;
+
+    for (int ii = 1; ii <= N; ii++)
+    {
+        int nsbx = dims->orig_dims->nbx[ii];
+        config->dims_set(config, dims, ii, "nsbx", &nsbx);
+    }
+}
+
+
+
+static void set_slack_cost_mass_spring(ocp_qp_in *qp_in)
+{
+    ocp_qp_dims *dims = qp_in->dim;
+
+    for (int ii = 0; ii <= dims->N; ii++)
+    {
+        int nv = dims->nu[ii] + dims->nx[ii];
+        int ni = dims->nb[ii] + dims->ng[ii];
+        int ns = dims->ns[ii];
+
+        for (int jj = 0; jj < ns; jj++)
+            qp_in->idxs[ii][jj] = dims->nbu[ii] + jj;
+
+        // weights small enough that the slacks are active at the solution
+        blasfeo_dvecse(2*ns, 1.0, qp_in->Z+ii, 0);
+        blasfeo_dvecse(2*ns, 0.1, qp_in->rqz+ii, nv);
+        blasfeo_dvecse(2*ns, 0.0, qp_in->d+ii, 2*ni);
+        blasfeo_dvecse(2*ns, 0.0, qp_in->m+ii, 2*ni);
+    }
+}
+
+
+
+// solve the mass spring QP with hpipm and copy the primal solution, slacks included
+static int solve_mass_spring_hpipm(bool soft, int single_precision, vector<double> &ux, double *res)
+{
+    int nx_ = 8;
+    int nu_ = 3;
+    int N = 15;
+    int nb_ = 11;
+    int ng_ = 0;
+    int ngN = 0;
+    int ir_iter = 3;
+
+    ocp_qp_solver_plan plan;
+    plan.qp_solver = PARTIAL_CONDENSING_HPIPM;
+
+    ocp_qp_xcond_solver_config *config = ocp_qp_xcond_solver_config_create(plan);
+
+    ocp_qp_xcond_solver_dims *qp_dims =
+        create_ocp_qp_dims_mass_spring(config, N, nx_, nu_, nb_, ng_, ngN);
+    if (soft)
+        soften_state_bounds_mass_spring(config, qp_dims);
+
+    ocp_qp_in *qp_in = create_ocp_qp_in_mass_spring(qp_dims->orig_dims);
+    set_slack_cost_mass_spring(qp_in);
+
+    ocp_qp_out *qp_out = ocp_qp_out_create(qp_dims->orig_dims);
+
+    void *opts = ocp_qp_xcond_solver_opts_create(config, qp_dims);
+    config->opts_set(config, opts, "cond_N", &N);
+    config->opts_set(config, opts, "single_precision", &single_precision);
+    config->opts_set(config, opts, "ir_iter", &ir_iter);
+
+    ocp_qp_solver *qp_solver = ocp_qp_create(config, qp_dims, opts);
+
+    int acados_return = ocp_qp_solve(qp_solver, qp_in, qp_out);
+
+    ocp_qp_inf_norm_residuals(qp_dims->orig_dims, qp_in, qp_out, res);
+
+    ux.clear();
+    ocp_qp_dims *dims = qp_in->dim;
+    for (int ii = 0; ii <= N; ii++)
+        for (int jj = 0; jj < dims->nu[ii] + dims->nx[ii] + 2*dims->ns[ii]; jj++)
+            ux.push_back(BLASFEO_DVECEL(qp_out->ux+ii, jj));
+
+    free(qp_solver);
+    free(qp_out);
+    free(qp_in);
+    free(qp_dims);
+    free(opts);
+    free(config);
+
+    return acados_return;
+}
+
+
+
+TEST_CASE("hpipm single precision with iterative refinement", "[QP solvers]")
+{
+    // the inequalities are resolved to the single precision ipm tolerance,
+    // the refinement steps recover the equality constraints to double precision
+    double tol_ir = 1e-4;
+    double tol_eq = 1e-6;
+
+    vector<double> ux_double, ux_single;
+    double res_double[4], res_single[4];
+
+    for (bool soft : {false, true})
+    {
+        SECTION(soft ? "soft constraints" : "hard constraints")
+        {
+            REQUIRE(solve_mass_spring_hpipm(soft, 0, ux_double, res_double) == 0);
+            REQUIRE(solve_mass_spring_hpipm(soft, 1, ux_single, res_single) == 0);
+
+            REQUIRE(ux_single.size() == ux_double.size());
+
+            double max_err = 0.0;
+            for (std::size_t ii = 0; ii < ux_double.size(); ii++)
+            {
+                double err = fabs(ux_single[ii] - ux_double[ii]);
+                max_err = err > max_err ? err : max_err;
+            }
+
+            std::cout << "\n---> hpipm single vs double precision"
+                      << (soft ? " (soft)" : "") << ": max error " << max_err << "\n";
+            REQUIRE(max_err <= tol_ir);
+
+            REQUIRE(res_single[1] <= tol_eq);
+        }
+    }
+}
+
+
+
+// solve the mass spring QP with partial condensing on the given number of threads and copy the
+// partially condensed QP and the expanded solution
+static int solve_mass_spring_pcond(int num_threads, vector<double> &cond_qp, vector<double> &sol)
+{
+    int nx_ = 8;
+    int nu_ = 3;
+    int N = 15;
+    int nb_ = 11;
+    int ng_ = 0;
+    int ngN = 0;
+    int N2 = 5;
+
+    ocp_qp_solver_plan plan;
+    plan.qp_solver = PARTIAL_CONDENSING_HPIPM;
+
+    ocp_qp_xcond_solver_config *config = ocp_qp_xcond_solver_config_create(plan);
+
+    ocp_qp_xcond_solver_dims *qp_dims =
+        create_ocp_qp_dims_mass_spring(config, N, nx_, nu_, nb_, ng_, ngN);
+
+    ocp_qp_in *qp_in = create_ocp_qp_in_mass_spring(qp_dims->orig_dims);
+    ocp_qp_out *qp_out = ocp_qp_out_create(qp_dims->orig_dims);
+
+    void *opts = ocp_qp_xcond_solver_opts_create(config, qp_dims);
+    config->opts_set(config, opts, "cond_N", &N2);
+    config->opts_set(config, opts, "cond_num_threads", &num_threads);
+
+    ocp_qp_solver *qp_solver = ocp_qp_create(config, qp_dims, opts);
+
+    int acados_return = ocp_qp_solve(qp_solver, qp_in, qp_out);
+
+    // partially condensed QP
+    ocp_qp_xcond_solver_memory *mem = (ocp_qp_xcond_solver_memory *) qp_solver->mem;
+    ocp_qp_in *pcond_qp_in = (ocp_qp_in *) mem->xcond_qp_in;
+    ocp_qp_dims *pdims = pcond_qp_in->dim;
+
+    cond_qp.clear();
+    for (int ii = 0; ii <= pdims->N; ii++)
+    {
+        int nu = pdims->nu[ii];
+        int nx = pdims->nx[ii];
+        int ni = pdims->nb[ii] + pdims->ng[ii];
+        int ns = pdims->ns[ii];
+
+        for (int jj = 0; jj <= nu + nx; jj++)
+            for (int kk = 0; kk < nu + nx; kk++)
+                cond_qp.push_back(BLASFEO_DMATEL(pcond_qp_in->RSQrq+ii, jj, kk));
+        for (int jj = 0; jj < nu + nx + 2*ns; jj++)
+            cond_qp.push_back(BLASFEO_DVECEL(pcond_qp_in->rqz+ii, jj));
+        for (int jj = 0; jj < 2*ni + 2*ns; jj++)
+            cond_qp.push_back(BLASFEO_DVECEL(pcond_qp_in->d+ii, jj));
+        for (int jj = 0; jj < pdims->nb[ii]; jj++)
+            cond_qp.push_back(pcond_qp_in->idxb[ii][jj]);
+
+        if (ii < pdims->N)
+        {
+            int nx1 = pdims->nx[ii+1];
+            for (int jj = 0; jj <= nu + nx; jj++)
+                for (int kk = 0; kk < nx1; kk++)
+                    cond_qp.push_back(BLASFEO_DMATEL(pcond_qp_in->BAbt+ii, jj, kk));
+            for (int jj = 0; jj < nx1; jj++)
+                cond_qp.push_back(BLASFEO_DVECEL(pcond_qp_in->b+ii, jj));
+        }
+    }
+
+    // expanded solution
+    ocp_qp_dims *dims = qp_in->dim;
+
+    sol.clear();
+    for (int ii = 0; ii <= N; ii++)
+    {
+        int ni = dims->nb[ii] + dims->ng[ii] + dims->ns[ii];
+        for (int jj = 0; jj < dims->nu[ii] + dims->nx[ii] + 2*dims->ns[ii]; jj++)
+            sol.push_back(BLASFEO_DVECEL(qp_out->ux+ii, jj));
+        for (int jj = 0; jj < 2*ni; jj++)
+            sol.push_back(BLASFEO_DVECEL(qp_out->lam+ii, jj));
+        if (ii < N)
+            for (int jj = 0; jj < dims->nx[ii+1]; jj++)
+                sol.push_back(BLASFEO_DVECEL(qp_out->pi+ii, jj));
+    }
+
+    free(qp_solver);
+    free(qp_out);
+    free(qp_in);
+    free(qp_dims);
+    free(opts);
+    free(config);
+
+    return acados_return;
+}
+
+
+
+TEST_CASE("partial condensing on multiple threads", "[QP solvers]")
+{
+    // the blocks are condensed and expanded independently, so the thread count
+    // must not change the result beyond rounding
+    double tol = 1e-14;
+
+    vector<double> cond_serial, sol_serial;
+    REQUIRE(solve_mass_spring_pcond(1, cond_serial, sol_serial) == 0);
+
+    for (int num_threads : {2, 4})
+    {
+        SECTION("num_threads = " + std::to_string(num_threads))
+        {
+            vector<double> cond_parallel, sol_parallel;
+            REQUIRE(solve_mass_spring_pcond(num_threads, cond_parallel, sol_parallel) == 0);
+
+            REQUIRE(cond_parallel.size() == cond_serial.size());
+            REQUIRE(sol_parallel.size() == sol_serial.size());
+
+            double max_err_cond = 0.0;
+            for (std::size_t ii = 0; ii < cond_serial.size(); ii++)
+            {
+                double err = fabs(cond_parallel[ii] - cond_serial[ii]);
+                max_err_cond = err > max_err_cond ? err : max_err_cond;
+            }
+
+            double max_err_sol = 0.0;
+            for (std::size_t ii = 0; ii < sol_serial.size(); ii++)
+            {
+                double err = fabs(sol_parallel[ii] - sol_serial[ii]);
+                max_err_sol = err > max_err_sol ? err : max_err_sol;
+            }
+
+            std::cout << "\n---> partial condensing on " << num_threads
+                      << " threads: max error condensed QP " << max_err_cond
+                      << ", solution " << max_err_sol << "\n";
+            REQUIRE(max_err_cond <= tol);
+            REQUIRE(max_err_sol <= tol);
+        }
+    }
+}
+
+
+
+#ifdef ACADOS_WITH_QPOASES
+TEST_CASE("qpoases warm start from the previous working set", "[QP solvers]")
+{
+    int nx_ = 8;
+    int nu_ = 3;
+    int N = 15;
+    int nb_ = 11;
+    int ng_ = 0;
+    int ngN = 0;
+
+    ocp_qp_solver_plan plan;
+    plan.qp_solver = FULL_CONDENSING_QPOASES;
+
+    ocp_qp_xcond_solver_config *config = ocp_qp_xcond_solver_config_create(plan);
+
+    ocp_qp_xcond_solver_dims *qp_dims =
+        create_ocp_qp_dims_mass_spring(config, N, nx_, nu_, nb_, ng_, ngN);
+
+    ocp_qp_in *qp_in = create_ocp_qp_in_mass_spring(qp_dims->orig_dims);
+    ocp_qp_out *out_cold = ocp_qp_out_create(qp_dims->orig_dims);
+    ocp_qp_out *out_warm = ocp_qp_out_create(qp_dims->orig_dims);
+
+    // one solver starting from an empty working set, one from the previous one
+    int warm_start = 0;
+    void *opts_cold = ocp_qp_xcond_solver_opts_create(config, qp_dims);
+    config->opts_set(config, opts_cold, "warm_start", &warm_start);
+    ocp_qp_solver *solver_cold = ocp_qp_create(config, qp_dims, opts_cold);
+
+    warm_start = 1;
+    void *opts_warm = ocp_qp_xcond_solver_opts_create(config, qp_dims);
+    config->opts_set(config, opts_warm, "warm_start", &warm_start);
+    ocp_qp_solver *solver_warm = ocp_qp_create(config, qp_dims, opts_warm);
+
+    REQUIRE(ocp_qp_solve(solver_cold, qp_in, out_cold) == 0);
+    REQUIRE(ocp_qp_solve(solver_warm, qp_in, out_warm) == 0);
+
+    // neighbouring QP: small change of the linear cost term, as between two MPC samples
+    ocp_qp_dims *dims = qp_in->dim;
+    for (int ii = 0; ii <= N; ii++)
+        for (int jj = 0; jj < dims->nu[ii] + dims->nx[ii]; jj++)
+            BLASFEO_DVECEL(qp_in->rqz+ii, jj) += 1e-2;
+
+    REQUIRE(ocp_qp_solve(solver_cold, qp_in, out_cold) == 0);
+    REQUIRE(ocp_qp_solve(solver_warm, qp_in, out_warm) == 0);
+
+    int iter_cold = ((qp_info *) out_cold->misc)->num_iter;
+    int iter_warm = ((qp_info *) out_warm->misc)->num_iter;
+
+    double max_err = 0.0;
+    for (int ii = 0; ii <= N; ii++)
+    {
+        for (int jj = 0; jj < dims->nu[ii] + dims->nx[ii]; jj++)
+        {
+            double err = fabs(BLASFEO_DVECEL(out_warm->ux+ii, jj) - BLASFEO_DVECEL(out_cold->ux+ii, jj));
+            max_err = err > max_err ? err : max_err;
+        }
+    }
+
+    std::cout << "\n---> qpoases working set recalculations: cold " << iter_cold
+              << ", warm " << iter_warm << ", max difference " << max_err << "\n";
+
+    REQUIRE(iter_cold > 0);
+    REQUIRE(iter_warm < iter_cold);
+    REQUIRE(max_err <= 1e-10);
+
+    free(solver_warm);
+    free(solver_cold);
+    free(opts_warm);
+    free(opts_cold);
+    free(out_warm);
+    free(out_cold);
+    free(qp_in);
+    free(qp_dims);
+    free(config);
+}
+#endif
+
+
+
+#if defined(ACADOS_WITH_OSQP) && defined(PROFILING)
+TEST_CASE("osqp time limit", "[QP solvers]")
+{
+    int nx_ = 8;
+    int nu_ = 3;
+    int N = 15;
+    int nb_ = 11;
+    int ng_ = 0;
+    int ngN = 0;
+
+    ocp_qp_solver_plan plan;
+    plan.qp_solver = PARTIAL_CONDENSING_OSQP;
+
+    ocp_qp_xcond_solver_config *config = ocp_qp_xcond_solver_config_create(plan);
+
+    ocp_qp_xcond_solver_dims *qp_dims =
+        create_ocp_qp_dims_mass_spring(config, N, nx_, nu_, nb_, ng_, ngN);
+
+    ocp_qp_in *qp_in = create_ocp_qp_in_mass_spring(qp_dims->orig_dims);
+    ocp_qp_out *qp_out = ocp_qp_out_create(qp_dims->orig_dims);
+
+    void *opts = ocp_qp_xcond_solver_opts_create(config, qp_dims);
+    ocp_qp_solver *solver = ocp_qp_create(config, qp_dims, opts);
+
+    // a deadline hit reports ACADOS_MAXITER, as hpipm and qpOASES do, so that the SQP keeps the step
+    double time_limit = 1e-9;
+    config->opts_set(config, opts, "time_limit", &time_limit);
+    REQUIRE(ocp_qp_solve(solver, qp_in, qp_out) == ACADOS_MAXITER);
+
+    int iter_limited = ((qp_info *) qp_out->misc)->num_iter;
+
+    // the limit is passed on at every solve, 0 disables it again
+    time_limit = 0.0;
+    config->opts_set(config, opts, "time_limit", &time_limit);
+    REQUIRE(ocp_qp_solve(solver, qp_in, qp_out) == ACADOS_SUCCESS);
+
+    int iter_free = ((qp_info *) qp_out->misc)->num_iter;
+
+    REQUIRE(iter_limited < iter_free);
+
+    free(solver);
+    free(qp_out);
+    free(qp_in);
+    free(qp_dims);
+    free(opts);
+    free(config);
+}
+#endif
+
+
+
+// solve the mass spring QP with controls held over blocks of block_size stages and copy the
+// controls of all stages
+static int solve_mass_spring_blocked(ocp_qp_solver_t qp_solver, int block_size,
+                                     vector<double> &u, double *res)
+{
+    int nx_ = 8;
+    int nu_ = 3;
+    int N = 15;
+    int nb_ = 11;
+    int ng_ = 0;
+    int ngN = 0;
+
+    ocp_qp_solver_plan plan;
+    plan.qp_solver = qp_solver;
+
+    ocp_qp_xcond_solver_config *config = ocp_qp_xcond_solver_config_create(plan);
+
+    ocp_qp_xcond_solver_dims *qp_dims =
+        create_ocp_qp_dims_mass_spring(config, N, nx_, nu_, nb_, ng_, ngN);
+
+    // the first stage of each block is free, the others hold its controls
+    for (int ii = 1; ii < N; ii++)
+    {
+        int hold = ii % block_size != 0;
+        config->dims_set(config, qp_dims, ii, "mb_hold", &hold);
+    }
+
+    ocp_qp_in *qp_in = create_ocp_qp_in_mass_spring(qp_dims->orig_dims);
+    ocp_qp_out *qp_out = ocp_qp_out_create(qp_dims->orig_dims);
+
+    void *opts = ocp_qp_xcond_solver_opts_create(config, qp_dims);
+    if (qp_solver == PARTIAL_CONDENSING_HPIPM)
+    {
+        int N2 = 5;
+        config->opts_set(config, opts, "cond_N", &N2);
+    }
+
+    ocp_qp_solver *solver = ocp_qp_create(config, qp_dims, opts);
+
+    int acados_return = ocp_qp_solve(solver, qp_in, qp_out);
+
+    ocp_qp_inf_norm_residuals(qp_dims->orig_dims, qp_in, qp_out, res);
+
+    u.clear();
+    for (int ii = 0; ii < N; ii++)
+        for (int jj = 0; jj < nu_; jj++)
+            u.push_back(BLASFEO_DVECEL(qp_out->ux+ii, jj));
+
+    free(solver);
+    free(qp_out);
+    free(qp_in);
+    free(qp_dims);
+    free(opts);
+    free(config);
+
+    return acados_return;
+}
+
+
+
+TEST_CASE("move blocking", "[QP solvers]")
+{
+    int N = 15;
+    int nu_ = 3;
+
+    vector<double> u_free, u_blocked;
+    double res_free[4], res_blocked[4];
+
+    for (ocp_qp_solver_t qp_solver : {PARTIAL_CONDENSING_HPIPM, FULL_CONDENSING_HPIPM})
+    {
+        SECTION(qp_solver == PARTIAL_CONDENSING_HPIPM ? "partial condensing" : "full condensing")
+        {
+            // reference without any mb_hold set
+            ocp_qp_solver_plan plan;
+            plan.qp_solver = qp_solver;
+            ocp_qp_xcond_solver_config *config = ocp_qp_xcond_solver_config_create(plan);
+            ocp_qp_xcond_solver_dims *qp_dims =
+                create_ocp_qp_dims_mass_spring(config, N, 8, nu_, 11, 0, 0);
+            ocp_qp_in *qp_in = create_ocp_qp_in_mass_spring(qp_dims->orig_dims);
+            ocp_qp_out *qp_out = ocp_qp_out_create(qp_dims->orig_dims);
+            void *opts = ocp_qp_xcond_solver_opts_create(config, qp_dims);
+            if (qp_solver == PARTIAL_CONDENSING_HPIPM)
+            {
+                int N2 = 5;
+                config->opts_set(config, opts, "cond_N", &N2);
+            }
+            ocp_qp_solver *solver = ocp_qp_create(config, qp_dims, opts);
+            REQUIRE(ocp_qp_solve(solver, qp_in, qp_out) == 0);
+
+            vector<double> u_ref;
+            for (int ii = 0; ii < N; ii++)
+                for (int jj = 0; jj < nu_; jj++)
+                    u_ref.push_back(BLASFEO_DVECEL(qp_out->ux+ii, jj));
+
+            free(solver);
+            free(qp_out);
+            free(qp_in);
+            free(qp_dims);
+            free(opts);
+            free(config);
+
+            // blocks of size 1 hold no stage and reproduce the unblocked solve
+            REQUIRE(solve_mass_spring_blocked(qp_solver, 1, u_free, res_free) == 0);
+            REQUIRE(u_free.size() == u_ref.size());
+            double max_err = 0.0;
+            for (std::size_t ii = 0; ii < u_ref.size(); ii++)
+            {
+                double err = fabs(u_free[ii] - u_ref[ii]);
+                max_err = err > max_err ? err : max_err;
+            }
+            REQUIRE(max_err <= 1e-12);
+
+            // blocks of size 3: controls are constant over each block, the solution is feasible
+            int block_size = 3;
+            REQUIRE(solve_mass_spring_blocked(qp_solver, block_size, u_blocked, res_blocked) == 0);
+
+            double max_jump = 0.0;
+            double max_change = 0.0;
+            for (int ii = 1; ii < N; ii++)
+            {
+                for (int jj = 0; jj < nu_; jj++)
+                {
+                    double jump = fabs(u_blocked[ii*nu_+jj] - u_blocked[(ii-1)*nu_+jj]);
+                    if (ii % block_size != 0)
+                        max_jump = jump > max_jump ? jump : max_jump;
+                }
+            }
+            for (std::size_t ii = 0; ii < u_ref.size(); ii++)
+            {
+                double change = fabs(u_blocked[ii] - u_ref[ii]);
+                max_change = change > max_change ? change : max_change;
+            }
+
+            std::cout << "\n---> move blocking: max change of u within a block " << max_jump
+                      << ", max difference to the unblocked solution " << max_change << "\n";
+
+            REQUIRE(max_jump == 0.0);
+            REQUIRE(max_change > 1e-6);
+            REQUIRE(res_blocked[1] <= 1e-8);  // dynamics
+            REQUIRE(res_blocked[2] <= 1e-8);  // bounds
+        }
+    }
+}
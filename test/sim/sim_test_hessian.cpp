@@ -400,6 +400,12 @@ TEST_CASE("pendulum_hessians", "[integrators]")
             for (int num_steps = 1; num_steps < 20; num_steps += 2)
             {
             SECTION("num_steps = " + std::to_string(num_steps))
+            {
+            // checkpointing only implemented in ERK
+            int max_checkpoint_steps = hashitsim_hess(solver) == ERK ? 3 : 0;
+            for (int checkpoint_steps = 0; checkpoint_steps <= max_checkpoint_steps; checkpoint_steps += 3)
+            {
+            SECTION("checkpoint_steps = " + std::to_string(checkpoint_steps))
             {
 
 
@@ -452,6 +458,7 @@ TEST_CASE("pendulum_hessians", "[integrators]")
                     {
                         opts->num_steps *= 2;  // use more steps as explict RK has lower order
                     }
+                    opts->checkpoint_steps = checkpoint_steps;
                 }
 
 
@@ -616,6 +623,8 @@ TEST_CASE("pendulum_hessians", "[integrators]")
                 free(out);
                 free(sim_solver);
             }  // end SECTION
+            }  // end for checkpoint_steps
+            }  // end SECTION
             }  // end for
             }  // end SECTION
             }  // end for
@@ -53,12 +53,17 @@
 #include "acados_c/external_function_interface.h"
 #include "acados_c/sim_interface.h"
 
+#include "blasfeo/include/blasfeo_d_aux.h"
+
 // wt model
 #include "examples/c/wt_model_nx3/wt_model.h"
 
 // x0 and u for simulation
 #include "examples/c/wt_model_nx3/u_x0.c"
 
+// pendulum model (implicit, with hessians)
+#include "examples/c/pendulum_model/pendulum_model.h"
+
 extern "C"
 {
 
@@ -72,6 +77,7 @@ sim_solver_t hashitsim(std::string const& inString)
     if (inString == "IRK") return IRK;
     if (inString == "GNSF") return GNSF;
     if (inString == "LIFTED_IRK") return LIFTED_IRK;
+    if (inString == "ERK_ADAPTIVE") return ERK_ADAPTIVE;
 
     return (sim_solver_t) -1;
 }
@@ -82,6 +88,7 @@ double sim_solver_tolerance(std::string const& inString)
     if (inString == "IRK") return 1e-7;
     if (inString == "GNSF") return 1e-7;
     if (inString == "LIFTED_IRK") return 1e-5;
+    if (inString == "ERK_ADAPTIVE") return 1e-6;
 
     return -1;
 }
@@ -91,7 +98,7 @@ double sim_solver_tolerance(std::string const& inString)
 
 TEST_CASE("wt_nx3_example", "[integrators]")
 {
-    vector<std::string> solvers = {"ERK", "IRK", "GNSF", "LIFTED_IRK"};
+    vector<std::string> solvers = {"ERK", "IRK", "GNSF", "LIFTED_IRK", "ERK_ADAPTIVE"};
     // initialize dimensions
     int ii, jj;
 
@@ -418,6 +425,13 @@ TEST_CASE("wt_nx3_example", "[integrators]")
                         opts->ns = 2;  // number of stages in rk integrator
                         break;
 
+                    case ERK_ADAPTIVE:
+                        // Dormand-Prince 5(4) with local error control
+                        opts->ns = 7;  // number of stages in rk integrator
+                        opts->tol_abs = 1e-10;
+                        opts->tol_rel = 1e-10;
+                        break;
+
                     default :
                         printf("\nnot enough sim solvers implemented!\n");
                         exit(1);
@@ -437,6 +451,7 @@ TEST_CASE("wt_nx3_example", "[integrators]")
                 switch (plan.sim_solver)
                 {
                     case ERK:  // ERK
+                    case ERK_ADAPTIVE:  // adaptive ERK
                     {
                         sim_in_set(config, dims, in, "expl_ode_fun", &expl_ode_fun);
                         sim_in_set(config, dims, in, "expl_vde_for", &expl_vde_for);
@@ -593,3 +608,414 @@ TEST_CASE("wt_nx3_example", "[integrators]")
     external_function_casadi_free(&get_matrices_fun);
 
 }  // END_TEST_CASE
+
+
+
+/************************************************
+* IRK with sparse LU
+************************************************/
+
+// double integrator with swapped residual rows, f = [xdot_1 - u; xdot_0 - x_1]: the diagonal of
+// dG_dK is structurally zero, a pivot below IRK_SPARSE_LU_PIV_TOL, so the sparse LU without
+// pivoting has to fall back to the dense one
+static void swapped_di_res(void **in, struct blasfeo_dvec_args *res)
+{
+    struct blasfeo_dvec *x = (struct blasfeo_dvec *) in[0];
+    struct blasfeo_dvec_args *xdot = (struct blasfeo_dvec_args *) in[1];
+    double *u = (double *) in[2];
+
+    BLASFEO_DVECEL(res->x, res->xi+0) = BLASFEO_DVECEL(xdot->x, xdot->xi+1) - u[0];
+    BLASFEO_DVECEL(res->x, res->xi+1) = BLASFEO_DVECEL(xdot->x, xdot->xi+0) - BLASFEO_DVECEL(x, 1);
+}
+
+
+
+static void swapped_di_jac(struct blasfeo_dmat *df_dx, struct blasfeo_dmat *df_dxdot)
+{
+    blasfeo_dgese(2, 2, 0.0, df_dx, 0, 0);
+    BLASFEO_DMATEL(df_dx, 1, 1) = -1.0;
+    blasfeo_dgese(2, 2, 0.0, df_dxdot, 0, 0);
+    BLASFEO_DMATEL(df_dxdot, 0, 1) = 1.0;
+    BLASFEO_DMATEL(df_dxdot, 1, 0) = 1.0;
+}
+
+
+
+static void swapped_di_fun(void *self, ext_fun_arg_t *type_in, void **in, ext_fun_arg_t *type_out,
+                           void **out)
+{
+    swapped_di_res(in, (struct blasfeo_dvec_args *) out[0]);
+}
+
+
+
+static void swapped_di_fun_jac_x_xdot(void *self, ext_fun_arg_t *type_in, void **in,
+                                      ext_fun_arg_t *type_out, void **out)
+{
+    swapped_di_res(in, (struct blasfeo_dvec_args *) out[0]);
+    swapped_di_jac((struct blasfeo_dmat *) out[1], (struct blasfeo_dmat *) out[2]);
+}
+
+
+
+static void swapped_di_jac_x_xdot_u(void *self, ext_fun_arg_t *type_in, void **in,
+                                    ext_fun_arg_t *type_out, void **out)
+{
+    swapped_di_jac((struct blasfeo_dmat *) out[0], (struct blasfeo_dmat *) out[1]);
+
+    struct blasfeo_dmat *df_du = (struct blasfeo_dmat *) out[2];
+    blasfeo_dgese(2, 1, 0.0, df_du, 0, 0);
+    BLASFEO_DMATEL(df_du, 0, 0) = -1.0;
+}
+
+
+
+// the model is linear
+static void swapped_di_hess(void *self, ext_fun_arg_t *type_in, void **in, ext_fun_arg_t *type_out,
+                            void **out)
+{
+    struct blasfeo_dmat *hess = (struct blasfeo_dmat *) out[0];
+    blasfeo_dgese(hess->m, hess->n, 0.0, hess, 0, 0);
+}
+
+
+
+typedef struct
+{
+    int nx;
+    int nu;
+    double T;
+    int num_steps;
+    double *x0;
+    double *u;
+    void *impl_ode_fun;
+    void *impl_ode_fun_jac_x_xdot;
+    void *impl_ode_jac_x_xdot_u;
+    void *impl_ode_hess;
+} irk_sparse_lu_model;
+
+
+
+// simulates one interval with IRK, out_all holds xn, S_forw, S_adj and S_hess (if sens_hess)
+static void irk_sparse_lu_simulate(irk_sparse_lu_model *model, bool sparse_lu, bool jac_reuse,
+                                   bool sens_hess, vector<double> &out_all)
+{
+    int ii;
+    int nx = model->nx;
+    int nu = model->nu;
+    int NF = nx + nu;
+
+    sim_solver_plan plan;
+    plan.sim_solver = IRK;
+
+    sim_config *config = sim_config_create(plan);
+
+    void *dims = sim_dims_create(config);
+    sim_dims_set(config, dims, "nx", &nx);
+    sim_dims_set(config, dims, "nu", &nu);
+
+    void *opts_ = sim_opts_create(config, dims);
+    sim_opts *opts = (sim_opts *) opts_;
+    opts->sens_forw = true;
+    opts->sens_adj = true;
+    opts->sens_hess = sens_hess;
+    opts->jac_reuse = jac_reuse;
+    opts->newton_iter = 5;
+    opts->num_steps = model->num_steps;
+    opts->ns = 4;
+    sim_opts_set(config, opts_, "sparse_lu", &sparse_lu);
+
+    sim_in *in = sim_in_create(config, dims);
+    sim_out *out = sim_out_create(config, dims);
+
+    in->T = model->T;
+    sim_in_set(config, dims, in, "impl_ode_fun", model->impl_ode_fun);
+    sim_in_set(config, dims, in, "impl_ode_fun_jac_x_xdot", model->impl_ode_fun_jac_x_xdot);
+    sim_in_set(config, dims, in, "impl_ode_jac_x_xdot_u", model->impl_ode_jac_x_xdot_u);
+    sim_in_set(config, dims, in, "impl_ode_hess", model->impl_ode_hess);
+
+    for (ii = 0; ii < nx; ii++)
+        in->x[ii] = model->x0[ii];
+    for (ii = 0; ii < nu; ii++)
+        in->u[ii] = model->u[ii];
+    for (ii = 0; ii < nx * NF; ii++)
+        in->S_forw[ii] = 0.0;
+    for (ii = 0; ii < nx; ii++)
+        in->S_forw[ii * (nx + 1)] = 1.0;
+    for (ii = 0; ii < nx; ii++)
+        in->S_adj[ii] = 1.0;
+    for (ii = nx; ii < NF; ii++)
+        in->S_adj[ii] = 0.0;
+
+    sim_solver *solver = sim_solver_create(config, dims, opts);
+
+    int acados_return = sim_solve(solver, in, out);
+    REQUIRE(acados_return == 0);
+
+    out_all.assign(out->xn, out->xn + nx);
+    out_all.insert(out_all.end(), out->S_forw, out->S_forw + nx * NF);
+    out_all.insert(out_all.end(), out->S_adj, out->S_adj + NF);
+    if (sens_hess)
+        out_all.insert(out_all.end(), out->S_hess, out->S_hess + NF * NF);
+
+    free(config);
+    free(dims);
+    free(opts);
+
+    free(in);
+    free(out);
+    free(solver);
+}
+
+
+
+static double irk_sparse_lu_max_diff(irk_sparse_lu_model *model, bool jac_reuse, bool sens_hess)
+{
+    vector<double> out_dense, out_sparse;
+    irk_sparse_lu_simulate(model, false, jac_reuse, sens_hess, out_dense);
+    irk_sparse_lu_simulate(model, true, jac_reuse, sens_hess, out_sparse);
+
+    REQUIRE(out_dense.size() == out_sparse.size());
+
+    double max_diff = 0.0;
+    for (size_t ii = 0; ii < out_dense.size(); ii++)
+        max_diff = fmax(max_diff, fabs(out_sparse[ii] - out_dense[ii]));
+    return max_diff;
+}
+
+
+
+TEST_CASE("irk_sparse_lu", "[integrators]")
+{
+    /* pendulum, the sparse LU succeeds */
+    external_function_casadi impl_ode_fun;
+    impl_ode_fun.casadi_fun = &pendulum_ode_impl_ode_fun;
+    impl_ode_fun.casadi_work = &pendulum_ode_impl_ode_fun_work;
+    impl_ode_fun.casadi_sparsity_in = &pendulum_ode_impl_ode_fun_sparsity_in;
+    impl_ode_fun.casadi_sparsity_out = &pendulum_ode_impl_ode_fun_sparsity_out;
+    impl_ode_fun.casadi_n_in = &pendulum_ode_impl_ode_fun_n_in;
+    impl_ode_fun.casadi_n_out = &pendulum_ode_impl_ode_fun_n_out;
+    external_function_casadi_create(&impl_ode_fun);
+
+    external_function_casadi impl_ode_fun_jac_x_xdot;
+    impl_ode_fun_jac_x_xdot.casadi_fun = &pendulum_ode_impl_ode_fun_jac_x_xdot_z;
+    impl_ode_fun_jac_x_xdot.casadi_work = &pendulum_ode_impl_ode_fun_jac_x_xdot_z_work;
+    impl_ode_fun_jac_x_xdot.casadi_sparsity_in = &pendulum_ode_impl_ode_fun_jac_x_xdot_z_sparsity_in;
+    impl_ode_fun_jac_x_xdot.casadi_sparsity_out =
+                         &pendulum_ode_impl_ode_fun_jac_x_xdot_z_sparsity_out;
+    impl_ode_fun_jac_x_xdot.casadi_n_in = &pendulum_ode_impl_ode_fun_jac_x_xdot_z_n_in;
+    impl_ode_fun_jac_x_xdot.casadi_n_out = &pendulum_ode_impl_ode_fun_jac_x_xdot_z_n_out;
+    external_function_casadi_create(&impl_ode_fun_jac_x_xdot);
+
+    external_function_casadi impl_ode_jac_x_xdot_u;
+    impl_ode_jac_x_xdot_u.casadi_fun = &pendulum_ode_impl_ode_jac_x_xdot_u_z;
+    impl_ode_jac_x_xdot_u.casadi_work = &pendulum_ode_impl_ode_jac_x_xdot_u_z_work;
+    impl_ode_jac_x_xdot_u.casadi_sparsity_in = &pendulum_ode_impl_ode_jac_x_xdot_u_z_sparsity_in;
+    impl_ode_jac_x_xdot_u.casadi_sparsity_out = &pendulum_ode_impl_ode_jac_x_xdot_u_z_sparsity_out;
+    impl_ode_jac_x_xdot_u.casadi_n_in = &pendulum_ode_impl_ode_jac_x_xdot_u_z_n_in;
+    impl_ode_jac_x_xdot_u.casadi_n_out = &pendulum_ode_impl_ode_jac_x_xdot_u_z_n_out;
+    external_function_casadi_create(&impl_ode_jac_x_xdot_u);
+
+    external_function_casadi impl_ode_hess;
+    impl_ode_hess.casadi_fun = &pendulum_ode_impl_ode_hess;
+    impl_ode_hess.casadi_work = &pendulum_ode_impl_ode_hess_work;
+    impl_ode_hess.casadi_sparsity_in = &pendulum_ode_impl_ode_hess_sparsity_in;
+    impl_ode_hess.casadi_sparsity_out = &pendulum_ode_impl_ode_hess_sparsity_out;
+    impl_ode_hess.casadi_n_in = &pendulum_ode_impl_ode_hess_n_in;
+    impl_ode_hess.casadi_n_out = &pendulum_ode_impl_ode_hess_n_out;
+    external_function_casadi_create(&impl_ode_hess);
+
+    double x0_pendulum[4] = {0.0, 0.5, 0.0, 0.0};
+    double u_pendulum[1] = {0.1};
+
+    irk_sparse_lu_model pendulum;
+    pendulum.nx = 4;
+    pendulum.nu = 1;
+    pendulum.T = 0.1;
+    pendulum.num_steps = 10;
+    pendulum.x0 = x0_pendulum;
+    pendulum.u = u_pendulum;
+    pendulum.impl_ode_fun = &impl_ode_fun;
+    pendulum.impl_ode_fun_jac_x_xdot = &impl_ode_fun_jac_x_xdot;
+    pendulum.impl_ode_jac_x_xdot_u = &impl_ode_jac_x_xdot_u;
+    pendulum.impl_ode_hess = &impl_ode_hess;
+
+    /* swapped double integrator, the sparse LU falls back to the dense one */
+    external_function_generic di_fun = {&swapped_di_fun};
+    external_function_generic di_fun_jac_x_xdot = {&swapped_di_fun_jac_x_xdot};
+    external_function_generic di_jac_x_xdot_u = {&swapped_di_jac_x_xdot_u};
+    external_function_generic di_hess = {&swapped_di_hess};
+
+    double x0_di[2] = {0.1, -0.2};
+    double u_di[1] = {0.5};
+
+    irk_sparse_lu_model swapped_di;
+    swapped_di.nx = 2;
+    swapped_di.nu = 1;
+    swapped_di.T = 0.1;
+    swapped_di.num_steps = 2;
+    swapped_di.x0 = x0_di;
+    swapped_di.u = u_di;
+    swapped_di.impl_ode_fun = &di_fun;
+    swapped_di.impl_ode_fun_jac_x_xdot = &di_fun_jac_x_xdot;
+    swapped_di.impl_ode_jac_x_xdot_u = &di_jac_x_xdot_u;
+    swapped_di.impl_ode_hess = &di_hess;
+
+    for (int jac_reuse = 0; jac_reuse < 2; jac_reuse++)
+    {
+        for (int sens_hess = 0; sens_hess < 2; sens_hess++)
+        {
+            double diff_pendulum = irk_sparse_lu_max_diff(&pendulum, jac_reuse, sens_hess);
+            double diff_di = irk_sparse_lu_max_diff(&swapped_di, jac_reuse, sens_hess);
+
+            std::cout << "\n---> testing IRK sparse LU (jac_reuse = " << jac_reuse
+                      << ", sens_hess = " << sens_hess << ")\n";
+            std::cout  << "max_diff pendulum          = " << diff_pendulum << "\n";
+            std::cout  << "max_diff dense fallback    = " << diff_di << "\n";
+
+            REQUIRE(diff_pendulum <= 1e-10);
+            REQUIRE(diff_di <= 1e-10);
+        }
+    }
+
+    external_function_casadi_free(&impl_ode_fun);
+    external_function_casadi_free(&impl_ode_fun_jac_x_xdot);
+    external_function_casadi_free(&impl_ode_jac_x_xdot_u);
+    external_function_casadi_free(&impl_ode_hess);
+}  // END_TEST_CASE
+
+
+
+TEST_CASE("wt_nx3_batch", "[integrators]")
+{
+    int ii, jj;
+
+    const int nx = 3;
+    const int nu = 4;
+    int NF = nx + nu;  // columns of forward seed
+
+    const int M = 16;  // number of trajectories
+
+    double T = 0.05;  // simulation time
+
+    sim_solver_plan plan;
+    plan.sim_solver = ERK;
+
+    sim_config *config = sim_config_create(plan);
+
+    void *dims = sim_dims_create(config);
+    sim_dims_set(config, dims, "nx", &nx);
+    sim_dims_set(config, dims, "nu", &nu);
+
+    void *opts_ = sim_opts_create(config, dims);
+    sim_opts *opts = (sim_opts *) opts_;
+    opts->ns = 4;
+    opts->num_steps = 3;
+    opts->sens_adj = false;
+
+    // batch solver, one worker per available thread
+    sim_batch_solver *batch_solver = sim_batch_solver_create(config, dims, opts, 0);
+    int num_threads = batch_solver->num_threads;
+
+    // reference solver
+    sim_solver *solver = sim_solver_create(config, dims, opts);
+    sim_in *in = sim_in_create(config, dims);
+    sim_out *out = sim_out_create(config, dims);
+
+    // external functions: one set per worker, plus one for the reference solver
+    vector<external_function_casadi> expl_ode_fun(num_threads + 1);
+    vector<external_function_casadi> expl_vde_for(num_threads + 1);
+    for (ii = 0; ii <= num_threads; ii++)
+    {
+        expl_ode_fun[ii].casadi_fun = &casadi_expl_ode_fun;
+        expl_ode_fun[ii].casadi_work = &casadi_expl_ode_fun_work;
+        expl_ode_fun[ii].casadi_sparsity_in = &casadi_expl_ode_fun_sparsity_in;
+        expl_ode_fun[ii].casadi_sparsity_out = &casadi_expl_ode_fun_sparsity_out;
+        expl_ode_fun[ii].casadi_n_in = &casadi_expl_ode_fun_n_in;
+        expl_ode_fun[ii].casadi_n_out = &casadi_expl_ode_fun_n_out;
+        external_function_casadi_create(&expl_ode_fun[ii]);
+
+        expl_vde_for[ii].casadi_fun = &casadi_expl_vde_for;
+        expl_vde_for[ii].casadi_work = &casadi_expl_vde_for_work;
+        expl_vde_for[ii].casadi_sparsity_in = &casadi_expl_vde_for_sparsity_in;
+        expl_vde_for[ii].casadi_sparsity_out = &casadi_expl_vde_for_sparsity_out;
+        expl_vde_for[ii].casadi_n_in = &casadi_expl_vde_for_n_in;
+        expl_vde_for[ii].casadi_n_out = &casadi_expl_vde_for_n_out;
+        external_function_casadi_create(&expl_vde_for[ii]);
+    }
+
+    for (ii = 0; ii < num_threads; ii++)
+    {
+        sim_batch_in_set(batch_solver, ii, "T", &T);
+        sim_batch_in_set(batch_solver, ii, "expl_ode_fun", &expl_ode_fun[ii]);
+        sim_batch_in_set(batch_solver, ii, "expl_vde_for", &expl_vde_for[ii]);
+    }
+    sim_batch_precompute(batch_solver);
+
+    in->T = T;
+    sim_in_set(config, dims, in, "expl_ode_fun", &expl_ode_fun[num_threads]);
+    sim_in_set(config, dims, in, "expl_vde_for", &expl_vde_for[num_threads]);
+    for (ii = 0; ii < nx * NF; ii++)
+        in->S_forw[ii] = 0.0;
+    for (ii = 0; ii < nx; ii++)
+        in->S_forw[ii * (nx + 1)] = 1.0;
+    sim_precompute(solver, in, out);
+
+    // structure-of-arrays inputs, perturbed initial states
+    vector<double> x0_batch(nx * M);
+    vector<double> u_batch(nu * M);
+    vector<double> xn_batch(nx * M);
+    vector<double> S_batch(nx * NF * M);
+    for (jj = 0; jj < M; jj++)
+    {
+        for (ii = 0; ii < nx; ii++)
+            x0_batch[ii * M + jj] = x0[ii] * (1.0 + 0.01 * jj);
+        for (ii = 0; ii < nu; ii++)
+            u_batch[ii * M + jj] = u_sim[ii];
+    }
+
+    int acados_return = sim_solve_batch(batch_solver, M, x0_batch.data(), u_batch.data(),
+                                        xn_batch.data(), S_batch.data());
+    REQUIRE(acados_return == 0);
+
+    double max_error = 0.0;
+    double max_error_forw = 0.0;
+    for (jj = 0; jj < M; jj++)
+    {
+        for (ii = 0; ii < nx; ii++)
+            in->x[ii] = x0_batch[ii * M + jj];
+        for (ii = 0; ii < nu; ii++)
+            in->u[ii] = u_batch[ii * M + jj];
+
+        acados_return = sim_solve(solver, in, out);
+        REQUIRE(acados_return == 0);
+
+        for (ii = 0; ii < nx; ii++)
+            max_error = fmax(max_error, fabs(out->xn[ii] - xn_batch[ii * M + jj]));
+        for (ii = 0; ii < nx * NF; ii++)
+            max_error_forw = fmax(max_error_forw, fabs(out->S_forw[ii] - S_batch[ii * M + jj]));
+    }
+
+    std::cout << "\n---> testing batch integrator ERK (M = " << M << ", num_threads = "
+              << num_threads << ")\n";
+    std::cout  << "error_sim   = " << max_error << "\n";
+    std::cout  << "error_forw  = " << max_error_forw << "\n";
+
+    REQUIRE(max_error <= 1e-12);
+    REQUIRE(max_error_forw <= 1e-12);
+
+    for (ii = 0; ii <= num_threads; ii++)
+    {
+        external_function_casadi_free(&expl_ode_fun[ii]);
+        external_function_casadi_free(&expl_vde_for[ii]);
+    }
+
+    sim_batch_solver_destroy(batch_solver);
+    free(config);
+    free(dims);
+    free(opts);
+
+    free(in);
+    free(out);
+    free(solver);
+}  // END_TEST_CASE